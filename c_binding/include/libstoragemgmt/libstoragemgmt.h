@@ -22,6 +22,7 @@
 #include "libstoragemgmt_local_disk.h"
 #include "libstoragemgmt_nfsexport.h"
 #include "libstoragemgmt_pool.h"
+#include "libstoragemgmt_rpc_stats.h"
 #include "libstoragemgmt_snapshot.h"
 #include "libstoragemgmt_systems.h"
 #include "libstoragemgmt_targetport.h"
@@ -40,6 +41,16 @@ extern "C" {
  * Description:
  *      Get a connection to a storage provider.
  *
+ *      Since version 1.11 a connection can be used by several threads at
+ *      once. Their requests are sent to the plugin as they are made rather
+ *      than one after the other, and each thread gets its own errors from
+ *      lsm_error_last_get(). A list iterator or a batch is used by one
+ *      thread at a time, and the connection must not be closed while other
+ *      threads still use it. Once the plugin goes away or sends something
+ *      which can't be read, every call on the connection, including those
+ *      already waiting, fails with LSM_ERR_TRANSPORT_COMMUNICATION or
+ *      LSM_ERR_TRANSPORT_SERIALIZATION.
+ *
  * @uri:
  *      Uniform Resource Identifier (see URI documentation)
  * @password:
@@ -110,98 +121,1441 @@ int LSM_DLL_EXPORT lsm_connect_close(lsm_connect *conn, lsm_flag flags);
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
- *              On success.
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer or
+ *              invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_plugin_info_get(lsm_connect *conn, char **desc,
+                                       char **version, lsm_flag flags);
+
+/**
+ * lsm_available_plugins_list - Retrieves a list of available plug-ins.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Retrieve a list of available plug-ins.
+ *
+ * @sep:
+ *      Data separator used for string of plugin. Check document of 'plugins'
+ *      argument for detail.
+ * @plugins:
+ *      String list of plug-ins with the form 'desc<sep>version'.
+ *      Returned plugins memory should be freed by calling
+ *      lsm_string_list_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags.
+ *
+ */
+int LSM_DLL_EXPORT lsm_available_plugins_list(const char *sep,
+                                              lsm_string_list **plugins,
+                                              lsm_flag flags);
+
+/**
+ * lsm_connect_timeout_set - Sets the time-out for this connection.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Sets the time-out for this connection.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Time-out in ms.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid lsm_connect or invalid
+ *              flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_timeout_set(lsm_connect *conn, uint32_t timeout,
+                                           lsm_flag flags);
+
+/**
+ * lsm_connect_timeout_get - Gets the time-out for this connection.
+ *
+ * Version:
+ *      1.0
+ *
+ * Description:
+ *      Gets the time-out for this connection.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @timeout:
+ *      Output pointer of uint32_t. Time-out in ms.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_timeout_get(lsm_connect *conn, uint32_t *timeout,
+                                           lsm_flag flags);
+
+/**
+ * lsm_connect_fd_get - Gets the file descriptor of a connection.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Gets the file descriptor the connection uses to talk to the plugin, so
+ *      an application can wait for responses to requests sent with
+ *      lsm_rpc_submit() using poll(2), epoll(7) or an event loop of its
+ *      choice. The descriptor stays owned by the connection, it must not be
+ *      read from, written to or closed by the application.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @fd:
+ *      Output pointer of int. The file descriptor.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_fd_get(lsm_connect *conn, int *fd,
+                                      lsm_flag flags);
+
+/**
+ * lsm_connect_stats_get - Gets the statistics of the calls made so far.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Gets, for each method called on this connection, how many calls were
+ *      made, how many bytes were sent and received, the time spent
+ *      serializing, in the transport and plugin and deserializing, and a
+ *      histogram of how long the calls took. Only calls which got a
+ *      response are counted. Use it to find slow plugins and oversized
+ *      responses. Accessors for the records are in libstoragemgmt_rpc_stats.h.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @stats:
+ *      Output pointer of lsm_rpc_stats array, one record per method. Memory
+ *      should be freed by lsm_rpc_stats_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of records.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_NO_MEMORY
+ *              When no memory.
+ */
+int LSM_DLL_EXPORT lsm_connect_stats_get(lsm_connect *conn,
+                                         lsm_rpc_stats **stats[],
+                                         uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_connect_stats_reset - Clears the statistics of a connection.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Clears what lsm_connect_stats_get() returns. Calls outstanding are
+ *      still counted once their response arrives.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When argument 'conn' is not a valid lsm_connect pointer or
+ *              invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_stats_reset(lsm_connect *conn, lsm_flag flags);
+
+/**
+ * lsm_connect_cache_ttl_set - Answers some reads from a cache on the client.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Keeps the responses to lsm_system_list(), lsm_pool_list() or
+ *      lsm_capabilities(), as chosen by 'what', for 'ttl_ms' milliseconds,
+ *      and answers the same calls made in that time without asking the
+ *      plugin. Calling any method which may change what the plugin reports,
+ *      like lsm_volume_create() or lsm_system_read_cache_pct_update(),
+ *      throws all the cached responses away, so does this call. Changes
+ *      made outside this connection are only seen once the responses
+ *      expire or lsm_connect_cache_clear() is called. Nothing is cached
+ *      unless asked for.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @what:
+ *      Which of the reads to cache, as enumerated by 'lsm_cache_class'.
+ * @ttl_ms:
+ *      How long to keep responses for, in milliseconds. 0 turns caching
+ *      off for 'what'.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When argument 'conn' is not a valid lsm_connect pointer,
+ *              'what' is not a valid lsm_cache_class or invalid flags.
+ *          * LSM_ERR_NO_MEMORY
+ *              When no memory.
+ */
+int LSM_DLL_EXPORT lsm_connect_cache_ttl_set(lsm_connect *conn,
+                                             lsm_cache_class what,
+                                             uint32_t ttl_ms, lsm_flag flags);
+
+/**
+ * lsm_connect_cache_stats_get - Gets how often the cache answered a read.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Gets how many of the calls cached by lsm_connect_cache_ttl_set()
+ *      were answered from the cache and how many had to ask the plugin,
+ *      since the connection was made.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @what:
+ *      Which of the reads to get the counts for.
+ * @hits:
+ *      Output pointer of uint64_t. Calls answered from the cache.
+ * @misses:
+ *      Output pointer of uint64_t. Calls sent to the plugin.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, 'conn' is not a valid lsm_connect
+ *              pointer, 'what' is not a valid lsm_cache_class or invalid
+ *              flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_cache_stats_get(lsm_connect *conn,
+                                               lsm_cache_class what,
+                                               uint64_t *hits,
+                                               uint64_t *misses,
+                                               lsm_flag flags);
+
+/**
+ * lsm_connect_cache_clear - Throws the cached responses away.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Makes the next calls cached by lsm_connect_cache_ttl_set() ask the
+ *      plugin again, e.g. after the storage was changed by another client.
+ *      The ttls set are kept.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When argument 'conn' is not a valid lsm_connect pointer or
+ *              invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_connect_cache_clear(lsm_connect *conn, lsm_flag flags);
+
+/**
+ * lsm_rpc_submit - Sends a listing request without waiting for the result.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Sends a listing request to the plugin and returns straight away. Any
+ *      number of requests can be outstanding on a connection at the same
+ *      time. Use lsm_rpc_poll_complete() to find out which requests have
+ *      been answered, and the lsm_rpc_*_complete() function matching the
+ *      method to retrieve the result.
+ *
+ *      Other calls on the connection can still be made while requests are
+ *      outstanding, they block as usual.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @method:
+ *      The listing to request, see lsm_rpc_method.
+ * @search_key:
+ *      Search key, same as for the blocking listing call. NULL if no
+ *      search is wanted. Must be NULL for LSM_RPC_SYSTEM_LIST.
+ * @search_value:
+ *      Search value.
+ * @rpc_id:
+ *      Output pointer of uint32_t. Identifies the request in
+ *      lsm_rpc_poll_complete() and the lsm_rpc_*_complete() functions.
+ * @flags:
+ *      Flags of the listing call, see the blocking listing call.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or unknown method.
+ *          * LSM_ERR_UNSUPPORTED_SEARCH_KEY
+ *              When provided search_key is not supported by the method.
+ *          * LSM_ERR_TRANSPORT_COMMUNICATION
+ *              When the request could not be sent.
+ */
+int LSM_DLL_EXPORT lsm_rpc_submit(lsm_connect *conn, lsm_rpc_method method,
+                                  const char *search_key,
+                                  const char *search_value, uint32_t *rpc_id,
+                                  lsm_flag flags);
+
+/**
+ * lsm_rpc_poll_complete - Checks for an answered request without blocking.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Reads what the plugin has sent so far without blocking and reports
+ *      the next request sent with lsm_rpc_submit() which has been
+ *      answered. Every request is reported once.
+ *
+ *      Responses already read off the file descriptor are buffered by the
+ *      connection, so after the descriptor became readable call this until
+ *      'rpc_id' comes back as 0 before waiting on it again.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Output pointer of uint32_t. Id of an answered request, or 0 if none
+ *      has been answered yet.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success, including when nothing has been answered yet.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags.
+ *          * LSM_ERR_TRANSPORT_COMMUNICATION
+ *              When the plugin went away or sent something unreadable.
+ */
+int LSM_DLL_EXPORT lsm_rpc_poll_complete(lsm_connect *conn, uint32_t *rpc_id,
+                                         lsm_flag flags);
+
+/**
+ * lsm_rpc_system_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_SYSTEM_LIST, same as lsm_system_list() would have returned it.
+ *      Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @systems:
+ *      Output pointer of lsm_system array. Memory should be freed by
+ *      lsm_system_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of systems.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_SYSTEM_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_system_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_system **systems[],
+    uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_rpc_pool_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_POOL_LIST, same as lsm_pool_list() would have returned it.
+ *      Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @pools:
+ *      Output pointer of lsm_pool array. Memory should be freed by
+ *      lsm_pool_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of pools.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_POOL_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_pool_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_pool **pools[], uint32_t *count,
+    lsm_flag flags);
+
+/**
+ * lsm_rpc_volume_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_VOLUME_LIST, same as lsm_volume_list() would have returned it.
+ *      Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @volumes:
+ *      Output pointer of lsm_volume array. Memory should be freed by
+ *      lsm_volume_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of volumes.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_VOLUME_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_volume_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_volume **volumes[],
+    uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_rpc_disk_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_DISK_LIST, same as lsm_disk_list() would have returned it.
+ *      Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @disks:
+ *      Output pointer of lsm_disk array. Memory should be freed by
+ *      lsm_disk_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of disks.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_DISK_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_disk_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_disk **disks[], uint32_t *count,
+    lsm_flag flags);
+
+/**
+ * lsm_rpc_fs_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_FS_LIST, same as lsm_fs_list() would have returned it.
+ *      Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @fs:
+ *      Output pointer of lsm_fs array. Memory should be freed by
+ *      lsm_fs_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of file systems.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_FS_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_fs_list_complete(lsm_connect *conn, uint32_t rpc_id,
+                                            lsm_fs **fs[], uint32_t *count,
+                                            lsm_flag flags);
+
+/**
+ * lsm_rpc_access_group_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_ACCESS_GROUP_LIST, same as lsm_access_group_list() would have
+ *      returned it. Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @groups:
+ *      Output pointer of lsm_access_group array. Memory should be freed by
+ *      lsm_access_group_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of access groups.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_ACCESS_GROUP_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_access_group_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_access_group **groups[],
+    uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_rpc_target_port_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_TARGET_PORT_LIST, same as lsm_target_port_list() would have
+ *      returned it. Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @target_ports:
+ *      Output pointer of lsm_target_port array. Memory should be freed by
+ *      lsm_target_port_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of target ports.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_TARGET_PORT_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_target_port_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_target_port **target_ports[],
+    uint32_t *count, lsm_flag flags);
+
+/**
+ * lsm_rpc_battery_list_complete - Gets the result of a listing request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the result of a request sent with lsm_rpc_submit() and
+ *      LSM_RPC_BATTERY_LIST, same as lsm_battery_list() would have returned it.
+ *      Blocks if the request has not been answered yet.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @rpc_id:
+ *      Id returned by lsm_rpc_submit().
+ * @bs:
+ *      Output pointer of lsm_battery array. Memory should be freed by
+ *      lsm_battery_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of batteries.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags, or when rpc_id is not an outstanding
+ *              LSM_RPC_BATTERY_LIST request.
+ *          * Any error the blocking listing call returns.
+ */
+int LSM_DLL_EXPORT lsm_rpc_battery_list_complete(
+    lsm_connect *conn, uint32_t rpc_id, lsm_battery **bs[], uint32_t *count,
+    lsm_flag flags);
+
+/**
+ * lsm_volume_list_iter_open - Starts reading a list of volumes as it arrives.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Sends the same request as lsm_volume_list(), but asks the plug-in to
+ *      send the volumes in parts, which lsm_volume_list_iter_next() hands
+ *      out one at a time as they arrive.  Only a part of the list is held
+ *      at any time and the first volume is available before the rest have
+ *      been sent.  Plug-ins which can't send a list in parts send it all at
+ *      once, which works the same, only without those benefits.
+ *      Other calls can be made on the connection while the iterator is
+ *      open.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUMES
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @iter:
+ *      Output pointer of lsm_list_iter. It should be closed by
+ *      lsm_list_iter_close().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid search key.
+ *          * LSM_ERR_NO_MEMORY
+ *              No enough memory.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_iter_open(lsm_connect *conn,
+                                             const char *search_key,
+                                             const char *search_value,
+                                             lsm_list_iter **iter,
+                                             lsm_flag flags);
+
+/**
+ * lsm_volume_list_iter_next - Gets the next volume of a list.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Hands out the next volume of a list started by
+ *      lsm_volume_list_iter_open(), waiting for the plug-in to send it if
+ *      it has not arrived yet.
+ *
+ * @iter:
+ *      lsm_list_iter opened by lsm_volume_list_iter_open().
+ * @volume:
+ *      Output pointer of lsm_volume, NULL once all volumes have been handed
+ *      out. It should be freed by lsm_volume_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or at the end of the list.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or iter was not
+ *              opened by lsm_volume_list_iter_open().
+ *          * Any error lsm_volume_list() returns.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_iter_next(lsm_list_iter *iter,
+                                             lsm_volume **volume,
+                                             lsm_flag flags);
+
+/**
+ * lsm_disk_list_iter_open - Starts reading a list of disks as it arrives.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list_iter_open(), for the disks lsm_disk_list()
+ *      returns.
+ *
+ * Capability:
+ *      LSM_CAP_DISKS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id".
+ * @search_value:
+ *      Search value.
+ * @iter:
+ *      Output pointer of lsm_list_iter. It should be closed by
+ *      lsm_list_iter_close().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid search key.
+ *          * LSM_ERR_NO_MEMORY
+ *              No enough memory.
+ */
+int LSM_DLL_EXPORT lsm_disk_list_iter_open(lsm_connect *conn,
+                                           const char *search_key,
+                                           const char *search_value,
+                                           lsm_list_iter **iter,
+                                           lsm_flag flags);
+
+/**
+ * lsm_disk_list_iter_next - Gets the next disk of a list.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list_iter_next(), for an iterator opened by
+ *      lsm_disk_list_iter_open().
+ *
+ * @iter:
+ *      lsm_list_iter opened by lsm_disk_list_iter_open().
+ * @disk:
+ *      Output pointer of lsm_disk, NULL once all disks have been handed
+ *      out. It should be freed by lsm_disk_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or at the end of the list.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or iter was not
+ *              opened by lsm_disk_list_iter_open().
+ *          * Any error lsm_disk_list() returns.
+ */
+int LSM_DLL_EXPORT lsm_disk_list_iter_next(lsm_list_iter *iter,
+                                           lsm_disk **disk, lsm_flag flags);
+
+/**
+ * lsm_fs_list_iter_open - Starts reading a list of file systems as it
+ * arrives.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list_iter_open(), for the file systems
+ *      lsm_fs_list() returns.
+ *
+ * Capability:
+ *      LSM_CAP_FS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @iter:
+ *      Output pointer of lsm_list_iter. It should be closed by
+ *      lsm_list_iter_close().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid search key.
+ *          * LSM_ERR_NO_MEMORY
+ *              No enough memory.
+ */
+int LSM_DLL_EXPORT lsm_fs_list_iter_open(lsm_connect *conn,
+                                         const char *search_key,
+                                         const char *search_value,
+                                         lsm_list_iter **iter, lsm_flag flags);
+
+/**
+ * lsm_fs_list_iter_next - Gets the next file system of a list.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list_iter_next(), for an iterator opened by
+ *      lsm_fs_list_iter_open().
+ *
+ * @iter:
+ *      lsm_list_iter opened by lsm_fs_list_iter_open().
+ * @fs:
+ *      Output pointer of lsm_fs, NULL once all file systems have been
+ *      handed out. It should be freed by lsm_fs_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or at the end of the list.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or iter was not
+ *              opened by lsm_fs_list_iter_open().
+ *          * Any error lsm_fs_list() returns.
+ */
+int LSM_DLL_EXPORT lsm_fs_list_iter_next(lsm_list_iter *iter, lsm_fs **fs,
+                                         lsm_flag flags);
+
+/**
+ * lsm_list_iter_close - Finishes with a list iterator.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Frees an iterator opened by one of the lsm_*_list_iter_open()
+ *      functions.  Closing it before the end of the list reads and drops
+ *      whatever the plug-in is still sending of it.
+ *
+ * @iter:
+ *      lsm_list_iter to close.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When iter is not a valid lsm_list_iter pointer or invalid
+ *              flags.
+ *          * Any error reading the rest of the list, the iterator is freed
+ *            regardless.
+ */
+int LSM_DLL_EXPORT lsm_list_iter_close(lsm_list_iter *iter, lsm_flag flags);
+
+/**
+ * lsm_batch_open - Starts collecting calls to send in one request.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Calls added with the lsm_batch_*() functions are kept until
+ *      lsm_batch_run() sends them all to the plugin in one request, which
+ *      saves a round trip for every call but the first, e.g. when masking
+ *      hundreds of volumes.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @batch:
+ *      Output pointer of lsm_batch. It should be closed by
+ *      lsm_batch_close().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL, 'conn' is not a valid lsm_connect
+ *              pointer, '*batch' is not NULL or invalid flags.
+ *          * LSM_ERR_NO_MEMORY
+ *              When no memory.
+ */
+int LSM_DLL_EXPORT lsm_batch_open(lsm_connect *conn, lsm_batch **batch,
+                                  lsm_flag flags);
+
+/**
+ * lsm_batch_volume_mask - Adds a lsm_volume_mask() call to a batch.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_mask(), made when the batch is run.
+ *
+ * @batch:
+ *      lsm_batch opened by lsm_batch_open().
+ * @access_group:
+ *      Access group to grant access to.
+ * @volume:
+ *      Volume to grant access to.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is not valid or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_batch_volume_mask(lsm_batch *batch,
+                                         lsm_access_group *access_group,
+                                         lsm_volume *volume, lsm_flag flags);
+
+/**
+ * lsm_batch_volume_unmask - Adds a lsm_volume_unmask() call to a batch.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_unmask(), made when the batch is run.
+ *
+ * @batch:
+ *      lsm_batch opened by lsm_batch_open().
+ * @access_group:
+ *      Access group to revoke access from.
+ * @volume:
+ *      Volume to revoke access to.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is not valid or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_batch_volume_unmask(lsm_batch *batch,
+                                           lsm_access_group *access_group,
+                                           lsm_volume *volume,
+                                           lsm_flag flags);
+
+/**
+ * lsm_batch_volume_delete - Adds a lsm_volume_delete() call to a batch.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_delete(), made when the batch is run. The job it
+ *      may start is returned by lsm_batch_result_get().
+ *
+ * @batch:
+ *      lsm_batch opened by lsm_batch_open().
+ * @volume:
+ *      Volume to delete.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is not valid or invalid flags.
+ */
+int LSM_DLL_EXPORT lsm_batch_volume_delete(lsm_batch *batch,
+                                           lsm_volume *volume,
+                                           lsm_flag flags);
+
+/**
+ * lsm_batch_run - Sends the calls of a batch and waits for all of them.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Sends the calls added since the batch was opened or last run in one
+ *      request. The plugin makes them in the order they were added, each
+ *      whether the ones before failed or not. What each call got is read
+ *      with lsm_batch_result_get(), by the order it was added in. Plugins
+ *      which don't take batches get the calls one at a time instead.
+ *
+ * @batch:
+ *      lsm_batch opened by lsm_batch_open().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When every call succeeded or started a job.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When 'batch' is not a valid lsm_batch pointer or invalid
+ *              flags.
+ *          * The error of the first call which failed, whose details are
+ *            returned by lsm_error_last_get().
+ *          * Any error sending the batch, no call was made then.
+ */
+int LSM_DLL_EXPORT lsm_batch_run(lsm_batch *batch, lsm_flag flags);
+
+/**
+ * lsm_batch_result_get - Gets what one call of a batch run got.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Gets the outcome of a call made by the last lsm_batch_run().
+ *
+ * @batch:
+ *      lsm_batch run by lsm_batch_run().
+ * @index:
+ *      Which call, 0 for the first one added.
+ * @job:
+ *      Output pointer of the job id if the call started a job, NULL
+ *      otherwise. Memory should be freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              When the call succeeded.
+ *          * LSM_ERR_JOB_STARTED
+ *              When the call started a job, 'job' is set.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When 'batch' is not a valid lsm_batch pointer, 'index' is
+ *              out of range, 'job' is NULL or '*job' is not NULL, or
+ *              invalid flags.
+ *          * The error the call failed with otherwise.
+ */
+int LSM_DLL_EXPORT lsm_batch_result_get(lsm_batch *batch, uint32_t index,
+                                        char **job, lsm_flag flags);
+
+/**
+ * lsm_batch_close - Finishes with a batch.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Frees a batch opened by lsm_batch_open(). Calls not run yet are
+ *      dropped.
+ *
+ * @batch:
+ *      lsm_batch to close.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When 'batch' is not a valid lsm_batch pointer or invalid
+ *              flags.
+ */
+int LSM_DLL_EXPORT lsm_batch_close(lsm_batch *batch, lsm_flag flags);
+
+/**
+ * lsm_pool_list_page - Gets one page of a list of pools.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list_page(), for the pools lsm_pool_list() returns.
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id" and "system_id".
+ * @search_value:
+ *      Search value.
+ * @limit:
+ *      Most pools to return, at least 1.
+ * @cursor:
+ *      NULL for the first page, else next_cursor of the previous page.
+ * @pools:
+ *      Output pointer of lsm_pool array. It should be manually freed by
+ *      lsm_pool_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of pools.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, NULL after the
+ *      last page. It should be freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key or cursor, or limit is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_pool_list_page(lsm_connect *conn, const char *search_key,
+                                      const char *search_value, uint32_t limit,
+                                      const char *cursor, lsm_pool **pools[],
+                                      uint32_t *count, char **next_cursor,
+                                      lsm_flag flags);
+
+/**
+ * lsm_volume_list_page - Gets one page of a list of volumes.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list(), but returns at most limit volumes, so a
+ *      large list can be read a page at a time instead of all at once.
+ *      Pass the next_cursor of a page as the cursor of the call for the
+ *      page after it.  Plug-ins which can't return a page return every
+ *      volume and no next_cursor, so the whole list is one page.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUMES
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @limit:
+ *      Most volumes to return, at least 1.
+ * @cursor:
+ *      NULL for the first page, else next_cursor of the previous page.
+ * @volumes:
+ *      Output pointer of lsm_volume array. It should be manually freed by
+ *      lsm_volume_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of volumes.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, NULL after the
+ *      last page. It should be freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key or cursor, or limit is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_list_page(lsm_connect *conn,
+                                        const char *search_key,
+                                        const char *search_value,
+                                        uint32_t limit, const char *cursor,
+                                        lsm_volume **volumes[],
+                                        uint32_t *count, char **next_cursor,
+                                        lsm_flag flags);
+
+/**
+ * lsm_disk_list_page - Gets one page of a list of disks.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Same as lsm_volume_list_page(), for the disks lsm_disk_list() returns.
+ *
+ * Capability:
+ *      LSM_CAP_DISKS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id" and "system_id".
+ * @search_value:
+ *      Search value.
+ * @limit:
+ *      Most disks to return, at least 1.
+ * @cursor:
+ *      NULL for the first page, else next_cursor of the previous page.
+ * @disks:
+ *      Output pointer of lsm_disk array. It should be manually freed by
+ *      lsm_disk_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of disks.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, NULL after the
+ *      last page. It should be freed by free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success or searched value not found.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer or
- *              invalid flags.
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key or cursor, or limit is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
  */
-int LSM_DLL_EXPORT lsm_plugin_info_get(lsm_connect *conn, char **desc,
-                                       char **version, lsm_flag flags);
+int LSM_DLL_EXPORT lsm_disk_list_page(lsm_connect *conn, const char *search_key,
+                                      const char *search_value, uint32_t limit,
+                                      const char *cursor, lsm_disk **disks[],
+                                      uint32_t *count, char **next_cursor,
+                                      lsm_flag flags);
 
 /**
- * lsm_available_plugins_list - Retrieves a list of available plug-ins.
+ * lsm_access_group_list_page - Gets one page of a list of access groups.
  *
  * Version:
- *      1.0
+ *      1.11
  *
  * Description:
- *      Retrieve a list of available plug-ins.
+ *      Same as lsm_volume_list_page(), for the access groups
+ *      lsm_access_group_list() returns.
  *
- * @sep:
- *      Data separator used for string of plugin. Check document of 'plugins'
- *      argument for detail.
- * @plugins:
- *      String list of plug-ins with the form 'desc<sep>version'.
- *      Returned plugins memory should be freed by calling
- *      lsm_string_list_free().
+ * Capability:
+ *      LSM_CAP_ACCESS_GROUPS
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id" and "system_id".
+ * @search_value:
+ *      Search value.
+ * @limit:
+ *      Most access groups to return, at least 1.
+ * @cursor:
+ *      NULL for the first page, else next_cursor of the previous page.
+ * @groups:
+ *      Output pointer of lsm_access_group array. It should be manually freed by
+ *      lsm_access_group_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of access groups.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, NULL after the
+ *      last page. It should be freed by free().
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
- *              On success.
+ *              On success or searched value not found.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or invalid flags.
- *
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key or cursor, or limit is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
  */
-int LSM_DLL_EXPORT lsm_available_plugins_list(const char *sep,
-                                              lsm_string_list **plugins,
-                                              lsm_flag flags);
+int LSM_DLL_EXPORT lsm_access_group_list_page(
+    lsm_connect *conn, const char *search_key, const char *search_value,
+    uint32_t limit, const char *cursor, lsm_access_group **groups[],
+    uint32_t *count, char **next_cursor, lsm_flag flags);
 
 /**
- * lsm_connect_timeout_set - Sets the time-out for this connection.
+ * lsm_fs_list_page - Gets one page of a list of file systems.
  *
  * Version:
- *      1.0
+ *      1.11
  *
  * Description:
- *      Sets the time-out for this connection.
+ *      Same as lsm_volume_list_page(), for the file systems
+ *      lsm_fs_list() returns.
+ *
+ * Capability:
+ *      LSM_CAP_FS
  *
  * @conn:
  *      Valid lsm_connect pointer.
- * @timeout:
- *      Time-out in ms.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id", "system_id" and "pool_id".
+ * @search_value:
+ *      Search value.
+ * @limit:
+ *      Most file systems to return, at least 1.
+ * @cursor:
+ *      NULL for the first page, else next_cursor of the previous page.
+ * @fs:
+ *      Output pointer of lsm_fs array. It should be manually freed by
+ *      lsm_fs_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of file systems.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, NULL after the
+ *      last page. It should be freed by free().
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
- *              On success.
+ *              On success or searched value not found.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or invalid lsm_connect or invalid
- *              flags.
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key or cursor, or limit is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
  */
-int LSM_DLL_EXPORT lsm_connect_timeout_set(lsm_connect *conn, uint32_t timeout,
-                                           lsm_flag flags);
+int LSM_DLL_EXPORT lsm_fs_list_page(lsm_connect *conn, const char *search_key,
+                                    const char *search_value, uint32_t limit,
+                                    const char *cursor, lsm_fs **fs[],
+                                    uint32_t *count, char **next_cursor,
+                                    lsm_flag flags);
 
 /**
- * lsm_connect_timeout_get - Gets the time-out for this connection.
+ * lsm_nfs_list_page - Gets one page of a list of NFS exports.
  *
  * Version:
- *      1.0
+ *      1.11
  *
  * Description:
- *      Gets the time-out for this connection.
+ *      Same as lsm_volume_list_page(), for the NFS exports
+ *      lsm_nfs_list() returns.
+ *
+ * Capability:
+ *      LSM_CAP_EXPORTS
  *
  * @conn:
  *      Valid lsm_connect pointer.
- * @timeout:
- *      Output pointer of uint32_t. Time-out in ms.
+ * @search_key:
+ *      Search key(NULL for all).
+ *      Valid search keys are: "id" and "fs_id".
+ * @search_value:
+ *      Search value.
+ * @limit:
+ *      Most NFS exports to return, at least 1.
+ * @cursor:
+ *      NULL for the first page, else next_cursor of the previous page.
+ * @exports:
+ *      Output pointer of lsm_nfs_export array. It should be manually freed by
+ *      lsm_nfs_export_record_array_free().
+ * @count:
+ *      Output pointer of uint32_t. Number of NFS exports.
+ * @next_cursor:
+ *      Output pointer of char *. Cursor of the next page, NULL after the
+ *      last page. It should be freed by free().
  * @flags:
  *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
  *
  * Return:
  *      Error code as enumerated by 'lsm_error_number'.
  *          * LSM_ERR_OK
- *              On success.
+ *              On success or searched value not found.
  *          * LSM_ERR_INVALID_ARGUMENT
- *              When any argument is NULL or not a valid lsm_connect pointer
- *              or invalid flags.
+ *              When any argument is NULL or invalid flags or invalid search
+ *              key or cursor, or limit is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
  */
-int LSM_DLL_EXPORT lsm_connect_timeout_get(lsm_connect *conn, uint32_t *timeout,
-                                           lsm_flag flags);
+int LSM_DLL_EXPORT lsm_nfs_list_page(lsm_connect *conn, const char *search_key,
+                                     const char *search_value, uint32_t limit,
+                                     const char *cursor,
+                                     lsm_nfs_export **exports[],
+                                     uint32_t *count, char **next_cursor,
+                                     lsm_flag flags);
 
 /**
  * lsm_job_status_get - Check on the status of a job with no data returned.
@@ -461,6 +1815,103 @@ int LSM_DLL_EXPORT lsm_job_status_ss_get(lsm_connect *conn, const char *job,
 int LSM_DLL_EXPORT lsm_job_free(lsm_connect *conn, char **job_id,
                                 lsm_flag flags);
 
+/**
+ * lsm_job_wait - Wait for a job to complete.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Wait until a job is no longer in progress, has got as far as percent
+ *      or timeout milliseconds have passed, whichever comes first.  The
+ *      plug-in holds the request until then, so the job is seen to complete
+ *      as soon as it does without polling lsm_job_status_get().  Use
+ *      lsm_job_status_volume_get() and etc afterwards to get the data of a
+ *      completed job.
+ *
+ * @conn:
+ *      Valid connection.
+ * @job_id:
+ *      String. Job id
+ * @percent:
+ *      uint8_t. Progress in percent which ends the wait. Domain 0..100, use
+ *      100 to wait for the job to complete.
+ * @timeout:
+ *      uint32_t. Time out in milliseconds.
+ * @status:
+ *      Output pointer of lsm_job_status. LSM_JOB_INPROGRESS when the time
+ *      out passed, see lsm_job_status_get() for the others.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent job complete. Domain 0..100.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success, also when the time out passed.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer,
+ *              percent is over 100 or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When job not found.
+ */
+int LSM_DLL_EXPORT lsm_job_wait(lsm_connect *conn, const char *job_id,
+                                uint8_t percent, uint32_t timeout,
+                                lsm_job_status *status,
+                                uint8_t *percent_complete, lsm_flag flags);
+
+/**
+ * lsm_jobs_wait_any - Wait for any of many jobs to complete.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Wait until one of the jobs is no longer in progress or has got as far
+ *      as percent, or until timeout milliseconds have passed, see
+ *      lsm_job_wait().  Call again without the job it returned to wait for
+ *      the next one.
+ *
+ * @conn:
+ *      Valid connection.
+ * @job_ids:
+ *      Array of job id strings.
+ * @count:
+ *      uint32_t. Number of jobs.
+ * @percent:
+ *      uint8_t. Progress in percent which ends the wait. Domain 0..100, use
+ *      100 to wait for a job to complete.
+ * @timeout:
+ *      uint32_t. Time out in milliseconds.
+ * @index:
+ *      Output pointer of uint32_t. Index into job_ids of the job which ended
+ *      the wait, or the one furthest along when the time out passed.
+ * @status:
+ *      Output pointer of lsm_job_status. Status of that job,
+ *      LSM_JOB_INPROGRESS when the time out passed.
+ * @percent_complete:
+ *      Output pointer of uint8_t. Percent that job is complete.
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'.
+ *          * LSM_ERR_OK
+ *              On success, also when the time out passed.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer,
+ *              count is 0, percent is over 100 or invalid flags.
+ *          * LSM_ERR_NOT_FOUND_JOB
+ *              When a job is not found.
+ */
+int LSM_DLL_EXPORT lsm_jobs_wait_any(lsm_connect *conn, const char *job_ids[],
+                                     uint32_t count, uint8_t percent,
+                                     uint32_t timeout, uint32_t *index,
+                                     lsm_job_status *status,
+                                     uint8_t *percent_complete,
+                                     lsm_flag flags);
+
 /**
  * lsm_capabilities - Query the capabilities of the storage array.
  *
@@ -1018,6 +2469,56 @@ int LSM_DLL_EXPORT lsm_volume_replicate_range(
 int LSM_DLL_EXPORT lsm_volume_delete(lsm_connect *conn, lsm_volume *volume,
                                      char **job, lsm_flag flags);
 
+/**
+ * lsm_volume_delete_bulk - Delete many volumes in one call.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Deletes each of the volumes as lsm_volume_delete() would, in one
+ *      request to the plugin.  A volume which can't be deleted doesn't stop
+ *      the ones after it, each gets a result of its own.  Plugins may
+ *      delete them all in one go on the storage system, plugins which
+ *      can't delete them one at a time.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUME_DELETE
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @volumes:
+ *      Array of lsm_volume pointers to delete.
+ * @count:
+ *      Number of volumes, at least 1.
+ * @results:
+ *      Output pointer of int32_t array, count of them. The error code
+ *      lsm_volume_delete() would have returned for each volume, in the same
+ *      order. Memory should be freed via free().
+ * @jobs:
+ *      Output pointer of lsm_string_list, count of them. The job of each
+ *      volume whose result is LSM_ERR_JOB_STARTED, an empty string for the
+ *      others. Memory should be freed via lsm_string_list_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'. How each volume
+ *      fared is in results.
+ *          * LSM_ERR_OK
+ *              The plugin got the volumes, results and jobs are set.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags or count is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_delete_bulk(lsm_connect *conn,
+                                          lsm_volume *volumes[],
+                                          uint32_t count, int32_t **results,
+                                          lsm_string_list **jobs,
+                                          lsm_flag flags);
+
 /**
  * lsm_volume_enable - Set a Volume to online
  *
@@ -1329,6 +2830,65 @@ int LSM_DLL_EXPORT lsm_access_group_initiator_add(
     lsm_access_group_init_type init_type,
     lsm_access_group **updated_access_group, lsm_flag flags);
 
+/**
+ * lsm_access_group_initiator_add_bulk - Adds many initiators to the access
+ * group in one call.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Adds each of the initiators as lsm_access_group_initiator_add()
+ *      would, in one request to the plugin.  An initiator which can't be
+ *      added doesn't stop the ones after it, each gets a result of its own.
+ *
+ * Capability:
+ *      LSM_CAP_ACCESS_GROUP_INITIATOR_ADD_WWPN
+ *      LSM_CAP_ACCESS_GROUP_INITIATOR_ADD_ISCSI_IQN
+ *
+ * @conn:
+ *      Valid lsm_connect pointer.
+ * @access_group:
+ *      Pointer of lsm_access_group to modify.
+ * @init_ids:
+ *      lsm_string_list of the initiator ids to add, at least 1.
+ * @init_type:
+ *      lsm_access_group_init_type of all of them. Valid initiator types
+ *      are:
+ *          * LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_IQN
+ *              iSCSI IQN.
+ *          * LSM_ACCESS_GROUP_INIT_TYPE_WWPN
+ *              FC WWPN
+ * @results:
+ *      Output pointer of int32_t array, one for each initiator. The error
+ *      code lsm_access_group_initiator_add() would have returned for it, in
+ *      the same order. Memory should be freed via free().
+ * @updated_access_group:
+ *      Output pointer of the lsm_access_group once all the initiators were
+ *      added. Returned value must be freed with
+ *      lsm_access_group_record_free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'. How each initiator
+ *      fared is in results.
+ *          * LSM_ERR_OK
+ *              The plugin got the initiators, results and
+ *              updated_access_group are set.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags or invalid lsm_access_group pointer or
+ *              any illegal initiator or invalid init_type or no initiators.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_access_group_initiator_add_bulk(
+    lsm_connect *conn, lsm_access_group *access_group,
+    lsm_string_list *init_ids, lsm_access_group_init_type init_type,
+    int32_t **results, lsm_access_group **updated_access_group,
+    lsm_flag flags);
+
 /**
  * lsm_access_group_initiator_delete - Deletes an initiator from an access group
  *
@@ -1467,6 +3027,89 @@ int LSM_DLL_EXPORT lsm_volume_unmask(lsm_connect *conn,
                                      lsm_access_group *access_group,
                                      lsm_volume *volume, lsm_flag flags);
 
+/**
+ * lsm_volume_mask_bulk - Grants access to many volumes for the specified
+ * group in one call.
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Grants access to each of the volumes as lsm_volume_mask() would, in
+ *      one request to the plugin.  A volume which can't be masked doesn't
+ *      stop the ones after it, each gets a result of its own.
+ *
+ * Capability:
+ *      LSM_CAP_VOLUME_MASK
+ *
+ * @conn:
+ *      Valid connection.
+ * @access_group:
+ *      Pointer of lsm_access_group.
+ * @volumes:
+ *      Array of lsm_volume pointers.
+ * @count:
+ *      Number of volumes, at least 1.
+ * @results:
+ *      Output pointer of int32_t array, count of them. The error code
+ *      lsm_volume_mask() would have returned for each volume, in the same
+ *      order. Memory should be freed via free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number'. How each volume
+ *      fared is in results.
+ *          * LSM_ERR_OK
+ *              The plugin got the volumes, results is set.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_connect pointer
+ *              or invalid flags or invalid lsm_access_group pointer or
+ *              invalid lsm_volume or count is 0.
+ *          * LSM_ERR_NO_SUPPORT
+ *              Not supported.
+ */
+int LSM_DLL_EXPORT lsm_volume_mask_bulk(lsm_connect *conn,
+                                        lsm_access_group *access_group,
+                                        lsm_volume *volumes[], uint32_t count,
+                                        int32_t **results, lsm_flag flags);
+
+/**
+ * lsm_volume_unmask_bulk - Revokes access to many volumes for the specified
+ * group in one call.
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Revokes access to each of the volumes as lsm_volume_unmask() would,
+ *      see lsm_volume_mask_bulk().
+ *
+ * Capability:
+ *      LSM_CAP_VOLUME_UNMASK
+ *
+ * @conn:
+ *      Valid connection.
+ * @access_group:
+ *      Pointer of lsm_access_group.
+ * @volumes:
+ *      Array of lsm_volume pointers.
+ * @count:
+ *      Number of volumes, at least 1.
+ * @results:
+ *      Output pointer of int32_t array, count of them. The error code
+ *      lsm_volume_unmask() would have returned for each volume, in the same
+ *      order. Memory should be freed via free().
+ * @flags:
+ *      Reserved for future use, must be LSM_CLIENT_FLAG_RSVD.
+ *
+ * Return:
+ *      Same as lsm_volume_mask_bulk().
+ */
+int LSM_DLL_EXPORT lsm_volume_unmask_bulk(lsm_connect *conn,
+                                          lsm_access_group *access_group,
+                                          lsm_volume *volumes[],
+                                          uint32_t count, int32_t **results,
+                                          lsm_flag flags);
+
 /**
  * lsm_volumes_accessible_by_access_group - Query volumes that the
  * specified access group has access to.
@@ -141,6 +141,9 @@ typedef lsm_error *lsm_error_ptr;
  *
  * Description:
  *      Retrieves the last error of the lsm connection.
+ *      Errors are kept for each thread, the error returned is the one of
+ *      the last call the calling thread made on the connection. The error
+ *      a thread leaves behind is freed when the thread exits.
  *      Note: Address returned is valid until lsm_connect gets freed, copy
  *      return value if you need longer scope. Do not free returned pointer.
  *
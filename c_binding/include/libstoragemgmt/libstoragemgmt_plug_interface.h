@@ -1168,6 +1168,196 @@ struct lsm_ops_v1_3 {
     lsm_plug_volume_read_cache_policy_update vol_rcp_update;
 };
 
+/**
+ * New in version 1.11.
+ * Retrieve one page of a list of pools.  The cursor is whatever the plug-in
+ * handed back as next_cursor for the previous page, the client doesn't look
+ * into it.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   search_key      Search key
+ * @param[in]   search_value    Search value
+ * @param[in]   limit           Most pools to return, at least 1
+ * @param[in]   cursor          Where to continue, NULL for the first page
+ * @param[out]  pool_array      Array of pools
+ * @param[out]  count           Number of pools
+ * @param[out]  next_cursor     Where the next page starts, allocated with
+ *                              malloc, NULL when there are no more
+ * @param[in]   flags           Reserved
+ * @return LSM_ERR_OK, else error reason
+ */
+typedef int (*lsm_plug_pool_list_page)(lsm_plugin_ptr c,
+                                       const char *search_key,
+                                       const char *search_value,
+                                       uint32_t limit, const char *cursor,
+                                       lsm_pool **pool_array[],
+                                       uint32_t *count, char **next_cursor,
+                                       lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Retrieve one page of a list of volumes, see lsm_plug_pool_list_page.
+ */
+typedef int (*lsm_plug_volume_list_page)(lsm_plugin_ptr c,
+                                         const char *search_key,
+                                         const char *search_value,
+                                         uint32_t limit, const char *cursor,
+                                         lsm_volume **vol_array[],
+                                         uint32_t *count, char **next_cursor,
+                                         lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Retrieve one page of a list of disks, see lsm_plug_pool_list_page.
+ */
+typedef int (*lsm_plug_disk_list_page)(lsm_plugin_ptr c,
+                                       const char *search_key,
+                                       const char *search_value,
+                                       uint32_t limit, const char *cursor,
+                                       lsm_disk **disk_array[],
+                                       uint32_t *count, char **next_cursor,
+                                       lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Retrieve one page of a list of access groups, see
+ * lsm_plug_pool_list_page.
+ */
+typedef int (*lsm_plug_access_group_list_page)(
+    lsm_plugin_ptr c, const char *search_key, const char *search_value,
+    uint32_t limit, const char *cursor, lsm_access_group **groups[],
+    uint32_t *group_count, char **next_cursor, lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Retrieve one page of a list of file systems, see lsm_plug_pool_list_page.
+ */
+typedef int (*lsm_plug_fs_list_page)(lsm_plugin_ptr c, const char *search_key,
+                                     const char *search_value, uint32_t limit,
+                                     const char *cursor, lsm_fs **fs[],
+                                     uint32_t *fs_count, char **next_cursor,
+                                     lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Retrieve one page of a list of NFS exports, see lsm_plug_pool_list_page.
+ */
+typedef int (*lsm_plug_nfs_list_page)(lsm_plugin_ptr c, const char *search_key,
+                                      const char *search_value, uint32_t limit,
+                                      const char *cursor,
+                                      lsm_nfs_export **exports[],
+                                      uint32_t *count, char **next_cursor,
+                                      lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Grant an access group access to many volumes at once.  A failing volume
+ * doesn't stop the ones after it.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   group           Access group
+ * @param[in]   volumes         Volumes to grant access to
+ * @param[in]   count           Number of volumes
+ * @param[out]  results         Error code of each volume, count of them
+ * @param[in]   flags           Reserved
+ * @return LSM_ERR_OK when results got filled in, else error reason
+ */
+typedef int (*lsm_plug_volume_mask_bulk)(lsm_plugin_ptr c,
+                                         lsm_access_group *group,
+                                         lsm_volume *volumes[], uint32_t count,
+                                         int32_t results[], lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Revoke access to many volumes at once, see lsm_plug_volume_mask_bulk.
+ */
+typedef int (*lsm_plug_volume_unmask_bulk)(lsm_plugin_ptr c,
+                                           lsm_access_group *group,
+                                           lsm_volume *volumes[],
+                                           uint32_t count, int32_t results[],
+                                           lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Delete many volumes at once.  A failing volume doesn't stop the ones after
+ * it.
+ * @param[in]   c               Valid lsm plug-in pointer
+ * @param[in]   volumes         Volumes to delete
+ * @param[in]   count           Number of volumes
+ * @param[out]  results         Error code of each volume, count of them
+ * @param[out]  jobs            Job ID of each volume whose result is
+ *                              LSM_ERR_JOB_STARTED, allocated with malloc,
+ *                              count of them
+ * @param[in]   flags           Reserved
+ * @return LSM_ERR_OK when results got filled in, else error reason
+ */
+typedef int (*lsm_plug_volume_delete_bulk)(lsm_plugin_ptr c,
+                                           lsm_volume *volumes[],
+                                           uint32_t count, int32_t results[],
+                                           char *jobs[], lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Add many initiators to an access group at once.  A failing initiator
+ * doesn't stop the ones after it.
+ * @param[in]   c                       Valid lsm plug-in pointer
+ * @param[in]   access_group            Access group
+ * @param[in]   initiator_ids           Initiators to add
+ * @param[in]   id_type                 Initiator type of all of them
+ * @param[out]  results                 Error code of each initiator
+ * @param[out]  updated_access_group    Access group after the change
+ * @param[in]   flags                   Reserved
+ * @return LSM_ERR_OK when results got filled in, else error reason
+ */
+typedef int (*lsm_plug_access_group_initiator_add_bulk)(
+    lsm_plugin_ptr c, lsm_access_group *access_group,
+    lsm_string_list *initiator_ids, lsm_access_group_init_type id_type,
+    int32_t results[], lsm_access_group **updated_access_group,
+    lsm_flag flags);
+
+/**
+ * New in version 1.11.
+ * Wait until one of many jobs is no longer in progress or has got as far as
+ * percent, or until timeout milliseconds have passed.
+ * @param[in]   c                   Valid lsm plug-in pointer
+ * @param[in]   jobs                Job IDs to wait on
+ * @param[in]   count               Number of jobs
+ * @param[in]   percent             Progress which ends the wait, 100 waits
+ *                                  for a job to complete
+ * @param[in]   timeout             Time out in milliseconds
+ * @param[out]  index               Job which ended the wait, when the time
+ *                                  out passed the one furthest along
+ * @param[out]  status              Status of that job
+ * @param[out]  percent_complete    How far that job got
+ * @param[in]   flags               Reserved
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success, the time out passing included.
+ */
+typedef int (*lsm_plug_jobs_wait_any)(lsm_plugin_ptr c, const char *jobs[],
+                                      uint32_t count, uint8_t percent,
+                                      uint32_t timeout, uint32_t *index,
+                                      lsm_job_status *status,
+                                      uint8_t *percent_complete,
+                                      lsm_flag flags);
+
+/** \struct lsm_ops_v1_11
+ * \brief Functions added in version 1.11.  Any of them can be left NULL.  A
+ * page is then cut out of the full list the plain listing call returns, the
+ * bulk calls are made one item at a time through the plain call and jobs are
+ * waited on by polling the job status call.
+ */
+struct lsm_ops_v1_11 {
+    lsm_plug_pool_list_page pool_list_page;
+    lsm_plug_volume_list_page vol_list_page;
+    lsm_plug_disk_list_page disk_list_page;
+    lsm_plug_access_group_list_page ag_list_page;
+    lsm_plug_fs_list_page fs_list_page;
+    lsm_plug_nfs_list_page nfs_list_page;
+    lsm_plug_volume_mask_bulk vol_mask_bulk;
+    lsm_plug_volume_unmask_bulk vol_unmask_bulk;
+    lsm_plug_volume_delete_bulk vol_delete_bulk;
+    lsm_plug_access_group_initiator_add_bulk ag_add_initiator_bulk;
+    lsm_plug_jobs_wait_any jobs_wait_any;
+};
+
 /**
  * Copies the memory pointed to by item with given type t.
  * @param t         Type of item to copy
@@ -1248,6 +1438,27 @@ int LSM_DLL_EXPORT lsm_register_plugin_v1_3(
     struct lsm_nas_ops_v1 *nas_ops, struct lsm_ops_v1_2 *ops_v1_2,
     struct lsm_ops_v1_3 *ops_v1_3);
 
+/**
+ * Used to register version 1.11 APIs plug-in operation.
+ * @param plug              Pointer provided by the framework
+ * @param private_data      Private data to be used for whatever the plug-in
+ *                          needs
+ * @param mgm_ops           Function pointers for struct lsm_mgmt_ops_v1
+ * @param san_ops           Function pointers for struct lsm_san_ops_v1
+ * @param fs_ops            Function pointers for struct lsm_fs_ops_v1
+ * @param nas_ops           Function pointers for struct lsm_nas_ops_v1
+ * @param ops_v1_2          Function pointers for struct lsm_ops_v1_2
+ * @param ops_v1_3          Function pointers for struct lsm_ops_v1_3
+ * @param ops_v1_11         Function pointers for struct lsm_ops_v1_11
+ * @return Error code as enumerated by \ref lsm_error_number.
+ * @retval LSM_ERR_OK on success.
+ */
+int LSM_DLL_EXPORT lsm_register_plugin_v1_11(
+    lsm_plugin_ptr plug, void *private_data, struct lsm_mgmt_ops_v1 *mgm_ops,
+    struct lsm_san_ops_v1 *san_ops, struct lsm_fs_ops_v1 *fs_ops,
+    struct lsm_nas_ops_v1 *nas_ops, struct lsm_ops_v1_2 *ops_v1_2,
+    struct lsm_ops_v1_3 *ops_v1_3, struct lsm_ops_v1_11 *ops_v1_11);
+
 /**
  * Used to retrieve private data for plug-in operation.
  * @param plug  Opaque plug-in pointer.
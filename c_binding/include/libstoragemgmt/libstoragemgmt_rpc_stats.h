@@ -0,0 +1,246 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ */
+
+#ifndef LIBSTORAGEMGMT_RPC_STATS_H
+#define LIBSTORAGEMGMT_RPC_STATS_H
+
+#include "libstoragemgmt_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * lsm_rpc_stats_record_free - Frees the memory for an individual record.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Frees the memory for an individual lsm_rpc_stats.
+ *
+ * @s:
+ *      lsm_rpc_stats to release memory for.
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number':
+ *          * LSM_ERR_OK
+ *              On success or not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_rpc_stats
+ *              pointer.
+ */
+int LSM_DLL_EXPORT lsm_rpc_stats_record_free(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_record_array_free - Frees the memory of a statistics array.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Frees the memory for each of the records and then the array itself.
+ *
+ * @stats:
+ *      Array to release memory for.
+ * @count:
+ *      Number of elements.
+ * Return:
+ *      Error code as enumerated by 'lsm_error_number':
+ *          * LSM_ERR_OK
+ *              On success or not found.
+ *          * LSM_ERR_INVALID_ARGUMENT
+ *              When any argument is NULL or not a valid lsm_rpc_stats
+ *              pointer.
+ */
+int LSM_DLL_EXPORT lsm_rpc_stats_record_array_free(lsm_rpc_stats *stats[],
+                                                   uint32_t count);
+
+/**
+ * lsm_rpc_stats_method_get - Retrieves the method the statistics are for.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the name of the IPC method, e.g. "volumes".
+ *      Note: Address returned is valid until lsm_rpc_stats gets freed, copy
+ *      return value if you need longer scope. Do not free returned string.
+ *
+ * @s:
+ *      Statistics to retrieve the method for.
+ *
+ * Return:
+ *      string. NULL if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+const char LSM_DLL_EXPORT *lsm_rpc_stats_method_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_calls_get - Retrieves the number of calls made.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the number of requests for the method which got a
+ *      response, errors included.
+ *
+ * @s:
+ *      Statistics to retrieve the count for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_calls_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_errors_get - Retrieves the number of calls which failed.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the number of requests for the method which the plugin
+ *      answered with an error.
+ *
+ * @s:
+ *      Statistics to retrieve the count for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_errors_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_bytes_sent_get - Retrieves the number of bytes sent.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the size of all the requests sent for the method, message
+ *      headers included.
+ *
+ * @s:
+ *      Statistics to retrieve the size for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_bytes_sent_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_bytes_received_get - Retrieves the number of bytes received.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the size of all the responses received for the method,
+ *      message headers included.
+ *
+ * @s:
+ *      Statistics to retrieve the size for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_bytes_received_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_serialize_ns_get - Retrieves the time spent serializing.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the time spent encoding the requests for the method, in
+ *      nanoseconds.
+ *
+ * @s:
+ *      Statistics to retrieve the time for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_serialize_ns_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_transport_ns_get - Retrieves the time spent waiting.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the time from sending the requests for the method to
+ *      reading their responses, less the time spent serializing and
+ *      deserializing, in nanoseconds. This is the time taken by the
+ *      transport and the plugin.
+ *
+ * @s:
+ *      Statistics to retrieve the time for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_transport_ns_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_deserialize_ns_get - Retrieves the time spent deserializing.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves the time spent decoding the responses for the method, in
+ *      nanoseconds.
+ *
+ * @s:
+ *      Statistics to retrieve the time for.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_deserialize_ns_get(lsm_rpc_stats *s);
+
+/**
+ * lsm_rpc_stats_histogram_get - Retrieves one bucket of the latency
+ * histogram.
+ *
+ * Version:
+ *      1.11
+ *
+ * Description:
+ *      Retrieves how many calls for the method took as long as the bucket
+ *      covers. Bucket 0 counts the calls which took less than 1
+ *      microsecond, bucket n those which took from 2^(n-1) up to 2^n
+ *      microseconds. The last bucket, LSM_RPC_STATS_HISTOGRAM_BUCKETS - 1,
+ *      counts everything longer.
+ *
+ * @s:
+ *      Statistics to retrieve the bucket for.
+ * @bucket:
+ *      Index of the bucket, less than LSM_RPC_STATS_HISTOGRAM_BUCKETS.
+ *
+ * Return:
+ *      uint64_t. 0 if argument 's' is NULL or not a valid lsm_rpc_stats
+ *      pointer or 'bucket' is out of range.
+ */
+uint64_t LSM_DLL_EXPORT lsm_rpc_stats_histogram_get(lsm_rpc_stats *s,
+                                                    uint32_t bucket);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* LIBSTORAGEMGMT_RPC_STATS_H */
@@ -136,6 +136,27 @@ typedef struct _lsm_led_slot lsm_led_slot;
  */
 typedef struct _lsm_battery lsm_battery;
 
+/**
+ * Opaque data type for a listing read as it arrives
+ * New in version 1.11
+ */
+typedef struct _lsm_list_iter lsm_list_iter;
+
+/**
+ * Opaque data type for the statistics of one method on a connection
+ * New in version 1.11
+ */
+typedef struct _lsm_rpc_stats lsm_rpc_stats;
+
+/**
+ * Opaque data type for calls sent to the plugin in one request
+ * New in version 1.11
+ */
+typedef struct _lsm_batch lsm_batch;
+
+/** Number of buckets in the latency histogram of lsm_rpc_stats */
+#define LSM_RPC_STATS_HISTOGRAM_BUCKETS 24
+
 /** \enum lsm_replication_type Different types of replications that can be
  * created */
 typedef enum {
@@ -271,6 +292,26 @@ typedef enum {
     LSM_JOB_ERROR = 3
 } lsm_job_status;
 
+/** \enum lsm_rpc_method Listing calls which can be sent with lsm_rpc_submit */
+typedef enum {
+    LSM_RPC_SYSTEM_LIST = 1,
+    LSM_RPC_POOL_LIST = 2,
+    LSM_RPC_VOLUME_LIST = 3,
+    LSM_RPC_DISK_LIST = 4,
+    LSM_RPC_FS_LIST = 5,
+    LSM_RPC_ACCESS_GROUP_LIST = 6,
+    LSM_RPC_TARGET_PORT_LIST = 7,
+    LSM_RPC_BATTERY_LIST = 8
+} lsm_rpc_method;
+
+/** \enum lsm_cache_class Reads a connection can answer from its cache, see
+ * lsm_connect_cache_ttl_set */
+typedef enum {
+    LSM_CACHE_SYSTEMS = 0,
+    LSM_CACHE_POOLS = 1,
+    LSM_CACHE_CAPABILITIES = 2
+} lsm_cache_class;
+
 typedef enum {
     LSM_DISK_TYPE_UNKNOWN = 0,
     LSM_DISK_TYPE_OTHER = 1,
@@ -0,0 +1,556 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Micro benchmarks for the IPC hot path, run with "make bench".  With
+ * --json every result is printed as a json object on a line of its own, so
+ * the results of two builds can be compared, e.g. with
+ * "make bench BENCH_FLAGS=--json > before.json".
+ */
+
+#include "libstoragemgmt/libstoragemgmt.h"
+#include "lsm_convert.hpp"
+#include "lsm_ipc.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <malloc.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Every allocation made through operator new is counted, to see what
+ * decoding costs in allocations as well as time.
+ */
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size) {
+    void *p = malloc(size);
+
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    ++allocations;
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+/**
+ * Resident set size in KiB.
+ */
+static long rss_kib(void) {
+    long size = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+
+    if (f) {
+        if (fscanf(f, "%ld %ld", &size, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/*
+ * One line of results, printed as text or as json.
+ */
+static bool json_output = false;
+
+class LSM_DLL_LOCAL Result {
+  public:
+    explicit Result(const char *bench) { add("bench", bench); }
+
+    Result &add(const char *key, const char *v) {
+        fields.emplace_back(key, Value(v));
+        return *this;
+    }
+
+    Result &add(const char *key, uint64_t v) {
+        fields.emplace_back(key, Value(v));
+        return *this;
+    }
+
+    /**
+     * Adds a measurement, rounded to the given number of decimals.
+     */
+    Result &add(const char *key, double v, int decimals) {
+        char buf[64];
+
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        fields.emplace_back(key, Value(Value::numeric_t, buf));
+        return *this;
+    }
+
+    ~Result() {
+        if (json_output) {
+            std::map<std::string, Value> o;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                o[fields[i].first] = fields[i].second;
+            }
+            printf("%s\n", Value(std::move(o)).serialize().c_str());
+        } else {
+            printf("%-10s", fields[0].second.asC_str());
+            for (size_t i = 1; i < fields.size(); ++i) {
+                const Value &v = fields[i].second;
+                bool str = (v.valueType() == Value::string_t);
+                printf(" %s %s", fields[i].first.c_str(),
+                       str ? v.asC_str() : v.serialize().c_str());
+            }
+            printf("\n");
+        }
+        fflush(stdout);
+    }
+
+  private:
+    std::vector<std::pair<std::string, Value>> fields;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Streams iterations messages of msg_size bytes over a socket pair, one
+ * thread sending and the calling thread receiving.
+ */
+static void bench_transport(size_t msg_size, size_t iterations) {
+    int sv[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        perror("socketpair");
+        return;
+    }
+
+    std::string msg(msg_size, 'x');
+    Transport rx(sv[1]);
+
+    double start = now_sec();
+    std::thread sender([&]() {
+        Transport tx(sv[0]);
+        int ec = 0;
+        for (size_t i = 0; i < iterations; ++i) {
+            if (tx.msg_send(msg, ec) != 0) {
+                fprintf(stderr, "msg_send errno %d\n", ec);
+                break;
+            }
+        }
+    });
+
+    size_t received = 0;
+    try {
+        for (size_t i = 0; i < iterations; ++i) {
+            int ec = 0;
+            received += rx.msg_recv(ec).size();
+        }
+    } catch (const EOFException &e) {
+        fprintf(stderr, "transport: unexpected EOF\n");
+    }
+    double elapsed = now_sec() - start;
+    sender.join();
+
+    Result("transport")
+        .add("bytes", (uint64_t)msg_size)
+        .add("messages", (uint64_t)iterations)
+        .add("mib_per_s", received / elapsed / (1024 * 1024), 1)
+        .add("msg_per_s", iterations / elapsed, 1);
+}
+
+/**
+ * Builds a volumes listing the way a plug-in hands it back to the client.
+ */
+static Value volume_list(size_t count) {
+    std::vector<Value> vols;
+
+    for (size_t i = 0; i < count; ++i) {
+        std::map<std::string, Value> v;
+        std::string n = ::to_string(i);
+        char vpd83[33];
+
+        snprintf(vpd83, sizeof(vpd83), "6%031zx", i);
+
+        v["class"] = Value("Volume");
+        v["id"] = Value("VOL_ID_" + n);
+        v["name"] = Value("Volume " + n);
+        v["vpd83"] = Value(vpd83);
+        v["block_size"] = Value((uint64_t)512);
+        v["num_of_blocks"] = Value((uint64_t)(2097152 + i));
+        v["admin_state"] = Value((uint32_t)1);
+        v["system_id"] = Value("sim-01");
+        v["pool_id"] = Value("POO1");
+        v["plugin_data"] = Value();
+        vols.push_back(Value(std::move(v)));
+    }
+
+    std::map<std::string, Value> resp;
+    resp["id"] = Value((uint32_t)100);
+    resp["result"] = Value(std::move(vols));
+    return Value(std::move(resp));
+}
+
+/**
+ * Times serializing and de-serializing a volumes listing response with the
+ * given encoding.
+ */
+static void bench_payload(size_t count, Payload::encoding_type e) {
+    Value resp = volume_list(count);
+    size_t iterations = std::max((size_t)1, (size_t)200000 / count);
+    std::string data;
+
+    // Reuses the buffer between messages, as Ipc does
+    double start = now_sec();
+    for (size_t i = 0; i < iterations; ++i) {
+        Payload::serialize(resp, e, data);
+    }
+    double enc = (now_sec() - start) / iterations;
+
+    start = now_sec();
+    for (size_t i = 0; i < iterations; ++i) {
+        Value v = Payload::deserialize(data);
+    }
+    double dec = (now_sec() - start) / iterations;
+
+    Result("payload")
+        .add("encoding", Payload::encodingName(e))
+        .add("volumes", (uint64_t)count)
+        .add("bytes", (uint64_t)data.size())
+        .add("encode_ms", enc * 1000, 3)
+        .add("encode_mib_per_s", data.size() / enc / (1024 * 1024), 1)
+        .add("decode_ms", dec * 1000, 3);
+}
+
+/**
+ * Times de-serializing a volumes listing response and then reading every
+ * field of every record, which is what the client does converting it.
+ */
+static void bench_records(size_t count, Payload::encoding_type e) {
+    std::string data = Payload::serialize(volume_list(count), e);
+    size_t iterations = std::max((size_t)1, (size_t)200000 / count);
+    uint64_t sink = 0;
+
+    double start = now_sec();
+    for (size_t i = 0; i < iterations; ++i) {
+        const Value resp = Payload::deserialize(data);
+        const std::vector<Value> &vols = resp["result"].asArray();
+
+        for (size_t r = 0; r < vols.size(); ++r) {
+            const Value &v = vols[r];
+
+            sink += v["id"].asString().size() + v["name"].asString().size() +
+                    v["vpd83"].asString().size() +
+                    v["block_size"].asUint64_t() +
+                    v["num_of_blocks"].asUint64_t() +
+                    v["admin_state"].asUint32_t() +
+                    v["system_id"].asString().size() +
+                    v["pool_id"].asString().size() +
+                    (v["plugin_data"].asC_str() != NULL);
+        }
+    }
+    double took = (now_sec() - start) / iterations;
+
+    // Same again, reading the fields straight out of the payload
+    std::string key, str;
+    start = now_sec();
+    for (size_t i = 0; i < iterations; ++i) {
+        PayloadReader r(data.data(), data.size(), e);
+
+        r.objectEnter();
+        while (r.objectNext(key)) {
+            if (key != "result") {
+                r.skip();
+                continue;
+            }
+            r.arrayEnter();
+            while (r.arrayNext()) {
+                r.objectEnter();
+                while (r.objectNext(key)) {
+                    if (key == "block_size" || key == "num_of_blocks" ||
+                        key == "admin_state") {
+                        sink += r.uint64();
+                    } else if (key == "plugin_data") {
+                        sink += r.string(str);
+                    } else if (key != "class") {
+                        r.string(str);
+                        sink += str.size();
+                    } else {
+                        r.skip();
+                    }
+                }
+            }
+        }
+        r.finish();
+    }
+    double direct = (now_sec() - start) / iterations;
+
+    Result("records")
+        .add("encoding", Payload::encodingName(e))
+        .add("volumes", (uint64_t)count)
+        .add("decode_read_ms", took * 1000, 3)
+        .add("direct_ms", direct * 1000, 3)
+        .add("sink", sink);
+}
+
+/**
+ * Times decoding and skipping a json volumes listing with each of the json
+ * scanners the CPU supports.  Skipping is what happens to the result of a
+ * response on arrival, before it is decoded.
+ */
+static void bench_scan(size_t count) {
+    std::string data = Payload::serialize(volume_list(count), Payload::json);
+    size_t iterations = std::max((size_t)1, (size_t)200000 / count);
+    size_t scanners = 0;
+    const JsonScanner *scan = json_scanners(scanners);
+
+    for (size_t s = 0; s < scanners; ++s) {
+        double start = now_sec();
+        for (size_t i = 0; i < iterations; ++i) {
+            PayloadReader r(data.data(), data.size(), Payload::json, scan[s]);
+            Value v = r.value();
+            r.finish();
+        }
+        double dec = (now_sec() - start) / iterations;
+
+        start = now_sec();
+        for (size_t i = 0; i < iterations; ++i) {
+            PayloadReader r(data.data(), data.size(), Payload::json, scan[s]);
+            r.skip();
+            r.finish();
+        }
+        double skip = (now_sec() - start) / iterations;
+
+        Result("scan")
+            .add("scanner", scan[s].name)
+            .add("volumes", (uint64_t)count)
+            .add("decode_ms", dec * 1000, 3)
+            .add("skip_ms", skip * 1000, 3)
+            .add("skip_mib_per_s", data.size() / skip / (1024 * 1024), 1);
+    }
+}
+
+/**
+ * Counts the allocations and the growth in resident memory of decoding a
+ * volumes listing into a Value, with fresh scratch space as a one off
+ * decode has and with the scratch space an Ipc keeps between responses.
+ */
+static void bench_allocs(size_t count, Payload::encoding_type e) {
+    std::string data = Payload::serialize(volume_list(count), e);
+    DecodeScratch scratch;
+
+    for (int reused = 0; reused < 2; ++reused) {
+        // Warm up, so the scratch space has grown already when reused
+        Payload::deserialize(data, scratch);
+        scratch.reset();
+        malloc_trim(0);
+
+        size_t before = allocations;
+        long rss = rss_kib();
+        {
+            Value v = reused ? Payload::deserialize(data, scratch)
+                             : Payload::deserialize(data);
+            Result("allocs")
+                .add("encoding", Payload::encodingName(e))
+                .add("volumes", (uint64_t)count)
+                .add("scratch", reused ? "reused" : "fresh")
+                .add("allocations", (uint64_t)(allocations - before))
+                .add("rss_kib", (uint64_t)(rss_kib() - rss));
+        }
+        scratch.reset();
+    }
+}
+
+/**
+ * Times the client side converters on a volumes listing: records to Values
+ * as a plug-in answers, and the listing back to records from a decoded Value
+ * and straight from the payload.
+ */
+static void bench_convert(size_t count, Payload::encoding_type e) {
+    std::vector<lsm_volume *> vols(count);
+    size_t iterations = std::max((size_t)1, (size_t)200000 / count);
+    lsm_volume **got = NULL;
+    uint32_t got_count = 0;
+    double to_value = 0, from_value = 0, from_payload = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = ::to_string(i);
+        char vpd83[33];
+
+        snprintf(vpd83, sizeof(vpd83), "6%031zx", i);
+        vols[i] = lsm_volume_record_alloc(
+            ("VOL_ID_" + n).c_str(), ("Volume " + n).c_str(), vpd83, 512,
+            2097152 + i, 1, "sim-01", "POO1", NULL);
+    }
+
+    std::string data;
+    for (size_t i = 0; i < iterations; ++i) {
+        double start = now_sec();
+        std::vector<Value> values;
+        values.reserve(count);
+        for (size_t r = 0; r < count; ++r) {
+            values.push_back(volume_to_value(vols[r]));
+        }
+        Value list(std::move(values));
+        to_value += now_sec() - start;
+
+        if (data.empty()) {
+            data = Payload::serialize(list, e);
+        }
+    }
+
+    for (size_t i = 0; i < iterations; ++i) {
+        Value list = Payload::deserialize(data);
+
+        double start = now_sec();
+        int rc = value_array_to_volumes(list, &got, &got_count);
+        from_value += now_sec() - start;
+        if (rc == LSM_ERR_OK) {
+            lsm_volume_record_array_free(got, got_count);
+        }
+
+        start = now_sec();
+        PayloadReader r(data.data(), data.size(), e);
+        rc = reader_array_to_volumes(r, &got, &got_count);
+        from_payload += now_sec() - start;
+        if (rc == LSM_ERR_OK) {
+            lsm_volume_record_array_free(got, got_count);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        lsm_volume_record_free(vols[i]);
+    }
+
+    Result("convert")
+        .add("encoding", Payload::encodingName(e))
+        .add("volumes", (uint64_t)count)
+        .add("to_value_ms", to_value / iterations * 1000, 3)
+        .add("from_value_ms", from_value / iterations * 1000, 3)
+        .add("from_payload_ms", from_payload / iterations * 1000, 3);
+}
+
+/**
+ * Calls made from the given number of threads on one connection, answered
+ * by a plug-in stand in which replies straight away.  Latency is the mean
+ * time a call took as seen by the thread making it.
+ */
+static void bench_contention(size_t threads, size_t calls) {
+    int sv[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        perror("socketpair");
+        return;
+    }
+
+    std::thread plugin([&]() {
+        Ipc server(sv[1]);
+        try {
+            for (;;) {
+                Value req = server.readRequest();
+                server.responseSend(Value((uint32_t)30000),
+                                    req["id"].asUint32_t());
+            }
+        } catch (...) {
+            // Client hung up
+        }
+    });
+
+    lsm_connect *c = connection_get();
+    c->tp = new Ipc(sv[0]);
+
+    size_t each = std::max((size_t)1, calls / threads);
+    size_t failed = 0;
+    std::vector<std::thread> callers;
+    std::vector<size_t> errors(threads, 0);
+
+    double start = now_sec();
+    for (size_t t = 0; t < threads; ++t) {
+        callers.emplace_back([&, t]() {
+            for (size_t i = 0; i < each; ++i) {
+                uint32_t timeout = 0;
+                int rc = lsm_connect_timeout_get(c, &timeout,
+                                                 LSM_CLIENT_FLAG_RSVD);
+                if (rc != LSM_ERR_OK || timeout != 30000) {
+                    errors[t]++;
+                }
+            }
+        });
+    }
+    for (size_t t = 0; t < threads; ++t) {
+        callers[t].join();
+        failed += errors[t];
+    }
+    double elapsed = now_sec() - start;
+
+    connection_free(c);
+    plugin.join();
+
+    Result("contention")
+        .add("threads", (uint64_t)threads)
+        .add("calls", (uint64_t)(each * threads))
+        .add("errors", (uint64_t)failed)
+        .add("calls_per_s", each * threads / elapsed, 1)
+        .add("latency_us", elapsed / each * 1e6, 1);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 2 && strcmp(argv[1], "--json") == 0) {
+        json_output = true;
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--json]\n", argv[0]);
+        return 1;
+    }
+
+    static const size_t sizes[] = {1024,          64 * 1024,
+                                   1024 * 1024,   16 * 1024 * 1024,
+                                   64 * 1024 * 1024};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        // Push roughly 1 GiB through the socket for every size
+        size_t iterations = (1024UL * 1024 * 1024) / sizes[i];
+        if (iterations > 100000) {
+            iterations = 100000;
+        }
+        bench_transport(sizes[i], iterations);
+    }
+
+    static const size_t counts[] = {1000, 10000, 100000};
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        bench_payload(counts[i], Payload::json);
+        bench_payload(counts[i], Payload::msgpack);
+    }
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        bench_records(counts[i], Payload::json);
+        bench_records(counts[i], Payload::msgpack);
+    }
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        bench_convert(counts[i], Payload::json);
+        bench_convert(counts[i], Payload::msgpack);
+    }
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        bench_scan(counts[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        bench_allocs(counts[i], Payload::json);
+        bench_allocs(counts[i], Payload::msgpack);
+    }
+
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        bench_contention(threads, 100000);
+    }
+    return 0;
+}
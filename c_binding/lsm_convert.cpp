@@ -15,358 +15,1147 @@
 #include "libstoragemgmt/libstoragemgmt_blockrange.h"
 #include "libstoragemgmt/libstoragemgmt_nfsexport.h"
 #include "libstoragemgmt/libstoragemgmt_plug_interface.h"
+#include "libstoragemgmt/libstoragemgmt_targetport.h"
+#include <algorithm>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
-bool std_map_has_key(const std::map<std::string, Value> &x, const char *key) {
-    return x.find(key) != x.end();
-}
-
-bool is_expected_object(Value &obj, std::string class_name) {
+bool is_expected_object(const Value &obj, std::string class_name) {
     if (obj.valueType() == Value::object_t) {
-        std::map<std::string, Value> i = obj.asObject();
-        std::map<std::string, Value>::iterator iter = i.find("class");
-        if (iter != i.end() && iter->second.asString() == class_name) {
+        const Value &c = obj["class"];
+        if (c.valueType() == Value::string_t && c.asString() == class_name) {
             return true;
         }
     }
     return false;
 }
 
-lsm_volume *value_to_volume(Value &vol) {
-    lsm_volume *rc = NULL;
+/*
+ * Every record type is described once, by a table of its members sorted by
+ * key.  Converting records to Values and back, and reading them straight out
+ * of a payload, are all driven by that table, so a member can't be added to
+ * one direction and missed in the other.
+ */
 
-    if (is_expected_object(vol, CLASS_NAME_VOLUME)) {
-        std::map<std::string, Value> v = vol.asObject();
+enum field_kind {
+    FIELD_CLASS,       // "class", the name of the record type
+    FIELD_STRING,      // char *
+    FIELD_UINT64,      // uint64_t
+    FIELD_UINT32,      // uint32_t
+    FIELD_INT32,       // int32_t, or an enumeration
+    FIELD_ANON_ID,     // uint64_t, the top two values are sent as -1 and -2
+    FIELD_STRING_LIST, // lsm_string_list *
+};
 
-        rc = lsm_volume_record_alloc(
-            v["id"].asString().c_str(), v["name"].asString().c_str(),
-            v["vpd83"].asString().c_str(), v["block_size"].asUint64_t(),
-            v["num_of_blocks"].asUint64_t(), v["admin_state"].asUint32_t(),
-            v["system_id"].asString().c_str(), v["pool_id"].asString().c_str(),
-            v["plugin_data"].asC_str());
-    } else {
-        throw ValueException("value_to_volume: Not correct type");
-    }
+/* String which is NULL when null, rather than "" */
+#define FIELD_NULLABLE 0x1
 
-    return rc;
+/*
+ * Left out when unset, which is a NULL or empty string or a number equal to
+ * RecordField::unset.
+ */
+#define FIELD_OPTIONAL 0x2
+
+/*
+ * String which is mostly the same in every record of a list, such as the id
+ * of the system.  Lists handed out in a slab keep one copy of each value.
+ */
+#define FIELD_SHARED 0x4
+
+struct RecordField {
+    const char *key;
+    field_kind kind;
+    unsigned flags;
+    size_t offset;
+    int32_t unset;
+};
+
+#define FIELD(type, key, kind, flags, member)                                  \
+    { key, kind, flags, offsetof(type, member), 0 }
+
+#define FIELD_UNSET(type, key, member, unset)                                  \
+    { key, FIELD_INT32, FIELD_OPTIONAL, offsetof(type, member), unset }
+
+#define FIELD_CLASS_NAME                                                       \
+    { "class", FIELD_CLASS, 0, 0, 0 }
+
+#define FIELDS_COUNT(fields) (sizeof(fields) / sizeof(fields[0]))
+
+template <typename T> struct RecordType {
+    const char *class_name;
+    uint32_t magic;
+    const RecordField *fields;
+    size_t count;
+
+    /* Allocates a record with the members of the one given */
+    T *(*copy)(T *);
+    int (*release)(T *);
+    T **(*array_alloc)(uint32_t);
+
+    /* Checks a record put in a slab, NULL when lists are not slabs */
+    int (*slab_init)(T *, const lsm_slab *);
+};
+
+static constexpr bool key_less(const char *a, const char *b) {
+    return (*a == *b) ? (*a != '\0' && key_less(a + 1, b + 1))
+                      : ((unsigned char)*a < (unsigned char)*b);
 }
 
-Value volume_to_value(lsm_volume *vol) {
-    if (LSM_IS_VOL(vol)) {
-        std::map<std::string, Value> v;
-        v["class"] = Value(CLASS_NAME_VOLUME);
-        v["id"] = Value(vol->id);
-        v["name"] = Value(vol->name);
-        v["vpd83"] = Value(vol->vpd83);
-        v["block_size"] = Value(vol->block_size);
-        v["num_of_blocks"] = Value(vol->number_of_blocks);
-        v["admin_state"] = Value(vol->admin_state);
-        v["system_id"] = Value(vol->system_id);
-        v["pool_id"] = Value(vol->pool_id);
-        v["plugin_data"] = Value(vol->plugin_data);
-        return Value(v);
-    }
-    return Value();
+static constexpr bool fields_sorted(const RecordField *f, size_t count) {
+    return count < 2 || (key_less(f[0].key, f[1].key) &&
+                         fields_sorted(f + 1, count - 1));
 }
 
-int value_array_to_volumes(Value &volume_values, lsm_volume **volumes[],
-                           uint32_t *count) {
-    int rc = LSM_ERR_OK;
-    try {
-        *count = 0;
+/*
+ * Which members were read is kept as a bit mask.  Enumerations are read
+ * and written as int32_t.
+ */
+#define RECORD_TYPE(name, type, class_name, magic, copy, release, alloc,       \
+                    slab_init)                                                 \
+    static_assert(fields_sorted(name##_fields, FIELDS_COUNT(name##_fields)),   \
+                  #name " members have to be sorted by key");                  \
+    static_assert(FIELDS_COUNT(name##_fields) <= 32,                           \
+                  #name " has too many members");                              \
+    static constexpr RecordType<type> name##_type = {                          \
+        class_name, magic,   name##_fields, FIELDS_COUNT(name##_fields),       \
+        copy,       release, alloc,         slab_init}
+
+static_assert(sizeof(lsm_disk_type) == sizeof(int32_t) &&
+                  sizeof(lsm_disk_link_type) == sizeof(int32_t) &&
+                  sizeof(lsm_system_mode_type) == sizeof(int32_t) &&
+                  sizeof(lsm_access_group_init_type) == sizeof(int32_t) &&
+                  sizeof(lsm_target_port_type) == sizeof(int32_t) &&
+                  sizeof(lsm_battery_type) == sizeof(int32_t),
+              "enumerations are converted as int32_t");
+
+static constexpr RecordField volume_fields[] = {
+    FIELD(lsm_volume, "admin_state", FIELD_UINT32, 0, admin_state),
+    FIELD(lsm_volume, "block_size", FIELD_UINT64, 0, block_size),
+    FIELD_CLASS_NAME,
+    FIELD(lsm_volume, "id", FIELD_STRING, 0, id),
+    FIELD(lsm_volume, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_volume, "num_of_blocks", FIELD_UINT64, 0, number_of_blocks),
+    FIELD(lsm_volume, "plugin_data", FIELD_STRING, FIELD_NULLABLE,
+          plugin_data),
+    FIELD(lsm_volume, "pool_id", FIELD_STRING, FIELD_SHARED, pool_id),
+    FIELD(lsm_volume, "system_id", FIELD_STRING, FIELD_SHARED, system_id),
+    FIELD(lsm_volume, "vpd83", FIELD_STRING, 0, vpd83),
+};
+RECORD_TYPE(volume, lsm_volume, CLASS_NAME_VOLUME, LSM_VOL_MAGIC,
+            lsm_volume_record_copy, lsm_volume_record_free,
+            lsm_volume_record_array_alloc, lsm_volume_slab_init);
+
+static constexpr RecordField disk_fields[] = {
+    FIELD(lsm_disk, "block_size", FIELD_UINT64, 0, block_size),
+    FIELD_CLASS_NAME,
+    FIELD(lsm_disk, "disk_type", FIELD_INT32, 0, type),
+    FIELD(lsm_disk, "id", FIELD_STRING, 0, id),
+    FIELD_UNSET(lsm_disk, "link_type", link_type,
+                LSM_DISK_LINK_TYPE_NO_SUPPORT),
+    FIELD(lsm_disk, "location", FIELD_STRING, FIELD_OPTIONAL, location),
+    FIELD(lsm_disk, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_disk, "num_of_blocks", FIELD_UINT64, 0, number_of_blocks),
+    FIELD(lsm_disk, "plugin_data", FIELD_STRING, FIELD_NULLABLE, plugin_data),
+    FIELD_UNSET(lsm_disk, "rpm", rpm, LSM_DISK_RPM_NO_SUPPORT),
+    FIELD(lsm_disk, "status", FIELD_UINT64, 0, status),
+    FIELD(lsm_disk, "system_id", FIELD_STRING, FIELD_SHARED, system_id),
+    FIELD(lsm_disk, "vpd83", FIELD_STRING, FIELD_OPTIONAL, vpd83),
+};
+RECORD_TYPE(disk, lsm_disk, CLASS_NAME_DISK, LSM_DISK_MAGIC,
+            lsm_disk_record_copy, lsm_disk_record_free,
+            lsm_disk_record_array_alloc, lsm_disk_slab_init);
+
+static constexpr RecordField pool_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_pool, "element_type", FIELD_UINT64, 0, element_type),
+    FIELD(lsm_pool, "free_space", FIELD_UINT64, 0, free_space),
+    FIELD(lsm_pool, "id", FIELD_STRING, 0, id),
+    FIELD(lsm_pool, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_pool, "plugin_data", FIELD_STRING, FIELD_NULLABLE, plugin_data),
+    FIELD(lsm_pool, "status", FIELD_UINT64, 0, status),
+    FIELD(lsm_pool, "status_info", FIELD_STRING, 0, status_info),
+    FIELD(lsm_pool, "system_id", FIELD_STRING, FIELD_SHARED, system_id),
+    FIELD(lsm_pool, "total_space", FIELD_UINT64, 0, total_space),
+    FIELD(lsm_pool, "unsupported_actions", FIELD_UINT64, 0,
+          unsupported_actions),
+};
+RECORD_TYPE(pool, lsm_pool, CLASS_NAME_POOL, LSM_POOL_MAGIC,
+            lsm_pool_record_copy, lsm_pool_record_free,
+            lsm_pool_record_array_alloc, lsm_pool_slab_init);
+
+static constexpr RecordField system_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_system, "fw_version", FIELD_STRING, FIELD_OPTIONAL, fw_version),
+    FIELD(lsm_system, "id", FIELD_STRING, 0, id),
+    FIELD_UNSET(lsm_system, "mode", mode, LSM_SYSTEM_MODE_NO_SUPPORT),
+    FIELD(lsm_system, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_system, "plugin_data", FIELD_STRING, FIELD_NULLABLE,
+          plugin_data),
+    FIELD_UNSET(lsm_system, "read_cache_pct", read_cache_pct,
+                LSM_SYSTEM_READ_CACHE_PCT_NO_SUPPORT),
+    FIELD(lsm_system, "status", FIELD_UINT32, 0, status),
+    FIELD(lsm_system, "status_info", FIELD_STRING, 0, status_info),
+};
+RECORD_TYPE(system, lsm_system, CLASS_NAME_SYSTEM, LSM_SYSTEM_MAGIC,
+            lsm_system_record_copy, lsm_system_record_free,
+            lsm_system_record_array_alloc, NULL);
+
+static constexpr RecordField access_group_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_access_group, "id", FIELD_STRING, 0, id),
+    FIELD(lsm_access_group, "init_ids", FIELD_STRING_LIST, 0, initiators),
+    FIELD(lsm_access_group, "init_type", FIELD_INT32, 0, init_type),
+    FIELD(lsm_access_group, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_access_group, "plugin_data", FIELD_STRING, FIELD_NULLABLE,
+          plugin_data),
+    FIELD(lsm_access_group, "system_id", FIELD_STRING, FIELD_SHARED,
+          system_id),
+};
+RECORD_TYPE(access_group, lsm_access_group, CLASS_NAME_ACCESS_GROUP,
+            LSM_ACCESS_GROUP_MAGIC, lsm_access_group_record_copy,
+            lsm_access_group_record_free, lsm_access_group_record_array_alloc,
+            lsm_access_group_slab_init);
+
+static constexpr RecordField block_range_fields[] = {
+    FIELD(lsm_block_range, "block_count", FIELD_UINT64, 0, block_count),
+    FIELD_CLASS_NAME,
+    FIELD(lsm_block_range, "dest_block", FIELD_UINT64, 0, dest_start),
+    FIELD(lsm_block_range, "src_block", FIELD_UINT64, 0, source_start),
+};
+RECORD_TYPE(block_range, lsm_block_range, CLASS_NAME_BLOCK_RANGE,
+            LSM_BLOCK_RANGE_MAGIC, lsm_block_range_record_copy,
+            lsm_block_range_record_free, lsm_block_range_record_array_alloc,
+            NULL);
+
+static constexpr RecordField fs_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_fs, "free_space", FIELD_UINT64, 0, free_space),
+    FIELD(lsm_fs, "id", FIELD_STRING, 0, id),
+    FIELD(lsm_fs, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_fs, "plugin_data", FIELD_STRING, FIELD_NULLABLE, plugin_data),
+    FIELD(lsm_fs, "pool_id", FIELD_STRING, FIELD_SHARED, pool_id),
+    FIELD(lsm_fs, "system_id", FIELD_STRING, FIELD_SHARED, system_id),
+    FIELD(lsm_fs, "total_space", FIELD_UINT64, 0, total_space),
+};
+RECORD_TYPE(fs, lsm_fs, CLASS_NAME_FILE_SYSTEM, LSM_FS_MAGIC,
+            lsm_fs_record_copy, lsm_fs_record_free, lsm_fs_record_array_alloc,
+            lsm_fs_slab_init);
+
+static constexpr RecordField ss_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_fs_ss, "id", FIELD_STRING, 0, id),
+    FIELD(lsm_fs_ss, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_fs_ss, "plugin_data", FIELD_STRING, FIELD_NULLABLE,
+          plugin_data),
+    FIELD(lsm_fs_ss, "ts", FIELD_UINT64, 0, time_stamp),
+};
+RECORD_TYPE(ss, lsm_fs_ss, CLASS_NAME_FS_SNAPSHOT, LSM_SS_MAGIC,
+            lsm_fs_ss_record_copy, lsm_fs_ss_record_free,
+            lsm_fs_ss_record_array_alloc, NULL);
+
+static constexpr RecordField nfs_export_fields[] = {
+    FIELD(lsm_nfs_export, "anongid", FIELD_ANON_ID, 0, anon_gid),
+    FIELD(lsm_nfs_export, "anonuid", FIELD_ANON_ID, 0, anon_uid),
+    FIELD(lsm_nfs_export, "auth", FIELD_STRING, FIELD_NULLABLE, auth_type),
+    FIELD_CLASS_NAME,
+    FIELD(lsm_nfs_export, "export_path", FIELD_STRING, FIELD_NULLABLE,
+          export_path),
+    FIELD(lsm_nfs_export, "fs_id", FIELD_STRING, FIELD_NULLABLE, fs_id),
+    FIELD(lsm_nfs_export, "id", FIELD_STRING, FIELD_NULLABLE, id),
+    FIELD(lsm_nfs_export, "options", FIELD_STRING, FIELD_NULLABLE, options),
+    FIELD(lsm_nfs_export, "plugin_data", FIELD_STRING, FIELD_NULLABLE,
+          plugin_data),
+    FIELD(lsm_nfs_export, "ro", FIELD_STRING_LIST, 0, read_only),
+    FIELD(lsm_nfs_export, "root", FIELD_STRING_LIST, 0, root),
+    FIELD(lsm_nfs_export, "rw", FIELD_STRING_LIST, 0, read_write),
+};
+RECORD_TYPE(nfs_export, lsm_nfs_export, CLASS_NAME_FS_EXPORT,
+            LSM_NFS_EXPORT_MAGIC, lsm_nfs_export_record_copy,
+            lsm_nfs_export_record_free, lsm_nfs_export_record_array_alloc,
+            NULL);
+
+static constexpr RecordField target_port_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_target_port, "id", FIELD_STRING, FIELD_NULLABLE, id),
+    FIELD(lsm_target_port, "network_address", FIELD_STRING, FIELD_NULLABLE,
+          network_address),
+    FIELD(lsm_target_port, "physical_address", FIELD_STRING, FIELD_NULLABLE,
+          physical_address),
+    FIELD(lsm_target_port, "physical_name", FIELD_STRING, FIELD_NULLABLE,
+          physical_name),
+    FIELD(lsm_target_port, "plugin_data", FIELD_STRING, FIELD_NULLABLE,
+          plugin_data),
+    FIELD(lsm_target_port, "port_type", FIELD_INT32, 0, type),
+    FIELD(lsm_target_port, "service_address", FIELD_STRING, FIELD_NULLABLE,
+          service_address),
+    FIELD(lsm_target_port, "system_id", FIELD_STRING, FIELD_NULLABLE,
+          system_id),
+};
+RECORD_TYPE(target_port, lsm_target_port, CLASS_NAME_TARGET_PORT,
+            LSM_TARGET_PORT_MAGIC, lsm_target_port_copy,
+            lsm_target_port_record_free, lsm_target_port_record_array_alloc,
+            NULL);
+
+static constexpr RecordField battery_fields[] = {
+    FIELD_CLASS_NAME,
+    FIELD(lsm_battery, "id", FIELD_STRING, 0, id),
+    FIELD(lsm_battery, "name", FIELD_STRING, 0, name),
+    FIELD(lsm_battery, "plugin_data", FIELD_STRING,
+          FIELD_NULLABLE | FIELD_OPTIONAL, plugin_data),
+    FIELD(lsm_battery, "status", FIELD_UINT64, 0, status),
+    FIELD(lsm_battery, "system_id", FIELD_STRING, 0, system_id),
+    FIELD(lsm_battery, "type", FIELD_INT32, 0, type),
+};
+RECORD_TYPE(battery, lsm_battery, CLASS_NAME_BATTERY, LSM_BATTERY_MAGIC,
+            lsm_battery_record_copy, lsm_battery_record_free,
+            lsm_battery_record_array_alloc, NULL);
+
+template <typename M> static M &member(const void *rec, const RecordField &f) {
+    return *(M *)((char *)rec + f.offset);
+}
 
-        if (Value::array_t == volume_values.valueType()) {
-            std::vector<Value> vol = volume_values.asArray();
+/**
+ * What a string member is set to, given what was read.  s is NULL when the
+ * member was null or missing.
+ */
+static const char *field_string(const RecordField &f, const char *s) {
+    if (!s) {
+        return (f.flags & (FIELD_NULLABLE | FIELD_OPTIONAL)) ? NULL : "";
+    }
+    return ((f.flags & FIELD_OPTIONAL) && s[0] == '\0') ? NULL : s;
+}
 
-            *count = vol.size();
+static Value anon_id_to_value(uint64_t id) {
+    if (id == UINT64_MAX) {
+        return Value(-1);
+    } else if (id == UINT64_MAX - 1) {
+        return Value(-2);
+    }
+    return Value(id);
+}
 
-            if (vol.size()) {
-                *volumes = lsm_volume_record_array_alloc(vol.size());
+template <typename T>
+static Value record_to_value(const RecordType<T> &type, T *rec) {
+    if (!MAGIC_CHECK(rec, type.magic)) {
+        return Value();
+    }
 
-                if (*volumes) {
-                    for (size_t i = 0; i < vol.size(); ++i) {
-                        (*volumes)[i] = value_to_volume(vol[i]);
-                        if (!((*volumes)[i])) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
-                } else {
-                    rc = LSM_ERR_NO_MEMORY;
-                }
+    // The members go in sorted already, nothing is looked up by key
+    Value::object_type o;
+    o.reserve(type.count);
+
+    for (size_t i = 0; i < type.count; ++i) {
+        const RecordField &f = type.fields[i];
+        bool optional = (f.flags & FIELD_OPTIONAL) != 0;
+
+        switch (f.kind) {
+        case (FIELD_CLASS):
+            o.emplace_back(f.key, Value(type.class_name));
+            break;
+        case (FIELD_STRING): {
+            const char *s = member<const char *>(rec, f);
+            if (s || !optional) {
+                o.emplace_back(f.key, Value(s));
             }
+            break;
+        }
+        case (FIELD_UINT64):
+            o.emplace_back(f.key, Value(member<uint64_t>(rec, f)));
+            break;
+        case (FIELD_UINT32):
+            o.emplace_back(f.key, Value(member<uint32_t>(rec, f)));
+            break;
+        case (FIELD_INT32): {
+            int32_t n = member<int32_t>(rec, f);
+            if (n != f.unset || !optional) {
+                o.emplace_back(f.key, Value(n));
+            }
+            break;
+        }
+        case (FIELD_ANON_ID):
+            o.emplace_back(f.key, anon_id_to_value(member<uint64_t>(rec, f)));
+            break;
+        case (FIELD_STRING_LIST):
+            o.emplace_back(f.key, string_list_to_value(
+                                      member<lsm_string_list *>(rec, f)));
+            break;
         }
-    } catch (const ValueException &ve) {
-        rc = LSM_ERR_LIB_BUG;
-        goto error;
     }
+    return Value(std::move(o));
+}
 
-out:
-    return rc;
+/**
+ * Starts a record to read into.  Its strings will point at what was read,
+ * the record handed out is a copy of it.
+ */
+template <typename T>
+static void record_view(const RecordType<T> &type, T &view) {
+    memset(&view, 0, sizeof(view));
+    view.magic = type.magic;
+
+    for (size_t i = 0; i < type.count; ++i) {
+        const RecordField &f = type.fields[i];
+        if (f.kind == FIELD_INT32 && (f.flags & FIELD_OPTIONAL)) {
+            member<int32_t>(&view, f) = f.unset;
+        }
+    }
+}
 
-error:
-    if (*volumes && *count) {
-        lsm_volume_record_array_free(*volumes, *count);
-        *volumes = NULL;
-        *count = 0;
+template <typename T>
+static void record_view_free(const RecordType<T> &type, T &view) {
+    for (size_t i = 0; i < type.count; ++i) {
+        const RecordField &f = type.fields[i];
+        if (f.kind == FIELD_STRING_LIST) {
+            lsm_string_list *&l = member<lsm_string_list *>(&view, f);
+            if (l) {
+                lsm_string_list_free(l);
+                l = NULL;
+            }
+        }
     }
-    goto out;
 }
 
-lsm_disk *value_to_disk(Value &disk) {
-    lsm_disk *rc = NULL;
-    if (is_expected_object(disk, CLASS_NAME_DISK)) {
-        std::map<std::string, Value> d = disk.asObject();
-        const char *plugin_data = NULL;
+/**
+ * Index of the first member which has to be there but was not read, else
+ * count.  Those are the class, and lists and numbers which are not
+ * optional.  seen has a bit set for each member read.
+ */
+template <typename T>
+static size_t record_missing(const RecordType<T> &type, uint32_t seen) {
+    for (size_t i = 0; i < type.count; ++i) {
+        const RecordField &f = type.fields[i];
+        if (f.kind != FIELD_STRING && !(f.flags & FIELD_OPTIONAL) &&
+            !(seen & (1u << i))) {
+            return i;
+        }
+    }
+    return type.count;
+}
 
-        if (std_map_has_key(d, "plugin_data")) {
-            plugin_data = d["plugin_data"].asC_str();
+/**
+ * Throws unless the members which have to be there were read.
+ */
+template <typename T>
+static void record_required_check(const RecordType<T> &type, uint32_t seen) {
+    size_t i = record_missing(type, seen);
+    if (i != type.count) {
+        throw ValueException(std::string(type.class_name) + ": " +
+                             type.fields[i].key + " missing");
+    }
+}
+
+/**
+ * Sets the strings of view which were not read.
+ */
+template <typename T>
+static void record_view_finish(const RecordType<T> &type, T &view,
+                               uint32_t seen) {
+    for (size_t i = 0; i < type.count; ++i) {
+        const RecordField &f = type.fields[i];
+        if (f.kind == FIELD_STRING && !(seen & (1u << i))) {
+            member<const char *>(&view, f) = field_string(f, NULL);
         }
+    }
+}
 
-        rc = lsm_disk_record_alloc_pd(
-            d["id"].asString().c_str(), d["name"].asString().c_str(),
-            (lsm_disk_type)d["disk_type"].asInt32_t(),
-            d["block_size"].asUint64_t(), d["num_of_blocks"].asUint64_t(),
-            d["status"].asUint64_t(), d["system_id"].asString().c_str(),
-            plugin_data);
-        if ((rc != NULL) && std_map_has_key(d, "vpd83") &&
-            (d["vpd83"].asC_str()[0] != '\0') &&
-            (lsm_disk_vpd83_set(rc, d["vpd83"].asC_str()) != LSM_ERR_OK)) {
+/**
+ * Allocates a copy of the record read into view.  What view holds is freed.
+ * @return record, NULL when out of memory
+ */
+template <typename T>
+static T *record_view_copy(const RecordType<T> &type, T &view, bool ok) {
+    T *rc = ok ? type.copy(&view) : NULL;
+    record_view_free(type, view);
+    return rc;
+}
 
-            lsm_disk_record_free(rc);
-            rc = NULL;
-            throw ValueException("value_to_disk: failed to update 'vpd83'");
+/**
+ * Index of the member key, else count.  Members mostly arrive in the order
+ * of the table, so looking starts at hint.
+ */
+static size_t field_find(const RecordField *fields, size_t count,
+                         const std::string &key, size_t hint) {
+    for (size_t n = 0; n < count; ++n, ++hint) {
+        if (hint >= count) {
+            hint = 0;
+        }
+        if (key == fields[hint].key) {
+            return hint;
         }
+    }
+    return count;
+}
 
-        if ((rc != NULL) && std_map_has_key(d, "location") &&
-            (d["location"].asC_str()[0] != '\0')) {
+/**
+ * Reads a record into view.  Unless the record is bad the caller frees
+ * view, else there is nothing left to free.
+ * @param[out]  why     What is wrong with a bad record
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when v is not a record of the type
+ */
+template <typename T>
+static int value_to_view(const RecordType<T> &type, const Value &v, T &view,
+                         std::string &why) {
+    const Value::object_type *members = NULL;
+    uint32_t seen = 0;
+    size_t at = 0;
+    int rc = LSM_ERR_OK;
 
-            if (lsm_disk_location_set(rc, d["location"].asC_str()) !=
-                LSM_ERR_OK) {
-                lsm_disk_record_free(rc);
-                rc = NULL;
-                throw ValueException("value_to_disk: failed to update "
-                                     "location");
-            }
+    if (!is_expected_object(v, type.class_name) || !v.tryObject(members)) {
+        why = std::string(type.class_name) + ": Not correct type";
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    record_view(type, view);
+
+    // Both are sorted by key, so the lookups mostly hit first time
+    for (const auto &m : *members) {
+        size_t i = field_find(type.fields, type.count, m.first, at);
+        if (i == type.count) {
+            continue;
         }
-        if ((rc != NULL) && std_map_has_key(d, "rpm") &&
-            (d["rpm"].asInt32_t() != LSM_DISK_RPM_NO_SUPPORT)) {
-            if (lsm_disk_rpm_set(rc, d["rpm"].asInt32_t()) != LSM_ERR_OK) {
-                lsm_disk_record_free(rc);
-                rc = NULL;
-                throw ValueException("value_to_disk: failed to update rpm");
-            }
+
+        const RecordField &f = type.fields[i];
+        const Value &mv = m.second;
+        bool good = true;
+        at = i + 1;
+        seen |= 1u << i;
+
+        switch (f.kind) {
+        case (FIELD_CLASS):
+            break;
+        case (FIELD_STRING): {
+            const char *str = NULL;
+            good = mv.tryC_str(str);
+            member<const char *>(&view, f) = field_string(f, str);
+            break;
+        }
+        case (FIELD_UINT64):
+        case (FIELD_ANON_ID):
+            good = mv.tryUint64_t(member<uint64_t>(&view, f));
+            break;
+        case (FIELD_UINT32): {
+            // Read wide, so what doesn't fit isn't silently truncated
+            uint64_t n = 0;
+            good = mv.tryUint64_t(n) && n <= UINT32_MAX;
+            member<uint32_t>(&view, f) = (uint32_t)n;
+            break;
         }
-        if ((rc != NULL) && std_map_has_key(d, "link_type") &&
-            (d["link_type"].asInt32_t() != LSM_DISK_LINK_TYPE_NO_SUPPORT)) {
-            if (lsm_disk_link_type_set(
-                    rc, (lsm_disk_link_type)d["link_type"].asInt32_t()) !=
-                LSM_ERR_OK) {
-                lsm_disk_record_free(rc);
-                rc = NULL;
-                throw ValueException("value_to_disk: failed to update "
-                                     "link_type");
+        case (FIELD_INT32):
+            if (!(f.flags & FIELD_OPTIONAL) ||
+                Value::null_t != mv.valueType()) {
+                int64_t n = 0;
+                good = mv.tryInt64_t(n) && n >= INT32_MIN && n <= INT32_MAX;
+                member<int32_t>(&view, f) = (int32_t)n;
             }
+            break;
+        case (FIELD_STRING_LIST): {
+            int lrc =
+                value_to_string_list(mv, &member<lsm_string_list *>(&view, f));
+            good = LSM_ERR_TRANSPORT_INVALID_ARG != lrc;
+            if (LSM_ERR_NO_MEMORY == lrc) {
+                rc = lrc;
+            }
+            break;
+        }
+        }
+
+        if (!good) {
+            record_view_free(type, view);
+            why = std::string(type.class_name) + ": " + f.key +
+                  " not correct type";
+            return LSM_ERR_TRANSPORT_INVALID_ARG;
         }
-    } else {
-        throw ValueException("value_to_disk: Not correct type");
     }
+
+    size_t missing = record_missing(type, seen);
+    if (missing != type.count) {
+        record_view_free(type, view);
+        why = std::string(type.class_name) + ": " + type.fields[missing].key +
+              " missing";
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    record_view_finish(type, view, seen);
     return rc;
 }
 
-Value disk_to_value(lsm_disk *disk) {
-    if (LSM_IS_DISK(disk)) {
-        std::map<std::string, Value> d;
-        d["class"] = Value(CLASS_NAME_DISK);
-        d["id"] = Value(disk->id);
-        d["name"] = Value(disk->name);
-        d["disk_type"] = Value(disk->type);
-        d["block_size"] = Value(disk->block_size);
-        d["num_of_blocks"] = Value(disk->number_of_blocks);
-        d["status"] = Value(disk->status);
-        d["system_id"] = Value(disk->system_id);
-        d["plugin_data"] = Value(disk->plugin_data);
-        if (disk->location != NULL)
-            d["location"] = Value(disk->location);
-        if (disk->rpm != LSM_DISK_RPM_NO_SUPPORT)
-            d["rpm"] = Value(disk->rpm);
-        if (disk->link_type != LSM_DISK_LINK_TYPE_NO_SUPPORT)
-            d["link_type"] = Value(disk->link_type);
-        if (disk->vpd83 != NULL)
-            d["vpd83"] = Value(disk->vpd83);
-
-        return Value(d);
+/**
+ * Allocates the record v holds.
+ * @param[out]  rec     Record, NULL on error
+ * @param[out]  why     What is wrong with a bad record
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when v is not a record of the type
+ */
+template <typename T>
+static int value_to_record(const RecordType<T> &type, const Value &v, T **rec,
+                           std::string &why) {
+    T view;
+    int rc = value_to_view(type, v, view, why);
+
+    *rec = NULL;
+    if (LSM_ERR_TRANSPORT_INVALID_ARG != rc) {
+        *rec = record_view_copy(type, view, LSM_ERR_OK == rc);
+        if (!*rec) {
+            rc = LSM_ERR_NO_MEMORY;
+        }
     }
-    return Value();
+    return rc;
 }
 
-int value_array_to_disks(Value &disk_values, lsm_disk **disks[],
-                         uint32_t *count) {
-    int rc = LSM_ERR_OK;
-    try {
-        *count = 0;
+/**
+ * Same as above, with a bad record thrown as a ValueException.
+ * @return record, NULL when out of memory
+ */
+template <typename T>
+static T *value_to_record(const RecordType<T> &type, const Value &v) {
+    std::string why;
+    T *rec = NULL;
 
-        if (Value::array_t == disk_values.valueType()) {
-            std::vector<Value> d = disk_values.asArray();
+    if (LSM_ERR_TRANSPORT_INVALID_ARG == value_to_record(type, v, &rec, why)) {
+        throw ValueException(why);
+    }
+    return rec;
+}
 
-            *count = d.size();
+/**
+ * Reads an array of strings.
+ * @return list, NULL when out of memory
+ */
+static lsm_string_list *reader_string_list(PayloadReader &r,
+                                           std::string &scratch) {
+    lsm_string_list *l = lsm_string_list_alloc(0);
 
-            if (d.size()) {
-                *disks = lsm_disk_record_array_alloc(d.size());
+    try {
+        r.arrayEnter();
+        while (r.arrayNext()) {
+            r.string(scratch);
+            if (l && LSM_ERR_OK != lsm_string_list_append(l, scratch.c_str())) {
+                lsm_string_list_free(l);
+                l = NULL;
+            }
+        }
+    } catch (...) {
+        if (l) {
+            lsm_string_list_free(l);
+        }
+        throw;
+    }
+    return l;
+}
 
-                if (*disks) {
-                    for (size_t i = 0; i < d.size(); ++i) {
-                        (*disks)[i] = value_to_disk(d[i]);
-                        if (!((*disks)[i])) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
+/**
+ * Reads the class of a record, which has to be class_name.
+ */
+static void reader_class_check(PayloadReader &r, std::string &scratch,
+                               const char *class_name) {
+    r.string(scratch);
+    if (scratch != class_name) {
+        throw ValueException(std::string("Expected class ") + class_name +
+                             ", got " + scratch);
+    }
+}
+
+/**
+ * Space reused from one record to the next while reading an array of them,
+ * so the strings keep their capacity.
+ */
+struct RecordScratch {
+    std::string key;
+    std::string cls;
+    std::string item;
+    std::vector<std::string> strings;
+
+    explicit RecordScratch(size_t count) : strings(count) {}
+};
+
+/**
+ * Reads a record into view, which the caller frees.  The strings of view
+ * point into s until the next record is read.
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when a number doesn't fit its member, as value_to_view has it
+ */
+template <typename T>
+static int reader_to_view(const RecordType<T> &type, PayloadReader &r,
+                          RecordScratch &s, T &view) {
+    uint32_t seen = 0;
+    uint32_t strings = 0; // Strings read which were not null
+    size_t at = 0;
+    bool ok = true;
+    bool fits = true;
+
+    record_view(type, view);
+    try {
+        r.objectEnter();
+        while (r.objectNext(s.key)) {
+            size_t i = field_find(type.fields, type.count, s.key, at);
+            if (i == type.count) {
+                r.skip();
+                continue;
+            }
+
+            const RecordField &f = type.fields[i];
+            at = i + 1;
+            seen |= 1u << i;
+
+            switch (f.kind) {
+            case (FIELD_CLASS):
+                reader_class_check(r, s.cls, type.class_name);
+                break;
+            case (FIELD_STRING):
+                if (r.string(s.strings[i])) {
+                    strings |= 1u << i;
+                } else {
+                    strings &= ~(1u << i);
+                }
+                break;
+            case (FIELD_UINT64):
+            case (FIELD_ANON_ID):
+                member<uint64_t>(&view, f) = r.uint64();
+                break;
+            case (FIELD_UINT32): {
+                uint64_t n = r.uint64();
+                if (n > UINT32_MAX) {
+                    fits = false;
                 } else {
-                    rc = LSM_ERR_NO_MEMORY;
+                    member<uint32_t>(&view, f) = (uint32_t)n;
                 }
+                break;
+            }
+            case (FIELD_INT32):
+                if ((f.flags & FIELD_OPTIONAL) && Value::null_t == r.peek()) {
+                    r.skip();
+                } else {
+                    int64_t n = r.int64();
+                    if (n < INT32_MIN || n > INT32_MAX) {
+                        fits = false;
+                    } else {
+                        member<int32_t>(&view, f) = (int32_t)n;
+                    }
+                }
+                break;
+            case (FIELD_STRING_LIST): {
+                lsm_string_list *&l = member<lsm_string_list *>(&view, f);
+                if (l) {
+                    lsm_string_list_free(l);
+                }
+                l = reader_string_list(r, s.item);
+                ok = ok && l;
+                break;
+            }
             }
         }
-    } catch (const ValueException &ve) {
-        rc = LSM_ERR_LIB_BUG;
-        goto error;
-    }
 
-out:
-    return rc;
+        record_required_check(type, seen);
+    } catch (...) {
+        record_view_free(type, view);
+        throw;
+    }
 
-error:
-    if (*disks && *count) {
-        lsm_disk_record_array_free(*disks, *count);
-        *disks = NULL;
-        *count = 0;
+    for (size_t i = 0; i < type.count; ++i) {
+        const RecordField &f = type.fields[i];
+        if (f.kind == FIELD_STRING && (seen & (1u << i))) {
+            member<const char *>(&view, f) = field_string(
+                f, (strings & (1u << i)) ? s.strings[i].c_str() : NULL);
+        }
+    }
+    record_view_finish(type, view, seen);
+    if (!fits) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
     }
-    goto out;
+    return ok ? LSM_ERR_OK : LSM_ERR_NO_MEMORY;
 }
 
-lsm_pool *value_to_pool(Value &pool) {
-    lsm_pool *rc = NULL;
+/**
+ * Collects the records of a list result.  Types which can be put in a slab
+ * are kept as views, with their strings copied into one buffer, until all
+ * of them are handed out in one allocation.  Others are copied a record at
+ * a time.  Whatever was not handed out is freed on destruction.
+ */
+template <typename T> class RecordList {
+  public:
+    explicit RecordList(const RecordType<T> &type)
+        : type(type), rc(LSM_ERR_OK) {}
+
+    ~RecordList() {
+        for (size_t i = 0; i < views.size(); ++i) {
+            record_view_free(type, views[i]);
+        }
+        for (size_t i = 0; i < copies.size(); ++i) {
+            type.release(copies[i]);
+        }
+    }
 
-    if (is_expected_object(pool, CLASS_NAME_POOL)) {
-        std::map<std::string, Value> i = pool.asObject();
+    /**
+     * @return LSM_ERR_OK, unless a record added could not be kept
+     */
+    int error() const { return rc; }
+
+    /**
+     * Keeps the record read into view, what view holds is taken over.
+     * @param view      Record read
+     * @param ok        False when reading it ran out of memory
+     */
+    void add(T &view, bool ok) {
+        if (!ok || LSM_ERR_OK != rc) {
+            record_view_free(type, view);
+            rc = LSM_ERR_NO_MEMORY;
+        } else if (!type.slab_init) {
+            T *rec = record_view_copy(type, view, true);
+            if (rec) {
+                copies.push_back(rec);
+            } else {
+                rc = LSM_ERR_NO_MEMORY;
+            }
+        } else {
+            for (size_t i = 0; i < type.count; ++i) {
+                const RecordField &f = type.fields[i];
+                if (f.kind == FIELD_STRING) {
+                    const char *&str = member<const char *>(&view, f);
+                    at.push_back(str ? keep(str, f.flags & FIELD_SHARED)
+                                     : std::string::npos);
+                    str = NULL;
+                }
+            }
+            views.push_back(view);
+        }
+    }
 
-        rc = lsm_pool_record_alloc(
-            i["id"].asString().c_str(), i["name"].asString().c_str(),
-            i["element_type"].asUint64_t(),
-            i["unsupported_actions"].asUint64_t(),
-            i["total_space"].asUint64_t(), i["free_space"].asUint64_t(),
-            i["status"].asUint64_t(), i["status_info"].asString().c_str(),
-            i["system_id"].asString().c_str(), i["plugin_data"].asC_str());
-    } else {
-        throw ValueException("value_to_pool: Not correct type");
+    /**
+     * Hands out the records kept, nothing on error.
+     * @return LSM_ERR_OK on success, else error code
+     */
+    int finish(T **records[], uint32_t *count) {
+        *records = NULL;
+        *count = 0;
+
+        if (LSM_ERR_OK != rc) {
+            return rc;
+        }
+
+        if (views.size()) {
+            uint32_t n = views.size();
+            *records = slab();
+            if (!*records) {
+                return LSM_ERR_NO_MEMORY;
+            }
+            *count = n;
+        } else if (copies.size()) {
+            *records = type.array_alloc(copies.size());
+            if (!*records) {
+                return LSM_ERR_NO_MEMORY;
+            }
+            std::copy(copies.begin(), copies.end(), *records);
+            *count = copies.size();
+            copies.clear();
+        }
+        return rc;
     }
-    return rc;
-}
 
-Value pool_to_value(lsm_pool *pool) {
-    if (LSM_IS_POOL(pool)) {
-        std::map<std::string, Value> p;
-        p["class"] = Value(CLASS_NAME_POOL);
-        p["id"] = Value(pool->id);
-        p["name"] = Value(pool->name);
-        p["element_type"] = Value(pool->element_type);
-        p["unsupported_actions"] = Value(pool->unsupported_actions);
-        p["total_space"] = Value(pool->total_space);
-        p["free_space"] = Value(pool->free_space);
-        p["status"] = Value(pool->status);
-        p["status_info"] = Value(pool->status_info);
-        p["system_id"] = Value(pool->system_id);
-        p["plugin_data"] = Value(pool->plugin_data);
-        return Value(p);
+  private:
+    /**
+     * Copies a string of a view into chars, unless it is shared and the same
+     * value is there already.  Only the first few distinct values of shared
+     * members are looked up, as they are few in any one list.
+     * @return offset of the string in chars
+     */
+    size_t keep(const char *str, bool share) {
+        size_t len = strlen(str);
+        size_t rc = chars.size();
+
+        if (share) {
+            for (size_t i = 0; i < shared.size(); ++i) {
+                if (shared[i].second == len &&
+                    memcmp(chars.data() + shared[i].first, str, len) == 0) {
+                    return shared[i].first;
+                }
+            }
+            if (shared.size() < 16) {
+                shared.emplace_back(rc, len);
+            }
+        }
+        chars.append(str, len + 1);
+        return rc;
     }
-    return Value();
-}
 
-lsm_system *value_to_system(Value &system) {
-    lsm_system *rc = NULL;
-    if (is_expected_object(system, CLASS_NAME_SYSTEM)) {
-        std::map<std::string, Value> i = system.asObject();
-
-        rc = lsm_system_record_alloc(
-            i["id"].asString().c_str(), i["name"].asString().c_str(),
-            i["status"].asUint32_t(), i["status_info"].asString().c_str(),
-            i["plugin_data"].asC_str());
-        if ((rc != NULL) && std_map_has_key(i, "fw_version") &&
-            (i["fw_version"].asC_str()[0] != '\0')) {
-
-            if (lsm_system_fw_version_set(rc, i["fw_version"].asC_str()) !=
-                LSM_ERR_OK) {
-                lsm_system_record_free(rc);
-                rc = NULL;
-                throw ValueException("value_to_system: failed to update "
-                                     "fw_version");
+    /**
+     * Puts the views kept in a slab, which takes over what they hold.
+     * @return array of records, NULL on error
+     */
+    T **slab() {
+        uint32_t n = views.size();
+        lsm_slab *slab = NULL;
+        void *space = NULL;
+        char *strings = NULL;
+        T **array = (T **)lsm_slab_alloc(n, sizeof(T), chars.size(), &slab,
+                                         &space, &strings);
+        T *recs = (T *)space;
+        size_t k = 0;
+        int init = LSM_ERR_OK;
+
+        if (!array) {
+            return NULL;
+        }
+
+        memcpy(strings, chars.data(), chars.size());
+        for (uint32_t i = 0; i < n; ++i) {
+            memcpy(&recs[i], &views[i], sizeof(T));
+            for (size_t j = 0; j < type.count; ++j) {
+                const RecordField &f = type.fields[j];
+                if (f.kind == FIELD_STRING) {
+                    member<const char *>(&recs[i], f) =
+                        (at[k] == std::string::npos) ? NULL : strings + at[k];
+                    ++k;
+                }
+            }
+            array[i] = &recs[i];
+
+            // Every record has to know its slab before any is freed
+            if (LSM_ERR_OK != type.slab_init(&recs[i], slab)) {
+                init = LSM_ERR_NO_MEMORY;
             }
         }
-        if ((rc != NULL) && std_map_has_key(i, "mode") &&
-            (i["mode"].asInt32_t() != LSM_SYSTEM_MODE_NO_SUPPORT) &&
-            (lsm_system_mode_set(
-                rc, (lsm_system_mode_type)i["mode"].asInt32_t()))) {
-
-            lsm_system_record_free(rc);
-            rc = NULL;
-            throw ValueException("value_to_system: failed to update 'mode'");
-        }
-        if ((rc != NULL) && std_map_has_key(i, "read_cache_pct") &&
-            (i["read_cache_pct"].asInt32_t() !=
-             LSM_SYSTEM_READ_CACHE_PCT_NO_SUPPORT)) {
-
-            if (lsm_system_read_cache_pct_set(
-                    rc, i["read_cache_pct"].asInt32_t()) != LSM_ERR_OK) {
-                lsm_system_record_free(rc);
-                rc = NULL;
-                throw ValueException("value_to_system: failed to update "
-                                     "read_cache_pct");
+        views.clear();
+
+        if (LSM_ERR_OK != init) {
+            // As when copying a record fails
+            for (uint32_t i = 0; i < n; ++i) {
+                type.release(array[i]);
             }
+            free(array);
+            array = NULL;
         }
-    } else {
-        throw ValueException("value_to_system: Not correct type");
+        return array;
     }
-    return rc;
+
+    const RecordType<T> &type;
+    int rc;
+    std::vector<T *> copies;
+    std::vector<T> views;
+    std::vector<size_t> at; // Of each string of views in chars, npos if NULL
+    std::string chars;
+    // Offset and length in chars of the values of shared members
+    std::vector<std::pair<size_t, size_t>> shared;
+};
+
+/**
+ * Reads an array of records out of a response.  Nothing is handed back on
+ * error.
+ */
+template <typename T>
+static int reader_array_to_records(PayloadReader &r, const RecordType<T> &type,
+                                   T **records[], uint32_t *count) {
+    RecordScratch s(type.count);
+    RecordList<T> list(type);
+    bool invalid = false;
+
+    *records = NULL;
+    *count = 0;
+
+    if (Value::null_t == r.peek()) {
+        r.skip();
+        return LSM_ERR_OK;
+    }
+
+    r.arrayEnter();
+    while (r.arrayNext()) {
+        if (invalid || LSM_ERR_OK != list.error()) {
+            // Keep reading so the rest of the payload still checks out
+            r.skip();
+            continue;
+        }
+
+        T view;
+        int rc = reader_to_view(type, r, s, view);
+        if (LSM_ERR_TRANSPORT_INVALID_ARG == rc) {
+            record_view_free(type, view);
+            invalid = true;
+            continue;
+        }
+        list.add(view, LSM_ERR_OK == rc);
+    }
+    if (invalid) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+    return list.finish(records, count);
 }
 
-Value system_to_value(lsm_system *system) {
-    if (LSM_IS_SYSTEM(system)) {
-        std::map<std::string, Value> s;
-        s["class"] = Value(CLASS_NAME_SYSTEM);
-        s["id"] = Value(system->id);
-        s["name"] = Value(system->name);
-        s["status"] = Value(system->status);
-        s["status_info"] = Value(system->status_info);
-        s["plugin_data"] = Value(system->plugin_data);
-        if (system->fw_version != NULL)
-            s["fw_version"] = Value(system->fw_version);
-        if (system->mode != LSM_SYSTEM_MODE_NO_SUPPORT)
-            s["mode"] = Value(system->mode);
-        if (system->read_cache_pct != LSM_SYSTEM_READ_CACHE_PCT_NO_SUPPORT)
-            s["read_cache_pct"] = Value(system->read_cache_pct);
-        return Value(s);
+/**
+ * Converts an array of Values to records.  Nothing is handed back on error.
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when v is not an array of records of the type
+ */
+template <typename T>
+static int value_array_to_records(const RecordType<T> &type, const Value &v,
+                                  T **records[], uint32_t *count) {
+    const std::vector<Value> *values = NULL;
+    RecordList<T> list(type);
+    std::string why;
+
+    *records = NULL;
+    *count = 0;
+
+    if (!v.tryArray(values)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
     }
-    return Value();
+
+    for (size_t i = 0; i < values->size() && LSM_ERR_OK == list.error();
+         ++i) {
+        T view;
+        int rc = value_to_view(type, (*values)[i], view, why);
+        if (LSM_ERR_TRANSPORT_INVALID_ARG == rc) {
+            return rc;
+        }
+        list.add(view, LSM_ERR_OK == rc);
+    }
+    return list.finish(records, count);
 }
 
-lsm_string_list *value_to_string_list(Value &v) {
-    lsm_string_list *il = NULL;
+lsm_volume *value_to_volume(const Value &vol) {
+    return value_to_record(volume_type, vol);
+}
 
-    if (Value::array_t == v.valueType()) {
-        std::vector<Value> vl = v.asArray();
-        uint32_t size = vl.size();
-        il = lsm_string_list_alloc(size);
-
-        if (il) {
-            for (uint32_t i = 0; i < size; ++i) {
-                if (LSM_ERR_OK !=
-                    lsm_string_list_elem_set(il, i, vl[i].asC_str())) {
-                    lsm_string_list_free(il);
-                    il = NULL;
-                    break;
-                }
-            }
+Value volume_to_value(lsm_volume *vol) {
+    return record_to_value(volume_type, vol);
+}
+
+int value_to_volume(const Value &vol, lsm_volume **out) {
+    std::string why;
+    return value_to_record(volume_type, vol, out, why);
+}
+
+int value_array_to_volumes(const Value &volume_values, lsm_volume **volumes[],
+                           uint32_t *count) {
+    return value_array_to_records(volume_type, volume_values, volumes, count);
+}
+
+lsm_disk *value_to_disk(const Value &disk) {
+    return value_to_record(disk_type, disk);
+}
+
+Value disk_to_value(lsm_disk *disk) { return record_to_value(disk_type, disk); }
+
+int value_array_to_disks(const Value &disk_values, lsm_disk **disks[],
+                         uint32_t *count) {
+    return value_array_to_records(disk_type, disk_values, disks, count);
+}
+
+lsm_pool *value_to_pool(const Value &pool) {
+    return value_to_record(pool_type, pool);
+}
+
+Value pool_to_value(lsm_pool *pool) { return record_to_value(pool_type, pool); }
+
+int value_to_pool(const Value &pool, lsm_pool **out) {
+    std::string why;
+    return value_to_record(pool_type, pool, out, why);
+}
+
+int value_array_to_pools(const Value &pool_values, lsm_pool **pools[],
+                         uint32_t *count) {
+    return value_array_to_records(pool_type, pool_values, pools, count);
+}
+
+int reader_array_to_volumes(PayloadReader &r, lsm_volume **volumes[],
+                            uint32_t *count) {
+    return reader_array_to_records(r, volume_type, volumes, count);
+}
+
+int reader_array_to_disks(PayloadReader &r, lsm_disk **disks[],
+                          uint32_t *count) {
+    return reader_array_to_records(r, disk_type, disks, count);
+}
+
+int reader_array_to_pools(PayloadReader &r, lsm_pool **pools[],
+                          uint32_t *count) {
+    return reader_array_to_records(r, pool_type, pools, count);
+}
+
+int reader_array_to_systems(PayloadReader &r, lsm_system **systems[],
+                            uint32_t *count) {
+    return reader_array_to_records(r, system_type, systems, count);
+}
+
+int reader_array_to_access_groups(PayloadReader &r, lsm_access_group **groups[],
+                                  uint32_t *count) {
+    return reader_array_to_records(r, access_group_type, groups, count);
+}
+
+int reader_array_to_fs(PayloadReader &r, lsm_fs **fs[], uint32_t *count) {
+    return reader_array_to_records(r, fs_type, fs, count);
+}
+
+int reader_array_to_nfs_exports(PayloadReader &r, lsm_nfs_export **exports[],
+                                uint32_t *count) {
+    return reader_array_to_records(r, nfs_export_type, exports, count);
+}
+
+int reader_array_to_target_ports(PayloadReader &r,
+                                 lsm_target_port **target_ports[],
+                                 uint32_t *count) {
+    return reader_array_to_records(r, target_port_type, target_ports, count);
+}
+
+int reader_array_to_batteries(PayloadReader &r, lsm_battery **bs[],
+                              uint32_t *count) {
+    return reader_array_to_records(r, battery_type, bs, count);
+}
+
+lsm_system *value_to_system(const Value &system) {
+    return value_to_record(system_type, system);
+}
+
+int value_to_system(const Value &system, lsm_system **out) {
+    std::string why;
+    return value_to_record(system_type, system, out, why);
+}
+
+Value system_to_value(lsm_system *system) {
+    return record_to_value(system_type, system);
+}
+
+int value_array_to_systems(const Value &system_values, lsm_system **systems[],
+                           uint32_t *count) {
+    return value_array_to_records(system_type, system_values, systems, count);
+}
+
+int value_to_string_list(const Value &v, lsm_string_list **list) {
+    const std::vector<Value> *items = NULL;
+    lsm_string_list *l = NULL;
+    int rc = LSM_ERR_OK;
+
+    *list = NULL;
+    if (!v.tryArray(items)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    l = lsm_string_list_alloc(items->size());
+    if (!l) {
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < items->size() && LSM_ERR_OK == rc; ++i) {
+        const char *str = NULL;
+        if (!(*items)[i].tryC_str(str)) {
+            rc = LSM_ERR_TRANSPORT_INVALID_ARG;
+        } else if (LSM_ERR_OK != lsm_string_list_elem_set(l, i, str)) {
+            rc = LSM_ERR_NO_MEMORY;
         }
+    }
+
+    if (LSM_ERR_OK == rc) {
+        *list = l;
     } else {
+        lsm_string_list_free(l);
+    }
+    return rc;
+}
+
+lsm_string_list *value_to_string_list(const Value &v) {
+    lsm_string_list *il = NULL;
+
+    if (LSM_ERR_TRANSPORT_INVALID_ARG == value_to_string_list(v, &il)) {
         throw ValueException("value_to_string_list: Not correct type");
     }
     return il;
@@ -382,85 +1171,26 @@ Value string_list_to_value(lsm_string_list *sl) {
             rc.push_back(Value(lsm_string_list_elem_get(sl, i)));
         }
     }
-    return Value(rc);
+    return Value(std::move(rc));
 }
 
-lsm_access_group *value_to_access_group(Value &group) {
-    lsm_string_list *il = NULL;
-    lsm_access_group *ag = NULL;
-
-    if (is_expected_object(group, CLASS_NAME_ACCESS_GROUP)) {
-        std::map<std::string, Value> vAg = group.asObject();
-        il = value_to_string_list(vAg["init_ids"]);
-
-        if (il) {
-            ag = lsm_access_group_record_alloc(
-                vAg["id"].asString().c_str(), vAg["name"].asString().c_str(),
-                il, (lsm_access_group_init_type)vAg["init_type"].asInt32_t(),
-                vAg["system_id"].asString().c_str(),
-                vAg["plugin_data"].asC_str());
-        }
-        /* This stuff is copied in lsm_access_group_record_alloc */
-        lsm_string_list_free(il);
-    } else {
-        throw ValueException("value_to_access_group: Not correct type");
-    }
-    return ag;
+lsm_access_group *value_to_access_group(const Value &group) {
+    return value_to_record(access_group_type, group);
 }
 
 Value access_group_to_value(lsm_access_group *group) {
-    if (LSM_IS_ACCESS_GROUP(group)) {
-        std::map<std::string, Value> ag;
-        ag["class"] = Value(CLASS_NAME_ACCESS_GROUP);
-        ag["id"] = Value(group->id);
-        ag["name"] = Value(group->name);
-        ag["init_ids"] = Value(string_list_to_value(group->initiators));
-        ag["init_type"] = Value(group->init_type);
-        ag["system_id"] = Value(group->system_id);
-        ag["plugin_data"] = Value(group->plugin_data);
-        return Value(ag);
-    }
-    return Value();
+    return record_to_value(access_group_type, group);
 }
 
-int value_array_to_access_groups(Value &group, lsm_access_group **ag_list[],
-                                 uint32_t *count) {
-    int rc = LSM_ERR_OK;
-
-    try {
-        std::vector<Value> ag = group.asArray();
-        *count = ag.size();
-
-        if (*count) {
-            *ag_list = lsm_access_group_record_array_alloc(*count);
-            if (*ag_list) {
-                uint32_t i;
-                for (i = 0; i < *count; ++i) {
-                    (*ag_list)[i] = value_to_access_group(ag[i]);
-                    if (!((*ag_list)[i])) {
-                        rc = LSM_ERR_NO_MEMORY;
-                        goto error;
-                    }
-                }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = LSM_ERR_LIB_BUG;
-        goto error;
-    }
-
-out:
-    return rc;
+int value_to_access_group(const Value &group, lsm_access_group **out) {
+    std::string why;
+    return value_to_record(access_group_type, group, out, why);
+}
 
-error:
-    if (*ag_list && *count) {
-        lsm_access_group_record_array_free(*ag_list, *count);
-        *ag_list = NULL;
-        *count = 0;
-    }
-    goto out;
+int value_array_to_access_groups(const Value &group,
+                                 lsm_access_group **ag_list[],
+                                 uint32_t *count) {
+    return value_array_to_records(access_group_type, group, ag_list, count);
 }
 
 Value access_group_list_to_value(lsm_access_group **group, uint32_t count) {
@@ -473,51 +1203,28 @@ Value access_group_list_to_value(lsm_access_group **group, uint32_t count) {
             rc.push_back(access_group_to_value(group[i]));
         }
     }
-    return Value(rc);
+    return Value(std::move(rc));
 }
 
-lsm_block_range *value_to_block_range(Value &br) {
-    lsm_block_range *rc = NULL;
-    if (is_expected_object(br, CLASS_NAME_BLOCK_RANGE)) {
-        std::map<std::string, Value> range = br.asObject();
-
-        rc = lsm_block_range_record_alloc(range["src_block"].asUint64_t(),
-                                          range["dest_block"].asUint64_t(),
-                                          range["block_count"].asUint64_t());
-    } else {
-        throw ValueException("value_to_block_range: Not correct type");
-    }
-    return rc;
+lsm_block_range *value_to_block_range(const Value &br) {
+    return value_to_record(block_range_type, br);
 }
 
 Value block_range_to_value(lsm_block_range *br) {
-    if (LSM_IS_BLOCK_RANGE(br)) {
-        std::map<std::string, Value> r;
-        r["class"] = Value(CLASS_NAME_BLOCK_RANGE);
-        r["src_block"] = Value(br->source_start);
-        r["dest_block"] = Value(br->dest_start);
-        r["block_count"] = Value(br->block_count);
-        return Value(r);
-    }
-    return Value();
+    return record_to_value(block_range_type, br);
 }
 
-lsm_block_range **value_to_block_range_list(Value &brl, uint32_t *count) {
+int value_to_block_range_list(const Value &brl, lsm_block_range **list[],
+                              uint32_t *count) {
+    return value_array_to_records(block_range_type, brl, list, count);
+}
+
+lsm_block_range **value_to_block_range_list(const Value &brl, uint32_t *count) {
     lsm_block_range **rc = NULL;
-    std::vector<Value> r = brl.asArray();
-    *count = r.size();
-    if (*count) {
-        rc = lsm_block_range_record_array_alloc(*count);
-        if (rc) {
-            for (uint32_t i = 0; i < *count; ++i) {
-                rc[i] = value_to_block_range(r[i]);
-                if (!rc[i]) {
-                    lsm_block_range_record_array_free(rc, i);
-                    rc = NULL;
-                    break;
-                }
-            }
-        }
+
+    if (LSM_ERR_TRANSPORT_INVALID_ARG ==
+        value_to_block_range_list(brl, &rc, count)) {
+        throw ValueException("value_to_block_range_list: Not correct type");
     }
     return rc;
 }
@@ -531,146 +1238,55 @@ Value block_range_list_to_value(lsm_block_range **brl, uint32_t count) {
             r.push_back(block_range_to_value(brl[i]));
         }
     }
-    return Value(r);
+    return Value(std::move(r));
 }
 
-lsm_fs *value_to_fs(Value &fs) {
-    lsm_fs *rc = NULL;
-    if (is_expected_object(fs, CLASS_NAME_FILE_SYSTEM)) {
-        std::map<std::string, Value> f = fs.asObject();
+lsm_fs *value_to_fs(const Value &fs) {
+    return value_to_record(fs_type, fs);
+}
 
-        rc = lsm_fs_record_alloc(
-            f["id"].asString().c_str(), f["name"].asString().c_str(),
-            f["total_space"].asUint64_t(), f["free_space"].asUint64_t(),
-            f["pool_id"].asString().c_str(), f["system_id"].asString().c_str(),
-            f["plugin_data"].asC_str());
-    } else {
-        throw ValueException("value_to_fs: Not correct type");
-    }
-    return rc;
+int value_to_fs(const Value &fs, lsm_fs **out) {
+    std::string why;
+    return value_to_record(fs_type, fs, out, why);
 }
 
-Value fs_to_value(lsm_fs *fs) {
-    if (LSM_IS_FS(fs)) {
-        std::map<std::string, Value> f;
-        f["class"] = Value(CLASS_NAME_FILE_SYSTEM);
-        f["id"] = Value(fs->id);
-        f["name"] = Value(fs->name);
-        f["total_space"] = Value(fs->total_space);
-        f["free_space"] = Value(fs->free_space);
-        f["pool_id"] = Value(fs->pool_id);
-        f["system_id"] = Value(fs->system_id);
-        f["plugin_data"] = Value(fs->plugin_data);
-        return Value(f);
-    }
-    return Value();
+int value_array_to_fs(const Value &fs_values, lsm_fs **fs[], uint32_t *count) {
+    return value_array_to_records(fs_type, fs_values, fs, count);
 }
 
-lsm_fs_ss *value_to_ss(Value &ss) {
-    lsm_fs_ss *rc = NULL;
-    if (is_expected_object(ss, CLASS_NAME_FS_SNAPSHOT)) {
-        std::map<std::string, Value> f = ss.asObject();
+Value fs_to_value(lsm_fs *fs) { return record_to_value(fs_type, fs); }
 
-        rc = lsm_fs_ss_record_alloc(
-            f["id"].asString().c_str(), f["name"].asString().c_str(),
-            f["ts"].asUint64_t(), f["plugin_data"].asC_str());
-    } else {
-        throw ValueException("value_to_ss: Not correct type");
-    }
-    return rc;
+lsm_fs_ss *value_to_ss(const Value &ss) {
+    return value_to_record(ss_type, ss);
 }
 
-Value ss_to_value(lsm_fs_ss *ss) {
-    if (LSM_IS_SS(ss)) {
-        std::map<std::string, Value> f;
-        f["class"] = Value(CLASS_NAME_FS_SNAPSHOT);
-        f["id"] = Value(ss->id);
-        f["name"] = Value(ss->name);
-        f["ts"] = Value(ss->time_stamp);
-        f["plugin_data"] = Value(ss->plugin_data);
-        return Value(f);
-    }
-    return Value();
+int value_to_ss(const Value &ss, lsm_fs_ss **out) {
+    std::string why;
+    return value_to_record(ss_type, ss, out, why);
 }
 
-lsm_nfs_export *value_to_nfs_export(Value &exp) {
-    lsm_nfs_export *rc = NULL;
-    if (is_expected_object(exp, CLASS_NAME_FS_EXPORT)) {
-        int ok = 0;
-        lsm_string_list *root = NULL;
-        lsm_string_list *rw = NULL;
-        lsm_string_list *ro = NULL;
-
-        std::map<std::string, Value> i = exp.asObject();
-
-        /* Check all the arrays for successful allocation */
-        root = value_to_string_list(i["root"]);
-        if (root) {
-            rw = value_to_string_list(i["rw"]);
-            if (rw) {
-                ro = value_to_string_list(i["ro"]);
-                if (!ro) {
-                    lsm_string_list_free(rw);
-                    lsm_string_list_free(root);
-                    rw = NULL;
-                    root = NULL;
-                } else {
-                    ok = 1;
-                }
-            } else {
-                lsm_string_list_free(root);
-                root = NULL;
-            }
-        }
+Value ss_to_value(lsm_fs_ss *ss) { return record_to_value(ss_type, ss); }
 
-        if (ok) {
-            rc = lsm_nfs_export_record_alloc(
-                i["id"].asC_str(), i["fs_id"].asC_str(),
-                i["export_path"].asC_str(), i["auth"].asC_str(), root, rw, ro,
-                i["anonuid"].asUint64_t(), i["anongid"].asUint64_t(),
-                i["options"].asC_str(), i["plugin_data"].asC_str());
+lsm_nfs_export *value_to_nfs_export(const Value &exp) {
+    return value_to_record(nfs_export_type, exp);
+}
 
-            lsm_string_list_free(root);
-            lsm_string_list_free(rw);
-            lsm_string_list_free(ro);
-        }
-    } else {
-        throw ValueException("value_to_nfs_export: Not correct type");
-    }
-    return rc;
+int value_to_nfs_export(const Value &exp, lsm_nfs_export **out) {
+    std::string why;
+    return value_to_record(nfs_export_type, exp, out, why);
 }
 
 Value nfs_export_to_value(lsm_nfs_export *exp) {
-    if (LSM_IS_NFS_EXPORT(exp)) {
-        std::map<std::string, Value> f;
-        f["class"] = Value(CLASS_NAME_FS_EXPORT);
-        f["id"] = Value(exp->id);
-        f["fs_id"] = Value(exp->fs_id);
-        f["export_path"] = Value(exp->export_path);
-        f["auth"] = Value(exp->auth_type);
-        f["root"] = Value(string_list_to_value(exp->root));
-        f["rw"] = Value(string_list_to_value(exp->read_write));
-        f["ro"] = Value(string_list_to_value(exp->read_only));
-        if (exp->anon_uid == UINT64_MAX)
-            f["anonuid"] = Value(-1);
-        else if (exp->anon_uid == UINT64_MAX - 1)
-            f["anonuid"] = Value(-2);
-        else
-            f["anonuid"] = Value(exp->anon_uid);
-        if (exp->anon_gid == UINT64_MAX)
-            f["anongid"] = Value(-1);
-        else if (exp->anon_gid == UINT64_MAX - 1)
-            f["anongid"] = Value(-2);
-        else
-            f["anongid"] = Value(exp->anon_gid);
-        f["options"] = Value(exp->options);
-        f["plugin_data"] = Value(exp->plugin_data);
-        return Value(f);
-    }
-    return Value();
+    return record_to_value(nfs_export_type, exp);
 }
 
-lsm_storage_capabilities *value_to_capabilities(Value &exp) {
+int value_array_to_nfs_exports(const Value &export_values,
+                               lsm_nfs_export **exports[], uint32_t *count) {
+    return value_array_to_records(nfs_export_type, export_values, exports,
+                                  count);
+}
+
+lsm_storage_capabilities *value_to_capabilities(const Value &exp) {
     lsm_storage_capabilities *rc = NULL;
     if (is_expected_object(exp, CLASS_NAME_CAPABILITIES)) {
         const char *val = exp["cap"].asC_str();
@@ -683,75 +1299,57 @@ lsm_storage_capabilities *value_to_capabilities(Value &exp) {
 
 Value capabilities_to_value(lsm_storage_capabilities *cap) {
     if (LSM_IS_CAPABILITY(cap)) {
-        std::map<std::string, Value> c;
+        Value::object_type c;
         char *t = capability_string(cap);
-        c["class"] = Value(CLASS_NAME_CAPABILITIES);
-        c["cap"] = Value(t);
+        c.reserve(2);
+        c.emplace_back("cap", Value(t));
+        c.emplace_back("class", Value(CLASS_NAME_CAPABILITIES));
         free(t);
-        return Value(c);
+        return Value(std::move(c));
     }
     return Value();
 }
 
-lsm_target_port *value_to_target_port(Value &tp) {
-    lsm_target_port *rc = NULL;
-    if (is_expected_object(tp, CLASS_NAME_TARGET_PORT)) {
-        rc = lsm_target_port_record_alloc(
-            tp["id"].asC_str(),
-            (lsm_target_port_type)tp["port_type"].asInt32_t(),
-            tp["service_address"].asC_str(), tp["network_address"].asC_str(),
-            tp["physical_address"].asC_str(), tp["physical_name"].asC_str(),
-            tp["system_id"].asC_str(), tp["plugin_data"].asC_str());
-    } else {
-        throw ValueException("value_to_target_port: Not correct type");
-    }
-    return rc;
+lsm_target_port *value_to_target_port(const Value &tp) {
+    return value_to_record(target_port_type, tp);
 }
 
 Value target_port_to_value(lsm_target_port *tp) {
-    if (LSM_IS_TARGET_PORT(tp)) {
-        std::map<std::string, Value> p;
-        p["class"] = Value(CLASS_NAME_TARGET_PORT);
-        p["id"] = Value(tp->id);
-        p["port_type"] = Value(tp->type);
-        p["service_address"] = Value(tp->service_address);
-        p["network_address"] = Value(tp->network_address);
-        p["physical_address"] = Value(tp->physical_address);
-        p["physical_name"] = Value(tp->physical_name);
-        p["system_id"] = Value(tp->system_id);
-        p["plugin_data"] = Value(tp->plugin_data);
-        return Value(p);
-    }
-    return Value();
+    return record_to_value(target_port_type, tp);
 }
 
-int values_to_uint32_array(Value &value, uint32_t **uint32_array,
+int value_array_to_target_ports(const Value &tp_values,
+                                lsm_target_port **target_ports[],
+                                uint32_t *count) {
+    return value_array_to_records(target_port_type, tp_values, target_ports,
+                                  count);
+}
+
+int values_to_uint32_array(const Value &value, uint32_t **uint32_array,
                            uint32_t *count) {
-    int rc = LSM_ERR_OK;
+    const std::vector<Value> *data = NULL;
+
     *count = 0;
-    try {
-        std::vector<Value> data = value.asArray();
-        *count = data.size();
-        if (*count) {
-            *uint32_array = (uint32_t *)malloc(sizeof(uint32_t) * *count);
-            if (*uint32_array) {
-                uint32_t i;
-                for (i = 0; i < *count; i++) {
-                    (*uint32_array)[i] = data[i].asUint32_t();
-                }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
-            }
+    if (!value.tryArray(data)) {
+        return LSM_ERR_LIB_BUG;
+    }
+
+    if (data->size()) {
+        uint32_t *a = (uint32_t *)malloc(sizeof(uint32_t) * data->size());
+        if (!a) {
+            return LSM_ERR_NO_MEMORY;
         }
-    } catch (const ValueException &ve) {
-        if (*count) {
-            free(*uint32_array);
-            *uint32_array = NULL;
-            *count = 0;
+
+        for (size_t i = 0; i < data->size(); i++) {
+            if (!(*data)[i].tryUint32_t(a[i])) {
+                free(a);
+                return LSM_ERR_LIB_BUG;
+            }
         }
-        rc = LSM_ERR_LIB_BUG;
+        *uint32_array = a;
+        *count = data->size();
     }
-    return rc;
+    return LSM_ERR_OK;
 }
 
 Value uint32_array_to_value(uint32_t *uint32_array, uint32_t count) {
@@ -766,77 +1364,15 @@ Value uint32_array_to_value(uint32_t *uint32_array, uint32_t count) {
     return rc;
 }
 
-lsm_battery *value_to_battery(Value &battery) {
-    lsm_battery *rc = NULL;
-    if (is_expected_object(battery, CLASS_NAME_BATTERY)) {
-        std::map<std::string, Value> b = battery.asObject();
-
-        rc = lsm_battery_record_alloc(
-            b["id"].asString().c_str(), b["name"].asString().c_str(),
-            (lsm_battery_type)b["type"].asInt32_t(), b["status"].asUint64_t(),
-            b["system_id"].asString().c_str(), b["plugin_data"].asC_str());
-    } else {
-        throw ValueException("value_to_battery: Not correct type");
-    }
-    return rc;
+lsm_battery *value_to_battery(const Value &battery) {
+    return value_to_record(battery_type, battery);
 }
 
 Value battery_to_value(lsm_battery *battery) {
-    if (LSM_IS_BATTERY(battery)) {
-        std::map<std::string, Value> b;
-        b["class"] = Value(CLASS_NAME_BATTERY);
-        b["id"] = Value(battery->id);
-        b["name"] = Value(battery->name);
-        b["type"] = Value(battery->type);
-        b["status"] = Value(battery->status);
-        b["system_id"] = Value(battery->system_id);
-        if (battery->plugin_data != NULL)
-            b["plugin_data"] = Value(battery->plugin_data);
-        return Value(b);
-    }
-    return Value();
+    return record_to_value(battery_type, battery);
 }
 
-int value_array_to_batteries(Value &battery_values, lsm_battery ***bs,
+int value_array_to_batteries(const Value &battery_values, lsm_battery ***bs,
                              uint32_t *count) {
-    int rc = LSM_ERR_OK;
-    try {
-        *count = 0;
-
-        if (Value::array_t == battery_values.valueType()) {
-            std::vector<Value> d = battery_values.asArray();
-
-            *count = d.size();
-
-            if (d.size()) {
-                *bs = lsm_battery_record_array_alloc(d.size());
-
-                if (*bs) {
-                    for (size_t i = 0; i < d.size(); ++i) {
-                        (*bs)[i] = value_to_battery(d[i]);
-                        if (!((*bs)[i])) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
-                } else {
-                    rc = LSM_ERR_NO_MEMORY;
-                }
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = LSM_ERR_LIB_BUG;
-        goto error;
-    }
-
-out:
-    return rc;
-
-error:
-    if (*bs && *count) {
-        lsm_battery_record_array_free(*bs, *count);
-        *bs = NULL;
-        *count = 0;
-    }
-    goto out;
+    return value_array_to_records(battery_type, battery_values, bs, count);
 }
@@ -45,14 +45,24 @@ const char CLASS_NAME_BATTERY[] = "Battery";
  * @param class_name    Class name to check
  * @return boolean, true if matches
  */
-bool LSM_DLL_LOCAL is_expected_object(Value &obj, std::string class_name);
+bool LSM_DLL_LOCAL is_expected_object(const Value &obj, std::string class_name);
 
 /**
  * Converts an array of Values to a lsm_string_list
  * @param list      List represented as an vector of strings.
  * @return lsm_string_list pointer, NULL on error.
  */
-lsm_string_list LSM_DLL_LOCAL *value_to_string_list(Value &list);
+lsm_string_list LSM_DLL_LOCAL *value_to_string_list(const Value &list);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  list     Array of strings
+ * @param[out] out      String list, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when list is not an array of strings
+ */
+int LSM_DLL_LOCAL value_to_string_list(const Value &list,
+                                       lsm_string_list **out);
 
 /**
  * Converts a lsm_string_list to a Value
@@ -66,7 +76,16 @@ Value LSM_DLL_LOCAL string_list_to_value(lsm_string_list *sl);
  * @param vol Value to convert.
  * @return lsm_volume *, else NULL on error
  */
-lsm_volume LSM_DLL_LOCAL *value_to_volume(Value &vol);
+lsm_volume LSM_DLL_LOCAL *value_to_volume(const Value &vol);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  vol      Value to convert
+ * @param[out] out      Volume, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_volume(const Value &vol, lsm_volume **out);
 
 /**
  * Converts a lsm_volume *to a Value
@@ -80,9 +99,10 @@ Value LSM_DLL_LOCAL volume_to_value(lsm_volume *vol);
  * @param volume_values     Vector of values that represents volumes
  * @param volumes           An array of volume pointers
  * @param count             Number of volumes
- * @return LSM_ERR_OK on success, else error reason
+ * @return LSM_ERR_OK on success, else error reason, see
+ *         value_array_to_pools.
  */
-int LSM_DLL_LOCAL value_array_to_volumes(Value &volume_values,
+int LSM_DLL_LOCAL value_array_to_volumes(const Value &volume_values,
                                          lsm_volume **volumes[],
                                          uint32_t *count);
 
@@ -91,7 +111,7 @@ int LSM_DLL_LOCAL value_array_to_volumes(Value &volume_values,
  * @param disk  Value representing a disk
  * @return lsm_disk pointer, else NULL on error
  */
-lsm_disk LSM_DLL_LOCAL *value_to_disk(Value &disk);
+lsm_disk LSM_DLL_LOCAL *value_to_disk(const Value &disk);
 
 /**
  * Converts a lsm_disk to a value
@@ -107,15 +127,24 @@ Value LSM_DLL_LOCAL disk_to_value(lsm_disk *disk);
  * @param[out] count            Number of disks
  * @return LSM_ERR_OK on success, else error reason.
  */
-int LSM_DLL_LOCAL value_array_to_disks(Value &disk_values, lsm_disk **disks[],
-                                       uint32_t *count);
+int LSM_DLL_LOCAL value_array_to_disks(const Value &disk_values,
+                                       lsm_disk **disks[], uint32_t *count);
 
 /**
  * Converts a value to a pool
  * @param pool To convert to lsm_pool *
  * @return lsm_pool *, else NULL on error.
  */
-lsm_pool LSM_DLL_LOCAL *value_to_pool(Value &pool);
+lsm_pool LSM_DLL_LOCAL *value_to_pool(const Value &pool);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  pool     Value to convert
+ * @param[out] out      Pool, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_pool(const Value &pool, lsm_pool **out);
 
 /**
  * Converts a lsm_pool * to Value
@@ -124,12 +153,33 @@ lsm_pool LSM_DLL_LOCAL *value_to_pool(Value &pool);
  */
 Value LSM_DLL_LOCAL pool_to_value(lsm_pool *pool);
 
+/**
+ * Converts a vector of pool values to an array.
+ * @param[in] pool_values       Vector of values that represents pools
+ * @param[out] pools            An array of pool pointers
+ * @param[out] count            Number of pools
+ * @return LSM_ERR_OK on success, else error reason.
+ *         LSM_ERR_TRANSPORT_INVALID_ARG when pool_values is not an array
+ *         of pools.
+ */
+int LSM_DLL_LOCAL value_array_to_pools(const Value &pool_values,
+                                       lsm_pool **pools[], uint32_t *count);
+
 /**
  * Converts a value to a system
  * @param system to convert to lsm_system *
  * @return lsm_system pointer, else NULL on error
  */
-lsm_system LSM_DLL_LOCAL *value_to_system(Value &system);
+lsm_system LSM_DLL_LOCAL *value_to_system(const Value &system);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  system   Value to convert
+ * @param[out] out      System, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_system(const Value &system, lsm_system **out);
 
 /**
  * Converts a lsm_system * to a Value
@@ -138,12 +188,34 @@ lsm_system LSM_DLL_LOCAL *value_to_system(Value &system);
  */
 Value LSM_DLL_LOCAL system_to_value(lsm_system *system);
 
+/**
+ * Converts a vector of system values to an array.
+ * @param[in] system_values     Vector of values that represents systems
+ * @param[out] systems          An array of system pointers
+ * @param[out] count            Number of systems
+ * @return LSM_ERR_OK on success, else error reason, see
+ *         value_array_to_pools.
+ */
+int LSM_DLL_LOCAL value_array_to_systems(const Value &system_values,
+                                         lsm_system **systems[],
+                                         uint32_t *count);
+
 /**
  * Converts a Value to a lsm_access_group
  * @param group to convert to lsm_access_group*
  * @return lsm_access_group *, NULL on error
  */
-lsm_access_group LSM_DLL_LOCAL *value_to_access_group(Value &group);
+lsm_access_group LSM_DLL_LOCAL *value_to_access_group(const Value &group);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  group    Value to convert
+ * @param[out] out      Access group, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_access_group(const Value &group,
+                                        lsm_access_group **out);
 
 /**
  * Converts a lsm_access_group to a Value
@@ -159,7 +231,7 @@ Value LSM_DLL_LOCAL access_group_to_value(lsm_access_group *group);
  * @param[out] count        Number of items in the returned array.
  * @return LSM_ERR_OK on success, else error reason
  */
-int LSM_DLL_LOCAL value_array_to_access_groups(Value &group,
+int LSM_DLL_LOCAL value_array_to_access_groups(const Value &group,
                                                lsm_access_group **ag_list[],
                                                uint32_t *count);
 
@@ -177,7 +249,7 @@ Value LSM_DLL_LOCAL access_group_list_to_value(lsm_access_group **group,
  * @param br        Value representing a block range
  * @return lsm_block_range *
  */
-lsm_block_range LSM_DLL_LOCAL *value_to_block_range(Value &br);
+lsm_block_range LSM_DLL_LOCAL *value_to_block_range(const Value &br);
 
 /**
  * Converts a lsm_block_range to a Value
@@ -192,9 +264,21 @@ Value LSM_DLL_LOCAL block_range_to_value(lsm_block_range *br);
  * @param[out] count        Number of items in the resulting array
  * @return NULL on memory allocation failure, else array of lsm_block_range
  */
-lsm_block_range LSM_DLL_LOCAL **value_to_block_range_list(Value &brl,
+lsm_block_range LSM_DLL_LOCAL **value_to_block_range_list(const Value &brl,
                                                           uint32_t *count);
 
+/**
+ * Same as above, without throwing.
+ * @param[in]  brl          Value representing block range(s)
+ * @param[out] list         Array of lsm_block_range, NULL on error
+ * @param[out] count        Number of items in list
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when brl is not an array of block ranges
+ */
+int LSM_DLL_LOCAL value_to_block_range_list(const Value &brl,
+                                            lsm_block_range **list[],
+                                            uint32_t *count);
+
 /**
  * Converts an array of lsm_block_range to Value
  * @param brl           An array of lsm_block_range
@@ -209,7 +293,16 @@ Value LSM_DLL_LOCAL block_range_list_to_value(lsm_block_range **brl,
  * @param fs        Value representing a FS to be converted
  * @return lsm_fs pointer or NULL on error.
  */
-lsm_fs LSM_DLL_LOCAL *value_to_fs(Value &fs);
+lsm_fs LSM_DLL_LOCAL *value_to_fs(const Value &fs);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  fs       Value to convert
+ * @param[out] out      File system, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_fs(const Value &fs, lsm_fs **out);
 
 /**
  * Converts a lsm_fs pointer to a Value
@@ -218,12 +311,32 @@ lsm_fs LSM_DLL_LOCAL *value_to_fs(Value &fs);
  */
 Value LSM_DLL_LOCAL fs_to_value(lsm_fs *fs);
 
+/**
+ * Converts a vector of file system values to an array.
+ * @param[in] fs_values         Vector of values that represents file systems
+ * @param[out] fs               An array of file system pointers
+ * @param[out] count            Number of file systems
+ * @return LSM_ERR_OK on success, else error reason, see
+ *         value_array_to_pools.
+ */
+int LSM_DLL_LOCAL value_array_to_fs(const Value &fs_values, lsm_fs **fs[],
+                                    uint32_t *count);
+
 /**
  * Converts a value to a lsm_ss *
  * @param ss        Value representing a snapshot to be converted
  * @return lsm_ss pointer or NULL on error.
  */
-lsm_fs_ss LSM_DLL_LOCAL *value_to_ss(Value &ss);
+lsm_fs_ss LSM_DLL_LOCAL *value_to_ss(const Value &ss);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  ss       Value to convert
+ * @param[out] out      Snapshot, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_ss(const Value &ss, lsm_fs_ss **out);
 
 /**
  * Converts a lsm_ss pointer to a Value
@@ -237,7 +350,16 @@ Value LSM_DLL_LOCAL ss_to_value(lsm_fs_ss *ss);
  * @param exp        Value representing a nfs export to be converted
  * @return lsm_nfs_export pointer or NULL on error.
  */
-lsm_nfs_export LSM_DLL_LOCAL *value_to_nfs_export(Value &exp);
+lsm_nfs_export LSM_DLL_LOCAL *value_to_nfs_export(const Value &exp);
+
+/**
+ * Same as above, without throwing.
+ * @param[in]  exp      Value to convert
+ * @param[out] out      NFS export, NULL on error
+ * @return LSM_ERR_OK, LSM_ERR_NO_MEMORY, else LSM_ERR_TRANSPORT_INVALID_ARG
+ *         when it is not one
+ */
+int LSM_DLL_LOCAL value_to_nfs_export(const Value &exp, lsm_nfs_export **out);
 
 /**
  * Converts a lsm_nfs_export pointer to a Value
@@ -246,12 +368,24 @@ lsm_nfs_export LSM_DLL_LOCAL *value_to_nfs_export(Value &exp);
  */
 Value LSM_DLL_LOCAL nfs_export_to_value(lsm_nfs_export *exp);
 
+/**
+ * Converts a vector of NFS export values to an array.
+ * @param[in] export_values     Vector of values that represents NFS exports
+ * @param[out] exports          An array of NFS export pointers
+ * @param[out] count            Number of NFS exports
+ * @return LSM_ERR_OK on success, else error reason, see
+ *         value_array_to_pools.
+ */
+int LSM_DLL_LOCAL value_array_to_nfs_exports(const Value &export_values,
+                                             lsm_nfs_export **exports[],
+                                             uint32_t *count);
+
 /**
  * Converts a Value to a lsm_storage_capabilities
  * @param exp       Value representing a storage capabilities
  * @return lsm_storage_capabilities pointer or NULL on error
  */
-lsm_storage_capabilities LSM_DLL_LOCAL *value_to_capabilities(Value &exp);
+lsm_storage_capabilities LSM_DLL_LOCAL *value_to_capabilities(const Value &exp);
 
 /**
  * Converts a lsm_storage_capabilities to a value
@@ -265,7 +399,7 @@ Value LSM_DLL_LOCAL capabilities_to_value(lsm_storage_capabilities *cap);
  * @param tp    Value to convert to lsm_target_port
  * @return lsm_target_port pointer or NULL on errors
  */
-lsm_target_port LSM_DLL_LOCAL *value_to_target_port(Value &tp);
+lsm_target_port LSM_DLL_LOCAL *value_to_target_port(const Value &tp);
 
 /**
  * Converts a lsm_target_port to a value
@@ -274,10 +408,23 @@ lsm_target_port LSM_DLL_LOCAL *value_to_target_port(Value &tp);
  */
 Value LSM_DLL_LOCAL target_port_to_value(lsm_target_port *tp);
 
+/**
+ * Converts a vector of target port values to an array.
+ * @param[in] tp_values         Vector of values that represents target ports
+ * @param[out] target_ports     An array of target port pointers
+ * @param[out] count            Number of target ports
+ * @return LSM_ERR_OK on success, else error reason, see
+ *         value_array_to_pools.
+ */
+int LSM_DLL_LOCAL value_array_to_target_ports(const Value &tp_values,
+                                              lsm_target_port **target_ports[],
+                                              uint32_t *count);
+
 /**
  * Converts a value to array of uint32.
  */
-int LSM_DLL_LOCAL values_to_uint32_array(Value &value, uint32_t **uint32_array,
+int LSM_DLL_LOCAL values_to_uint32_array(const Value &value,
+                                         uint32_t **uint32_array,
                                          uint32_t *count);
 
 /**
@@ -291,7 +438,7 @@ Value LSM_DLL_LOCAL uint32_array_to_value(uint32_t *uint32_array,
  * @param battery  Value representing a battery
  * @return lsm_battery pointer, else NULL on error
  */
-lsm_battery LSM_DLL_LOCAL *value_to_battery(Value &battery);
+lsm_battery LSM_DLL_LOCAL *value_to_battery(const Value &battery);
 
 /**
  * Converts a lsm_battery to a value
@@ -307,7 +454,115 @@ Value LSM_DLL_LOCAL battery_to_value(lsm_battery *battery);
  * @param[out] count                Number of batteries
  * @return LSM_ERR_OK on success, else error reason.
  */
-int LSM_DLL_LOCAL value_array_to_batteries(Value &battery_values,
+int LSM_DLL_LOCAL value_array_to_batteries(const Value &battery_values,
                                            lsm_battery **bs[], uint32_t *count);
 
+/**
+ * Reads an array of volumes straight out of a response, without building
+ * Values for them first.  A null result reads as no volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] volumes  An array of volume pointers
+ * @param[out] count    Number of volumes
+ * @return LSM_ERR_OK on success, else error reason,
+ *         LSM_ERR_TRANSPORT_INVALID_ARG for a number too big for its
+ *         member.  Malformed records throw ValueException.
+ */
+int LSM_DLL_LOCAL reader_array_to_volumes(PayloadReader &r,
+                                          lsm_volume **volumes[],
+                                          uint32_t *count);
+
+/**
+ * Reads an array of disks straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] disks    An array of disk pointers
+ * @param[out] count    Number of disks
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_disks(PayloadReader &r, lsm_disk **disks[],
+                                        uint32_t *count);
+
+/**
+ * Reads an array of pools straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] pools    An array of pool pointers
+ * @param[out] count    Number of pools
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_pools(PayloadReader &r, lsm_pool **pools[],
+                                        uint32_t *count);
+
+
+/**
+ * Reads an array of systems straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] systems  An array of system pointers
+ * @param[out] count    Number of systems
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_systems(PayloadReader &r,
+                                          lsm_system **systems[],
+                                          uint32_t *count);
+
+/**
+ * Reads an array of access groups straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] groups   An array of access group pointers
+ * @param[out] count    Number of access groups
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_access_groups(PayloadReader &r,
+                                                lsm_access_group **groups[],
+                                                uint32_t *count);
+
+/**
+ * Reads an array of file systems straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] fs       An array of file system pointers
+ * @param[out] count    Number of file systems
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_fs(PayloadReader &r, lsm_fs **fs[],
+                                     uint32_t *count);
+
+/**
+ * Reads an array of NFS exports straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] exports  An array of NFS export pointers
+ * @param[out] count    Number of NFS exports
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_nfs_exports(PayloadReader &r,
+                                              lsm_nfs_export **exports[],
+                                              uint32_t *count);
+
+/**
+ * Reads an array of target ports straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r            Reader positioned at the result
+ * @param[out] target_ports An array of target port pointers
+ * @param[out] count        Number of target ports
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_target_ports(PayloadReader &r,
+                                               lsm_target_port **target_ports[],
+                                               uint32_t *count);
+
+/**
+ * Reads an array of batteries straight out of a response, see
+ * reader_array_to_volumes.
+ * @param[in]  r        Reader positioned at the result
+ * @param[out] bs       An array of battery pointers
+ * @param[out] count    Number of batteries
+ * @return LSM_ERR_OK on success, else error reason.
+ */
+int LSM_DLL_LOCAL reader_array_to_batteries(PayloadReader &r,
+                                            lsm_battery **bs[],
+                                            uint32_t *count);
+
 #endif
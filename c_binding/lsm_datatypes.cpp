@@ -26,6 +26,7 @@
 #include "libstoragemgmt/libstoragemgmt_nfsexport.h"
 #include "libstoragemgmt/libstoragemgmt_plug_interface.h"
 #include "libstoragemgmt/libstoragemgmt_pool.h"
+#include "libstoragemgmt/libstoragemgmt_rpc_stats.h"
 #include "libstoragemgmt/libstoragemgmt_snapshot.h"
 #include "libstoragemgmt/libstoragemgmt_systems.h"
 #include "libstoragemgmt/libstoragemgmt_targetport.h"
@@ -176,20 +177,47 @@ lsm_string_list *lsm_string_list_copy(lsm_string_list *src) {
 lsm_connect *connection_get() {
     lsm_connect *c = (lsm_connect *)calloc(1, sizeof(lsm_connect));
     if (c) {
+        c->lock = new (std::nothrow) std::mutex;
+        c->errors = new (std::nothrow) std::shared_ptr<ThreadErrors>;
+        if (c->errors) {
+            try {
+                c->errors->reset(new ThreadErrors);
+            } catch (const std::bad_alloc &) {
+            }
+        }
+        if (!c->lock || !c->errors || !*c->errors) {
+            delete c->lock;
+            delete c->errors;
+            free(c);
+            return NULL;
+        }
         c->magic = LSM_CONNECT_MAGIC;
     }
     return c;
 }
 
+ResponseCache::ResponseCache() {
+    memset(ttl_ms, 0, sizeof(ttl_ms));
+    memset(hits, 0, sizeof(hits));
+    memset(misses, 0, sizeof(misses));
+    clears = 0;
+}
+
+void ResponseCache::clear() {
+    entries.clear();
+    ++clears;
+}
+
 void connection_free(lsm_connect *c) {
     if (LSM_IS_CONNECT(c)) {
 
         c->magic = LSM_DEL_MAGIC(LSM_CONNECT_MAGIC);
         c->flags = 0;
 
-        if (c->error) {
-            lsm_error_free(c->error);
-            c->error = NULL;
+        if (c->errors) {
+            // The errors go with the last thread to let go of them
+            delete (c->errors);
+            c->errors = NULL;
         }
 
         if (c->tp) {
@@ -197,15 +225,144 @@ void connection_free(lsm_connect *c) {
             c->tp = NULL;
         }
 
+        if (c->submitted) {
+            delete (c->submitted);
+            c->submitted = NULL;
+        }
+
+        if (c->cache) {
+            delete (c->cache);
+            c->cache = NULL;
+        }
+
         if (c->raw_uri) {
             free(c->raw_uri);
             c->raw_uri = NULL;
         }
 
+        delete (c->lock);
+        c->lock = NULL;
+
         free(c);
     }
 }
 
+ThreadErrors::~ThreadErrors() {
+    std::map<std::thread::id, lsm_error *>::iterator i;
+
+    for (i = errors.begin(); i != errors.end(); ++i) {
+        lsm_error_free(i->second);
+    }
+}
+
+/*
+ * Connections the calling thread has left an error on.  When the thread
+ * exits it frees its errors, so they don't pile up on a connection shared
+ * by threads which come and go, nor turn up for a later thread given the
+ * same id.
+ */
+class LSM_DLL_LOCAL ThreadErrorsHeld {
+  public:
+    ~ThreadErrorsHeld() {
+        for (size_t i = 0; i < held.size(); ++i) {
+            std::shared_ptr<ThreadErrors> te = held[i].lock();
+            if (te) {
+                thread_error_drop(*te);
+            }
+        }
+    }
+
+    void add(const std::shared_ptr<ThreadErrors> &te) {
+        size_t kept = 0;
+        bool found = false;
+
+        // Forget the connections which were freed meanwhile
+        for (size_t i = 0; i < held.size(); ++i) {
+            std::shared_ptr<ThreadErrors> h = held[i].lock();
+            if (h) {
+                found = found || h == te;
+                held[kept++] = held[i];
+            }
+        }
+        held.resize(kept);
+
+        if (!found) {
+            held.push_back(te);
+        }
+    }
+
+    static void thread_error_drop(ThreadErrors &te) {
+        lsm_error *e = NULL;
+        {
+            std::lock_guard<std::mutex> guard(te.lock);
+            std::map<std::thread::id, lsm_error *>::iterator i =
+                te.errors.find(std::this_thread::get_id());
+
+            if (i != te.errors.end()) {
+                e = i->second;
+                te.errors.erase(i);
+            }
+        }
+        lsm_error_free(e);
+    }
+
+  private:
+    std::vector<std::weak_ptr<ThreadErrors> > held;
+};
+
+static thread_local ThreadErrorsHeld thread_errors;
+
+void connection_error_set(lsm_connect *c, lsm_error *e) {
+    ThreadErrors &te = **c->errors;
+    lsm_error *old = NULL;
+
+    if (e) {
+        try {
+            thread_errors.add(*c->errors);
+        } catch (const std::bad_alloc &) {
+            // Kept nowhere the thread would free it from
+            lsm_error_free(e);
+            e = NULL;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> held(te.lock);
+        std::map<std::thread::id, lsm_error *>::iterator i =
+            te.errors.find(std::this_thread::get_id());
+
+        if (i != te.errors.end()) {
+            old = i->second;
+            if (e) {
+                i->second = e;
+            } else {
+                te.errors.erase(i);
+            }
+        } else if (e) {
+            try {
+                te.errors[std::this_thread::get_id()] = e;
+            } catch (const std::bad_alloc &) {
+                old = e;
+            }
+        }
+    }
+    lsm_error_free(old);
+}
+
+lsm_error *connection_error_take(lsm_connect *c) {
+    ThreadErrors &te = **c->errors;
+    std::lock_guard<std::mutex> held(te.lock);
+    std::map<std::thread::id, lsm_error *>::iterator i =
+        te.errors.find(std::this_thread::get_id());
+    lsm_error *e = NULL;
+
+    if (i != te.errors.end()) {
+        e = i->second;
+        te.errors.erase(i);
+    }
+    return e;
+}
+
 static int connection_establish(lsm_connect *c, const char *password,
                                 uint32_t timeout, lsm_error_ptr *e,
                                 lsm_flag flags) {
@@ -224,7 +381,7 @@ static int connection_establish(lsm_connect *c, const char *password,
         params["flags"] = Value(flags);
         Value p(params);
 
-        c->tp->rpc("plugin_register", p);
+        c->tp->rpcNegotiate("plugin_register", p);
     } catch (const ValueException &ve) {
         *e = lsm_error_create(LSM_ERR_TRANSPORT_SERIALIZATION,
                               "Error in serialization", ve.what(), NULL, NULL,
@@ -439,6 +596,34 @@ void *lsm_error_debug_data_get(lsm_error_ptr e, uint32_t *size) {
         return error;                                                          \
     }
 
+/* Where the records start, none of their members is bigger than 8 bytes */
+#define SLAB_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+void *lsm_slab_alloc(uint32_t count, size_t record_size, size_t strings_size,
+                     lsm_slab **slab, void **records, char **strings) {
+    size_t at_slab = SLAB_ALIGN(count * sizeof(void *));
+    size_t at_records = SLAB_ALIGN(at_slab + sizeof(lsm_slab));
+    size_t at_strings = at_records + record_size * count;
+    char *base = (char *)malloc(at_strings + strings_size);
+
+    if (base) {
+        *slab = (lsm_slab *)(base + at_slab);
+        (*slab)->begin = base;
+        (*slab)->end = base + at_strings + strings_size;
+        *records = base + at_records;
+        *strings = base + at_strings;
+    }
+    return base;
+}
+
+void lsm_slab_free(const lsm_slab *slab, void *p) {
+    uintptr_t at = (uintptr_t)p;
+
+    if (!slab || at < (uintptr_t)slab->begin || at >= (uintptr_t)slab->end) {
+        free(p);
+    }
+}
+
 CREATE_ALLOC_ARRAY_FUNC(lsm_pool_record_array_alloc, lsm_pool *)
 
 lsm_pool *lsm_pool_record_alloc(const char *id, const char *name,
@@ -491,33 +676,38 @@ lsm_pool *lsm_pool_record_copy(lsm_pool *toBeCopied) {
     return NULL;
 }
 
+int lsm_pool_slab_init(lsm_pool *p, const lsm_slab *slab) {
+    p->slab = slab;
+    return LSM_ERR_OK;
+}
+
 int lsm_pool_record_free(lsm_pool *p) {
     if (LSM_IS_POOL(p)) {
         p->magic = LSM_DEL_MAGIC(LSM_POOL_MAGIC);
         if (p->name) {
-            free(p->name);
+            lsm_slab_free(p->slab, p->name);
             p->name = NULL;
         }
 
         if (p->status_info) {
-            free(p->status_info);
+            lsm_slab_free(p->slab, p->status_info);
             p->status_info = NULL;
         }
 
         if (p->id) {
-            free(p->id);
+            lsm_slab_free(p->slab, p->id);
             p->id = NULL;
         }
 
         if (p->system_id) {
-            free(p->system_id);
+            lsm_slab_free(p->slab, p->system_id);
             p->system_id = NULL;
         }
 
-        free(p->plugin_data);
+        lsm_slab_free(p->slab, p->plugin_data);
         p->plugin_data = NULL;
 
-        free(p);
+        lsm_slab_free(p->slab, p);
         return LSM_ERR_OK;
     }
     return LSM_ERR_INVALID_ARGUMENT;
@@ -596,6 +786,7 @@ lsm_disk *lsm_disk_record_alloc_pd(const char *id, const char *name,
     lsm_disk *rc = (lsm_disk *)malloc(sizeof(lsm_disk));
     if (rc) {
         rc->magic = LSM_DISK_MAGIC;
+        rc->slab = NULL;
         rc->id = strdup(id);
         rc->name = strdup(name);
         rc->type = disk_type;
@@ -760,39 +951,47 @@ lsm_volume *lsm_volume_record_copy(lsm_volume *vol) {
     return rc;
 }
 
+int lsm_volume_slab_init(lsm_volume *v, const lsm_slab *slab) {
+    v->slab = slab;
+    if (v->vpd83 && (LSM_ERR_OK != lsm_volume_vpd83_verify(v->vpd83))) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+    return LSM_ERR_OK;
+}
+
 int lsm_volume_record_free(lsm_volume *v) {
     if (LSM_IS_VOL(v)) {
         v->magic = LSM_DEL_MAGIC(LSM_VOL_MAGIC);
 
         if (v->id) {
-            free(v->id);
+            lsm_slab_free(v->slab, v->id);
             v->id = NULL;
         }
 
         if (v->name) {
-            free(v->name);
+            lsm_slab_free(v->slab, v->name);
             v->name = NULL;
         }
 
         if (v->vpd83) {
-            free(v->vpd83);
+            lsm_slab_free(v->slab, v->vpd83);
             v->vpd83 = NULL;
         }
 
         if (v->system_id) {
-            free(v->system_id);
+            lsm_slab_free(v->slab, v->system_id);
             v->system_id = NULL;
         }
 
         if (v->pool_id) {
-            free(v->pool_id);
+            lsm_slab_free(v->slab, v->pool_id);
             v->pool_id = NULL;
         }
 
-        free(v->plugin_data);
+        lsm_slab_free(v->slab, v->plugin_data);
         v->plugin_data = NULL;
 
-        free(v);
+        lsm_slab_free(v->slab, v);
         return LSM_ERR_OK;
     }
     return LSM_ERR_INVALID_ARGUMENT;
@@ -809,6 +1008,8 @@ lsm_disk *lsm_disk_record_copy(lsm_disk *disk) {
             disk->id, disk->name, disk->type, disk->block_size,
             disk->number_of_blocks, disk->status, disk->system_id,
             disk->plugin_data);
+        if (new_lsm_disk == NULL)
+            return NULL;
         if (disk->vpd83 != NULL)
             if (lsm_disk_vpd83_set(new_lsm_disk, disk->vpd83) != LSM_ERR_OK) {
                 lsm_disk_record_free(new_lsm_disk);
@@ -827,28 +1028,36 @@ lsm_disk *lsm_disk_record_copy(lsm_disk *disk) {
     return NULL;
 }
 
+int lsm_disk_slab_init(lsm_disk *d, const lsm_slab *slab) {
+    d->slab = slab;
+    if (d->location && d->location[0] == '\0') {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+    return LSM_ERR_OK;
+}
+
 int lsm_disk_record_free(lsm_disk *d) {
     if (LSM_IS_DISK(d)) {
         d->magic = LSM_DEL_MAGIC(LSM_DISK_MAGIC);
 
-        free(d->id);
+        lsm_slab_free(d->slab, d->id);
         d->id = NULL;
 
-        free(d->name);
+        lsm_slab_free(d->slab, d->name);
         d->name = NULL;
 
-        free(d->system_id);
+        lsm_slab_free(d->slab, d->system_id);
         d->system_id = NULL;
 
-        free(d->plugin_data);
+        lsm_slab_free(d->slab, d->plugin_data);
         d->plugin_data = NULL;
 
-        free(d->vpd83);
+        lsm_slab_free(d->slab, d->vpd83);
         d->vpd83 = NULL;
 
-        free((char *)d->location);
+        lsm_slab_free(d->slab, (char *)d->location);
 
-        free(d);
+        lsm_slab_free(d->slab, d);
         return LSM_ERR_OK;
     }
     return LSM_ERR_INVALID_ARGUMENT;
@@ -899,7 +1108,7 @@ int lsm_disk_location_set(lsm_disk *disk, const char *location) {
     if ((disk == NULL) || (location == NULL) || (location[0] == '\0'))
         return LSM_ERR_INVALID_ARGUMENT;
 
-    free((char *)disk->location);
+    lsm_slab_free(disk->slab, (char *)disk->location);
     disk->location = strdup(location);
     if (disk->location == NULL)
         return LSM_ERR_NO_MEMORY;
@@ -926,7 +1135,7 @@ int lsm_disk_vpd83_set(lsm_disk *disk, const char *vpd83) {
     if ((disk == NULL) || (!LSM_IS_DISK(disk)) || (vpd83 == NULL))
         return LSM_ERR_INVALID_ARGUMENT;
 
-    free(disk->vpd83);
+    lsm_slab_free(disk->slab, disk->vpd83);
 
     disk->vpd83 = strdup(vpd83);
     if (disk->vpd83 == NULL)
@@ -955,27 +1164,38 @@ int lsm_disk_link_type_set(lsm_disk *disk, lsm_disk_link_type link_type) {
 
 CREATE_ALLOC_ARRAY_FUNC(lsm_access_group_record_array_alloc, lsm_access_group *)
 
-static lsm_string_list *standardize_init_list(lsm_string_list *initiators) {
+/**
+ * Switches the wwpns in a list of initiators to their internal
+ * representation, in place.
+ * @return LSM_ERR_OK on success, else error code
+ */
+static int init_list_standardize(lsm_string_list *initiators) {
     uint32_t i = 0;
-    lsm_string_list *rc = lsm_string_list_copy(initiators);
     char *wwpn = NULL;
 
-    if (rc) {
-        for (i = 0; i < lsm_string_list_size(rc); ++i) {
-            if (LSM_ERR_OK == wwpn_validate(lsm_string_list_elem_get(rc, i))) {
-                /* We have a wwpn, switch to internal representation */
-                wwpn = wwpn_convert(lsm_string_list_elem_get(rc, i));
-                if (!wwpn ||
-                    LSM_ERR_OK != lsm_string_list_elem_set(rc, i, wwpn)) {
-                    free(wwpn);
-                    lsm_string_list_free(rc);
-                    rc = NULL;
-                    break;
-                }
+    for (i = 0; i < lsm_string_list_size(initiators); ++i) {
+        if (LSM_ERR_OK ==
+            wwpn_validate(lsm_string_list_elem_get(initiators, i))) {
+            /* We have a wwpn, switch to internal representation */
+            wwpn = wwpn_convert(lsm_string_list_elem_get(initiators, i));
+            if (!wwpn ||
+                LSM_ERR_OK != lsm_string_list_elem_set(initiators, i, wwpn)) {
                 free(wwpn);
+                return LSM_ERR_NO_MEMORY;
             }
+            free(wwpn);
         }
     }
+    return LSM_ERR_OK;
+}
+
+static lsm_string_list *standardize_init_list(lsm_string_list *initiators) {
+    lsm_string_list *rc = lsm_string_list_copy(initiators);
+
+    if (rc && LSM_ERR_OK != init_list_standardize(rc)) {
+        lsm_string_list_free(rc);
+        rc = NULL;
+    }
 
     return rc;
 }
@@ -990,6 +1210,7 @@ lsm_access_group_record_alloc(const char *id, const char *name,
         rc = (lsm_access_group *)malloc(sizeof(lsm_access_group));
         if (rc) {
             rc->magic = LSM_ACCESS_GROUP_MAGIC;
+            rc->slab = NULL;
             rc->id = strdup(id);
             rc->name = strdup(name);
             rc->system_id = strdup(system_id);
@@ -1023,15 +1244,23 @@ lsm_access_group *lsm_access_group_record_copy(lsm_access_group *ag) {
     return rc;
 }
 
+int lsm_access_group_slab_init(lsm_access_group *ag, const lsm_slab *slab) {
+    ag->slab = slab;
+    if (ag->initiators) {
+        return init_list_standardize(ag->initiators);
+    }
+    return LSM_ERR_OK;
+}
+
 int lsm_access_group_record_free(lsm_access_group *ag) {
     if (LSM_IS_ACCESS_GROUP(ag)) {
         ag->magic = LSM_DEL_MAGIC(LSM_ACCESS_GROUP_MAGIC);
-        free(ag->id);
-        free(ag->name);
-        free(ag->system_id);
+        lsm_slab_free(ag->slab, ag->id);
+        lsm_slab_free(ag->slab, ag->name);
+        lsm_slab_free(ag->slab, ag->system_id);
         lsm_string_list_free(ag->initiators);
-        free(ag->plugin_data);
-        free(ag);
+        lsm_slab_free(ag->slab, ag->plugin_data);
+        lsm_slab_free(ag->slab, ag);
         return LSM_ERR_OK;
     }
     return LSM_ERR_INVALID_ARGUMENT;
@@ -1070,9 +1299,7 @@ void lsm_access_group_initiator_id_set(lsm_access_group *group,
 
 lsm_error_ptr lsm_error_last_get(lsm_connect *c) {
     if (LSM_IS_CONNECT(c)) {
-        lsm_error_ptr e = c->error;
-        c->error = NULL;
-        return e;
+        return connection_error_take(c);
     }
     return NULL;
 }
@@ -1148,15 +1375,20 @@ lsm_fs *lsm_fs_record_alloc(const char *id, const char *name,
     return rc;
 }
 
+int lsm_fs_slab_init(lsm_fs *fs, const lsm_slab *slab) {
+    fs->slab = slab;
+    return LSM_ERR_OK;
+}
+
 int lsm_fs_record_free(lsm_fs *fs) {
     if (LSM_IS_FS(fs)) {
         fs->magic = LSM_DEL_MAGIC(LSM_FS_MAGIC);
-        free(fs->id);
-        free(fs->name);
-        free(fs->pool_id);
-        free(fs->system_id);
-        free(fs->plugin_data);
-        free(fs);
+        lsm_slab_free(fs->slab, fs->id);
+        lsm_slab_free(fs->slab, fs->name);
+        lsm_slab_free(fs->slab, fs->pool_id);
+        lsm_slab_free(fs->slab, fs->system_id);
+        lsm_slab_free(fs->slab, fs->plugin_data);
+        lsm_slab_free(fs->slab, fs);
         return LSM_ERR_OK;
     }
     return LSM_ERR_INVALID_ARGUMENT;
@@ -1856,6 +2088,67 @@ MEMBER_FUNC_GET(uint64_t, lsm_battery, LSM_IS_BATTERY, status,
 MEMBER_FUNC_GET(lsm_battery_type, lsm_battery, LSM_IS_BATTERY, type,
                 LSM_BATTERY_TYPE_UNKNOWN);
 
+CREATE_ALLOC_ARRAY_FUNC(lsm_rpc_stats_record_array_alloc, lsm_rpc_stats *);
+
+lsm_rpc_stats *lsm_rpc_stats_record_alloc(const char *method,
+                                          const RpcStats &stats) {
+    lsm_rpc_stats *rc = NULL;
+
+    if (method == NULL)
+        return NULL;
+
+    rc = (lsm_rpc_stats *)malloc(sizeof(lsm_rpc_stats));
+    if (rc != NULL) {
+        rc->magic = LSM_RPC_STATS_MAGIC;
+        rc->method = strdup(method);
+        rc->calls = stats.calls;
+        rc->errors = stats.errors;
+        rc->bytes_sent = stats.bytes_sent;
+        rc->bytes_received = stats.bytes_received;
+        rc->serialize_ns = stats.serialize_ns;
+        rc->transport_ns = stats.transport_ns;
+        rc->deserialize_ns = stats.deserialize_ns;
+        memcpy(rc->histogram, stats.histogram, sizeof(rc->histogram));
+
+        if (rc->method == NULL) {
+            lsm_rpc_stats_record_free(rc);
+            return NULL;
+        }
+    }
+    return rc;
+}
+
+int lsm_rpc_stats_record_free(lsm_rpc_stats *s) {
+    if (LSM_IS_RPC_STATS(s)) {
+        s->magic = LSM_DEL_MAGIC(LSM_RPC_STATS_MAGIC);
+        free(s->method);
+        s->method = NULL;
+        free(s);
+        return LSM_ERR_OK;
+    }
+    return LSM_ERR_INVALID_ARGUMENT;
+}
+
+CREATE_FREE_ARRAY_FUNC(lsm_rpc_stats_record_array_free,
+                       lsm_rpc_stats_record_free, lsm_rpc_stats *,
+                       LSM_ERR_INVALID_ARGUMENT);
+
+MEMBER_FUNC_GET(const char *, lsm_rpc_stats, LSM_IS_RPC_STATS, method, NULL);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, calls, 0);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, errors, 0);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, bytes_sent, 0);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, bytes_received, 0);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, serialize_ns, 0);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, transport_ns, 0);
+MEMBER_FUNC_GET(uint64_t, lsm_rpc_stats, LSM_IS_RPC_STATS, deserialize_ns, 0);
+
+uint64_t lsm_rpc_stats_histogram_get(lsm_rpc_stats *s, uint32_t bucket) {
+    if (LSM_IS_RPC_STATS(s) && bucket < LSM_RPC_STATS_HISTOGRAM_BUCKETS) {
+        return s->histogram[bucket];
+    }
+    return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,9 @@
 #include "libstoragemgmt/libstoragemgmt_plug_interface.h"
 #include "lsm_ipc.hpp"
 #include <glib.h>
+#include <memory>
+#include <mutex>
+#include <thread>
 #ifdef HAVE_LEDMON
 #include <led/libled.h>
 #endif
@@ -48,11 +51,25 @@ extern "C" {
 #define LSM_FLAG_UNUSED_CHECK(x)  (x != 0)
 #define LSM_FLAG_GET_VALUE(x)     x["flags"].asUint64_t()
 #define LSM_FLAG_EXPECTED_TYPE(x) (Value::numeric_t == x["flags"].valueType())
+
+/**
+ * One allocation holding the array of a list result, the records it points
+ * at and their strings, see lsm_slab_alloc.  The array comes first, so
+ * freeing the array frees all of it.  Records in a slab point back at it,
+ * and only memory outside of it is freed along with them.
+ */
+struct _lsm_slab {
+    const char *begin; /**< First byte of the slab */
+    const char *end;   /**< One past the last byte of the slab */
+};
+typedef struct _lsm_slab lsm_slab;
+
 /**
  * Information about storage volumes.
  */
 struct LSM_DLL_LOCAL _lsm_volume {
     uint32_t magic;
+    const lsm_slab *slab;      /**< Slab the record is in, else NULL */
     char *id;                  /**< System wide unique identifier */
     char *name;                /**< Human recognizeable name */
     char *vpd83;               /**< SCSI page 83 unique ID */
@@ -72,6 +89,7 @@ struct LSM_DLL_LOCAL _lsm_volume {
  */
 struct LSM_DLL_LOCAL _lsm_pool {
     uint32_t magic;               /**< Used for verfication */
+    const lsm_slab *slab;         /**< Slab the record is in, else NULL */
     char *id;                     /**< System wide unique identifier */
     char *name;                   /**< Human recognizeable name */
     uint64_t element_type;        /**< What the pool can be used for */
@@ -91,10 +109,11 @@ struct LSM_DLL_LOCAL _lsm_pool {
  * Information pertaining to a storage group.
  */
 struct _lsm_access_group {
-    uint32_t magic;  /**< Used for verification */
-    char *id;        /**< Id */
-    char *name;      /**< Name */
-    char *system_id; /**< System id */
+    uint32_t magic;       /**< Used for verification */
+    const lsm_slab *slab; /**< Slab the record is in, else NULL */
+    char *id;             /**< Id */
+    char *name;           /**< Name */
+    char *system_id;      /**< System id */
     lsm_access_group_init_type init_type;
     /**< Init type */
     lsm_string_list *initiators;
@@ -192,6 +211,21 @@ struct LSM_DLL_LOCAL _lsm_plugin {
     struct lsm_fs_ops_v1 *fs_ops;     /**< Callbacks for fs ops */
     struct lsm_ops_v1_2 *ops_v1_2;    /**< Callbacks for v1.2 ops */
     struct lsm_ops_v1_3 *ops_v1_3;    /**< Callbacks for v1.3 ops */
+    struct lsm_ops_v1_11 *ops_v1_11;  /**< Callbacks for v1.11 ops */
+    uint32_t stream_id;               /**< Id of request being answered */
+    uint32_t stream_chunk;            /**< Records per part, 0 for all */
+};
+
+/**
+ * Error information of each thread making calls on a connection.  The
+ * threads which left one hold on to it too, so a thread which exits frees
+ * its error however long the connection lives on.
+ */
+struct LSM_DLL_LOCAL ThreadErrors {
+    std::mutex lock; /**< Guards errors */
+    std::map<std::thread::id, lsm_error *> errors;
+
+    ~ThreadErrors();
 };
 
 /**
@@ -202,8 +236,87 @@ struct LSM_DLL_LOCAL _lsm_connect {
     uint32_t magic;   /**< Magic, used for structure validation */
     uint32_t flags;   /**< Flags for the connection */
     char *raw_uri;    /**< Raw URI string */
-    lsm_error *error; /**< Error information */
-    Ipc *tp;          /**< IPC transport */
+    std::mutex *lock; /**< Guards submitted and cache */
+    std::shared_ptr<ThreadErrors> *errors;
+    /**< Error information of each thread making calls */
+    Ipc *tp; /**< IPC transport */
+    std::map<uint32_t, lsm_rpc_method> *submitted;
+    /**< Outstanding lsm_rpc_submit requests */
+    struct ResponseCache *cache; /**< Set once caching is turned on */
+};
+
+#define LSM_CACHE_CLASS_COUNT (LSM_CACHE_CAPABILITIES + 1)
+
+/**
+ * Responses to the reads clients make before nearly every operation, kept
+ * for as long as lsm_connect_cache_ttl_set asked for.
+ */
+struct LSM_DLL_LOCAL ResponseCache {
+    struct Entry {
+        Value response;
+        uint64_t expires; // CLOCK_MONOTONIC ms
+    };
+
+    uint32_t ttl_ms[LSM_CACHE_CLASS_COUNT]; // 0 when not cached
+    uint64_t hits[LSM_CACHE_CLASS_COUNT];
+    uint64_t misses[LSM_CACHE_CLASS_COUNT];
+    std::map<std::string, Entry> entries; // By method and parameters
+    uint64_t clears; // Responses read across a clear aren't kept
+
+    ResponseCache();
+
+    /**
+     * Drops every response kept.
+     */
+    void clear();
+};
+
+#define LSM_LIST_ITER_MAGIC   0xAA7A0017
+#define LSM_IS_LIST_ITER(obj) MAGIC_CHECK(obj, LSM_LIST_ITER_MAGIC)
+
+/**
+ * A listing which is read a part at a time as the plug-in sends it.
+ */
+struct LSM_DLL_LOCAL _lsm_list_iter {
+    uint32_t magic;            /**< Magic, used for structure validation */
+    lsm_connect *conn;         /**< Connection the listing is read from */
+    uint32_t rpc_id;           /**< Id of the listing request */
+    lsm_rpc_method method;     /**< What is being listed */
+    Value *chunk;              /**< Array of records being handed out */
+    uint32_t next;             /**< Next record of chunk to hand out */
+    int done;                  /**< Set once the last part has been read */
+};
+
+#define LSM_BATCH_MAGIC   0xAA7A0019
+#define LSM_IS_BATCH(obj) MAGIC_CHECK(obj, LSM_BATCH_MAGIC)
+
+/**
+ * Calls collected to be sent to the plug-in in one request.
+ */
+struct LSM_DLL_LOCAL _lsm_batch {
+    uint32_t magic;              /**< Magic, used for structure validation */
+    lsm_connect *conn;           /**< Connection the calls are made on */
+    std::vector<Value> *calls;   /**< Method and params of each call */
+    std::vector<Value> *results; /**< Result or error of each call run */
+};
+
+#define LSM_RPC_STATS_MAGIC   0xAA7A0018
+#define LSM_IS_RPC_STATS(obj) MAGIC_CHECK(obj, LSM_RPC_STATS_MAGIC)
+
+/**
+ * Copy of the statistics of one method, handed out to the client.
+ */
+struct LSM_DLL_LOCAL _lsm_rpc_stats {
+    uint32_t magic; /**< Magic, used for structure validation */
+    char *method;   /**< Method name */
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t serialize_ns;
+    uint64_t transport_ns;
+    uint64_t deserialize_ns;
+    uint64_t histogram[LSM_RPC_STATS_HISTOGRAM_BUCKETS];
 };
 
 #define LSM_ERROR_MAGIC   0xAA7A000C
@@ -241,6 +354,7 @@ struct LSM_DLL_LOCAL _lsm_string_list {
 #define LSM_IS_FS(obj) MAGIC_CHECK(obj, LSM_FS_MAGIC)
 struct LSM_DLL_LOCAL _lsm_fs {
     uint32_t magic;       /**< Magic, used for struct validation */
+    const lsm_slab *slab; /**< Slab the record is in, else NULL */
     char *id;             /**< Id */
     char *name;           /**< Name */
     char *pool_id;        /**< Pool ID */
@@ -264,6 +378,7 @@ struct LSM_DLL_LOCAL _lsm_fs_ss {
 #define LSM_IS_DISK(obj) MAGIC_CHECK(obj, LSM_DISK_MAGIC)
 struct LSM_DLL_LOCAL _lsm_disk {
     uint32_t magic;
+    const lsm_slab *slab; /**< Slab the record is in, else NULL */
     char *id;
     char *name;
     lsm_disk_type type;
@@ -357,6 +472,20 @@ lsm_connect LSM_DLL_LOCAL *connection_get();
  */
 void LSM_DLL_LOCAL connection_free(lsm_connect *c);
 
+/**
+ * Sets the error of the calling thread, freeing the one it had.
+ * @param c     Connection
+ * @param e     Error to keep, NULL to clear
+ */
+void LSM_DLL_LOCAL connection_error_set(lsm_connect *c, lsm_error *e);
+
+/**
+ * Takes the error of the calling thread off the connection.
+ * @param c     Connection
+ * @return NULL if the thread has none, else the error for the caller to free.
+ */
+lsm_error LSM_DLL_LOCAL *connection_error_take(lsm_connect *c);
+
 /**
  * Loads the requester driver specified in the uri.
  * @param c             Connection
@@ -372,6 +501,71 @@ int LSM_DLL_LOCAL driver_load(lsm_connect *c, const char *plugin,
                               const char *password, uint32_t timeout,
                               lsm_error_ptr *e, int startup, lsm_flag flags);
 
+/**
+ * Allocates an array of statistics records.
+ * @param size      Number of elements
+ * @return NULL on memory exhaustion, else new array.
+ */
+lsm_rpc_stats LSM_DLL_LOCAL **lsm_rpc_stats_record_array_alloc(uint32_t size);
+
+/**
+ * Copies the statistics of one method into a new record.
+ * @param method    Method name
+ * @param stats     Statistics kept by Ipc
+ * @return NULL on memory exhaustion, else new record.
+ */
+lsm_rpc_stats LSM_DLL_LOCAL *lsm_rpc_stats_record_alloc(const char *method,
+                                                        const RpcStats &stats);
+
+/**
+ * Allocates a slab for a list result: an array of count record pointers,
+ * count records of record_size bytes and strings_size bytes of strings.
+ * Records and strings are left for the caller to fill in.
+ * @param[in]   count           Number of records
+ * @param[in]   record_size     Size of a record
+ * @param[in]   strings_size    Bytes needed for all the strings
+ * @param[out]  slab            Slab, for the records to point at
+ * @param[out]  records         Space for the records
+ * @param[out]  strings         Space for the strings
+ * @return NULL on memory exhaustion, else the array of record pointers
+ */
+void LSM_DLL_LOCAL *lsm_slab_alloc(uint32_t count, size_t record_size,
+                                   size_t strings_size, lsm_slab **slab,
+                                   void **records, char **strings);
+
+/**
+ * Frees p, unless it is in slab.
+ * @param slab      Slab of the record p belongs to, may be NULL
+ * @param p         Memory to free, may be NULL
+ */
+void LSM_DLL_LOCAL lsm_slab_free(const lsm_slab *slab, void *p);
+
+/**
+ * Makes a record filled in by the caller in a slab valid, checking it the
+ * same way lsm_volume_record_alloc does.
+ * @param v         Record in the slab
+ * @param slab      Slab
+ * @return LSM_ERR_OK on success, else error code.  The record has to be
+ *         freed either way.
+ */
+int LSM_DLL_LOCAL lsm_volume_slab_init(lsm_volume *v, const lsm_slab *slab);
+
+/** As lsm_volume_slab_init, for disks */
+int LSM_DLL_LOCAL lsm_disk_slab_init(lsm_disk *d, const lsm_slab *slab);
+
+/** As lsm_volume_slab_init, for pools */
+int LSM_DLL_LOCAL lsm_pool_slab_init(lsm_pool *p, const lsm_slab *slab);
+
+/** As lsm_volume_slab_init, for file systems */
+int LSM_DLL_LOCAL lsm_fs_slab_init(lsm_fs *fs, const lsm_slab *slab);
+
+/**
+ * As lsm_volume_slab_init, for access groups.  The list of initiators is
+ * not in the slab, it is replaced by a standardized copy.
+ */
+int LSM_DLL_LOCAL lsm_access_group_slab_init(lsm_access_group *ag,
+                                             const lsm_slab *slab);
+
 char LSM_DLL_LOCAL *capability_string(lsm_storage_capabilities *c);
 
 const char LSM_DLL_LOCAL *uds_path(void);
@@ -12,114 +12,401 @@
 
 #include <algorithm>
 #include <errno.h>
-#include <iomanip>
 #include <iostream>
 #include <limits.h>
+#include <stdlib.h>
 #include <list>
 #include <sstream>
 #include <stdio.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
-#include "lsm_value_jsmn.hpp"
-
-static std::string zero_pad_num(unsigned int num) {
-    std::ostringstream ss;
-    ss << std::setw(Transport::HDR_LEN) << std::setfill('0') << num;
-    return ss.str();
-}
+#include "lsm_value_json.hpp"
+#include "lsm_value_msgpack.hpp"
 
 Transport::Transport() : s(-1) {}
 
 Transport::Transport(int socket_desc) : s(socket_desc) {}
 
-int Transport::msg_send(const std::string &msg, int &error_code) {
+/**
+ * Writes msg to a new memfd and seals it, so the receiver can map it without
+ * having to worry about it changing underneath.
+ * @return memfd, else -1 with error_code set
+ */
+static int memfd_fill(const std::string &msg, int &error_code) {
+#if defined(HAVE_MEMFD_CREATE) && defined(F_ADD_SEALS)
+    int fd = memfd_create("lsm_ipc", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    size_t written = 0;
+
+    if (fd == -1) {
+        error_code = errno;
+        return -1;
+    }
+
+    while (written < msg.size()) {
+        ssize_t wrote = write(fd, msg.data() + written, msg.size() - written);
+        if (wrote > 0) {
+            written += wrote;
+        } else if (wrote == -1 && errno == EINTR) {
+            continue;
+        } else {
+            error_code = (wrote == -1) ? errno : EIO;
+            ::close(fd);
+            return -1;
+        }
+    }
+
+    if (fcntl(fd, F_ADD_SEALS,
+              F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)) {
+        error_code = errno;
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    (void)msg;
+    error_code = ENOSYS;
+    return -1;
+#endif
+}
+
+/**
+ * Sends the header followed by msg, or only the header with memfd attached
+ * when msg is NULL.
+ */
+int Transport::hdr_send(const char *hdr, const std::string *msg, int memfd,
+                        int &error_code) {
+    struct iovec iov[2];
+    struct msghdr mh;
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+    size_t written = 0;
+    size_t msg_size = HDR_LEN;
+
+    // Header and payload go out together, the payload is never copied.
+    iov[0].iov_base = (void *)hdr;
+    iov[0].iov_len = HDR_LEN;
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = iov;
+    mh.msg_iovlen = 1;
+
+    if (msg) {
+        iov[1].iov_base = (void *)msg->data();
+        iov[1].iov_len = msg->size();
+        mh.msg_iovlen = 2;
+        msg_size += msg->size();
+    }
+
+    if (memfd >= 0) {
+        memset(&ctl, 0, sizeof(ctl));
+        mh.msg_control = ctl.buf;
+        mh.msg_controllen = sizeof(ctl.buf);
+
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cm), &memfd, sizeof(int));
+    }
+
+    while (written < msg_size) {
+        ssize_t wrote = sendmsg(s, &mh, MSG_NOSIGNAL); // No SIGPIPE
+        if (wrote > 0) {
+            written += wrote;
+
+            // The descriptor went with the first part
+            mh.msg_control = NULL;
+            mh.msg_controllen = 0;
+
+            // Advance past what the kernel took on a short write
+            size_t consumed = (size_t)wrote;
+            while (mh.msg_iovlen && consumed >= mh.msg_iov->iov_len) {
+                consumed -= mh.msg_iov->iov_len;
+                mh.msg_iov++;
+                mh.msg_iovlen--;
+            }
+            if (mh.msg_iovlen) {
+                mh.msg_iov->iov_base = (char *)mh.msg_iov->iov_base + consumed;
+                mh.msg_iov->iov_len -= consumed;
+            }
+        } else if (wrote == -1 && errno == EINTR) {
+            continue;
+        } else {
+            error_code = (wrote == -1) ? errno : EIO;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int Transport::msg_send(const std::string &msg, int &error_code, bool memfd) {
     int rc = -1;
     error_code = 0;
 
     if (msg.size() > 0) {
-        ssize_t written = 0;
+        char hdr[HDR_LEN + 1];
+
         // fprintf(stderr, ">>> %s\n", msg.c_str());
-        std::string data = zero_pad_num(msg.size()) + msg;
-        ssize_t msg_size = data.size();
-
-        while (written < msg_size) {
-            ssize_t wrote =
-                send(s, data.c_str() + written, (msg_size - written),
-                     MSG_NOSIGNAL); // Prevent SIGPIPE on write
-            if (wrote != -1) {
-                ssize_t t = written;
-                if (__builtin_add_overflow(t, wrote, &written)) {
-                    error_code = EOVERFLOW;
-                    break;
-                }
-            } else {
-                error_code = errno;
-                break;
-            }
+        if (msg.size() >= 0x80000000) {
+            error_code = EOVERFLOW;
+            return rc;
         }
 
-        if ((written == msg_size) && error_code == 0) {
-            rc = 0;
+        if (memfd) {
+            int ec = 0;
+            int fd = memfd_fill(msg, ec);
+            if (fd >= 0) {
+                // A length of zero says the payload is in the memfd
+                snprintf(hdr, sizeof(hdr), "%0*d", HDR_LEN, 0);
+                rc = hdr_send(hdr, NULL, fd, error_code);
+                ::close(fd);
+                return rc;
+            }
         }
+
+        snprintf(hdr, sizeof(hdr), "%0*zu", HDR_LEN, msg.size());
+        rc = hdr_send(hdr, &msg, -1, error_code);
     }
     return rc;
 }
 
-static std::string string_read(int fd, ssize_t count, int &error_code) {
-    char buff[4096];
-    ssize_t amount_read = 0;
-    std::string rc = "";
+/**
+ * recv() which also collects the memfds the other side passed along.
+ */
+ssize_t Transport::sock_recv(char *buff, size_t count, int flags) {
+    struct iovec iov;
+    struct msghdr mh;
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * 4)];
+        struct cmsghdr align;
+    } ctl;
+
+    iov.iov_base = buff;
+    iov.iov_len = count;
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = ctl.buf;
+    mh.msg_controllen = sizeof(ctl.buf);
+
+    ssize_t rd = recvmsg(s, &mh, flags | MSG_CMSG_CLOEXEC);
+
+    if (rd > 0 && mh.msg_controllen) {
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&mh); cm;
+             cm = CMSG_NXTHDR(&mh, cm)) {
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+                size_t n = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (size_t i = 0; i < n; ++i) {
+                    int fd = -1;
+                    memcpy(&fd, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+                    rfds.push_back(fd);
+                }
+            }
+        }
+    }
+    return rd;
+}
+
+/**
+ * Reads exactly count bytes into buff.
+ * @return 0 on success, else -1 with error_code set (0 on EOF)
+ */
+int Transport::buffer_read(char *buff, size_t count, int &error_code) {
+    size_t amount_read = 0;
 
     error_code = 0;
 
     while (amount_read < count) {
-        ssize_t rd = recv(
-            fd, buff, std::min((ssize_t)(sizeof(buff)), (count - amount_read)),
-            MSG_WAITALL);
+        ssize_t rd =
+            sock_recv(buff + amount_read, count - amount_read, MSG_WAITALL);
         if (rd > 0) {
-            ssize_t t = amount_read;
-            if (__builtin_add_overflow(t, rd, &amount_read)) {
-                error_code = EOVERFLOW;
-                break;
-            }
-            rc += std::string(buff, rd);
+            amount_read += rd;
+        } else if (rd == -1 && errno == EINTR) {
+            continue;
         } else {
-            error_code = errno;
-            break;
+            error_code = (rd == -1) ? errno : 0;
+            return -1;
         }
     }
+    return 0;
+}
+
+/**
+ * Same as buffer_read, but hands out what msg_poll has buffered first.
+ */
+int Transport::buffered_read(char *buff, size_t count, int &error_code) {
+    size_t have = std::min(count, rbuf.size());
+
+    if (have) {
+        memcpy(buff, rbuf.data(), have);
+        rbuf.erase(0, have);
+    }
+    return buffer_read(buff + have, count - have, error_code);
+}
 
-    if ((amount_read == count) && (error_code == 0))
+/**
+ * Maps the next memfd received and copies the payload out of it.
+ * @return 0 on success, else -1 with error_code set
+ */
+int Transport::memfd_read(std::string &msg, int &error_code) {
+    struct stat st;
+    int rc = -1;
+
+    if (rfds.empty()) {
+        error_code = EBADMSG;
         return rc;
-    else
-        throw EOFException("");
+    }
+
+    int fd = rfds.front();
+    rfds.pop_front();
+
+#ifdef F_GET_SEALS
+    // Make sure it can't be truncated while we have it mapped
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals == -1 || (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) !=
+                           (F_SEAL_SHRINK | F_SEAL_WRITE)) {
+        ::close(fd);
+        error_code = EBADMSG;
+        return rc;
+    }
+#endif
+
+    if (fstat(fd, &st) == -1) {
+        error_code = errno;
+    } else if (st.st_size <= 0 || st.st_size >= 0x80000000) {
+        error_code = EOVERFLOW;
+    } else {
+        void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE,
+                       fd, 0);
+        if (m == MAP_FAILED) {
+            error_code = errno;
+        } else {
+            msg.assign((const char *)m, st.st_size);
+            munmap(m, st.st_size);
+            rc = 0;
+        }
+    }
+
+    ::close(fd);
+    return rc;
 }
 
 std::string Transport::msg_recv(int &error_code) {
     std::string msg;
-    error_code = 0;
+    msg_recv(msg, error_code);
+    return msg;
+}
+
+void Transport::msg_recv(std::string &msg, int &error_code) {
+    char hdr[HDR_LEN + 1];
     unsigned long int payload_len = 0;
-    std::string len = string_read(s, HDR_LEN, error_code); // Read the length
-    if (len.size() && error_code == 0) {
-        payload_len = strtoul(len.c_str(), NULL, 10);
-        if (payload_len < 0x80000000) { /* Should be big enough */
-            ssize_t len = payload_len;
-            msg = string_read(s, len, error_code);
+
+    error_code = 0;
+    msg.clear();
+
+    // Read the length
+    if (buffered_read(hdr, HDR_LEN, error_code) != 0) {
+        throw EOFException("");
+    }
+    hdr[HDR_LEN] = '\0';
+
+    payload_len = strtoul(hdr, NULL, 10);
+    if (payload_len == 0) {
+        // The payload was passed in a memfd
+        if (memfd_read(msg, error_code) != 0) {
+            msg.clear();
+        }
+    } else if (payload_len < 0x80000000) { /* Should be big enough */
+        // Size the buffer once and receive straight into it
+        msg.resize(payload_len);
+        if (buffered_read(&msg[0], payload_len, error_code) != 0) {
+            throw EOFException("");
+        }
+    } else {
+        error_code = EOVERFLOW;
+    }
+    // fprintf(stderr, "<<< %s\n", msg.c_str());
+}
+
+bool Transport::msg_poll(std::string &msg, int &error_code) {
+    const size_t chunk = 64 * 1024;
+    bool eof = false;
+
+    error_code = 0;
+
+    for (;;) {
+        size_t have = rbuf.size();
+        rbuf.resize(have + chunk);
+
+        ssize_t rd = sock_recv(&rbuf[have], chunk, MSG_DONTWAIT);
+        rbuf.resize(have + ((rd > 0) ? rd : 0));
+
+        if (rd > 0) {
+            if ((size_t)rd < chunk) {
+                break;
+            }
+        } else if (rd == 0) {
+            eof = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
         } else {
+            error_code = errno;
+            return false;
+        }
+    }
+
+    if (rbuf.size() >= (size_t)HDR_LEN) {
+        char hdr[HDR_LEN + 1];
+
+        memcpy(hdr, rbuf.data(), HDR_LEN);
+        hdr[HDR_LEN] = '\0';
+
+        unsigned long int payload_len = strtoul(hdr, NULL, 10);
+        if (payload_len >= 0x80000000) {
             error_code = EOVERFLOW;
+            return false;
+        }
+
+        if (payload_len == 0) {
+            // The payload was passed in a memfd
+            rbuf.erase(0, HDR_LEN);
+            return memfd_read(msg, error_code) == 0;
+        }
+
+        if (rbuf.size() >= HDR_LEN + payload_len) {
+            msg.assign(rbuf, HDR_LEN, payload_len);
+            rbuf.erase(0, HDR_LEN + payload_len);
+            return true;
         }
-        // fprintf(stderr, "<<< %s\n", msg.c_str());
+        rbuf.reserve(HDR_LEN + payload_len);
     }
-    return msg;
+
+    if (eof) {
+        throw EOFException("");
+    }
+    return false;
 }
 
+int Transport::fd_get() const { return s; }
+
 int Transport::socket_get(const std::string &path, int &error_code) {
     int sfd = socket(AF_UNIX, SOCK_STREAM, 0);
     int rc = -1;
@@ -145,9 +432,55 @@ int Transport::socket_get(const std::string &path, int &error_code) {
     return rc;
 }
 
+int Transport::fd_recv(int sock, int &error_code) {
+    char byte = 0;
+    struct iovec iov;
+    struct msghdr mh;
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+    ssize_t rd = 0;
+    int fd = -1;
+
+    error_code = 0;
+
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = ctl.buf;
+    mh.msg_controllen = sizeof(ctl.buf);
+
+    do {
+        rd = recvmsg(sock, &mh, MSG_CMSG_CLOEXEC);
+    } while (rd == -1 && errno == EINTR);
+
+    if (rd <= 0) {
+        error_code = (rd == -1) ? errno : 0;
+        return -1;
+    }
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS &&
+        cm->cmsg_len == CMSG_LEN(sizeof(int))) {
+        memcpy(&fd, CMSG_DATA(cm), sizeof(int));
+    } else {
+        error_code = EBADMSG;
+    }
+    return fd;
+}
+
 Transport::~Transport() { close(); }
 
 void Transport::close() {
+    while (!rfds.empty()) {
+        ::close(rfds.front());
+        rfds.pop_front();
+    }
+
     if (s >= 0) {
         ::close(s);
         // Regardless, clear out socket
@@ -174,11 +507,387 @@ LsmException::LsmException(int code, std::string &msg,
     : std::runtime_error(msg), error_code(code), debug(debug_addl),
       debug_data(debug_data_addl) {}
 
-Ipc::Ipc() {}
+std::string Payload::serialize(const Value &v, encoding_type e) {
+    std::string out;
+    serialize(v, e, out);
+    return out;
+}
+
+void Payload::serialize(const Value &v, encoding_type e, std::string &out) {
+    out.clear();
+    if (e == msgpack) {
+        v.serializeMsgpack(out);
+    } else {
+        v.serializeJson(out);
+    }
+}
+
+Value Payload::deserialize(const std::string &data) {
+    DecodeScratch scratch;
+    return deserialize(data, scratch);
+}
+
+Value Payload::deserialize(const std::string &data, DecodeScratch &scratch) {
+    PayloadReader r(data.data(), data.size(),
+                    encodingDetect(data.data(), data.size()), scratch);
+    Value v = r.value();
+
+    r.finish();
+    return v;
+}
+
+const char *Payload::encodingName(encoding_type e) {
+    return (e == msgpack) ? "msgpack" : "json";
+}
+
+bool Payload::encodingLookup(const std::string &name, encoding_type &e) {
+    if (name == "msgpack") {
+        e = msgpack;
+        return true;
+    } else if (name == "json") {
+        e = json;
+        return true;
+    }
+    return false;
+}
+
+Payload::encoding_type Payload::encodingDetect(const char *data, size_t len) {
+    // A json payload is text, a MessagePack one always starts with the map
+    // header of the message envelope.
+    if (len && ((unsigned char)data[0]) >= 0x80) {
+        return msgpack;
+    }
+    return json;
+}
+
+PayloadReader::PayloadReader(const char *data, size_t len,
+                             Payload::encoding_type e, const JsonScanner &scan)
+    : begin(data), p(data), end(data + len), e(e), scan(scan), scratch(own) {}
+
+PayloadReader::PayloadReader(const char *data, size_t len,
+                             Payload::encoding_type e, DecodeScratch &scratch)
+    : begin(data), p(data), end(data + len), e(e), scan(json_scanner()),
+      scratch(scratch) {}
+
+/*
+ * The MessagePack side of the reader works on an mp_reader over the same
+ * bytes, which is synced back once done.
+ */
+#define MP_READER(r)                                                           \
+    mp_reader r;                                                               \
+    r.p = (const uint8_t *)p;                                                  \
+    r.end = (const uint8_t *)end
+
+#define MP_SYNC(r) p = (const char *)r.p
+
+Value::value_type PayloadReader::peek() {
+    if (e == Payload::msgpack) {
+        if (p == end) {
+            throw ValueException("Truncated MessagePack payload");
+        }
+        return mp_type((uint8_t)*p);
+    }
+
+    p = json_ws(p, end);
+    if (p == end) {
+        throw ValueException("Truncated json payload");
+    }
+
+    switch (*p) {
+    case ('{'):
+        return Value::object_t;
+    case ('['):
+        return Value::array_t;
+    case ('"'):
+        return Value::string_t;
+    case ('t'):
+    case ('f'):
+        return Value::boolean_t;
+    case ('n'):
+        return Value::null_t;
+    default:
+        return Value::numeric_t;
+    }
+}
+
+void PayloadReader::objectEnter() {
+    if (e == Payload::msgpack) {
+        MP_READER(r);
+        levels.push_back(mp_get_len(r, Value::object_t));
+        MP_SYNC(r);
+        return;
+    }
+
+    if (peek() != Value::object_t) {
+        throw ValueException("Value not object");
+    }
+    ++p;
+    levels.push_back(1);
+}
+
+bool PayloadReader::objectNext(std::string &key) {
+    if (levels.empty()) {
+        throw ValueException("Not in an object");
+    }
+
+    if (e == Payload::msgpack) {
+        if (!levels.back()) {
+            levels.pop_back();
+            return false;
+        }
+        levels.back()--;
+
+        MP_READER(r);
+        mp_get_key(r, key);
+        MP_SYNC(r);
+        return true;
+    }
+
+    p = json_ws(p, end);
+    if (p < end && *p == '}') {
+        ++p;
+        levels.pop_back();
+        return false;
+    }
+    if (!levels.back()) {
+        if (p == end || *p != ',') {
+            throw ValueException("Expecting , in json object");
+        }
+        p = json_ws(p + 1, end);
+    }
+    levels.back() = 0;
+
+    if (p == end || *p != '"') {
+        throw ValueException("Expecting json object key to be string");
+    }
+    const char *close = json_str_end(p + 1, end, scan);
+    json_get_str(key, p + 1, close - (p + 1));
+
+    p = json_ws(close + 1, end);
+    if (p == end || *p != ':') {
+        throw ValueException("Expecting : in json object");
+    }
+    ++p;
+    return true;
+}
+
+void PayloadReader::arrayEnter() {
+    if (e == Payload::msgpack) {
+        MP_READER(r);
+        levels.push_back(mp_get_len(r, Value::array_t));
+        MP_SYNC(r);
+        return;
+    }
+
+    if (peek() != Value::array_t) {
+        throw ValueException("Value not array");
+    }
+    ++p;
+    levels.push_back(1);
+}
+
+bool PayloadReader::arrayNext() {
+    if (levels.empty()) {
+        throw ValueException("Not in an array");
+    }
+
+    if (e == Payload::msgpack) {
+        if (!levels.back()) {
+            levels.pop_back();
+            return false;
+        }
+        levels.back()--;
+        return true;
+    }
+
+    p = json_ws(p, end);
+    if (p < end && *p == ']') {
+        ++p;
+        levels.pop_back();
+        return false;
+    }
+    if (!levels.back()) {
+        if (p == end || *p != ',') {
+            throw ValueException("Expecting , in json array");
+        }
+        ++p;
+    }
+    levels.back() = 0;
+    return true;
+}
 
-Ipc::Ipc(int fd) : t(fd) {}
+bool PayloadReader::string(std::string &out) {
+    Value::value_type t = peek();
 
-Ipc::Ipc(std::string socket_path) {
+    if (t == Value::null_t) {
+        skip();
+        out.clear();
+        return false;
+    } else if (t != Value::string_t) {
+        throw ValueException("Value not string");
+    }
+
+    if (e == Payload::msgpack) {
+        MP_READER(r);
+        mp_get_key(r, out);
+        MP_SYNC(r);
+        return true;
+    }
+
+    const char *close = json_str_end(p + 1, end, scan);
+    json_get_str(out, p + 1, close - (p + 1));
+    p = close + 1;
+    return true;
+}
+
+uint64_t PayloadReader::uint64() {
+    if (peek() != Value::numeric_t) {
+        throw ValueException("Value not numeric");
+    }
+    return value().asUint64_t();
+}
+
+int64_t PayloadReader::int64() {
+    if (peek() != Value::numeric_t) {
+        throw ValueException("Value not numeric");
+    }
+    return value().asInt64_t();
+}
+
+bool PayloadReader::boolean() {
+    if (peek() != Value::boolean_t) {
+        throw ValueException("Value not boolean");
+    }
+    return value().asBool();
+}
+
+Value PayloadReader::value() {
+    if (e == Payload::msgpack) {
+        MP_READER(r);
+        Value v = mp_parse(r);
+        MP_SYNC(r);
+        return v;
+    }
+
+    // Containers are collected on the scratch stacks above where the
+    // enclosing ones have got to, then moved out in one go.
+    switch (peek()) {
+    case (Value::object_t): {
+        Value::object_type &stack = scratch.members;
+        size_t base = stack.size();
+        std::string key;
+
+        objectEnter();
+        while (objectNext(key)) {
+            Value v = value();
+            stack.emplace_back(std::move(key), std::move(v));
+        }
+
+        Value::object_type members(
+            std::make_move_iterator(stack.begin() + base),
+            std::make_move_iterator(stack.end()));
+        stack.erase(stack.begin() + base, stack.end());
+        return Value(std::move(members));
+    }
+    case (Value::array_t): {
+        std::vector<Value> &stack = scratch.elements;
+        size_t base = stack.size();
+
+        arrayEnter();
+        while (arrayNext()) {
+            Value v = value();
+            stack.emplace_back(std::move(v));
+        }
+
+        std::vector<Value> elements(
+            std::make_move_iterator(stack.begin() + base),
+            std::make_move_iterator(stack.end()));
+        stack.erase(stack.begin() + base, stack.end());
+        return Value(std::move(elements));
+    }
+    case (Value::string_t): {
+        std::string s;
+        string(s);
+        return Value(std::move(s));
+    }
+    case (Value::boolean_t):
+        if (*p == 't') {
+            json_literal(p, end, "true", 4);
+            return Value(true);
+        }
+        json_literal(p, end, "false", 5);
+        return Value(false);
+    case (Value::null_t):
+        json_literal(p, end, "null", 4);
+        return Value();
+    case (Value::numeric_t):
+        return json_number(p, end);
+    }
+    throw ValueException("Unreachable path!");
+}
+
+void PayloadReader::skip() {
+    if (e == Payload::msgpack) {
+        MP_READER(r);
+        mp_skip(r);
+        MP_SYNC(r);
+        return;
+    }
+
+    switch (peek()) {
+    case (Value::object_t):
+    case (Value::array_t):
+        p = json_nest_end(p, end, scan, nest);
+        break;
+    case (Value::string_t):
+        p = json_str_end(p + 1, end, scan) + 1;
+        break;
+    case (Value::numeric_t):
+        json_number(p, end);
+        break;
+    default:
+        value();
+        break;
+    }
+}
+
+size_t PayloadReader::offset() const { return p - begin; }
+
+void PayloadReader::finish() {
+    if (e == Payload::json) {
+        p = json_ws(p, end);
+    }
+    if (p != end || !levels.empty()) {
+        throw ValueException("Trailing data after payload");
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+RpcStats::RpcStats()
+    : calls(0), errors(0), bytes_sent(0), bytes_received(0), serialize_ns(0),
+      transport_ns(0), deserialize_ns(0) {
+    memset(histogram, 0, sizeof(histogram));
+}
+
+Ipc::Ipc()
+    : receiving(false), broken(0), enc(Payload::json),
+      enc_accepted(Payload::json), enc_announce(false), memfd_send(false),
+      next_id(1) {}
+
+Ipc::Ipc(int fd)
+    : receiving(false), broken(0), t(fd), enc(Payload::json),
+      enc_accepted(Payload::json), enc_announce(false), memfd_send(false),
+      next_id(1) {}
+
+Ipc::Ipc(std::string socket_path)
+    : receiving(false), broken(0), enc(Payload::json),
+      enc_accepted(Payload::json), enc_announce(false), memfd_send(false),
+      next_id(1) {
     int e = 0;
     int fd = Transport::socket_get(socket_path, e);
     if (fd >= 0) {
@@ -188,30 +897,152 @@ Ipc::Ipc(std::string socket_path) {
 
 Ipc::~Ipc() { t.close(); }
 
-void Ipc::requestSend(const std::string request, const Value &params,
-                      int32_t id) {
-    int rc = 0;
+/*
+ * Largest allocation the output buffer and the decode scratch space keep
+ * once done with a message, so one huge listing doesn't pin its memory for
+ * the life of the connection.
+ */
+#define OUT_KEEP (4 * 1024 * 1024)
+
+std::string DecodeScratch::buffer() {
+    std::string b = std::move(spare);
+
+    spare = std::string();
+    b.clear();
+    return b;
+}
+
+void DecodeScratch::recycle(std::string &&msg) {
+    if (msg.capacity() > spare.capacity() && msg.capacity() <= OUT_KEEP) {
+        spare = std::move(msg);
+    }
+}
+
+void DecodeScratch::reset() {
+    elements.clear();
+    members.clear();
+    if (elements.capacity() * sizeof(Value) > OUT_KEEP) {
+        std::vector<Value>().swap(elements);
+    }
+    if (members.capacity() * sizeof(Value::object_type::value_type) >
+        OUT_KEEP) {
+        Value::object_type().swap(members);
+    }
+}
+
+void Ipc::messageSend(const Value &msg, const char *what) {
+    Payload::serialize(msg, enc, out);
+    bufferSend(what, memfd_send);
+}
+
+/**
+ * Sends what was serialized into out, in a memfd if memfd and it is big
+ * enough.
+ */
+void Ipc::bufferSend(const char *what, bool memfd) {
     int ec = 0;
+    int rc = t.msg_send(out, ec, memfd && out.size() >= Transport::MEMFD_MIN);
+
+    if (out.capacity() > OUT_KEEP) {
+        std::string().swap(out);
+    }
+
+    if (rc != 0) {
+        std::string em = std::string("Error sending ") + what + ": errno " +
+                         ::to_string(ec);
+        throw LsmException((int)LSM_ERR_TRANSPORT_COMMUNICATION, em);
+    }
+}
+
+/*
+ * Plug-ins which predate request ids answer everything with id 100, so it is
+ * never handed out to keep their responses from being mistaken for the
+ * response to a particular request.
+ */
+#define LEGACY_ID 100
+
+uint32_t Ipc::requestSubmit(const std::string &request, const Value &params,
+                            bool offer, uint32_t stream, bool poll) {
     std::map<std::string, Value> v;
+    Inflight track;
+    uint32_t id;
+    bool memfd;
+
+    track.start = now_ns();
+    track.method = request;
+    track.deserialize_ns = 0;
+    track.bytes_received = 0;
+    track.poll = poll;
+
+    {
+        std::lock_guard<std::mutex> held(lock);
+        id = next_id++;
+        if (id == LEGACY_ID || id == 0) {
+            id = next_id++;
+        }
+        memfd = memfd_send;
+    }
 
     v["method"] = Value(request);
     v["id"] = Value(id);
     v["params"] = params;
 
+    if (offer) {
+        std::vector<Value> names;
+        names.push_back(Value(Payload::encodingName(Payload::msgpack)));
+        names.push_back(Value(Payload::encodingName(Payload::json)));
+        v["encodings"] = Value(names);
+
+        // Only pays off where filling pages in a memfd is cheaper than
+        // copying through the socket, so it has to be asked for.
+        const char *memfd = getenv("LSM_IPC_MEMFD");
+        if (memfd && strcmp(memfd, "1") == 0) {
+            std::vector<Value> transfers;
+            transfers.push_back(Value("memfd"));
+            v["transfers"] = Value(transfers);
+        }
+    }
+
+    if (stream) {
+        v["stream"] = Value(stream);
+    }
+
     Value req(v);
-    rc = t.msg_send(Payload::serialize(req), ec);
+    std::lock_guard<std::mutex> sending(send_lock);
+    uint64_t begin = now_ns();
 
-    if (rc != 0) {
-        std::string em =
-            std::string("Error sending message: errno ") + ::to_string(ec);
-        throw LsmException((int)LSM_ERR_TRANSPORT_COMMUNICATION, em);
+    Payload::serialize(req, encodingGet(), out);
+    track.serialize_ns = now_ns() - begin;
+    track.bytes_sent = out.size() + Transport::HDR_LEN;
+
+    {
+        // Filed before sending as another thread may be the one to read the
+        // response.  Sends are in the order requests are filed, which
+        // plug-ins that don't echo the id rely on.
+        std::lock_guard<std::mutex> held(lock);
+        brokenCheck();
+        pending.push_back(id);
+        inflight[id] = track;
+        if (stream) {
+            // The parts are read by responseChunk
+            chunks[id];
+        }
+    }
+
+    try {
+        bufferSend("message", memfd);
+    } catch (...) {
+        std::lock_guard<std::mutex> held(lock);
+        pending.erase(std::find(pending.begin(), pending.end(), id));
+        inflight.erase(id);
+        chunks.erase(id);
+        throw;
     }
+    return id;
 }
 
 void Ipc::errorSend(int error_code, std::string msg, std::string debug,
                     uint32_t id) {
-    int ec = 0;
-    int rc = 0;
     std::map<std::string, Value> v;
     std::map<std::string, Value> error_data;
 
@@ -223,54 +1054,535 @@ void Ipc::errorSend(int error_code, std::string msg, std::string debug,
     v["id"] = Value(id);
 
     Value e(v);
-    rc = t.msg_send(Payload::serialize(e), ec);
-
-    if (rc != 0) {
-        std::string em = std::string("Error sending error message: errno ") +
-                         ::to_string(ec);
-        throw LsmException((int)LSM_ERR_TRANSPORT_COMMUNICATION, em);
-    }
+    messageSend(e, "error message");
 }
 
 Value Ipc::readRequest(void) {
     int ec;
-    std::string resp = t.msg_recv(ec);
-    return Payload::deserialize(resp);
+    std::string req = scratch.buffer();
+
+    t.msg_recv(req, ec);
+    Value v = Payload::deserialize(req, scratch);
+
+    scratch.recycle(std::move(req));
+    scratch.reset();
+    return v;
+}
+
+/**
+ * Serializes a response around result without copying it into an envelope
+ * Value first, members are written in the order a Value would have them.
+ */
+static void response_serialize(Payload::encoding_type e, const char *encoding,
+                               uint32_t id, bool more, const Value &result,
+                               std::string &out) {
+    out.clear();
+
+    if (e == Payload::msgpack) {
+        mp_put_len(out, 2 + (encoding ? 1 : 0) + (more ? 1 : 0), 0x80, 15,
+                   0xde);
+        if (encoding) {
+            mp_put_str(out, "encoding");
+            mp_put_str(out, encoding);
+        }
+        mp_put_str(out, "id");
+        mp_put_uint(out, id);
+        if (more) {
+            mp_put_str(out, "more");
+            out.push_back((char)0xc3);
+        }
+        mp_put_str(out, "result");
+        result.serializeMsgpack(out);
+        return;
+    }
+
+    out.push_back('{');
+    if (encoding) {
+        out.append("\"encoding\": ");
+        json_put_str(out, encoding, strlen(encoding));
+        out.append(", ");
+    }
+    out.append("\"id\": ");
+    json_put_uint(out, id);
+    if (more) {
+        out.append(", \"more\": true");
+    }
+    out.append(", \"result\": ");
+    result.serializeJson(out);
+    out.push_back('}');
 }
 
 void Ipc::responseSend(const Value &response, uint32_t id) {
-    int rc;
-    int ec;
-    std::map<std::string, Value> v;
+    response_serialize(enc,
+                       enc_announce ? Payload::encodingName(enc_accepted)
+                                    : NULL,
+                       id, false, response, out);
+    bufferSend("response", memfd_send);
 
-    v["id"] = id;
-    v["result"] = response;
+    if (enc_announce) {
+        enc = enc_accepted;
+        enc_announce = false;
+    }
+}
 
-    Value resp(v);
-    rc = t.msg_send(Payload::serialize(resp), ec);
+void Ipc::responseChunkSend(const Value &chunk, uint32_t id) {
+    response_serialize(enc, NULL, id, true, chunk, out);
+    bufferSend("response", memfd_send);
+}
 
-    if (rc != 0) {
-        std::string em =
-            std::string("Error sending response: errno ") + ::to_string(ec);
+/**
+ * Marks the connection broken, the threads waiting on it are woken to fail.
+ * Called with lock held.
+ */
+void Ipc::brokenSet(int code, const std::string &why) {
+    if (!broken) {
+        broken = code;
+        broken_why = why;
+    }
+    received.notify_all();
+}
+
+/**
+ * Throws the error the connection broke with, if it did.  Called with lock
+ * held.
+ */
+void Ipc::brokenCheck() const {
+    if (broken) {
+        std::string em = broken_why;
+        throw LsmException(broken, em);
+    }
+}
+
+/**
+ * Reads one response off the socket and files it, or if another thread is
+ * already reading waits for it to have read one.  Called with lock held,
+ * which is let go of while blocked.  Whatever goes wrong breaks the
+ * connection, as what follows on the socket can't be trusted.
+ */
+void Ipc::receive(Held &held) {
+    if (receiving) {
+        received.wait(held);
+        return;
+    }
+
+    int ec = 0;
+    std::string msg = scratch.buffer();
+
+    receiving = true;
+    held.unlock();
+    try {
+        t.msg_recv(msg, ec);
+    } catch (...) {
+        held.lock();
+        receiving = false;
+        brokenSet(LSM_ERR_TRANSPORT_COMMUNICATION, "Connection closed");
+        throw;
+    }
+    held.lock();
+    receiving = false;
+    received.notify_all();
+
+    if (ec) {
+        std::string em = "Error receiving response: errno " + ::to_string(ec);
+        brokenSet(LSM_ERR_TRANSPORT_COMMUNICATION, em);
         throw LsmException((int)LSM_ERR_TRANSPORT_COMMUNICATION, em);
     }
+
+    try {
+        responseRecv(std::move(msg));
+    } catch (const std::exception &e) {
+        brokenSet(LSM_ERR_TRANSPORT_SERIALIZATION,
+                  std::string("Malformed response: ") + e.what());
+        throw;
+    }
 }
 
-Value Ipc::responseRead() {
-    Value r = readRequest();
-    if (r.hasKey(std::string("result"))) {
-        return r.getValue("result");
-    } else {
-        std::map<std::string, Value> rp = r.asObject();
-        std::map<std::string, Value> error = rp["error"].asObject();
+/**
+ * Deserializes a response which was just read and files it.
+ */
+void Ipc::responseRecv(std::string msg) {
+    uint64_t begin = now_ns();
+    Value::object_type members;
+    std::string key;
+    Reply rep;
+
+    rep.msg = std::move(msg);
+    rep.result_at = std::string::npos;
+    rep.result_len = 0;
+    rep.e = Payload::encodingDetect(rep.msg.data(), rep.msg.size());
+
+    // The result is only stepped over, it is decoded once asked for
+    PayloadReader r(rep.msg.data(), rep.msg.size(), rep.e, scratch);
+    r.objectEnter();
+    while (r.objectNext(key)) {
+        if (key == "result") {
+            rep.result_at = r.offset();
+            r.skip();
+            rep.result_len = r.offset() - rep.result_at;
+        } else {
+            members.emplace_back(std::move(key), r.value());
+        }
+    }
+    r.finish();
+    rep.env = Value(std::move(members));
+
+    responseFile(rep, rep.msg.size() + Transport::HDR_LEN, now_ns() - begin);
+
+    // Only left with the message if it was a streamed part
+    scratch.recycle(std::move(rep.msg));
+}
+
+/**
+ * Adds a request which got its response to the statistics of its method.
+ */
+void Ipc::statsRecord(uint32_t id, bool error) {
+    std::map<uint32_t, Inflight>::iterator i = inflight.find(id);
+
+    if (i == inflight.end()) {
+        return;
+    }
 
+    const Inflight &f = i->second;
+    RpcStats &st = stats[f.method];
+    uint64_t took = now_ns() - f.start;
+    uint64_t ours = f.serialize_ns + f.deserialize_ns;
+    uint64_t us = took / 1000;
+    int bucket = 0;
+
+    st.calls++;
+    if (error) {
+        st.errors++;
+    }
+    st.bytes_sent += f.bytes_sent;
+    st.bytes_received += f.bytes_received;
+    st.serialize_ns += f.serialize_ns;
+    st.deserialize_ns += f.deserialize_ns;
+    st.transport_ns += (took > ours) ? took - ours : 0;
+
+    while (us && bucket < LSM_RPC_STATS_HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    st.histogram[bucket]++;
+
+    inflight.erase(i);
+}
+
+/**
+ * Matches a response which was just read to the request it belongs to.
+ */
+void Ipc::responseFile(Reply &rep, size_t bytes, uint64_t deserialize_ns) {
+    std::deque<uint32_t>::iterator iter = pending.end();
+    const Value &resp = rep.env;
+
+    if (resp.hasKey(std::string("encoding"))) {
+        // The other side accepted one of the encodings we offered
+        Payload::encoding_type e;
+        if (!Payload::encodingLookup(resp["encoding"].asString(), e)) {
+            throw ValueException("Unsupported encoding " +
+                                 resp["encoding"].asString());
+        }
+        enc = e;
+    }
+
+    if (pending.empty()) {
+        throw ValueException("Response without an outstanding request");
+    }
+
+    if (Value::numeric_t == resp["id"].valueType()) {
+        iter = std::find(pending.begin(), pending.end(),
+                         resp["id"].asUint32_t());
+    }
+
+    // Plug-ins which don't echo the id still answer in order
+    if (iter == pending.end()) {
+        iter = pending.begin();
+    }
+
+    std::map<uint32_t, Inflight>::iterator track = inflight.find(*iter);
+    if (track != inflight.end()) {
+        track->second.bytes_received += bytes;
+        track->second.deserialize_ns += deserialize_ns;
+        rep.method = track->second.method;
+    }
+
+    std::map<uint32_t, std::deque<Value> >::iterator streamed =
+        chunks.find(*iter);
+
+    if (streamed != chunks.end()) {
+        if (Value::boolean_t == resp["more"].valueType() &&
+            resp["more"].asBool()) {
+            // More parts to come, the request stays pending
+            uint64_t begin = now_ns();
+            streamed->second.push_back(resultValue(rep, scratch));
+            if (track != inflight.end()) {
+                track->second.deserialize_ns += now_ns() - begin;
+            }
+            return;
+        }
+    } else if (track != inflight.end() && track->second.poll) {
+        ready.push_back(*iter);
+    }
+
+    statsRecord(*iter, rep.result_at == std::string::npos);
+    replies[*iter] = std::move(rep);
+    pending.erase(iter);
+}
+
+/**
+ * Waits for the response to request id and takes it out of those kept.
+ * Called with lock held.
+ */
+Ipc::Reply Ipc::replyTake(uint32_t id, Held &held) {
+    std::map<uint32_t, Reply>::iterator found;
+
+    while ((found = replies.find(id)) == replies.end()) {
+        brokenCheck();
+        if (std::find(pending.begin(), pending.end(), id) == pending.end()) {
+            throw ValueException("Waiting on unknown request id " +
+                                 ::to_string(id));
+        }
+        receive(held);
+    }
+
+    Reply r = std::move(found->second);
+    replies.erase(found);
+
+    std::deque<uint32_t>::iterator unpolled =
+        std::find(ready.begin(), ready.end(), id);
+    if (unpolled != ready.end()) {
+        ready.erase(unpolled);
+    }
+
+    if (r.result_at == std::string::npos) {
+        const Value &error = r.env.getValue("error");
+
+        if (Value::object_t != error.valueType()) {
+            throw ValueException("Value not object");
+        }
         std::string msg = error["message"].asString();
         std::string data = error["data"].asString();
         throw LsmException((int)(error["code"].asInt32_t()), msg, data);
     }
+    return r;
+}
+
+/**
+ * Decodes the result of a response into a Value.
+ */
+Value Ipc::resultValue(const Reply &rep, DecodeScratch &s) {
+    PayloadReader r(rep.msg.data() + rep.result_at, rep.result_len, rep.e, s);
+    Value v = r.value();
+
+    r.finish();
+    return v;
+}
+
+/**
+ * Decoding of a response which was taken, done without lock so threads
+ * don't wait on each other's results.  Lends out scratch space of its own
+ * and, however the decoding ends, gives it back along with the message and
+ * adds the time taken to the statistics.
+ */
+class Ipc::Decoding {
+  public:
+    Decoding(Ipc &ipc, Reply &rep) : ipc(ipc), rep(rep) {
+        std::lock_guard<std::mutex> held(ipc.lock);
+        if (ipc.scratches.empty()) {
+            lent.emplace_back();
+        } else {
+            lent.splice(lent.begin(), ipc.scratches, ipc.scratches.begin());
+        }
+        begin = now_ns();
+    }
+
+    ~Decoding() {
+        uint64_t took = now_ns() - begin;
+
+        lent.front().reset();
+
+        std::lock_guard<std::mutex> held(ipc.lock);
+        // Statistics reset meanwhile don't get it
+        std::map<std::string, RpcStats>::iterator st =
+            ipc.stats.find(rep.method);
+        if (st != ipc.stats.end()) {
+            st->second.deserialize_ns += took;
+        }
+        ipc.scratch.recycle(std::move(rep.msg));
+        ipc.scratches.splice(ipc.scratches.begin(), lent);
+    }
+
+    DecodeScratch &scratch() { return lent.front(); }
+
+  private:
+    Ipc &ipc;
+    Reply &rep;
+    std::list<DecodeScratch> lent;
+    uint64_t begin;
+};
+
+/**
+ * Decodes the result of a response which was taken, called without lock.
+ */
+Value Ipc::replyValue(Reply &rep) {
+    Decoding d(*this, rep);
+
+    return resultValue(rep, d.scratch());
+}
+
+Value Ipc::responseWait(uint32_t id) {
+    Held held(lock);
+    Reply rep = replyTake(id, held);
+
+    held.unlock();
+    return replyValue(rep);
+}
+
+void Ipc::responseDecode(uint32_t id,
+                         const std::function<void(PayloadReader &)> &decode) {
+    Held held(lock);
+    Reply rep = replyTake(id, held);
+
+    held.unlock();
+
+    Decoding d(*this, rep);
+    PayloadReader r(rep.msg.data() + rep.result_at, rep.result_len, rep.e,
+                    d.scratch());
+
+    decode(r);
+    r.finish();
+}
+
+Value Ipc::responseChunk(uint32_t id, bool &more) {
+    Held held(lock);
+    std::map<uint32_t, std::deque<Value> >::iterator streamed = chunks.find(id);
+
+    if (streamed == chunks.end()) {
+        throw ValueException("Not a streamed request id " + ::to_string(id));
+    }
+
+    while (streamed->second.empty() && replies.find(id) == replies.end()) {
+        brokenCheck();
+        if (std::find(pending.begin(), pending.end(), id) == pending.end()) {
+            throw ValueException("Waiting on unknown request id " +
+                                 ::to_string(id));
+        }
+        receive(held);
+    }
+
+    if (!streamed->second.empty()) {
+        Value r = std::move(streamed->second.front());
+        streamed->second.pop_front();
+        more = true;
+        return r;
+    }
+
+    more = false;
+    chunks.erase(streamed);
+
+    Reply rep = replyTake(id, held);
+
+    held.unlock();
+    return replyValue(rep);
+}
+
+bool Ipc::responsePoll(uint32_t &id) {
+    std::lock_guard<std::mutex> held(lock);
+    std::string msg;
+    int ec = 0;
+
+    brokenCheck();
+
+    // Whichever thread is reading files what comes in meanwhile, breaking
+    // the connection as receive does
+    try {
+        while (!receiving && ready.empty() && t.msg_poll(msg, ec)) {
+            responseRecv(std::move(msg));
+        }
+    } catch (const EOFException &eof) {
+        brokenSet(LSM_ERR_TRANSPORT_COMMUNICATION, "Connection closed");
+        throw;
+    } catch (const std::exception &e) {
+        brokenSet(LSM_ERR_TRANSPORT_SERIALIZATION,
+                  std::string("Malformed response: ") + e.what());
+        throw;
+    }
+
+    if (ec) {
+        std::string em = "Error receiving response: errno " + ::to_string(ec);
+        brokenSet(LSM_ERR_TRANSPORT_COMMUNICATION, em);
+        throw LsmException((int)LSM_ERR_TRANSPORT_COMMUNICATION, em);
+    }
+
+    if (ready.empty()) {
+        return false;
+    }
+
+    id = ready.front();
+    ready.pop_front();
+    return true;
+}
+
+int Ipc::fdGet() const { return t.fd_get(); }
+
+Value Ipc::rpc(const std::string &request, const Value &params) {
+    return responseWait(requestSubmit(request, params));
+}
+
+void Ipc::rpcDecode(const std::string &request, const Value &params,
+                    const std::function<void(PayloadReader &)> &decode) {
+    responseDecode(requestSubmit(request, params), decode);
+}
+
+Value Ipc::rpcNegotiate(const std::string &request, const Value &params) {
+    const char *forced = getenv("LSM_IPC_ENCODING");
+    bool offer = !(forced && strcmp(forced, "json") == 0);
+
+    return responseWait(requestSubmit(request, params, offer));
+}
+
+void Ipc::encodingAccept(Value &offer) {
+    if (Value::array_t != offer.valueType()) {
+        return;
+    }
+
+    const std::vector<Value> &names = offer.asArray();
+    for (size_t i = 0; i < names.size(); ++i) {
+        Payload::encoding_type e;
+        if (Value::string_t == names[i].valueType() &&
+            Payload::encodingLookup(names[i].asString(), e)) {
+            enc_accepted = e;
+            enc_announce = true;
+            return;
+        }
+    }
+}
+
+void Ipc::transferAccept(Value &offer) {
+    if (Value::array_t != offer.valueType()) {
+        return;
+    }
+
+    const std::vector<Value> &names = offer.asArray();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (Value::string_t == names[i].valueType() &&
+            names[i].asString() == "memfd") {
+            memfd_send = true;
+        }
+    }
+}
+
+Payload::encoding_type Ipc::encodingGet() const {
+    std::lock_guard<std::mutex> held(lock);
+    return enc;
+}
+
+std::map<std::string, RpcStats> Ipc::statsGet() const {
+    std::lock_guard<std::mutex> held(lock);
+    return stats;
 }
 
-Value Ipc::rpc(const std::string &request, const Value &params, int32_t id) {
-    requestSend(request, params, id);
-    return responseRead();
+void Ipc::statsReset() {
+    std::lock_guard<std::mutex> held(lock);
+    stats.clear();
 }
@@ -10,7 +10,14 @@
 #define LSM_IPC_H
 
 #include "libstoragemgmt/libstoragemgmt_common.h"
+#include "libstoragemgmt/libstoragemgmt_types.h"
+#include "lsm_json_scan.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <stdint.h>
@@ -35,6 +42,12 @@ class LSM_DLL_LOCAL Transport {
      */
     const static int HDR_LEN = 10;
 
+    /**
+     * Payloads at least this big are worth passing in a memfd, see
+     * msg_send.
+     */
+    const static size_t MEMFD_MIN = 256 * 1024;
+
     /**
      * Empty ctor.
      * @return
@@ -54,11 +67,16 @@ class LSM_DLL_LOCAL Transport {
 
     /**
      * Sends a message over the transport.
+     * Note: With memfd set the payload is written to a sealed memfd which is
+     *       passed over the socket, after a header with a length of zero.
+     *       Only do this when the other side said it can receive it.  If no
+     *       memfd can be created the payload is sent inline.
      * @param[in]   msg         The message to be sent.
      * @param[out]  error_code  Errno (only valid if we return -1)
+     * @param[in]   memfd       Pass the payload in a memfd
      * @return 0 on success, else -1
      */
-    int msg_send(const std::string &msg, int &error_code);
+    int msg_send(const std::string &msg, int &error_code, bool memfd = false);
 
     /**
      * Received a message over the transport.
@@ -69,6 +87,31 @@ class LSM_DLL_LOCAL Transport {
      */
     std::string msg_recv(int &error_code);
 
+    /**
+     * Same as above, receiving into msg so its memory can be reused.
+     * @param[out]  msg         Message on success else 0 size
+     * @param[out]  error_code  (0 on success, else errno)
+     */
+    void msg_recv(std::string &msg, int &error_code);
+
+    /**
+     * Reads whatever is available without blocking and returns the next
+     * message if one has been received in full.  Data for a partial
+     * message is kept and used by the next call to msg_poll or msg_recv.
+     * Note: EOFException is thrown when the other side closed the transport
+     *       and no complete message is left.
+     * @param[out]  msg         The message, only valid if we return true.
+     * @param[out]  error_code  Errno (0 on success)
+     * @return true if a message was received, else false.
+     */
+    bool msg_poll(std::string &msg, int &error_code);
+
+    /**
+     * Returns the socket descriptor.
+     * @return Socket descriptor, -1 if not connected.
+     */
+    int fd_get() const;
+
     /**
      * Creates a connected socket (AF_UNIX) to the specified path
      * @param path of the AF_UNIX file to be used for IPC
@@ -77,6 +120,15 @@ class LSM_DLL_LOCAL Transport {
      */
     static int socket_get(const std::string &path, int &error_code);
 
+    /**
+     * Receives a file descriptor passed with SCM_RIGHTS, used by plug-ins
+     * lsmd started ahead of time to get their client connection.
+     * @param sock          Unix domain socket to receive on
+     * @param error_code    Error reason for the failure (errno, 0 on EOF)
+     * @return -1 on error, else received file descriptor.
+     */
+    static int fd_recv(int sock, int &error_code);
+
     /**
      * Closes the transport, called in the destructor if not done in advance.
      * @return 0 on success, else EBADF, EINTR, EIO.
@@ -84,7 +136,16 @@ class LSM_DLL_LOCAL Transport {
     void close();
 
   private:
-    int s; // Socket descriptor
+    int hdr_send(const char *hdr, const std::string *msg, int memfd,
+                 int &error_code);
+    ssize_t sock_recv(char *buff, size_t count, int flags);
+    int buffer_read(char *buff, size_t count, int &error_code);
+    int buffered_read(char *buff, size_t count, int &error_code);
+    int memfd_read(std::string &msg, int &error_code);
+
+    int s;                // Socket descriptor
+    std::string rbuf;     // Received by msg_poll but not yet returned
+    std::deque<int> rfds; // memfds received, in the order they were sent
 };
 
 /**
@@ -161,6 +222,10 @@ class LSM_DLL_LOCAL LsmException : public std::runtime_error {
 
 /**
  * Represents a value in the serialization.
+ * Booleans and integers are kept in native form, other numbers as the text
+ * they were received as.  Strings, arrays and objects are held in place, so
+ * a Value is only as big as the largest of them plus a tag, and moving one
+ * never copies what it holds.
  */
 class LSM_DLL_LOCAL Value {
   public:
@@ -176,6 +241,12 @@ class LSM_DLL_LOCAL Value {
         array_t
     };
 
+    /**
+     * Members of an object, kept sorted by key so a lookup is a binary
+     * search over contiguous memory.
+     */
+    typedef std::vector<std::pair<std::string, Value> > object_type;
+
     /**
      * Default constructor creates a "null" type
      */
@@ -230,23 +301,66 @@ class LSM_DLL_LOCAL Value {
      */
     Value(const std::string &v);
 
+    /**
+     * Constructor for std::string, taking over its contents
+     * @param v value
+     */
+    Value(std::string &&v);
+
     /**
      * Constructor for object type
      * @param v values
      */
     Value(const std::map<std::string, Value> &v);
 
+    /**
+     * Constructor for object type, taking over the values
+     * @param v values
+     */
+    Value(std::map<std::string, Value> &&v);
+
+    /**
+     * Constructor for object type from members in any order, when a key is
+     * repeated the last one wins.
+     * @param v values
+     */
+    Value(object_type &&v);
+
     /**
      * Constructor for array type
      * @param v array values
      */
     Value(const std::vector<Value> &v);
 
+    /**
+     * Constructor for array type, taking over the values
+     * @param v array values
+     */
+    Value(std::vector<Value> &&v);
+
+    Value(const Value &v);
+    Value(Value &&v) noexcept;
+    Value &operator=(const Value &v);
+    Value &operator=(Value &&v) noexcept;
+    ~Value();
+
     /**
      * Serialize Value to json
      * @return
      */
-    std::string serialize(void);
+    std::string serialize(void) const;
+
+    /**
+     * Serialize Value to json
+     * @param out   Buffer the encoded value is appended to
+     */
+    void serializeJson(std::string &out) const;
+
+    /**
+     * Serialize Value to MessagePack
+     * @param out   Buffer the encoded value is appended to
+     */
+    void serializeMsgpack(std::string &out) const;
 
     /**
      * Returns the enumerated type represented by object
@@ -255,12 +369,20 @@ class LSM_DLL_LOCAL Value {
     value_type valueType() const;
 
     /**
-     * Overloaded operator for map access
+     * Overloaded operator for map access, a missing key is added with a
+     * null value.
      * @param key
      * @return Value
      */
     Value &operator[](const std::string &key);
 
+    /**
+     * Overloaded operator for map access
+     * @param key
+     * @return Value, null if key doesn't exist
+     */
+    const Value &operator[](const std::string &key) const;
+
     /**
      * Overloaded operator for vector(array) access
      * @param i
@@ -268,106 +390,440 @@ class LSM_DLL_LOCAL Value {
      */
     Value &operator[](uint32_t i);
 
+    /**
+     * Overloaded operator for vector(array) access
+     * @param i
+     * @return Value
+     */
+    const Value &operator[](uint32_t i) const;
+
     /**
      * Returns true if value has a key in key/value pair
      * @return true if key exists, else false.
      */
-    bool hasKey(const std::string &k);
+    bool hasKey(const std::string &k) const;
 
     /**
      * Checks to see if a Value contains a valid request
      * @return True if it is a request, else false
      */
-    bool isValidRequest(void);
+    bool isValidRequest(void) const;
 
     /**
      * Given a key returns the value.
      * @param key
-     * @return Value
+     * @return Value, null if key doesn't exist
      */
-    Value getValue(const char *key);
+    const Value &getValue(const char *key) const;
 
     /**
      * Boolean value represented by object.
      * @return true, false ValueException on error
      */
-    bool asBool();
+    bool asBool() const;
 
     /**
      * Signed 32 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    int32_t asInt32_t();
+    int32_t asInt32_t() const;
 
     /**
      * Signed 64 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    int64_t asInt64_t();
+    int64_t asInt64_t() const;
 
     /**
      * Unsigned 32 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    uint32_t asUint32_t();
+    uint32_t asUint32_t() const;
 
     /**
      * Unsigned 64 integer value represented by object.
      * @return integer value else ValueException on error
      */
-    uint64_t asUint64_t();
+    uint64_t asUint64_t() const;
 
     /**
      * String value represented by object.
      * @return string value else ValueException on error
      */
-    std::string asString();
+    const std::string &asString() const;
 
     /**
      * Return string as a pointer to a character array
      * @return
      */
-    const char *asC_str();
+    const char *asC_str() const;
 
     /**
      * key/value represented by object.
-     * @return map of key and values else ValueException on error
+     * @return members sorted by key else ValueException on error
      */
-    std::map<std::string, Value> asObject();
+    const object_type &asObject() const;
 
     /**
      * vector of values represented by object.
      * @return vector of array values else ValueException on error
      */
-    std::vector<Value> asArray();
+    const std::vector<Value> &asArray() const;
+
+    /*
+     * The try* accessors below are the as* ones above without the throwing:
+     * they convert the same way, but a Value of the wrong type only costs a
+     * false return.  Decoding what a peer sent uses these, so a malformed
+     * message is turned away without unwinding.
+     */
+
+    /**
+     * Boolean value represented by object.
+     * @param[out]  v   value
+     * @return false when not a boolean
+     */
+    bool tryBool(bool &v) const;
+
+    /**
+     * Signed 32 integer value represented by object.
+     * @param[out]  v   value
+     * @return false when not an integer
+     */
+    bool tryInt32_t(int32_t &v) const;
+
+    /**
+     * Signed 64 integer value represented by object.
+     * @param[out]  v   value
+     * @return false when not an integer
+     */
+    bool tryInt64_t(int64_t &v) const;
+
+    /**
+     * Unsigned 32 integer value represented by object.
+     * @param[out]  v   value
+     * @return false when not an integer
+     */
+    bool tryUint32_t(uint32_t &v) const;
+
+    /**
+     * Unsigned 64 integer value represented by object.
+     * @param[out]  v   value
+     * @return false when not an integer
+     */
+    bool tryUint64_t(uint64_t &v) const;
+
+    /**
+     * String represented by object as a pointer to a character array, NULL
+     * for null.
+     * @param[out]  v   value
+     * @return false when neither a string nor null
+     */
+    bool tryC_str(const char *&v) const;
+
+    /**
+     * key/value represented by object.
+     * @param[out]  v   members sorted by key
+     * @return false when not an object
+     */
+    bool tryObject(const object_type *&v) const;
+
+    /**
+     * vector of values represented by object.
+     * @param[out]  v   array values
+     * @return false when not an array
+     */
+    bool tryArray(const std::vector<Value> *&v) const;
 
   private:
+    /**
+     * How a numeric_t is held.
+     */
+    enum number_type { int_n, uint_n, text_n };
+
+    void init(const Value &v);
+    void take(Value &v);
+    void release();
+    const Value *find(const std::string &key) const;
+
     value_type t;
-    std::vector<Value> array;
-    std::map<std::string, Value> obj;
-    std::string s;
+    number_type n;
+    union {
+        bool b;
+        int64_t i;              // int_n
+        uint64_t u;             // uint_n, only above INT64_MAX
+        std::string s;          // string_t and text_n
+        std::vector<Value> a;   // array_t
+        object_type o;          // object_t
+    };
 };
 
+class DecodeScratch;
+
 /**
  * Serialize, de-serialize methods.
  */
 class LSM_DLL_LOCAL Payload {
   public:
+    /**
+     * Wire encodings a payload can be serialized with.  json is what every
+     * peer understands, anything else has to be negotiated first.
+     */
+    enum encoding_type { json, msgpack };
+
     /**
      * Given a Value returns json representation.
      * @param v Value to serialize
      * @return String representation
      */
-    static std::string serialize(Value &v);
+    static std::string serialize(const Value &v);
+
+    /**
+     * Given a Value returns its representation in the requested encoding.
+     * @param v Value to serialize
+     * @param e Encoding to use
+     * @return Encoded representation
+     */
+    static std::string serialize(const Value &v, encoding_type e);
+
+    /**
+     * Serializes a Value in the requested encoding into a buffer, which is
+     * cleared first but keeps its allocation so it can be reused.
+     * @param v     Value to serialize
+     * @param e     Encoding to use
+     * @param out   Buffer for the encoded representation
+     */
+    static void serialize(const Value &v, encoding_type e, std::string &out);
+
+    /**
+     * Given a json or MessagePack payload return a Value, the encoding is
+     * detected from the first byte.
+     * @param data  Payload to de-serialize
+     * @return Value
+     */
+    static Value deserialize(const std::string &data);
 
     /**
-     * Given a json string return a Value
-     * @param json  String to de-serialize
+     * Same as above, drawing on scratch space which is kept between calls.
+     * @param data      Payload to de-serialize
+     * @param scratch   Scratch space
      * @return Value
      */
-    static Value deserialize(const std::string &json);
+    static Value deserialize(const std::string &data, DecodeScratch &scratch);
+
+    /**
+     * Returns the name used for an encoding during negotiation.
+     * @param e Encoding
+     * @return Name of encoding
+     */
+    static const char *encodingName(encoding_type e);
+
+    /**
+     * Looks up an encoding by the name used during negotiation.
+     * @param[in]   name    Name of encoding
+     * @param[out]  e       Encoding
+     * @return true if name is a supported encoding, else false
+     */
+    static bool encodingLookup(const std::string &name, encoding_type &e);
+
+    /**
+     * Tells the encoding of a received payload from its first byte.
+     * @param data  Payload
+     * @param len   Length of payload
+     * @return Encoding
+     */
+    static encoding_type encodingDetect(const char *data, size_t len);
 };
 
+/**
+ * Scratch space decoding draws from.  The members and elements of a json
+ * object or array are collected here and moved into a Value once the
+ * container is complete, so it is allocated once at its final size instead
+ * of growing an element at a time.  It also holds on to a receive buffer.
+ * An Ipc keeps one for the responses it decodes and resets it after each,
+ * which keeps the memory for the next unless it grew past a limit.
+ */
+class LSM_DLL_LOCAL DecodeScratch {
+  public:
+    /**
+     * Gets an empty buffer to receive the next message into, reusing the
+     * last one recycled.
+     * @return buffer
+     */
+    std::string buffer();
+
+    /**
+     * Hands back a receive buffer once done with it.
+     * @param msg   Buffer
+     */
+    void recycle(std::string &&msg);
+
+    /**
+     * Empties the scratch space, giving back memory beyond the limit.
+     */
+    void reset();
+
+    std::vector<Value> elements;  // Of the arrays being decoded
+    Value::object_type members;   // Of the objects being decoded
+
+  private:
+    std::string spare;
+};
+
+/**
+ * Pull decoder over a json or MessagePack payload.  The caller reads what
+ * it expects straight out of the message, so records can be filled in
+ * without building a Value tree first.  Anything other than what is asked
+ * for throws ValueException.
+ */
+class LSM_DLL_LOCAL PayloadReader {
+  public:
+    /**
+     * Constructor
+     * @param data  Payload, has to outlive the reader
+     * @param len   Length of payload
+     * @param e     Encoding of payload
+     * @param scan  json scanner, only given to compare implementations
+     */
+    PayloadReader(const char *data, size_t len, Payload::encoding_type e,
+                  const JsonScanner &scan = json_scanner());
+
+    /**
+     * Constructor, for a reader drawing on scratch space which outlives it.
+     * @param data      Payload, has to outlive the reader
+     * @param len       Length of payload
+     * @param e         Encoding of payload
+     * @param scratch   Scratch space
+     */
+    PayloadReader(const char *data, size_t len, Payload::encoding_type e,
+                  DecodeScratch &scratch);
+
+    /**
+     * Type of the next value, without reading it.
+     * @return enumerated type
+     */
+    Value::value_type peek();
+
+    /**
+     * Reads the start of an object, its members are read with objectNext.
+     */
+    void objectEnter();
+
+    /**
+     * Reads the key of the next member of the object last entered, the
+     * value is read next.
+     * @param[out]  key     Key of member
+     * @return false at the end of the object
+     */
+    bool objectNext(std::string &key);
+
+    /**
+     * Reads the start of an array, its elements are read with arrayNext.
+     */
+    void arrayEnter();
+
+    /**
+     * Checks for another element of the array last entered, which is read
+     * next.
+     * @return false at the end of the array
+     */
+    bool arrayNext();
+
+    /**
+     * Reads a string, null is read as an empty string.
+     * @param[out]  out     String read
+     * @return false if the value was null
+     */
+    bool string(std::string &out);
+
+    /**
+     * Reads a number, converted as Value::asUint64_t does.
+     * @return number
+     */
+    uint64_t uint64();
+
+    /**
+     * Reads a number, converted as Value::asInt64_t does.
+     * @return number
+     */
+    int64_t int64();
+
+    /**
+     * Reads a boolean.
+     * @return boolean
+     */
+    bool boolean();
+
+    /**
+     * Reads the next value whatever it is.
+     * @return Value
+     */
+    Value value();
+
+    /**
+     * Steps over the next value without decoding it.  Of a json object or
+     * array only the strings and the brackets are checked.
+     */
+    void skip();
+
+    /**
+     * Offset of the reader into the payload.
+     * @return offset
+     */
+    size_t offset() const;
+
+    /**
+     * Checks the whole payload has been read.
+     */
+    void finish();
+
+  private:
+    const char *begin;
+    const char *p;
+    const char *end;
+    Payload::encoding_type e;
+    const JsonScanner &scan;
+    DecodeScratch own;
+    DecodeScratch &scratch;
+    // json: 1 until the first element of the container is read, MessagePack:
+    // elements left to read.
+    std::vector<uint64_t> levels;
+    // json: closing brackets expected while skipping a container
+    std::string nest;
+};
+
+/**
+ * What the requests sent for one method have cost so far.  The time taken
+ * by a request is split into serializing it, deserializing the response and
+ * what is left, which is spent in the transport and the plug-in.
+ */
+struct LSM_DLL_LOCAL RpcStats {
+    uint64_t calls;          // Requests which got a response
+    uint64_t errors;         // Of those, how many got an error
+    uint64_t bytes_sent;     // Including headers
+    uint64_t bytes_received; // Including headers
+    uint64_t serialize_ns;
+    uint64_t transport_ns;
+    uint64_t deserialize_ns;
+
+    /**
+     * Bucket 0 counts requests which took less than 1us, bucket n those
+     * which took from 2^(n-1)us up to 2^n us, the last bucket everything
+     * longer.
+     */
+    uint64_t histogram[LSM_RPC_STATS_HISTOGRAM_BUCKETS];
+
+    RpcStats();
+};
+
+/**
+ * Requests and responses over a Transport.  The client side calls can be made
+ * from any number of threads at once: requests go out as they are made and
+ * whichever thread is waiting reads the responses off the socket, handing
+ * them to the threads they belong to.  Once a response can't be received or
+ * makes no sense, the connection is broken and every call made on it fails
+ * with LsmException, LSM_ERR_TRANSPORT_*.  The plug-in side calls are made
+ * from one thread.
+ */
 class LSM_DLL_LOCAL Ipc {
   public:
     /**
@@ -393,13 +849,21 @@ class LSM_DLL_LOCAL Ipc {
     ~Ipc();
 
     /**
-     * Send a request over IPC
+     * Send a request over IPC without waiting for the response, any number
+     * of requests can be outstanding at the same time.
      * @param request       IPC function name
      * @param params        Parameters
-     * @param id            Request ID
+     * @param offer         Offer the encodings and transfers we support, see
+     *                      rpcNegotiate
+     * @param stream        When not 0, ask for a listing to be sent in
+     *                      chunks of this many records, see responseChunk
+     * @param poll          Report the response to responsePoll
+     * @return Id of the request, used to wait for its response
      */
-    void requestSend(const std::string request, const Value &params,
-                     int32_t id = 100);
+    uint32_t requestSubmit(const std::string &request, const Value &params,
+                           bool offer = false, uint32_t stream = 0,
+                           bool poll = false);
+
     /**
      * Reads a request
      * @returns Value
@@ -414,10 +878,59 @@ class LSM_DLL_LOCAL Ipc {
     void responseSend(const Value &response, uint32_t id = 100);
 
     /**
-     * Read a response
-     * @return Value of response
+     * Send part of the response to a request which asked for it to be
+     * streamed, responseSend sends the last part.
+     * @param chunk         Array of records
+     * @param id            Id that matches request
+     */
+    void responseChunkSend(const Value &chunk, uint32_t id);
+
+    /**
+     * Waits for the response to a request sent with requestSubmit.
+     * Responses to other outstanding requests which arrive first are kept
+     * until they are asked for.
+     * @param id    Id returned by requestSubmit
+     * @return Result of the operation, LsmException if it failed
+     */
+    Value responseWait(uint32_t id);
+
+    /**
+     * Same as responseWait, but hands the result to decode as it was
+     * received instead of as a Value.
+     * @param id        Id returned by requestSubmit
+     * @param decode    Reads the result, the reader is only valid for the
+     *                  duration of the call
      */
-    Value responseRead();
+    void responseDecode(uint32_t id,
+                        const std::function<void(PayloadReader &)> &decode);
+
+    /**
+     * Waits for the next part of the response to a request sent with a
+     * stream chunk size.  Plug-ins which don't stream send everything as
+     * the last part.
+     * @param[in]   id      Id returned by requestSubmit
+     * @param[out]  more    Set to false for the last part
+     * @return Part of the result, LsmException if the request failed
+     */
+    Value responseChunk(uint32_t id, bool &more);
+
+    /**
+     * Checks without blocking for a response to a request sent with
+     * requestSubmit asking for it to be polled.  Responses are reported once
+     * each, in the order they arrive, and stay available to responseWait.
+     * Note: Data already read off the socket is buffered, call until it
+     *       returns false before waiting on the descriptor again.
+     * @param[out] id   Id of the request which has a response
+     * @return true if id was set, false if no response is ready.
+     */
+    bool responsePoll(uint32_t &id);
+
+    /**
+     * Returns the socket descriptor used to talk to the other side, for use
+     * with poll/epoll.  It stays owned by this object.
+     * @return Socket descriptor, -1 if not connected.
+     */
+    int fdGet() const;
 
     /**
      * Send an error
@@ -433,14 +946,135 @@ class LSM_DLL_LOCAL Ipc {
      * Do a remote procedure call (Request with a returned response
      * @param request           Function method
      * @param params            Function parameters
-     * @param id                Id of request
      * @return Result of the operation.
      */
-    Value rpc(const std::string &request, const Value &params,
-              int32_t id = 100);
+    Value rpc(const std::string &request, const Value &params);
+
+    /**
+     * Do a remote procedure call, handing the result to decode as it was
+     * received, see responseDecode.
+     * @param request           Function method
+     * @param params            Function parameters
+     * @param decode            Reads the result
+     */
+    void rpcDecode(const std::string &request, const Value &params,
+                   const std::function<void(PayloadReader &)> &decode);
+
+    /**
+     * Same as rpc, but offers the other side the encodings we support.  If
+     * it picks one, every message which follows is sent with it.  Setting
+     * LSM_IPC_ENCODING=json in the environment skips the offer.  With
+     * LSM_IPC_MEMFD=1 set it also tells the other side we can receive large
+     * payloads in a memfd.
+     * @param request           Function method
+     * @param params            Function parameters
+     * @return Result of the operation.
+     */
+    Value rpcNegotiate(const std::string &request, const Value &params);
+
+    /**
+     * Picks an encoding from the list a client offered with its request.
+     * The choice is announced in the next response, which is still sent in
+     * the current encoding, and is used for everything after it.
+     * @param offer     Array of encoding names, in order of preference
+     */
+    void encodingAccept(Value &offer);
+
+    /**
+     * Looks at the ways of passing payloads a client offered with its
+     * request.  If "memfd" is one of them, large payloads we send from now
+     * on are passed in a memfd instead of through the socket.
+     * @param offer     Array of transfer names
+     */
+    void transferAccept(Value &offer);
+
+    /**
+     * Returns the encoding used for messages we send.
+     * @return Current encoding
+     */
+    Payload::encoding_type encodingGet() const;
+
+    /**
+     * Returns the statistics of the requests sent so far, by method.  Only
+     * requests which got a response are counted.
+     * @return Copy of the statistics by method name
+     */
+    std::map<std::string, RpcStats> statsGet() const;
+
+    /**
+     * Clears the statistics, requests outstanding are still counted once
+     * their response arrives.
+     */
+    void statsReset();
 
   private:
+    /**
+     * A request sent which has not been answered yet.
+     */
+    struct Inflight {
+        std::string method;
+        uint64_t start; // CLOCK_MONOTONIC ns
+        uint64_t serialize_ns;
+        uint64_t deserialize_ns;
+        uint64_t bytes_sent;
+        uint64_t bytes_received;
+        bool poll; // Reported by responsePoll
+    };
+
+    /**
+     * A response received.  Only the envelope is decoded on arrival, the
+     * result is kept as it came until it is asked for.
+     */
+    struct Reply {
+        Value env;                // Members other than the result
+        std::string msg;          // Message as received
+        size_t result_at;         // Offset of result in msg, npos if none
+        size_t result_len;        // Length of result in msg
+        Payload::encoding_type e; // Encoding of msg
+        std::string method;       // Method of the request, for statistics
+    };
+
+    typedef std::unique_lock<std::mutex> Held;
+
+    class Decoding;
+
+    void messageSend(const Value &msg, const char *what);
+    void bufferSend(const char *what, bool memfd);
+    void receive(Held &held);
+    void brokenSet(int code, const std::string &why);
+    void brokenCheck() const;
+    void responseRecv(std::string msg);
+    void responseFile(Reply &rep, size_t bytes, uint64_t deserialize_ns);
+    Reply replyTake(uint32_t id, Held &held);
+    Value replyValue(Reply &rep);
+    Value resultValue(const Reply &rep, DecodeScratch &s);
+    void statsRecord(uint32_t id, bool error);
+
+    // Only one thread sends at a time and only one receives at a time, as
+    // tracked by receiving.  Everything else is guarded by lock.
+    mutable std::mutex lock;
+    std::mutex send_lock;              // Held while serializing and sending
+    std::condition_variable received;  // A thread stopped receiving
+    bool receiving;                    // A thread is reading from t
+    int broken;             // Error every call fails with from now on, or 0
+    std::string broken_why; // Message of that error
+
     Transport t;
+    Payload::encoding_type enc;
+    Payload::encoding_type enc_accepted;
+    bool enc_announce;
+    bool memfd_send; // Other side can receive payloads in a memfd
+    uint32_t next_id;
+    std::string out; // Messages are serialized here, guarded by send_lock
+    DecodeScratch scratch; // Envelopes and streamed parts are decoded with
+                           // this as they are received, under lock
+    std::list<DecodeScratch> scratches; // For results decoded without lock
+    std::deque<uint32_t> pending;      // Ids of requests sent, oldest first
+    std::map<uint32_t, Reply> replies; // Responses not yet asked for
+    std::deque<uint32_t> ready;        // Responses not yet polled for
+    std::map<uint32_t, std::deque<Value> > chunks; // Streamed parts by id
+    std::map<uint32_t, Inflight> inflight;         // Requests sent, by id
+    std::map<std::string, RpcStats> stats;         // By method
 };
 
 #endif
@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Differential fuzz test of the json scanners, run by "make check".  Every
+ * scanner the CPU supports has to find the same as the scalar one, and
+ * decoding with any of them has to agree with decoding with the scalar one.
+ * Optional arguments: seed and number of rounds.
+ */
+
+#include "lsm_ipc.hpp"
+
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::mt19937 rng;
+
+static size_t pick(size_t n) { return rng() % n; }
+
+/**
+ * Random bytes, mostly the ones the scanners look for.
+ */
+static std::string noise(size_t len) {
+    static const char interesting[] = "\"\\{}[]:, a\xfb\xdb\x7f";
+    std::string s(len, ' ');
+
+    for (size_t i = 0; i < len; ++i) {
+        s[i] = pick(4) ? interesting[pick(sizeof(interesting) - 1)]
+                       : (char)pick(256);
+    }
+    return s;
+}
+
+static Value random_value(int depth) {
+    switch (pick(depth ? 8 : 5)) {
+    case (0):
+        return Value();
+    case (1):
+        return Value(pick(2) == 1);
+    case (2):
+        return Value((uint64_t)rng() * rng());
+    case (3):
+        return Value((int64_t)0 - (int64_t)rng());
+    case (4):
+        // Long enough to take the vector paths, with escapes in
+        return Value(noise(pick(80)));
+    case (5):
+    case (6): {
+        std::map<std::string, Value> o;
+        size_t n = pick(6);
+        for (size_t i = 0; i < n; ++i) {
+            o[noise(pick(40))] = random_value(depth - 1);
+        }
+        return Value(std::move(o));
+    }
+    default: {
+        std::vector<Value> a;
+        size_t n = pick(6);
+        for (size_t i = 0; i < n; ++i) {
+            a.push_back(random_value(depth - 1));
+        }
+        return Value(std::move(a));
+    }
+    }
+}
+
+/**
+ * Breaks a document in some small way, or leaves it alone.
+ */
+static void mutate(std::string &doc) {
+    static const char structural[] = "\"\\{}[]:,";
+
+    if (doc.empty()) {
+        return;
+    }
+    switch (pick(5)) {
+    case (0):
+        doc[pick(doc.size())] = structural[pick(sizeof(structural) - 1)];
+        break;
+    case (1):
+        doc.erase(pick(doc.size()), 1);
+        break;
+    case (2):
+        doc.insert(pick(doc.size()), 1,
+                   structural[pick(sizeof(structural) - 1)]);
+        break;
+    case (3):
+        doc.resize(pick(doc.size()));
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Decodes doc, or the first value of it when skipping, with scan.
+ * @return json of what was decoded and where the reader ended up, else the
+ *         error
+ */
+static std::string decode(const std::string &doc, const JsonScanner &scan,
+                          bool skipping) {
+    try {
+        PayloadReader r(doc.data(), doc.size(), Payload::json, scan);
+        if (skipping) {
+            r.skip();
+            return "skipped to " + std::to_string(r.offset());
+        }
+        Value v = r.value();
+        size_t at = r.offset();
+        r.finish();
+        return v.serialize() + " at " + std::to_string(at);
+    } catch (const ValueException &ve) {
+        return std::string("error ") + ve.what();
+    }
+}
+
+static int fail(const char *what, const JsonScanner &scan,
+                const std::string &doc, const std::string &got,
+                const std::string &want) {
+    printf("FAIL %s with %s\n  input: %s\n  got:   %s\n  want:  %s\n", what,
+           scan.name, doc.c_str(), got.c_str(), want.c_str());
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long seed = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1;
+    unsigned long rounds = (argc > 2) ? strtoul(argv[2], NULL, 0) : 20000;
+    size_t count = 0;
+    const JsonScanner *scanners = json_scanners(count);
+    const JsonScanner &scalar = scanners[0];
+
+    rng.seed(seed);
+    printf("seed %lu, %lu rounds, scanners:", seed, rounds);
+    for (size_t i = 0; i < count; ++i) {
+        printf(" %s", scanners[i].name);
+    }
+    printf("\n");
+
+    for (unsigned long round = 0; round < rounds; ++round) {
+        // The scanners themselves, at every alignment and length
+        std::string buf = noise(pick(130));
+        const char *b = buf.data();
+        size_t from = pick(buf.size() + 1);
+        size_t to = from + pick(buf.size() - from + 1);
+
+        for (size_t i = 1; i < count; ++i) {
+            const JsonScanner &s = scanners[i];
+            if (s.string_stop(b + from, b + to) !=
+                    scalar.string_stop(b + from, b + to) ||
+                s.nest_stop(b + from, b + to) !=
+                    scalar.nest_stop(b + from, b + to)) {
+                return fail("scan", s, buf, "", "");
+            }
+        }
+
+        // Decoding whole documents
+        std::string doc = random_value(4).serialize();
+        mutate(doc);
+
+        std::string want = decode(doc, scalar, false);
+        std::string want_skip = decode(doc, scalar, true);
+
+        for (size_t i = 1; i < count; ++i) {
+            std::string got = decode(doc, scanners[i], false);
+            if (got != want) {
+                return fail("decode", scanners[i], doc, got, want);
+            }
+            got = decode(doc, scanners[i], true);
+            if (got != want_skip) {
+                return fail("skip", scanners[i], doc, got, want_skip);
+            }
+        }
+
+        // Skipping only checks the nesting, but wherever the value decodes
+        // skipping has to end up in the same place.
+        if (want.compare(0, 6, "error ") != 0) {
+            std::string at = want.substr(want.rfind(" at ") + 4);
+            if (want_skip != "skipped to " + at) {
+                return fail("skip vs decode", scalar, doc, want_skip, want);
+            }
+        }
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,243 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ */
+
+#include "lsm_json_scan.hpp"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SCAN_X86 1
+#include <immintrin.h>
+/*
+ * The strings and the gaps between brackets of a listing are mostly shorter
+ * than a 32 byte block, so avx2 loses more on the loads it wastes than it
+ * gains on the long ones.  lsm_bench skips 100k volumes at ~790 MiB/s with
+ * sse2 against ~720 MiB/s with avx2.
+ */
+#define SCAN_DEFAULT "sse2"
+#elif defined(__aarch64__)
+#define SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+/*
+ * '[' and '{' only differ by 0x20, as do ']' and '}', so or-ing that bit in
+ * leaves two values to compare against instead of four.
+ */
+#define BRACKET_BIT 0x20
+
+static const char *scalar_string_stop(const char *p, const char *end) {
+    while (p < end && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    return p;
+}
+
+static const char *scalar_nest_stop(const char *p, const char *end) {
+    for (; p < end; ++p) {
+        char c = *p | BRACKET_BIT;
+        if (*p == '"' || c == '{' || c == '}') {
+            break;
+        }
+    }
+    return p;
+}
+
+#ifdef SCAN_X86
+static const char *sse2_string_stop(const char *p, const char *end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+
+    for (; end - p >= 16; p += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)p);
+        unsigned m = _mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(b, quote), _mm_cmpeq_epi8(b, bslash)));
+        if (m) {
+            return p + __builtin_ctz(m);
+        }
+    }
+    return scalar_string_stop(p, end);
+}
+
+static const char *sse2_nest_stop(const char *p, const char *end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i bit = _mm_set1_epi8(BRACKET_BIT);
+
+    for (; end - p >= 16; p += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)p);
+        __m128i c = _mm_or_si128(b, bit);
+        unsigned m = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(b, quote),
+                         _mm_or_si128(_mm_cmpeq_epi8(c, open),
+                                      _mm_cmpeq_epi8(c, close))));
+        if (m) {
+            return p + __builtin_ctz(m);
+        }
+    }
+    return scalar_nest_stop(p, end);
+}
+
+__attribute__((target("avx2"))) static const char *
+avx2_string_stop(const char *p, const char *end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+
+    for (; end - p >= 32; p += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)p);
+        unsigned m = _mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(b, quote), _mm256_cmpeq_epi8(b, bslash)));
+        if (m) {
+            return p + __builtin_ctz(m);
+        }
+    }
+    return sse2_string_stop(p, end);
+}
+
+__attribute__((target("avx2"))) static const char *
+avx2_nest_stop(const char *p, const char *end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i bit = _mm256_set1_epi8(BRACKET_BIT);
+
+    for (; end - p >= 32; p += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)p);
+        __m256i c = _mm256_or_si256(b, bit);
+        unsigned m = _mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(b, quote),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(c, open),
+                                            _mm256_cmpeq_epi8(c, close))));
+        if (m) {
+            return p + __builtin_ctz(m);
+        }
+    }
+    return sse2_nest_stop(p, end);
+}
+#endif
+
+#ifdef SCAN_NEON
+/**
+ * Position of the first matching byte in a block, given the result of a
+ * compare.  Narrowing leaves four bits for every byte.
+ */
+static inline int neon_first(uint8x16_t eq) {
+    uint64_t m = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+    return m ? __builtin_ctzll(m) >> 2 : -1;
+}
+
+static const char *neon_string_stop(const char *p, const char *end) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t bslash = vdupq_n_u8('\\');
+
+    for (; end - p >= 16; p += 16) {
+        uint8x16_t b = vld1q_u8((const uint8_t *)p);
+        int i = neon_first(
+            vorrq_u8(vceqq_u8(b, quote), vceqq_u8(b, bslash)));
+        if (i >= 0) {
+            return p + i;
+        }
+    }
+    return scalar_string_stop(p, end);
+}
+
+static const char *neon_nest_stop(const char *p, const char *end) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t open = vdupq_n_u8('{');
+    const uint8x16_t close = vdupq_n_u8('}');
+    const uint8x16_t bit = vdupq_n_u8(BRACKET_BIT);
+
+    for (; end - p >= 16; p += 16) {
+        uint8x16_t b = vld1q_u8((const uint8_t *)p);
+        uint8x16_t c = vorrq_u8(b, bit);
+        int i = neon_first(vorrq_u8(
+            vceqq_u8(b, quote),
+            vorrq_u8(vceqq_u8(c, open), vceqq_u8(c, close))));
+        if (i >= 0) {
+            return p + i;
+        }
+    }
+    return scalar_nest_stop(p, end);
+}
+#endif
+
+static const JsonScanner scanners[] = {
+    {"scalar", scalar_string_stop, scalar_nest_stop},
+#ifdef SCAN_X86
+    {"sse2", sse2_string_stop, sse2_nest_stop},
+    {"avx2", avx2_string_stop, avx2_nest_stop},
+#endif
+#ifdef SCAN_NEON
+    {"neon", neon_string_stop, neon_nest_stop},
+#endif
+};
+
+static bool supported(const JsonScanner &s) {
+#ifdef SCAN_X86
+    if (strcmp(s.name, "avx2") == 0) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    (void)s;
+    return true;
+}
+
+/**
+ * Number of scanners the CPU supports.  They are sorted from least to most
+ * capable, so counting stops at the first one missing.
+ */
+static size_t supported_count() {
+    size_t n = 0;
+
+    while (n < sizeof(scanners) / sizeof(scanners[0]) &&
+           supported(scanners[n])) {
+        ++n;
+    }
+    return n;
+}
+
+const JsonScanner *json_scanners(size_t &count) {
+    static const size_t usable = supported_count();
+
+    count = usable;
+    return scanners;
+}
+
+static const JsonScanner *scanner_find(const char *name) {
+    size_t count = 0;
+    const JsonScanner *list = json_scanners(count);
+
+    for (size_t i = 0; name && i < count; ++i) {
+        if (strcmp(list[i].name, name) == 0) {
+            return &list[i];
+        }
+    }
+    return NULL;
+}
+
+static const JsonScanner &scanner_pick() {
+    size_t count = 0;
+    const JsonScanner *list = json_scanners(count);
+    const JsonScanner *s = scanner_find(getenv("LSM_JSON_SCAN"));
+
+#ifdef SCAN_DEFAULT
+    if (!s) {
+        s = scanner_find(SCAN_DEFAULT);
+    }
+#endif
+    return s ? *s : list[count - 1];
+}
+
+const JsonScanner &json_scanner() {
+    static const JsonScanner &picked = scanner_pick();
+    return picked;
+}
@@ -0,0 +1,51 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ */
+
+#ifndef LSM_JSON_SCAN_HPP
+#define LSM_JSON_SCAN_HPP
+
+#include "libstoragemgmt/libstoragemgmt_common.h"
+#include <stddef.h>
+
+/**
+ * Finds the characters json decoding has to stop at, a vector register of
+ * bytes at a time where the CPU allows.  Every implementation returns the
+ * same as the scalar one.
+ */
+struct LSM_DLL_LOCAL JsonScanner {
+    /** Name of the implementation, eg. "avx2" */
+    const char *name;
+
+    /**
+     * Finds the first '"' or '\\'.
+     * @return position found, else end
+     */
+    const char *(*string_stop)(const char *p, const char *end);
+
+    /**
+     * Finds the first '"', '[', ']', '{' or '}'.
+     * @return position found, else end
+     */
+    const char *(*nest_stop)(const char *p, const char *end);
+};
+
+/**
+ * Implementation to use, picked on first call.  It is the fastest one the
+ * CPU supports, sse2 rather than avx2 on x86_64, unless the environment
+ * variable LSM_JSON_SCAN names another.
+ * @return scanner
+ */
+const JsonScanner LSM_DLL_LOCAL &json_scanner();
+
+/**
+ * Implementations the CPU supports, the scalar one first.
+ * @param[out]  count   Number of implementations
+ * @return array of scanners
+ */
+const JsonScanner LSM_DLL_LOCAL *json_scanners(size_t &count);
+
+#endif
@@ -11,8 +11,11 @@
 #include "libstoragemgmt/libstoragemgmt_plug_interface.h"
 #include "libstoragemgmt/libstoragemgmt_types.h"
 #include <dirent.h>
+#include <new>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "lsm_convert.hpp"
 #include "lsm_datatypes.hpp"
@@ -63,8 +66,7 @@ static int get_battery_array(lsm_connect *c, int rc, Value &response,
         if (!LSM_IS_CONNECT(c)) {                                              \
             return LSM_ERR_INVALID_ARGUMENT;                                   \
         }                                                                      \
-        lsm_error_free(c->error);                                              \
-        c->error = NULL;                                                       \
+        connection_error_set(c, NULL);                                         \
     } while (0)
 
 static int check_search_key(const char *search_key,
@@ -224,12 +226,7 @@ static int lsm_error_log(lsm_connect *c, lsm_error_ptr error) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    if (c->error) {
-        lsm_error_free(c->error);
-        c->error = NULL;
-    }
-
-    c->error = error;
+    connection_error_set(c, error);
     return LSM_ERR_OK;
 }
 
@@ -244,10 +241,12 @@ static lsm_error_number log_exception(lsm_connect *c, lsm_error_number error,
     return error;
 }
 
-static int rpc(lsm_connect *c, const char *method, const Value &parameters,
-               Value &response) throw() {
+/**
+ * Runs an IPC operation, turning whatever it throws into an error code.
+ */
+template <typename F> static int ipc_call(lsm_connect *c, F op) throw() {
     try {
-        response = c->tp->rpc(method, parameters);
+        op();
     } catch (const ValueException &ve) {
         return log_exception(c, LSM_ERR_TRANSPORT_SERIALIZATION,
                              "Serialization error", ve.what());
@@ -264,6 +263,146 @@ static int rpc(lsm_connect *c, const char *method, const Value &parameters,
     return LSM_ERR_OK;
 }
 
+/*
+ * Methods which change nothing a cached response holds.  Calling any other
+ * method throws the cached responses away.
+ */
+static const char *const CACHE_KEEPING_METHODS[] = {
+    "access_groups",
+    "access_groups_granted_to_volume",
+    "batteries",
+    "capabilities",
+    "disks",
+    "exports",
+    "fs",
+    "fs_child_dependency",
+    "fs_snapshots",
+    "job_free",
+    "plugin_info",
+    "pool_member_info",
+    "pools",
+    "systems",
+    "target_ports",
+    "time_out_get",
+    "time_out_set",
+    "volume_cache_info",
+    "volume_child_dependency",
+    "volume_raid_create_cap_get",
+    "volume_raid_info",
+    "volume_replicate_range_block_size",
+    "volumes",
+    "volumes_accessible_by_access_group",
+};
+
+static bool cache_keeping(const char *method) {
+    for (size_t i = 0; i < sizeof(CACHE_KEEPING_METHODS) / sizeof(char *);
+         ++i) {
+        if (strcmp(method, CACHE_KEEPING_METHODS[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int rpc(lsm_connect *c, const char *method, const Value &parameters,
+               Value &response) throw() {
+    int rc =
+        ipc_call(c, [&]() { response = c->tp->rpc(method, parameters); });
+
+    // Failed or not, the call may have changed something
+    if (!cache_keeping(method)) {
+        std::lock_guard<std::mutex> held(*c->lock);
+        if (c->cache) {
+            c->cache->clear();
+        }
+    }
+    return rc;
+}
+
+static bool cache_on(lsm_connect *c, lsm_cache_class what) {
+    std::lock_guard<std::mutex> held(*c->lock);
+    return c->cache && c->cache->ttl_ms[what];
+}
+
+/**
+ * Same as rpc, but answered from the cache while the response to the same
+ * call is younger than the ttl set for what.  Only successful calls are
+ * cached.
+ */
+static int cached_rpc(lsm_connect *c, lsm_cache_class what, const char *method,
+                      const Value &parameters, Value &response) throw() {
+    if (!cache_on(c, what)) {
+        return rpc(c, method, parameters, response);
+    }
+
+    // Kept until the connection is closed once made
+    ResponseCache *cache = c->cache;
+    uint64_t now = now_ms();
+
+    return ipc_call(c, [&]() {
+        std::string key = std::string(method) + " " + parameters.serialize();
+        uint64_t clears = 0;
+
+        {
+            std::lock_guard<std::mutex> held(*c->lock);
+            std::map<std::string, ResponseCache::Entry>::iterator i =
+                cache->entries.find(key);
+
+            if (i != cache->entries.end() && now < i->second.expires) {
+                ++cache->hits[what];
+                response = i->second.response;
+                return;
+            }
+            ++cache->misses[what];
+            clears = cache->clears;
+        }
+
+        response = c->tp->rpc(method, parameters);
+
+        // Another thread may have changed something meanwhile
+        std::lock_guard<std::mutex> held(*c->lock);
+        if (clears == cache->clears) {
+            ResponseCache::Entry &e = cache->entries[key];
+            e.response = response;
+            e.expires = now + cache->ttl_ms[what];
+        }
+    });
+}
+
+/**
+ * Same as rpc, but the result is read by decode straight out of the
+ * response.  Anything decode throws is reported as a plug-in bug.
+ * @return error code of the call, else what decode returned
+ */
+static int
+rpc_decode(lsm_connect *c, const char *method, const Value &parameters,
+           const std::function<int(PayloadReader &)> &decode) throw() {
+    std::string bad;
+    int decoded = LSM_ERR_OK;
+    int rc = ipc_call(c, [&]() {
+        c->tp->rpcDecode(method, parameters, [&](PayloadReader &r) {
+            try {
+                decoded = decode(r);
+            } catch (const ValueException &ve) {
+                bad = ve.what();
+                throw;
+            }
+        });
+    });
+
+    if (!bad.empty()) {
+        return log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                             bad.c_str());
+    }
+    return (LSM_ERR_OK == rc) ? decoded : rc;
+}
+
 static int job_check(lsm_connect *c, int rc, Value &response, char **job) {
     try {
         if (LSM_ERR_OK == rc) {
@@ -286,18 +425,61 @@ static int job_check(lsm_connect *c, int rc, Value &response, char **job) {
     return rc;
 }
 
-static int get_access_groups(lsm_connect *c, int rc, Value &response,
-                             lsm_access_group **groups[], uint32_t *count) {
-    try {
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            rc = value_array_to_access_groups(response, groups, count);
+/**
+ * Converts a listing response into an array of records, nothing is handed
+ * back if any of them fails to convert.
+ */
+template <typename T>
+static int get_record_list(lsm_connect *c, int rc, Value &response,
+                           T **records[], uint32_t *count,
+                           int (*conv)(const Value &, T **[], uint32_t *)) {
+    *records = NULL;
+    *count = 0;
+
+    if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
+        rc = conv(response, records, count);
+        if (LSM_ERR_TRANSPORT_INVALID_ARG == rc) {
+            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", NULL);
         }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
     }
     return rc;
 }
 
+static int get_access_groups(lsm_connect *c, int rc, Value &response,
+                             lsm_access_group **groups[], uint32_t *count) {
+    return get_record_list(c, rc, response, groups, count,
+                           value_array_to_access_groups);
+}
+
+static int get_pool_array(lsm_connect *c, int rc, Value &response,
+                          lsm_pool **pools[], uint32_t *count) {
+    return get_record_list(c, rc, response, pools, count, value_array_to_pools);
+}
+
+static int get_system_array(lsm_connect *c, int rc, Value &response,
+                            lsm_system **systems[], uint32_t *count) {
+    return get_record_list(c, rc, response, systems, count,
+                           value_array_to_systems);
+}
+
+static int get_fs_array(lsm_connect *c, int rc, Value &response,
+                        lsm_fs **fs[], uint32_t *count) {
+    return get_record_list(c, rc, response, fs, count, value_array_to_fs);
+}
+
+static int get_target_port_array(lsm_connect *c, int rc, Value &response,
+                                 lsm_target_port **target_ports[],
+                                 uint32_t *count) {
+    return get_record_list(c, rc, response, target_ports, count,
+                           value_array_to_target_ports);
+}
+
+static int get_nfs_export_array(lsm_connect *c, int rc, Value &response,
+                                lsm_nfs_export **exports[], uint32_t *count) {
+    return get_record_list(c, rc, response, exports, count,
+                           value_array_to_nfs_exports);
+}
+
 static int add_search_params(std::map<std::string, Value> &p, const char *k,
                              const char *v, const char *const supported_keys[],
                              size_t supported_keys_count) {
@@ -362,7 +544,7 @@ int lsm_plugin_info_get(lsm_connect *c, char **desc, char **version,
         rc = rpc(c, "plugin_info", parameters, response);
 
         if (rc == LSM_ERR_OK) {
-            std::vector<Value> j = response.asArray();
+            const std::vector<Value> &j = response.asArray();
             *desc = strdup(j[0].asC_str());
             *version = strdup(j[1].asC_str());
 
@@ -541,7 +723,7 @@ static int job_status(lsm_connect *c, const char *job, lsm_job_status *status,
         rc = rpc(c, "job_status", parameters, response);
         if (LSM_ERR_OK == rc) {
             // We get back an array [status, percent, volume]
-            std::vector<Value> j = response.asArray();
+            const std::vector<Value> &j = response.asArray();
             *status = (lsm_job_status)j[0].asInt32_t();
             *percentComplete = (uint8_t)j[1].asUint32_t();
 
@@ -722,6 +904,119 @@ int lsm_job_free(lsm_connect *c, char **job, lsm_flag flags) {
     return rc;
 }
 
+/**
+ * Waits on jobs by polling their status, for plug-ins which can't wait on
+ * them.  Polls every 10ms at first, backing off to once a second.
+ */
+static int jobs_wait_poll(lsm_connect *c, const char *jobs[], uint32_t count,
+                          uint8_t percent, uint32_t timeout, uint32_t *index,
+                          lsm_job_status *status, uint8_t *percent_complete,
+                          lsm_flag flags) {
+    uint64_t deadline = now_ms() + timeout;
+    uint64_t interval = 10;
+
+    for (;;) {
+        bool ended = false;
+
+        *index = 0;
+        *status = LSM_JOB_INPROGRESS;
+        *percent_complete = 0;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            lsm_job_status s = LSM_JOB_INPROGRESS;
+            uint8_t done = 0;
+            Value rv;
+
+            int rc = job_status(c, jobs[i], &s, &done, rv, flags);
+            if (LSM_ERR_OK != rc) {
+                *index = i;
+                return rc;
+            }
+
+            if (ended) {
+                continue;
+            }
+            if (LSM_JOB_INPROGRESS != s || done >= percent) {
+                ended = true;
+                *index = i;
+                *status = s;
+                *percent_complete = done;
+            } else if (done > *percent_complete) {
+                *index = i;
+                *percent_complete = done;
+            }
+        }
+
+        uint64_t now = now_ms();
+        if (ended || now >= deadline) {
+            return LSM_ERR_OK;
+        }
+        usleep(1000 * std::min(interval, deadline - now));
+        interval = std::min(interval * 2, (uint64_t)1000);
+    }
+}
+
+int lsm_jobs_wait_any(lsm_connect *c, const char *job_ids[], uint32_t count,
+                      uint8_t percent, uint32_t timeout, uint32_t *index,
+                      lsm_job_status *status, uint8_t *percent_complete,
+                      lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    CONN_SETUP(c);
+
+    if (!job_ids || !count || percent > 100 || !index || !status ||
+        !percent_complete || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::vector<Value> jobs;
+    jobs.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (CHECK_STR(job_ids[i])) {
+            return LSM_ERR_INVALID_ARGUMENT;
+        }
+        jobs.push_back(Value(job_ids[i]));
+    }
+
+    std::map<std::string, Value> p;
+    p["job_ids"] = Value(std::move(jobs));
+    p["percent"] = Value(percent);
+    p["timeout"] = Value(timeout);
+    p["flags"] = Value(flags);
+    Value parameters(p);
+    Value response;
+
+    rc = rpc(c, "jobs_wait_any", parameters, response);
+    if (LSM_ERR_NO_SUPPORT == rc) {
+        return jobs_wait_poll(c, job_ids, count, percent, timeout, index,
+                              status, percent_complete, flags);
+    }
+    if (LSM_ERR_OK == rc) {
+        // We get back an array [index, status, percent]
+        const std::vector<Value> *r = NULL;
+        int32_t s = 0;
+        uint32_t done = 0;
+
+        if (!response.tryArray(r) || r->size() != 3 ||
+            !(*r)[0].tryUint32_t(*index) || *index >= count ||
+            !(*r)[1].tryInt32_t(s) || !(*r)[2].tryUint32_t(done)) {
+            return log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                                 "Malformed job wait response");
+        }
+        *status = (lsm_job_status)s;
+        *percent_complete = (uint8_t)done;
+    }
+    return rc;
+}
+
+int lsm_job_wait(lsm_connect *c, const char *job_id, uint8_t percent,
+                 uint32_t timeout, lsm_job_status *status,
+                 uint8_t *percent_complete, lsm_flag flags) {
+    uint32_t index = 0;
+
+    return lsm_jobs_wait_any(c, &job_id, 1, percent, timeout, &index, status,
+                             percent_complete, flags);
+}
+
 int lsm_capabilities(lsm_connect *c, lsm_system *system,
                      lsm_storage_capabilities **cap, lsm_flag flags) {
     int rc = LSM_ERR_OK;
@@ -741,7 +1036,8 @@ int lsm_capabilities(lsm_connect *c, lsm_system *system,
     Value response;
 
     try {
-        rc = rpc(c, "capabilities", parameters, response);
+        rc = cached_rpc(c, LSM_CACHE_CAPABILITIES, "capabilities", parameters,
+                        response);
 
         if (LSM_ERR_OK == rc && Value::object_t == response.valueType()) {
             *cap = value_to_capabilities(response);
@@ -758,7 +1054,6 @@ int lsm_capabilities(lsm_connect *c, lsm_system *system,
 
 int lsm_pool_list(lsm_connect *c, char *search_key, char *search_value,
                   lsm_pool **poolArray[], uint32_t *count, lsm_flag flags) {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
     if (!poolArray || !count || CHECK_RP(poolArray)) {
@@ -768,52 +1063,26 @@ int lsm_pool_list(lsm_connect *c, char *search_key, char *search_value,
     *count = 0;
     *poolArray = NULL;
 
-    try {
-        std::map<std::string, Value> p;
+    std::map<std::string, Value> p;
 
-        rc = add_search_params(p, search_key, search_value, POOL_SEARCH_KEYS,
+    int rc = add_search_params(p, search_key, search_value, POOL_SEARCH_KEYS,
                                POOL_SEARCH_KEYS_COUNT);
-        if (LSM_ERR_OK != rc) {
-            return rc;
-        }
-
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "pools", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> pools = response.asArray();
-
-            *count = pools.size();
-
-            if (pools.size()) {
-                *poolArray = lsm_pool_record_array_alloc(pools.size());
-
-                for (size_t i = 0; i < pools.size(); ++i) {
-                    (*poolArray)[i] = value_to_pool(pools[i]);
-                    if (!(*poolArray)[i]) {
-                        rc = LSM_ERR_NO_MEMORY;
-                        goto error;
-                    }
-                }
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
+    if (LSM_ERR_OK != rc) {
+        return rc;
     }
 
-out:
-    return rc;
+    p["flags"] = Value(flags);
+    Value parameters(p);
 
-error:
-    if (*poolArray && *count) {
-        lsm_pool_record_array_free(*poolArray, *count);
-        *poolArray = NULL;
-        *count = 0;
+    if (cache_on(c, LSM_CACHE_POOLS)) {
+        Value response;
+        rc = cached_rpc(c, LSM_CACHE_POOLS, "pools", parameters, response);
+        return get_pool_array(c, rc, response, poolArray, count);
     }
-    goto out;
+
+    return rpc_decode(c, "pools", parameters, [&](PayloadReader &r) {
+        return reader_array_to_pools(r, poolArray, count);
+    });
 }
 
 int lsm_pool_member_info(lsm_connect *c, lsm_pool *pool,
@@ -845,7 +1114,7 @@ int lsm_pool_member_info(lsm_connect *c, lsm_pool *pool,
 
         rc = rpc(c, "pool_member_info", parameters, response);
         if (LSM_ERR_OK == rc) {
-            std::vector<Value> j = response.asArray();
+            const std::vector<Value> &j = response.asArray();
             *raid_type = (lsm_volume_raid_type)j[0].asInt32_t();
             *member_type = (lsm_pool_member_type)j[1].asInt32_t();
             *member_ids = NULL;
@@ -877,71 +1146,36 @@ int lsm_target_port_list(lsm_connect *c, const char *search_key,
                          const char *search_value,
                          lsm_target_port **target_ports[], uint32_t *count,
                          lsm_flag flags) {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
     if (!target_ports || !count || CHECK_RP(target_ports)) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    try {
-        std::map<std::string, Value> p;
+    *count = 0;
+    *target_ports = NULL;
+
+    std::map<std::string, Value> p;
 
-        rc = add_search_params(p, search_key, search_value,
+    int rc = add_search_params(p, search_key, search_value,
                                TARGET_PORT_SEARCH_KEYS,
                                TARGET_PORT_SEARCH_KEYS_COUNT);
-        if (LSM_ERR_OK != rc) {
-            return rc;
-        }
-
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "target_ports", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> tp = response.asArray();
-
-            *count = tp.size();
-
-            if (tp.size()) {
-                *target_ports = lsm_target_port_record_array_alloc(tp.size());
-
-                for (size_t i = 0; i < tp.size(); ++i) {
-                    (*target_ports)[i] = value_to_target_port(tp[i]);
-                    if (!((*target_ports)[i])) {
-                        rc = LSM_ERR_NO_MEMORY;
-                        goto error;
-                    }
-                }
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
+    if (LSM_ERR_OK != rc) {
+        return rc;
     }
-out:
-    return rc;
 
-error:
-    if (*target_ports && *count) {
-        lsm_target_port_record_array_free(*target_ports, *count);
-        *target_ports = NULL;
-        *count = 0;
-    }
-    goto out;
+    p["flags"] = Value(flags);
+    Value parameters(p);
+
+    return rpc_decode(c, "target_ports", parameters, [&](PayloadReader &r) {
+        return reader_array_to_target_ports(r, target_ports, count);
+    });
 }
 
 static int get_volume_array(lsm_connect *c, int rc, Value &response,
                             lsm_volume **volumes[], uint32_t *count) {
-    if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-        try {
-            rc = value_array_to_volumes(response, volumes, count);
-        } catch (const ValueException &ve) {
-            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Wrong type", ve.what());
-        }
-    }
-    return rc;
+    return get_record_list(c, rc, response, volumes, count,
+                           value_array_to_volumes);
 }
 
 int lsm_volume_list(lsm_connect *c, const char *search_key,
@@ -963,23 +1197,16 @@ int lsm_volume_list(lsm_connect *c, const char *search_key,
     }
 
     Value parameters(p);
-    Value response;
 
-    rc = rpc(c, "volumes", parameters, response);
-    return get_volume_array(c, rc, response, volumes, count);
+    return rpc_decode(c, "volumes", parameters, [&](PayloadReader &r) {
+        return reader_array_to_volumes(r, volumes, count);
+    });
 }
 
 static int get_disk_array(lsm_connect *c, int rc, Value &response,
                           lsm_disk **disks[], uint32_t *count) {
-    if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-        rc = value_array_to_disks(response, disks, count);
-
-        if (LSM_ERR_OK != rc) {
-            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", NULL);
-        }
-    }
-
-    return rc;
+    return get_record_list(c, rc, response, disks, count,
+                           value_array_to_disks);
 }
 
 int lsm_disk_list(lsm_connect *c, const char *search_key,
@@ -1001,52 +1228,56 @@ int lsm_disk_list(lsm_connect *c, const char *search_key,
     }
 
     Value parameters(p);
-    Value response;
 
-    rc = rpc(c, "disks", parameters, response);
-    return get_disk_array(c, rc, response, disks, count);
+    return rpc_decode(c, "disks", parameters, [&](PayloadReader &r) {
+        return reader_array_to_disks(r, disks, count);
+    });
 }
 
-typedef void *(*convert)(Value &v);
+/**
+ * Reads a [job, record] response, either of which may be null.  A bad
+ * response is reported as a plug-in bug.
+ * @return record, else NULL when there is none or on error
+ */
+template <typename T>
+static T *parse_job_response(lsm_connect *c, const Value &response, int &rc,
+                             char **job, int (*conv)(const Value &, T **)) {
+    const std::vector<Value> *r = NULL;
+    const char *job_id = NULL;
+    T *val = NULL;
 
-static void *parse_job_response(lsm_connect *c, Value response, int &rc,
-                                char **job, convert conv) {
-    void *val = NULL;
     *job = NULL;
 
-    try {
-        // We get an array back. first value is job, second is data of interest.
-        if (Value::array_t == response.valueType()) {
-            std::vector<Value> r = response.asArray();
-            if (Value::string_t == r[0].valueType()) {
-                *job = strdup((r[0].asString()).c_str());
-                if (!(*job)) {
-                    rc = LSM_ERR_NO_MEMORY;
-                    goto error;
-                }
+    if (!response.tryArray(r)) {
+        return NULL;
+    }
+    if (r->size() < 2) {
+        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", NULL);
+        return NULL;
+    }
 
-                rc = LSM_ERR_JOB_STARTED;
-            }
-            if (Value::object_t == r[1].valueType()) {
-                val = conv(r[1]);
-                if (!val) {
-                    rc = LSM_ERR_NO_MEMORY;
-                    goto error;
-                }
-            }
+    // First value is job, second is data of interest.
+    if ((*r)[0].tryC_str(job_id) && job_id) {
+        *job = strdup(job_id);
+        if (!(*job)) {
+            rc = LSM_ERR_NO_MEMORY;
+            return NULL;
         }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
-    }
 
-out:
+        rc = LSM_ERR_JOB_STARTED;
+    }
+    if (Value::object_t == (*r)[1].valueType()) {
+        int conv_rc = conv((*r)[1], &val);
+        if (LSM_ERR_OK != conv_rc) {
+            rc = (LSM_ERR_TRANSPORT_INVALID_ARG == conv_rc)
+                     ? log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                                     NULL)
+                     : conv_rc;
+            free(*job);
+            *job = NULL;
+        }
+    }
     return val;
-
-error:
-    free(*job);
-    *job = NULL;
-    goto out;
 }
 
 int lsm_volume_create(lsm_connect *c, lsm_pool *pool, const char *volumeName,
@@ -1075,8 +1306,7 @@ int lsm_volume_create(lsm_connect *c, lsm_pool *pool, const char *volumeName,
 
     int rc = rpc(c, "volume_create", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *newVolume = (lsm_volume *)parse_job_response(
-            c, std::move(response), rc, job, (convert)value_to_volume);
+        *newVolume = parse_job_response(c, response, rc, job, value_to_volume);
     }
     return rc;
 }
@@ -1107,8 +1337,8 @@ int lsm_volume_resize(lsm_connect *c, lsm_volume *volume, uint64_t newSize,
 
     int rc = rpc(c, "volume_resize", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *resizedVolume = (lsm_volume *)parse_job_response(
-            c, std::move(response), rc, job, (convert)value_to_volume);
+        *resizedVolume =
+            parse_job_response(c, response, rc, job, value_to_volume);
     }
     return rc;
 }
@@ -1140,8 +1370,8 @@ int lsm_volume_replicate(lsm_connect *c, lsm_pool *pool,
 
     int rc = rpc(c, "volume_replicate", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *newReplicant = (lsm_volume *)parse_job_response(
-            c, std::move(response), rc, job, (convert)value_to_volume);
+        *newReplicant =
+            parse_job_response(c, response, rc, job, value_to_volume);
     }
     return rc;
 }
@@ -1237,35 +1467,140 @@ int lsm_volume_delete(lsm_connect *c, lsm_volume *volume, char **job,
     return rc;
 }
 
-int lsm_volume_raid_info(lsm_connect *c, lsm_volume *volume,
-                         lsm_volume_raid_type *raid_type, uint32_t *strip_size,
-                         uint32_t *disk_count, uint32_t *min_io_size,
-                         uint32_t *opt_io_size, lsm_flag flags) {
-    if (LSM_FLAG_UNUSED_CHECK(flags)) {
-        return LSM_ERR_INVALID_ARGUMENT;
+static Value volumes_to_value(lsm_volume *volumes[], uint32_t count) {
+    std::vector<Value> v;
+    v.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        v.push_back(volume_to_value(volumes[i]));
     }
+    return Value(std::move(v));
+}
 
-    int rc = LSM_ERR_OK;
-    CONN_SETUP(c);
+static bool volumes_valid(lsm_volume *volumes[], uint32_t count) {
+    if (!volumes || !count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!LSM_IS_VOL(volumes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    if (!LSM_IS_VOL(volume)) {
-        return LSM_ERR_INVALID_ARGUMENT;
+/**
+ * Copies out the error code of each item of a bulk call.
+ * @param[in]  c        Connection, for logging
+ * @param[in]  v        Array of error codes the plug-in sent
+ * @param[in]  count    Number of items the call was made with
+ * @param[out] results  Array of count codes, allocated with malloc
+ * @return LSM_ERR_OK, else error reason
+ */
+static int bulk_results_get(lsm_connect *c, const Value &v, uint32_t count,
+                            int32_t **results) {
+    const std::vector<Value> *codes = NULL;
+
+    if (!v.tryArray(codes) || codes->size() != count) {
+        return log_exception(c, LSM_ERR_PLUGIN_BUG,
+                             "Bulk results don't match the items", NULL);
     }
 
-    if (!raid_type || !strip_size || !disk_count || !min_io_size ||
-        !opt_io_size) {
-        return LSM_ERR_INVALID_ARGUMENT;
+    int32_t *r = (int32_t *)malloc(sizeof(int32_t) * count);
+    if (!r) {
+        return LSM_ERR_NO_MEMORY;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!(*codes)[i].tryInt32_t(r[i])) {
+            free(r);
+            return log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                                 NULL);
+        }
     }
+    *results = r;
+    return LSM_ERR_OK;
+}
 
-    try {
+int lsm_volume_delete_bulk(lsm_connect *c, lsm_volume *volumes[],
+                           uint32_t count, int32_t **results,
+                           lsm_string_list **jobs, lsm_flag flags) {
+    CONN_SETUP(c);
 
-        Value parameters = _create_volume_flag_param(volume, flags);
-        Value response;
+    if (!volumes_valid(volumes, count) || CHECK_RP(results) ||
+        CHECK_RP(jobs) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, Value> p;
+    p["volumes"] = volumes_to_value(volumes, count);
+    p["flags"] = Value(flags);
+
+    Value parameters(std::move(p));
+    Value response;
+
+    int rc = rpc(c, "volume_delete_bulk", parameters, response);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    // [error code of each volume, job of each volume or null]
+    const std::vector<Value> *parts = NULL;
+    const std::vector<Value> *job_values = NULL;
+    if (!response.tryArray(parts) || parts->size() != 2 ||
+        !(*parts)[1].tryArray(job_values) || job_values->size() != count) {
+        return log_exception(c, LSM_ERR_PLUGIN_BUG,
+                             "Bulk results don't match the items", NULL);
+    }
+
+    lsm_string_list *j = lsm_string_list_alloc(0);
+    if (!j) {
+        return LSM_ERR_NO_MEMORY;
+    }
+    for (uint32_t i = 0; i < count && LSM_ERR_OK == rc; ++i) {
+        const char *job = NULL;
+        (*job_values)[i].tryC_str(job);
+        rc = lsm_string_list_append(j, job ? job : "");
+    }
+
+    if (LSM_ERR_OK == rc) {
+        rc = bulk_results_get(c, (*parts)[0], count, results);
+    }
+    if (LSM_ERR_OK == rc) {
+        *jobs = j;
+    } else {
+        lsm_string_list_free(j);
+    }
+    return rc;
+}
+
+int lsm_volume_raid_info(lsm_connect *c, lsm_volume *volume,
+                         lsm_volume_raid_type *raid_type, uint32_t *strip_size,
+                         uint32_t *disk_count, uint32_t *min_io_size,
+                         uint32_t *opt_io_size, lsm_flag flags) {
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    int rc = LSM_ERR_OK;
+    CONN_SETUP(c);
+
+    if (!LSM_IS_VOL(volume)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    if (!raid_type || !strip_size || !disk_count || !min_io_size ||
+        !opt_io_size) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    try {
+
+        Value parameters = _create_volume_flag_param(volume, flags);
+        Value response;
 
         rc = rpc(c, "volume_raid_info", parameters, response);
         if (LSM_ERR_OK == rc) {
             // We get a value back, either null or job id.
-            std::vector<Value> j = response.asArray();
+            const std::vector<Value> &j = response.asArray();
             *raid_type = (lsm_volume_raid_type)j[0].asInt32_t();
             *strip_size = j[1].asUint32_t();
             *disk_count = j[2].asUint32_t();
@@ -1340,6 +1675,9 @@ int lsm_access_group_list(lsm_connect *c, const char *search_key,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
+    *groupCount = 0;
+    *groups = NULL;
+
     std::map<std::string, Value> p;
 
     int rc =
@@ -1351,10 +1689,10 @@ int lsm_access_group_list(lsm_connect *c, const char *search_key,
 
     p["flags"] = Value(flags);
     Value parameters(p);
-    Value response;
 
-    rc = rpc(c, "access_groups", parameters, response);
-    return get_access_groups(c, rc, response, groups, groupCount);
+    return rpc_decode(c, "access_groups", parameters, [&](PayloadReader &r) {
+        return reader_array_to_access_groups(r, groups, groupCount);
+    });
 }
 
 int lsm_access_group_create(lsm_connect *c, const char *name,
@@ -1489,6 +1827,69 @@ int lsm_access_group_initiator_delete(lsm_connect *c,
                               "access_group_initiator_delete");
 }
 
+int lsm_access_group_initiator_add_bulk(
+    lsm_connect *c, lsm_access_group *access_group, lsm_string_list *init_ids,
+    lsm_access_group_init_type init_type, int32_t **results,
+    lsm_access_group **updated_access_group, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    uint32_t count = lsm_string_list_size(init_ids);
+
+    if (!LSM_IS_ACCESS_GROUP(access_group) || !count || CHECK_RP(results) ||
+        CHECK_RP(updated_access_group) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::vector<Value> ids;
+    ids.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        Value id;
+        const char *init_id = lsm_string_list_elem_get(init_ids, i);
+        if (CHECK_STR(init_id) ||
+            LSM_ERR_OK != verify_initiator_id(init_id, init_type, id)) {
+            return LSM_ERR_INVALID_ARGUMENT;
+        }
+        ids.push_back(std::move(id));
+    }
+
+    std::map<std::string, Value> p;
+    p["access_group"] = access_group_to_value(access_group);
+    p["init_ids"] = Value(std::move(ids));
+    p["init_type"] = Value((int32_t)init_type);
+    p["flags"] = Value(flags);
+
+    Value parameters(std::move(p));
+    Value response;
+
+    int rc = rpc(c, "access_group_initiator_add_bulk", parameters, response);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    // [error code of each initiator, access group]
+    const std::vector<Value> *parts = NULL;
+    if (!response.tryArray(parts) || parts->size() != 2) {
+        return log_exception(c, LSM_ERR_PLUGIN_BUG,
+                             "Bulk results don't match the items", NULL);
+    }
+
+    lsm_access_group *ag = NULL;
+    rc = value_to_access_group((*parts)[1], &ag);
+    if (LSM_ERR_TRANSPORT_INVALID_ARG == rc) {
+        return log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", NULL);
+    } else if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    rc = bulk_results_get(c, (*parts)[0], count, results);
+    if (LSM_ERR_OK == rc) {
+        *updated_access_group = ag;
+    } else {
+        lsm_access_group_record_free(ag);
+    }
+    return rc;
+}
+
 int lsm_volume_mask(lsm_connect *c, lsm_access_group *access_group,
                     lsm_volume *volume, lsm_flag flags) {
     CONN_SETUP(c);
@@ -1529,6 +1930,48 @@ int lsm_volume_unmask(lsm_connect *c, lsm_access_group *group,
     return rpc(c, "volume_unmask", parameters, response);
 }
 
+static int volume_mask_bulk_common(lsm_connect *c,
+                                   lsm_access_group *access_group,
+                                   lsm_volume *volumes[], uint32_t count,
+                                   int32_t **results, lsm_flag flags,
+                                   const char *method) {
+    CONN_SETUP(c);
+
+    if (!LSM_IS_ACCESS_GROUP(access_group) ||
+        !volumes_valid(volumes, count) || CHECK_RP(results) ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, Value> p;
+    p["access_group"] = access_group_to_value(access_group);
+    p["volumes"] = volumes_to_value(volumes, count);
+    p["flags"] = Value(flags);
+
+    Value parameters(std::move(p));
+    Value response;
+
+    int rc = rpc(c, method, parameters, response);
+    if (LSM_ERR_OK == rc) {
+        rc = bulk_results_get(c, response, count, results);
+    }
+    return rc;
+}
+
+int lsm_volume_mask_bulk(lsm_connect *c, lsm_access_group *access_group,
+                         lsm_volume *volumes[], uint32_t count,
+                         int32_t **results, lsm_flag flags) {
+    return volume_mask_bulk_common(c, access_group, volumes, count, results,
+                                   flags, "volume_mask_bulk");
+}
+
+int lsm_volume_unmask_bulk(lsm_connect *c, lsm_access_group *access_group,
+                           lsm_volume *volumes[], uint32_t count,
+                           int32_t **results, lsm_flag flags) {
+    return volume_mask_bulk_common(c, access_group, volumes, count, results,
+                                   flags, "volume_unmask_bulk");
+}
+
 int lsm_volumes_accessible_by_access_group(lsm_connect *c,
                                            lsm_access_group *group,
                                            lsm_volume **volumes[],
@@ -1551,7 +1994,7 @@ int lsm_volumes_accessible_by_access_group(lsm_connect *c,
 
         rc = rpc(c, "volumes_accessible_by_access_group", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> vol = response.asArray();
+            const std::vector<Value> &vol = response.asArray();
 
             *count = vol.size();
 
@@ -1673,116 +2116,57 @@ int lsm_volume_child_dependency_delete(lsm_connect *c, lsm_volume *volume,
 
 int lsm_system_list(lsm_connect *c, lsm_system **systems[],
                     uint32_t *systemCount, lsm_flag flags) {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
     if (!systems || !systemCount) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    try {
-        std::map<std::string, Value> p;
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "systems", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> sys = response.asArray();
-
-            *systemCount = sys.size();
+    *systemCount = 0;
+    *systems = NULL;
 
-            if (sys.size()) {
-                *systems = lsm_system_record_array_alloc(sys.size());
+    std::map<std::string, Value> p;
+    p["flags"] = Value(flags);
+    Value parameters(p);
 
-                if (*systems) {
-                    for (size_t i = 0; i < sys.size(); ++i) {
-                        (*systems)[i] = value_to_system(sys[i]);
-                        if (!(*systems)[i]) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
-                } else {
-                    rc = LSM_ERR_NO_MEMORY;
-                }
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
+    if (cache_on(c, LSM_CACHE_SYSTEMS)) {
+        Value response;
+        int rc = cached_rpc(c, LSM_CACHE_SYSTEMS, "systems", parameters,
+                            response);
+        return get_system_array(c, rc, response, systems, systemCount);
     }
-out:
-    return rc;
 
-error:
-    if (*systems) {
-        lsm_system_record_array_free(*systems, *systemCount);
-        *systems = NULL;
-        *systemCount = 0;
-    }
-    goto out;
+    return rpc_decode(c, "systems", parameters, [&](PayloadReader &r) {
+        return reader_array_to_systems(r, systems, systemCount);
+    });
 }
 
 int lsm_fs_list(lsm_connect *c, const char *search_key,
                 const char *search_value, lsm_fs **fs[], uint32_t *fsCount,
                 lsm_flag flags) {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
     if (!fs || !fsCount) {
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    try {
-        std::map<std::string, Value> p;
-
-        rc = add_search_params(p, search_key, search_value, FS_SEARCH_KEYS,
-                               FS_SEARCH_KEYS_COUNT);
-        if (LSM_ERR_OK != rc) {
-            return rc;
-        }
-
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "fs", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> sys = response.asArray();
-
-            *fsCount = sys.size();
+    *fsCount = 0;
+    *fs = NULL;
 
-            if (sys.size()) {
-                *fs = lsm_fs_record_array_alloc(sys.size());
+    std::map<std::string, Value> p;
 
-                if (*fs) {
-                    for (size_t i = 0; i < sys.size(); ++i) {
-                        (*fs)[i] = value_to_fs(sys[i]);
-                        if (!((*fs)[i])) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
-                } else {
-                    rc = LSM_ERR_NO_MEMORY;
-                }
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
+    int rc = add_search_params(p, search_key, search_value, FS_SEARCH_KEYS,
+                               FS_SEARCH_KEYS_COUNT);
+    if (LSM_ERR_OK != rc) {
+        return rc;
     }
-out:
-    return rc;
 
-error:
-    if (*fs && *fsCount) {
-        lsm_fs_record_array_free(*fs, *fsCount);
-        *fs = NULL;
-        *fsCount = 0;
-    }
-    goto out;
+    p["flags"] = Value(flags);
+    Value parameters(p);
+
+    return rpc_decode(c, "fs", parameters, [&](PayloadReader &r) {
+        return reader_array_to_fs(r, fs, fsCount);
+    });
 }
 
 int lsm_fs_create(lsm_connect *c, lsm_pool *pool, const char *name,
@@ -1810,8 +2194,7 @@ int lsm_fs_create(lsm_connect *c, lsm_pool *pool, const char *name,
 
     int rc = rpc(c, "fs_create", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *fs = (lsm_fs *)parse_job_response(c, std::move(response), rc, job,
-                                           (convert)value_to_fs);
+        *fs = parse_job_response(c, response, rc, job, value_to_fs);
     }
     return rc;
 }
@@ -1856,8 +2239,7 @@ int lsm_fs_resize(lsm_connect *c, lsm_fs *fs, uint64_t new_size_bytes,
 
     int rc = rpc(c, "fs_resize", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *rfs = (lsm_fs *)parse_job_response(c, std::move(response), rc, job,
-                                            (convert)value_to_fs);
+        *rfs = parse_job_response(c, response, rc, job, value_to_fs);
     }
     return rc;
 }
@@ -1883,8 +2265,7 @@ int lsm_fs_clone(lsm_connect *c, lsm_fs *src_fs, const char *name,
 
     int rc = rpc(c, "fs_clone", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *cloned_fs = (lsm_fs *)parse_job_response(c, std::move(response), rc,
-                                                  job, (convert)value_to_fs);
+        *cloned_fs = parse_job_response(c, response, rc, job, value_to_fs);
     }
     return rc;
 }
@@ -2000,7 +2381,7 @@ int lsm_fs_ss_list(lsm_connect *c, lsm_fs *fs, lsm_fs_ss **ss[],
     try {
         rc = rpc(c, "fs_snapshots", parameters, response);
         if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> sys = response.asArray();
+            const std::vector<Value> &sys = response.asArray();
 
             *ssCount = sys.size();
 
@@ -2060,8 +2441,7 @@ int lsm_fs_ss_create(lsm_connect *c, lsm_fs *fs, const char *name,
 
     int rc = rpc(c, "fs_snapshot_create", parameters, response);
     if (LSM_ERR_OK == rc) {
-        *snapshot = (lsm_fs_ss *)parse_job_response(c, std::move(response), rc,
-                                                    job, (convert)value_to_ss);
+        *snapshot = parse_job_response(c, response, rc, job, value_to_ss);
     }
     return rc;
 }
@@ -2141,7 +2521,6 @@ int lsm_fs_ss_restore(lsm_connect *c, lsm_fs *fs, lsm_fs_ss *ss,
 int lsm_nfs_list(lsm_connect *c, const char *search_key,
                  const char *search_value, lsm_nfs_export **exports[],
                  uint32_t *count, lsm_flag flags) {
-    int rc = LSM_ERR_OK;
     CONN_SETUP(c);
 
     if (CHECK_RP(exports) || !count) {
@@ -2151,56 +2530,21 @@ int lsm_nfs_list(lsm_connect *c, const char *search_key,
     *count = 0;
     *exports = NULL;
 
-    try {
-        std::map<std::string, Value> p;
+    std::map<std::string, Value> p;
 
-        rc = add_search_params(p, search_key, search_value,
+    int rc = add_search_params(p, search_key, search_value,
                                NFS_EXPORT_SEARCH_KEYS,
                                NFS_EXPORT_SEARCH_KEYS_COUNT);
-        if (LSM_ERR_OK != rc) {
-            return rc;
-        }
-
-        p["flags"] = Value(flags);
-        Value parameters(p);
-        Value response;
-
-        rc = rpc(c, "exports", parameters, response);
-        if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-            std::vector<Value> exps = response.asArray();
-
-            *count = exps.size();
-
-            if (*count) {
-                *exports = lsm_nfs_export_record_array_alloc(*count);
-
-                if (*exports) {
-                    for (size_t i = 0; i < *count; ++i) {
-                        (*exports)[i] = value_to_nfs_export(exps[i]);
-                        if (!((*exports)[i])) {
-                            rc = LSM_ERR_NO_MEMORY;
-                            goto error;
-                        }
-                    }
-                } else {
-                    rc = LSM_ERR_NO_MEMORY;
-                }
-            }
-        }
-    } catch (const ValueException &ve) {
-        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
-        goto error;
+    if (LSM_ERR_OK != rc) {
+        return rc;
     }
-out:
-    return rc;
 
-error:
-    if (*exports && *count) {
-        lsm_nfs_export_record_array_free(*exports, *count);
-        *exports = NULL;
-        *count = 0;
-    }
-    goto out;
+    p["flags"] = Value(flags);
+    Value parameters(p);
+
+    return rpc_decode(c, "exports", parameters, [&](PayloadReader &r) {
+        return reader_array_to_nfs_exports(r, exports, count);
+    });
 }
 
 int lsm_nfs_export_fs(lsm_connect *c, const char *fs_id,
@@ -2322,7 +2666,7 @@ int lsm_volume_raid_create_cap_get(lsm_connect *c, lsm_system *system,
         return rc;
     }
     try {
-        std::vector<Value> j = response.asArray();
+        const std::vector<Value> &j = response.asArray();
 
         rc = values_to_uint32_array(j[0], supported_raid_types,
                                     supported_raid_type_count);
@@ -2494,15 +2838,8 @@ int lsm_system_read_cache_pct_update(lsm_connect *c, lsm_system *system,
 
 static int get_battery_array(lsm_connect *c, int rc, Value &response,
                              lsm_battery **bs[], uint32_t *count) {
-    if (LSM_ERR_OK == rc && Value::array_t == response.valueType()) {
-        try {
-            rc = value_array_to_batteries(response, bs, count);
-        } catch (const ValueException &ve) {
-            rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", NULL);
-        }
-    }
-
-    return rc;
+    return get_record_list(c, rc, response, bs, count,
+                           value_array_to_batteries);
 }
 
 int lsm_battery_list(lsm_connect *c, const char *search_key,
@@ -2514,6 +2851,9 @@ int lsm_battery_list(lsm_connect *c, const char *search_key,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
+    *count = 0;
+    *bs = NULL;
+
     std::map<std::string, Value> p;
     p["flags"] = Value(flags);
 
@@ -2524,10 +2864,10 @@ int lsm_battery_list(lsm_connect *c, const char *search_key,
     }
 
     Value parameters(p);
-    Value response;
 
-    rc = rpc(c, "batteries", parameters, response);
-    return get_battery_array(c, rc, response, bs, count);
+    return rpc_decode(c, "batteries", parameters, [&](PayloadReader &r) {
+        return reader_array_to_batteries(r, bs, count);
+    });
 }
 
 int lsm_volume_cache_info(lsm_connect *c, lsm_volume *volume,
@@ -2555,7 +2895,7 @@ int lsm_volume_cache_info(lsm_connect *c, lsm_volume *volume,
 
         rc = rpc(c, "volume_cache_info", parameters, response);
         if (LSM_ERR_OK == rc) {
-            std::vector<Value> j = response.asArray();
+            const std::vector<Value> &j = response.asArray();
             *write_cache_policy = j[0].asUint32_t();
             *write_cache_status = j[1].asUint32_t();
             *read_cache_policy = j[2].asUint32_t();
@@ -2640,3 +2980,679 @@ int lsm_volume_read_cache_policy_update(lsm_connect *c, lsm_volume *volume,
     // No response data.
     return rpc(c, "volume_read_cache_policy_update", parameters, response);
 }
+
+/**
+ * Plug-in method and search keys of each lsm_rpc_method, indexed by it.
+ */
+static const struct {
+    const char *method;
+    const char *const *search_keys;
+    size_t search_keys_count;
+} RPC_LIST_METHODS[] = {
+    {NULL, NULL, 0},
+    {"systems", NULL, 0},
+    {"pools", POOL_SEARCH_KEYS, POOL_SEARCH_KEYS_COUNT},
+    {"volumes", VOLUME_SEARCH_KEYS, VOLUME_SEARCH_KEYS_COUNT},
+    {"disks", DISK_SEARCH_KEYS, DISK_SEARCH_KEYS_COUNT},
+    {"fs", FS_SEARCH_KEYS, FS_SEARCH_KEYS_COUNT},
+    {"access_groups", ACCESS_GROUP_SEARCH_KEYS,
+     ACCESS_GROUP_SEARCH_KEYS_COUNT},
+    {"target_ports", TARGET_PORT_SEARCH_KEYS, TARGET_PORT_SEARCH_KEYS_COUNT},
+    {"batteries", BATTERY_SEARCH_KEYS, BATTERY_SEARCH_KEYS_COUNT},
+};
+
+int lsm_connect_fd_get(lsm_connect *c, int *fd, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (!fd || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    *fd = c->tp->fdGet();
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_stats_get(lsm_connect *c, lsm_rpc_stats **stats[],
+                          uint32_t *count, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (CHECK_RP(stats) || !count || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, RpcStats> all = c->tp->statsGet();
+    std::map<std::string, RpcStats>::const_iterator i;
+    uint32_t n = 0;
+
+    *count = 0;
+    if (all.empty()) {
+        return LSM_ERR_OK;
+    }
+
+    *stats = lsm_rpc_stats_record_array_alloc(all.size());
+    if (!*stats) {
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    for (i = all.begin(); i != all.end(); ++i) {
+        (*stats)[n] = lsm_rpc_stats_record_alloc(i->first.c_str(), i->second);
+        if (!(*stats)[n]) {
+            lsm_rpc_stats_record_array_free(*stats, n);
+            *stats = NULL;
+            return LSM_ERR_NO_MEMORY;
+        }
+        ++n;
+    }
+
+    *count = n;
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_stats_reset(lsm_connect *c, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    c->tp->statsReset();
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_cache_ttl_set(lsm_connect *c, lsm_cache_class what,
+                              uint32_t ttl_ms, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (what < LSM_CACHE_SYSTEMS || what > LSM_CACHE_CAPABILITIES ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> held(*c->lock);
+    if (!c->cache) {
+        c->cache = new (std::nothrow) ResponseCache;
+        if (!c->cache) {
+            return LSM_ERR_NO_MEMORY;
+        }
+    }
+
+    c->cache->ttl_ms[what] = ttl_ms;
+    c->cache->clear();
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_cache_stats_get(lsm_connect *c, lsm_cache_class what,
+                                uint64_t *hits, uint64_t *misses,
+                                lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (what < LSM_CACHE_SYSTEMS || what > LSM_CACHE_CAPABILITIES || !hits ||
+        !misses || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> held(*c->lock);
+    *hits = c->cache ? c->cache->hits[what] : 0;
+    *misses = c->cache ? c->cache->misses[what] : 0;
+    return LSM_ERR_OK;
+}
+
+int lsm_connect_cache_clear(lsm_connect *c, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> held(*c->lock);
+    if (c->cache) {
+        c->cache->clear();
+    }
+    return LSM_ERR_OK;
+}
+
+int lsm_rpc_submit(lsm_connect *c, lsm_rpc_method method,
+                   const char *search_key, const char *search_value,
+                   uint32_t *rpc_id, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (!rpc_id || method < LSM_RPC_SYSTEM_LIST ||
+        method > LSM_RPC_BATTERY_LIST) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, Value> p;
+    p["flags"] = Value(flags);
+
+    if (RPC_LIST_METHODS[method].search_keys_count) {
+        int rc = add_search_params(p, search_key, search_value,
+                                   RPC_LIST_METHODS[method].search_keys,
+                                   RPC_LIST_METHODS[method].search_keys_count);
+        if (LSM_ERR_OK != rc) {
+            return rc;
+        }
+    } else if (search_key) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    {
+        std::lock_guard<std::mutex> held(*c->lock);
+        if (!c->submitted) {
+            c->submitted =
+                new (std::nothrow) std::map<uint32_t, lsm_rpc_method>;
+            if (!c->submitted) {
+                return LSM_ERR_NO_MEMORY;
+            }
+        }
+    }
+
+    Value parameters(p);
+    uint32_t id = 0;
+
+    int rc = ipc_call(c, [&]() {
+        id = c->tp->requestSubmit(RPC_LIST_METHODS[method].method, parameters,
+                                  false, 0, true);
+    });
+    if (LSM_ERR_OK == rc) {
+        std::lock_guard<std::mutex> held(*c->lock);
+        (*c->submitted)[id] = method;
+        *rpc_id = id;
+    }
+    return rc;
+}
+
+int lsm_rpc_poll_complete(lsm_connect *c, uint32_t *rpc_id, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (!rpc_id || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    *rpc_id = 0;
+    return ipc_call(c, [&]() {
+        uint32_t id = 0;
+        if (c->tp->responsePoll(id)) {
+            *rpc_id = id;
+        }
+    });
+}
+
+/**
+ * Collects the response to a request sent with lsm_rpc_submit, which has to
+ * have been sent for the listing the caller expects.
+ */
+static int rpc_complete(lsm_connect *c, uint32_t rpc_id, lsm_rpc_method method,
+                        Value &response) {
+    std::map<uint32_t, lsm_rpc_method>::iterator i;
+
+    {
+        std::lock_guard<std::mutex> held(*c->lock);
+        if (!c->submitted ||
+            (i = c->submitted->find(rpc_id)) == c->submitted->end() ||
+            i->second != method) {
+            return LSM_ERR_INVALID_ARGUMENT;
+        }
+        c->submitted->erase(i);
+    }
+
+    return ipc_call(c, [&]() { response = c->tp->responseWait(rpc_id); });
+}
+
+#define RPC_LIST_COMPLETE(name, type, method, get_array)                       \
+    int lsm_rpc_##name##_list_complete(lsm_connect *c, uint32_t rpc_id,        \
+                                       type **records[], uint32_t *count,      \
+                                       lsm_flag flags) {                       \
+        CONN_SETUP(c);                                                         \
+                                                                               \
+        if (CHECK_RP(records) || !count || LSM_FLAG_UNUSED_CHECK(flags)) {     \
+            return LSM_ERR_INVALID_ARGUMENT;                                   \
+        }                                                                      \
+                                                                               \
+        *count = 0;                                                            \
+        Value response;                                                        \
+        int rc = rpc_complete(c, rpc_id, method, response);                    \
+        return get_array(c, rc, response, records, count);                     \
+    }
+
+RPC_LIST_COMPLETE(system, lsm_system, LSM_RPC_SYSTEM_LIST, get_system_array)
+RPC_LIST_COMPLETE(pool, lsm_pool, LSM_RPC_POOL_LIST, get_pool_array)
+RPC_LIST_COMPLETE(volume, lsm_volume, LSM_RPC_VOLUME_LIST, get_volume_array)
+RPC_LIST_COMPLETE(disk, lsm_disk, LSM_RPC_DISK_LIST, get_disk_array)
+RPC_LIST_COMPLETE(fs, lsm_fs, LSM_RPC_FS_LIST, get_fs_array)
+RPC_LIST_COMPLETE(access_group, lsm_access_group, LSM_RPC_ACCESS_GROUP_LIST,
+                  get_access_groups)
+RPC_LIST_COMPLETE(target_port, lsm_target_port, LSM_RPC_TARGET_PORT_LIST,
+                  get_target_port_array)
+RPC_LIST_COMPLETE(battery, lsm_battery, LSM_RPC_BATTERY_LIST,
+                  get_battery_array)
+
+/*
+ * Records the plug-in is asked to send per part of a listing read with an
+ * lsm_list_iter, enough to keep the per message overhead down while only
+ * a small part of a large listing is held at any time.
+ */
+#define LIST_ITER_CHUNK 256
+
+static int list_iter_open(lsm_connect *c, lsm_rpc_method method,
+                          const char *search_key, const char *search_value,
+                          lsm_list_iter **iter, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (CHECK_RP(iter)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, Value> p;
+    p["flags"] = Value(flags);
+
+    int rc = add_search_params(p, search_key, search_value,
+                               RPC_LIST_METHODS[method].search_keys,
+                               RPC_LIST_METHODS[method].search_keys_count);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    lsm_list_iter *i = (lsm_list_iter *)calloc(1, sizeof(lsm_list_iter));
+    if (!i) {
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    Value parameters(p);
+
+    rc = ipc_call(c, [&]() {
+        i->rpc_id = c->tp->requestSubmit(RPC_LIST_METHODS[method].method,
+                                         parameters, false, LIST_ITER_CHUNK);
+    });
+    if (LSM_ERR_OK != rc) {
+        free(i);
+        return rc;
+    }
+
+    i->magic = LSM_LIST_ITER_MAGIC;
+    i->conn = c;
+    i->method = method;
+    *iter = i;
+    return LSM_ERR_OK;
+}
+
+/**
+ * Hands out the next record of a listing, reading the next part of it when
+ * the one we have is used up.  *record is left NULL at the end.
+ */
+template <typename T>
+static int list_iter_next(lsm_list_iter *iter, lsm_rpc_method method,
+                          T **record, lsm_flag flags,
+                          T *(*conv)(const Value &)) {
+    if (!LSM_IS_LIST_ITER(iter) || iter->method != method || !record ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    lsm_connect *c = iter->conn;
+    CONN_SETUP(c);
+
+    *record = NULL;
+
+    while (!iter->chunk || iter->next >= iter->chunk->asArray().size()) {
+        if (iter->done) {
+            return LSM_ERR_OK;
+        }
+
+        delete iter->chunk;
+        iter->chunk = NULL;
+        iter->next = 0;
+
+        Value part;
+        bool more = false;
+        int rc = ipc_call(c, [&]() {
+            part = c->tp->responseChunk(iter->rpc_id, more);
+        });
+        if (LSM_ERR_OK != rc) {
+            iter->done = 1;
+            return rc;
+        }
+        iter->done = !more;
+
+        if (Value::array_t != part.valueType()) {
+            if (Value::null_t == part.valueType()) {
+                continue;
+            }
+            return log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                                 NULL);
+        }
+
+        try {
+            iter->chunk = new Value(std::move(part));
+        } catch (const std::bad_alloc &) {
+            return LSM_ERR_NO_MEMORY;
+        }
+    }
+
+    int rc = LSM_ERR_OK;
+    try {
+        *record = conv((*iter->chunk)[iter->next]);
+        if (!*record) {
+            rc = LSM_ERR_NO_MEMORY;
+        }
+    } catch (const ValueException &ve) {
+        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
+    }
+    ++iter->next;
+    return rc;
+}
+
+#define LIST_ITER(name, type, method, conv)                                    \
+    int lsm_##name##_list_iter_open(lsm_connect *c, const char *search_key,    \
+                                    const char *search_value,                  \
+                                    lsm_list_iter **iter, lsm_flag flags) {    \
+        return list_iter_open(c, method, search_key, search_value, iter,       \
+                              flags);                                          \
+    }                                                                          \
+                                                                               \
+    int lsm_##name##_list_iter_next(lsm_list_iter *iter, type **record,        \
+                                    lsm_flag flags) {                          \
+        return list_iter_next(iter, method, record, flags, conv);              \
+    }
+
+LIST_ITER(volume, lsm_volume, LSM_RPC_VOLUME_LIST, value_to_volume)
+LIST_ITER(disk, lsm_disk, LSM_RPC_DISK_LIST, value_to_disk)
+LIST_ITER(fs, lsm_fs, LSM_RPC_FS_LIST, value_to_fs)
+
+/**
+ * Sends a listing request for one page of records.  Plug-ins which page
+ * answer with the records and the cursor of the next page, older ones with
+ * every record, which is then the only page.
+ */
+static int page_rpc(lsm_connect *c, const char *method, const char *search_key,
+                    const char *search_value, const char *const keys[],
+                    size_t keys_count, uint32_t limit, const char *cursor,
+                    Value &records, char **next_cursor, lsm_flag flags) {
+    std::map<std::string, Value> p;
+    p["flags"] = Value(flags);
+
+    int rc = add_search_params(p, search_key, search_value, keys, keys_count);
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    p["limit"] = Value(limit);
+    p["cursor"] = Value(cursor);
+    Value parameters(p);
+    Value response;
+
+    rc = rpc(c, method, parameters, response);
+    if (LSM_ERR_OK != rc || Value::object_t != response.valueType()) {
+        records = response;
+        return rc;
+    }
+
+    try {
+        records = response["records"];
+
+        Value next = response["cursor"];
+        if (Value::string_t == next.valueType()) {
+            *next_cursor = strdup(next.asC_str());
+            if (!*next_cursor) {
+                return LSM_ERR_NO_MEMORY;
+            }
+        }
+    } catch (const ValueException &ve) {
+        rc = log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type", ve.what());
+    }
+    return rc;
+}
+
+#define LIST_PAGE(name, type, method, keys, get_array)                         \
+    int lsm_##name##_list_page(lsm_connect *c, const char *search_key,         \
+                               const char *search_value, uint32_t limit,       \
+                               const char *cursor, type **records[],           \
+                               uint32_t *count, char **next_cursor,            \
+                               lsm_flag flags) {                               \
+        CONN_SETUP(c);                                                         \
+                                                                               \
+        if (CHECK_RP(records) || !count || CHECK_RP(next_cursor) || !limit) {  \
+            return LSM_ERR_INVALID_ARGUMENT;                                   \
+        }                                                                      \
+                                                                               \
+        *count = 0;                                                            \
+        Value response;                                                        \
+        int rc = page_rpc(c, method, search_key, search_value, keys,           \
+                          keys##_COUNT, limit, cursor, response, next_cursor,  \
+                          flags);                                              \
+        rc = get_array(c, rc, response, records, count);                       \
+        if (LSM_ERR_OK != rc) {                                                \
+            free(*next_cursor);                                                \
+            *next_cursor = NULL;                                               \
+        }                                                                      \
+        return rc;                                                             \
+    }
+
+LIST_PAGE(pool, lsm_pool, "pools", POOL_SEARCH_KEYS, get_pool_array)
+LIST_PAGE(volume, lsm_volume, "volumes", VOLUME_SEARCH_KEYS, get_volume_array)
+LIST_PAGE(disk, lsm_disk, "disks", DISK_SEARCH_KEYS, get_disk_array)
+LIST_PAGE(access_group, lsm_access_group, "access_groups",
+          ACCESS_GROUP_SEARCH_KEYS, get_access_groups)
+LIST_PAGE(fs, lsm_fs, "fs", FS_SEARCH_KEYS, get_fs_array)
+LIST_PAGE(nfs, lsm_nfs_export, "exports", NFS_EXPORT_SEARCH_KEYS,
+          get_nfs_export_array)
+
+int lsm_list_iter_close(lsm_list_iter *iter, lsm_flag flags) {
+    if (!LSM_IS_LIST_ITER(iter) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    lsm_connect *c = iter->conn;
+    int rc = LSM_ERR_OK;
+
+    // The plug-in sends the whole listing regardless, what we didn't get to
+    // has to be read so it isn't mistaken for the answer to a later request.
+    if (LSM_IS_CONNECT(c) && !iter->done) {
+        rc = ipc_call(c, [&]() {
+            bool more = true;
+            while (more) {
+                c->tp->responseChunk(iter->rpc_id, more);
+            }
+        });
+    }
+
+    delete iter->chunk;
+    iter->chunk = NULL;
+    iter->magic = LSM_DEL_MAGIC(LSM_LIST_ITER_MAGIC);
+    free(iter);
+    return rc;
+}
+
+int lsm_batch_open(lsm_connect *c, lsm_batch **batch, lsm_flag flags) {
+    CONN_SETUP(c);
+
+    if (CHECK_RP(batch) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    lsm_batch *b = (lsm_batch *)calloc(1, sizeof(lsm_batch));
+    if (!b) {
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    b->calls = new (std::nothrow) std::vector<Value>;
+    b->results = new (std::nothrow) std::vector<Value>;
+    if (!b->calls || !b->results) {
+        delete b->calls;
+        delete b->results;
+        free(b);
+        return LSM_ERR_NO_MEMORY;
+    }
+
+    b->magic = LSM_BATCH_MAGIC;
+    b->conn = c;
+    *batch = b;
+    return LSM_ERR_OK;
+}
+
+static int batch_add(lsm_batch *batch, const char *method, Value &&params) {
+    std::map<std::string, Value> call;
+
+    call["method"] = Value(method);
+    call["params"] = std::move(params);
+    batch->calls->push_back(Value(std::move(call)));
+    return LSM_ERR_OK;
+}
+
+int lsm_batch_volume_mask(lsm_batch *batch, lsm_access_group *access_group,
+                          lsm_volume *volume, lsm_flag flags) {
+    if (!LSM_IS_BATCH(batch) || !LSM_IS_ACCESS_GROUP(access_group) ||
+        !LSM_IS_VOL(volume) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, Value> p;
+    p["access_group"] = access_group_to_value(access_group);
+    p["volume"] = volume_to_value(volume);
+    p["flags"] = Value(flags);
+
+    return batch_add(batch, "volume_mask", Value(std::move(p)));
+}
+
+int lsm_batch_volume_unmask(lsm_batch *batch, lsm_access_group *access_group,
+                            lsm_volume *volume, lsm_flag flags) {
+    if (!LSM_IS_BATCH(batch) || !LSM_IS_ACCESS_GROUP(access_group) ||
+        !LSM_IS_VOL(volume) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    std::map<std::string, Value> p;
+    p["access_group"] = access_group_to_value(access_group);
+    p["volume"] = volume_to_value(volume);
+    p["flags"] = Value(flags);
+
+    return batch_add(batch, "volume_unmask", Value(std::move(p)));
+}
+
+int lsm_batch_volume_delete(lsm_batch *batch, lsm_volume *volume,
+                            lsm_flag flags) {
+    if (!LSM_IS_BATCH(batch) || !LSM_IS_VOL(volume) ||
+        LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    return batch_add(batch, "volume_delete",
+                     _create_volume_flag_param(volume, flags));
+}
+
+/**
+ * Makes the calls of a batch one at a time, for plug-ins which don't take
+ * batches, and files what each got as the plug-in would have.
+ */
+static void batch_run_each(lsm_connect *c, const std::vector<Value> &calls,
+                           std::vector<Value> &results) {
+    for (size_t i = 0; i < calls.size(); ++i) {
+        std::map<std::string, Value> r;
+        Value response;
+        int rc = rpc(c, calls[i]["method"].asC_str(), calls[i]["params"],
+                     response);
+
+        if (LSM_ERR_OK == rc) {
+            r["result"] = std::move(response);
+        } else {
+            std::map<std::string, Value> e;
+            lsm_error *err = connection_error_take(c);
+            e["code"] = Value(rc);
+            e["message"] = Value(err ? err->message : NULL);
+            e["data"] = Value(err ? err->debug : NULL);
+            r["error"] = Value(std::move(e));
+            connection_error_set(c, err);
+        }
+        results.push_back(Value(std::move(r)));
+    }
+}
+
+int lsm_batch_run(lsm_batch *batch, lsm_flag flags) {
+    if (!LSM_IS_BATCH(batch) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    lsm_connect *c = batch->conn;
+    CONN_SETUP(c);
+
+    batch->results->clear();
+    if (batch->calls->empty()) {
+        return LSM_ERR_OK;
+    }
+
+    std::map<std::string, Value> p;
+    p["requests"] = Value(std::move(*batch->calls));
+    p["flags"] = Value(flags);
+    batch->calls->clear();
+
+    Value parameters(std::move(p));
+    const std::vector<Value> &calls = parameters["requests"].asArray();
+    Value response;
+
+    int rc = rpc(c, "batch", parameters, response);
+    if (LSM_ERR_NO_SUPPORT == rc) {
+        batch_run_each(c, calls, *batch->results);
+        rc = LSM_ERR_OK;
+    } else if (LSM_ERR_OK == rc) {
+        const std::vector<Value> *results = NULL;
+        if (!response.tryArray(results) || results->size() != calls.size()) {
+            return log_exception(c, LSM_ERR_PLUGIN_BUG, "Unexpected type",
+                                 "Batch results don't match the calls");
+        }
+        *batch->results = *results;
+    }
+
+    if (LSM_ERR_OK != rc) {
+        return rc;
+    }
+
+    // Report the first call which failed, if any
+    for (size_t i = 0; i < batch->results->size(); ++i) {
+        const Value &e = (*batch->results)[i].getValue("error");
+        int32_t code = LSM_ERR_PLUGIN_BUG;
+        const char *msg = NULL;
+        const char *data = NULL;
+
+        if (Value::null_t != e.valueType()) {
+            e.getValue("code").tryInt32_t(code);
+            e.getValue("message").tryC_str(msg);
+            e.getValue("data").tryC_str(data);
+            return log_exception(c, (lsm_error_number)code,
+                                 msg ? msg : "Batched call failed", data);
+        }
+    }
+    return LSM_ERR_OK;
+}
+
+int lsm_batch_result_get(lsm_batch *batch, uint32_t index, char **job,
+                         lsm_flag flags) {
+    if (!LSM_IS_BATCH(batch) || index >= batch->results->size() ||
+        CHECK_RP(job) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    const Value &r = (*batch->results)[index];
+    const Value &e = r.getValue("error");
+    int32_t code = LSM_ERR_PLUGIN_BUG;
+
+    if (Value::null_t != e.valueType()) {
+        e.getValue("code").tryInt32_t(code);
+        return code;
+    }
+
+    Value result = r.getValue("result");
+    return job_check(batch->conn, LSM_ERR_OK, result, job);
+}
+
+int lsm_batch_close(lsm_batch *batch, lsm_flag flags) {
+    if (!LSM_IS_BATCH(batch) || LSM_FLAG_UNUSED_CHECK(flags)) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    delete batch->calls;
+    batch->calls = NULL;
+    delete batch->results;
+    batch->results = NULL;
+    batch->magic = LSM_DEL_MAGIC(LSM_BATCH_MAGIC);
+    free(batch);
+    return LSM_ERR_OK;
+}
@@ -28,11 +28,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
+#include <time.h>
+#include <unistd.h>
 
 #define UNUSED(x) (void)(x)
 
 // Forward decl.
 static int lsm_plugin_run(lsm_plugin_ptr plug);
+static int process_request(lsm_plugin_ptr p, const std::string &method,
+                           Value &request, Value &response);
 static void get_batteries(int rc, lsm_battery *bs[], uint32_t count,
                           Value &response);
 static int handle_batteries(lsm_plugin_ptr p, Value &params, Value &response);
@@ -157,6 +161,24 @@ int lsm_register_plugin_v1_3(lsm_plugin_ptr plug, void *private_data,
     return rc;
 }
 
+int lsm_register_plugin_v1_11(lsm_plugin_ptr plug, void *private_data,
+                              struct lsm_mgmt_ops_v1 *mgm_op,
+                              struct lsm_san_ops_v1 *san_op,
+                              struct lsm_fs_ops_v1 *fs_op,
+                              struct lsm_nas_ops_v1 *nas_op,
+                              struct lsm_ops_v1_2 *ops_v1_2,
+                              struct lsm_ops_v1_3 *ops_v1_3,
+                              struct lsm_ops_v1_11 *ops_v1_11) {
+    int rc = lsm_register_plugin_v1_3(plug, private_data, mgm_op, san_op, fs_op,
+                                      nas_op, ops_v1_2, ops_v1_3);
+
+    if (rc != LSM_ERR_OK) {
+        return rc;
+    }
+    plug->ops_v1_11 = ops_v1_11;
+    return rc;
+}
+
 void *lsm_private_data_get(lsm_plugin_ptr plug) {
     if (!LSM_IS_PLUGIN(plug)) {
         return NULL;
@@ -214,7 +236,7 @@ static lsm_plugin_ptr lsm_plugin_alloc(lsm_plugin_register reg,
     return rc;
 }
 
-static void error_send(lsm_plugin_ptr p, int error_code) {
+static void error_send(lsm_plugin_ptr p, int error_code, uint32_t id) {
     if (!LSM_IS_PLUGIN(p)) {
         return;
     }
@@ -222,15 +244,37 @@ static void error_send(lsm_plugin_ptr p, int error_code) {
     if (p->error) {
         if (p->tp) {
             p->tp->errorSend(p->error->code, ss(p->error->message),
-                             ss(p->error->debug));
+                             ss(p->error->debug), id);
             lsm_error_free(p->error);
             p->error = NULL;
         }
     } else {
-        p->tp->errorSend(error_code, "Plugin didn't provide error message", "");
+        p->tp->errorSend(error_code, "Plugin didn't provide error message", "",
+                         id);
     }
 }
 
+/**
+ * Error of a request which is answered in a batch, as error_send would have
+ * sent it.
+ */
+static Value error_value(lsm_plugin_ptr p, int error_code) {
+    std::map<std::string, Value> e;
+
+    if (p->error) {
+        e["code"] = Value((int32_t)p->error->code);
+        e["message"] = Value(ss(p->error->message));
+        e["data"] = Value(ss(p->error->debug));
+        lsm_error_free(p->error);
+        p->error = NULL;
+    } else {
+        e["code"] = Value(error_code);
+        e["message"] = Value("Plugin didn't provide error message");
+        e["data"] = Value("");
+    }
+    return Value(std::move(e));
+}
+
 static int get_search_params(Value &params, char **k, char **v) {
     int rc = LSM_ERR_OK;
     Value key = params["search_key"];
@@ -277,6 +321,135 @@ static bool get_num(char *sn, int &num) {
     return true;
 }
 
+/**
+ * Retrieves the paging parameters of a listing request.
+ * @param[in]   params  Request parameters
+ * @param[out]  limit   Most records to return, 0 when no page was asked for
+ * @param[out]  cursor  Where to continue, NULL for the first page
+ * @return LSM_ERR_OK, else error reason
+ */
+static int get_page_params(Value &params, uint32_t *limit, char **cursor) {
+    Value l = params["limit"];
+    Value c = params["cursor"];
+
+    *limit = 0;
+    *cursor = NULL;
+
+    if (Value::null_t == l.valueType()) {
+        return LSM_ERR_OK;
+    }
+
+    if (Value::numeric_t != l.valueType() || 0 == l.asUint32_t()) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    if (Value::string_t == c.valueType()) {
+        *cursor = strdup(c.asC_str());
+        if (*cursor == NULL) {
+            return LSM_ERR_NO_MEMORY;
+        }
+    } else if (Value::null_t != c.valueType()) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    *limit = l.asUint32_t();
+    return LSM_ERR_OK;
+}
+
+/**
+ * Cuts the page a client asked for out of a full listing, for plug-ins
+ * which can't return a page themselves.  The cursor is the offset of the
+ * page.  On error all the records are freed.
+ * @param[in]       cursor      Offset of the page, NULL for the first
+ * @param[in]       limit       Most records in the page
+ * @param[in,out]   records     Full listing, page on return
+ * @param[in,out]   count       Number of records
+ * @param[out]      next_cursor Offset of the next page, NULL at the end
+ * @param[in]       release     Frees one record
+ * @param[in]       release_all Frees the listing
+ * @return LSM_ERR_OK, else error reason
+ */
+template <typename T>
+static int page_cut(const char *cursor, uint32_t limit, T **records[],
+                    uint32_t *count, char **next_cursor, int (*release)(T *),
+                    int (*release_all)(T *[], uint32_t)) {
+    int start = 0;
+
+    if (cursor && (!get_num((char *)cursor, start) || start < 0)) {
+        release_all(*records, *count);
+        *records = NULL;
+        *count = 0;
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    uint32_t first = ((uint32_t)start < *count) ? (uint32_t)start : *count;
+    uint32_t end = (*count - first > limit) ? first + limit : *count;
+
+    if (end < *count) {
+        *next_cursor = strdup(::to_string(end).c_str());
+        if (*next_cursor == NULL) {
+            release_all(*records, *count);
+            *records = NULL;
+            *count = 0;
+            return LSM_ERR_NO_MEMORY;
+        }
+    }
+
+    for (uint32_t i = 0; i < *count; ++i) {
+        if (i < first || i >= end) {
+            release((*records)[i]);
+        }
+    }
+    if (first) {
+        memmove(*records, *records + first, (end - first) * sizeof(T *));
+    }
+    *count = end - first;
+    return LSM_ERR_OK;
+}
+
+/**
+ * Calls a plug-in listing callback.  When the client asked for a page the
+ * paged callback is used if the plug-in has one, else the page is cut out
+ * of the full listing.
+ */
+template <typename T>
+static int list_call(lsm_plugin_ptr p, const char *key, const char *val,
+                     uint32_t limit, const char *cursor, lsm_flag flags,
+                     int (*list)(lsm_plugin_ptr, const char *, const char *,
+                                 T **[], uint32_t *, lsm_flag),
+                     int (*list_page)(lsm_plugin_ptr, const char *,
+                                      const char *, uint32_t, const char *,
+                                      T **[], uint32_t *, char **, lsm_flag),
+                     int (*release)(T *), int (*release_all)(T *[], uint32_t),
+                     T **records[], uint32_t *count, char **next_cursor) {
+    int rc = LSM_ERR_OK;
+
+    if (limit && list_page) {
+        return list_page(p, key, val, limit, cursor, records, count,
+                         next_cursor, flags);
+    }
+
+    rc = list(p, key, val, records, count, flags);
+    if (LSM_ERR_OK == rc && limit) {
+        rc = page_cut(cursor, limit, records, count, next_cursor, release,
+                      release_all);
+    }
+    return rc;
+}
+
+/**
+ * Wraps the records of a page with where the next page starts.
+ */
+static void page_response(int rc, uint32_t limit, const char *next_cursor,
+                          Value &response) {
+    if (LSM_ERR_OK == rc && limit) {
+        std::map<std::string, Value> page;
+        page["records"] = response;
+        page["cursor"] = Value(next_cursor);
+        response = Value(page);
+    }
+}
+
 int lsm_plugin_init_v1(int argc, char *argv[], lsm_plugin_register reg,
                        lsm_plugin_unregister unreg, const char *desc,
                        const char *version) {
@@ -287,8 +460,26 @@ int lsm_plugin_init_v1(int argc, char *argv[], lsm_plugin_register reg,
         return LSM_ERR_INVALID_ARGUMENT;
     }
 
-    int sd = 0;
-    if (argc == 2 && get_num(argv[1], sd)) {
+    int sd = -1;
+    int ctl = 0;
+    if (argc == 3 && 0 == strcmp(argv[1], "--warm") && get_num(argv[2], ctl)) {
+        // Started ahead of time by lsmd, wait for it to hand us a client
+        int ec = 0;
+        sd = Transport::fd_recv(ctl, ec);
+        ::close(ctl);
+        if (sd < 0) {
+            // lsmd is going away or reloading, nobody to serve
+            if (ec) {
+                syslog(LOG_USER | LOG_NOTICE,
+                       "Plug-in failed to receive client: %d", ec);
+            }
+            return ec ? 1 : 0;
+        }
+    } else if (argc == 2) {
+        get_num(argv[1], sd);
+    }
+
+    if (sd >= 0) {
         plug = lsm_plugin_alloc(reg, unreg, desc, version);
         if (plug) {
             plug->tp = new Ipc(sd);
@@ -446,6 +637,154 @@ static int handle_job_status(lsm_plugin_ptr p, Value &params, Value &response) {
     return rc;
 }
 
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Frees what the job status callback handed back with a completed job.
+ */
+static void job_value_free(lsm_data_type t, void *value) {
+    switch (t) {
+    case (LSM_DATA_TYPE_VOLUME):
+        lsm_volume_record_free((lsm_volume *)value);
+        break;
+    case (LSM_DATA_TYPE_FS):
+        lsm_fs_record_free((lsm_fs *)value);
+        break;
+    case (LSM_DATA_TYPE_SS):
+        lsm_fs_ss_record_free((lsm_fs_ss *)value);
+        break;
+    case (LSM_DATA_TYPE_POOL):
+        lsm_pool_record_free((lsm_pool *)value);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Waits on jobs through the job status callback, for plug-ins which can't
+ * wait on them.  The jobs are polled every 10ms at first, backing off to
+ * once a second.  The callback is a function call away, so this costs the
+ * client nothing.
+ */
+static int jobs_wait_poll(lsm_plugin_ptr p, const char *jobs[],
+                          uint32_t count, uint8_t percent, uint32_t timeout,
+                          uint32_t *index, lsm_job_status *status,
+                          uint8_t *percent_complete, lsm_flag flags) {
+    uint64_t deadline = now_ms() + timeout;
+    uint64_t interval = 10;
+
+    for (;;) {
+        bool ended = false;
+
+        *index = 0;
+        *status = LSM_JOB_INPROGRESS;
+        *percent_complete = 0;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            lsm_job_status s = LSM_JOB_INPROGRESS;
+            uint8_t done = 0;
+            lsm_data_type t = LSM_DATA_TYPE_UNKNOWN;
+            void *value = NULL;
+
+            int rc = p->mgmt_ops->job_status(p, jobs[i], &s, &done, &t, &value,
+                                             flags);
+            if (LSM_ERR_OK != rc) {
+                *index = i;
+                return rc;
+            }
+            if (value) {
+                job_value_free(t, value);
+            }
+
+            if (ended) {
+                continue;
+            }
+            if (LSM_JOB_INPROGRESS != s || done >= percent) {
+                ended = true;
+                *index = i;
+                *status = s;
+                *percent_complete = done;
+            } else if (done > *percent_complete) {
+                *index = i;
+                *percent_complete = done;
+            }
+        }
+
+        uint64_t now = now_ms();
+        if (ended || now >= deadline) {
+            return LSM_ERR_OK;
+        }
+        usleep(1000 * std::min(interval, deadline - now));
+        interval = std::min(interval * 2, (uint64_t)1000);
+    }
+}
+
+static int handle_jobs_wait_any(lsm_plugin_ptr p, Value &params,
+                                Value &response) {
+    lsm_plug_jobs_wait_any wait = NULL;
+
+    if (!p || !p->mgmt_ops) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+    if (p->ops_v1_11) {
+        wait = p->ops_v1_11->jobs_wait_any;
+    }
+    if (!wait && !p->mgmt_ops->job_status) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    Value v_jobs = params["job_ids"];
+    Value v_percent = params["percent"];
+    Value v_timeout = params["timeout"];
+    const std::vector<Value> *items = NULL;
+
+    if (!v_jobs.tryArray(items) ||
+        Value::numeric_t != v_percent.valueType() ||
+        Value::numeric_t != v_timeout.valueType() ||
+        !LSM_FLAG_EXPECTED_TYPE(params)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    std::vector<const char *> jobs(items->size());
+    for (size_t i = 0; i < items->size(); ++i) {
+        if (!(*items)[i].tryC_str(jobs[i])) {
+            return LSM_ERR_TRANSPORT_INVALID_ARG;
+        }
+    }
+    uint32_t percent = v_percent.asUint32_t();
+    if (jobs.empty() || percent > 100) {
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    uint32_t index = 0;
+    lsm_job_status status = LSM_JOB_INPROGRESS;
+    uint8_t done = 0;
+    int rc;
+
+    if (wait) {
+        rc = wait(p, jobs.data(), jobs.size(), percent, v_timeout.asUint32_t(),
+                  &index, &status, &done, LSM_FLAG_GET_VALUE(params));
+    } else {
+        rc = jobs_wait_poll(p, jobs.data(), jobs.size(), percent,
+                            v_timeout.asUint32_t(), &index, &status, &done,
+                            LSM_FLAG_GET_VALUE(params));
+    }
+
+    if (LSM_ERR_OK == rc) {
+        std::vector<Value> result;
+        result.push_back(Value(index));
+        result.push_back(Value((int32_t)status));
+        result.push_back(Value(done));
+        response = Value(result);
+    }
+    return rc;
+}
+
 static int handle_plugin_info(lsm_plugin_ptr p, Value &params,
                               Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
@@ -513,15 +852,23 @@ static int handle_pools(lsm_plugin_ptr p, Value &params, Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t limit = 0;
 
     if (p && p->mgmt_ops && p->mgmt_ops->pool_list) {
         lsm_pool **pools = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            ((rc = get_search_params(params, &key, &val)) == LSM_ERR_OK)) {
-            rc = p->mgmt_ops->pool_list(p, key, val, &pools, &count,
-                                        LSM_FLAG_GET_VALUE(params));
+            ((rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) &&
+            ((rc = get_page_params(params, &limit, &cursor)) == LSM_ERR_OK)) {
+            rc = list_call(
+                p, key, val, limit, cursor, LSM_FLAG_GET_VALUE(params),
+                p->mgmt_ops->pool_list,
+                p->ops_v1_11 ? p->ops_v1_11->pool_list_page : NULL,
+                lsm_pool_record_free, lsm_pool_record_array_free, &pools,
+                &count, &next);
             if (LSM_ERR_OK == rc) {
                 std::vector<Value> result;
                 result.reserve(count);
@@ -534,13 +881,16 @@ static int handle_pools(lsm_plugin_ptr p, Value &params, Value &response) {
                 pools = NULL;
                 response = Value(result);
             }
-            free(key);
-            free(val);
+            page_response(rc, limit, next, response);
         } else {
             if (rc == LSM_ERR_NO_SUPPORT) {
                 rc = LSM_ERR_TRANSPORT_INVALID_ARG;
             }
         }
+        free(key);
+        free(val);
+        free(cursor);
+        free(next);
     }
     return rc;
 }
@@ -591,9 +941,10 @@ static int capabilities(lsm_plugin_ptr p, Value &params, Value &response) {
         Value v_s = params["system"];
 
         if (IS_CLASS_SYSTEM(v_s) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_system *sys = value_to_system(v_s);
+            lsm_system *sys = NULL;
+            rc = value_to_system(v_s, &sys);
 
-            if (sys) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->mgmt_ops->capablities(p, sys, &c,
                                               LSM_FLAG_GET_VALUE(params));
                 if (LSM_ERR_OK == rc) {
@@ -602,8 +953,6 @@ static int capabilities(lsm_plugin_ptr p, Value &params, Value &response) {
                     c = NULL;
                 }
                 lsm_system_record_free(sys);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
         } else {
             rc = LSM_ERR_TRANSPORT_INVALID_ARG;
@@ -612,19 +961,36 @@ static int capabilities(lsm_plugin_ptr p, Value &params, Value &response) {
     return rc;
 }
 
-static void get_volumes(int rc, lsm_volume **vols, uint32_t count,
-                        Value &response) {
-    if (LSM_ERR_OK == rc) {
-        std::vector<Value> result;
-        result.reserve(count);
+/**
+ * Converts records for a listing response.  When the client asked for the
+ * listing to be streamed, full chunks are sent ahead as they are converted
+ * and only what is left over is returned for the final response.
+ */
+template <typename T>
+static Value records_to_value(lsm_plugin_ptr p, T **records, uint32_t count,
+                              Value (*conv)(T *)) {
+    uint32_t chunk = p->stream_chunk;
+    std::vector<Value> result;
+    result.reserve((chunk && chunk < count) ? chunk : count);
 
-        for (uint32_t i = 0; i < count; ++i) {
-            result.push_back(volume_to_value(vols[i]));
+    for (uint32_t i = 0; i < count; ++i) {
+        result.push_back(conv(records[i]));
+
+        if (chunk && result.size() == chunk && i + 1 < count) {
+            p->tp->responseChunkSend(Value(result), p->stream_id);
+            result.clear();
         }
+    }
+    return Value(result);
+}
+
+static void get_volumes(lsm_plugin_ptr p, int rc, lsm_volume **vols,
+                        uint32_t count, Value &response) {
+    if (LSM_ERR_OK == rc) {
+        response = records_to_value(p, vols, count, volume_to_value);
 
         lsm_volume_record_array_free(vols, count);
         vols = NULL;
-        response = Value(result);
     }
 }
 
@@ -632,41 +998,45 @@ static int handle_volumes(lsm_plugin_ptr p, Value &params, Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t limit = 0;
 
     if (p && p->san_ops && p->san_ops->vol_get) {
         lsm_volume **vols = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
-            rc = p->san_ops->vol_get(p, key, val, &vols, &count,
-                                     LSM_FLAG_GET_VALUE(params));
-
-            get_volumes(rc, vols, count, response);
-            free(key);
-            free(val);
+            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK &&
+            (rc = get_page_params(params, &limit, &cursor)) == LSM_ERR_OK) {
+            rc = list_call(p, key, val, limit, cursor,
+                           LSM_FLAG_GET_VALUE(params), p->san_ops->vol_get,
+                           p->ops_v1_11 ? p->ops_v1_11->vol_list_page : NULL,
+                           lsm_volume_record_free, lsm_volume_record_array_free,
+                           &vols, &count, &next);
+
+            get_volumes(p, rc, vols, count, response);
+            page_response(rc, limit, next, response);
         } else {
             if (rc == LSM_ERR_NO_SUPPORT) {
                 rc = LSM_ERR_TRANSPORT_INVALID_ARG;
             }
         }
+        free(key);
+        free(val);
+        free(cursor);
+        free(next);
     }
     return rc;
 }
 
-static void get_disks(int rc, lsm_disk **disks, uint32_t count,
-                      Value &response) {
+static void get_disks(lsm_plugin_ptr p, int rc, lsm_disk **disks,
+                      uint32_t count, Value &response) {
     if (LSM_ERR_OK == rc) {
-        std::vector<Value> result;
-        result.reserve(count);
-
-        for (uint32_t i = 0; i < count; ++i) {
-            result.push_back(disk_to_value(disks[i]));
-        }
+        response = records_to_value(p, disks, count, disk_to_value);
 
         lsm_disk_record_array_free(disks, count);
         disks = NULL;
-        response = Value(result);
     }
 }
 
@@ -674,23 +1044,33 @@ static int handle_disks(lsm_plugin_ptr p, Value &params, Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t limit = 0;
 
     if (p && p->san_ops && p->san_ops->disk_get) {
         lsm_disk **disks = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
-            rc = p->san_ops->disk_get(p, key, val, &disks, &count,
-                                      LSM_FLAG_GET_VALUE(params));
-            get_disks(rc, disks, count, response);
-            free(key);
-            free(val);
+            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK &&
+            (rc = get_page_params(params, &limit, &cursor)) == LSM_ERR_OK) {
+            rc = list_call(p, key, val, limit, cursor,
+                           LSM_FLAG_GET_VALUE(params), p->san_ops->disk_get,
+                           p->ops_v1_11 ? p->ops_v1_11->disk_list_page : NULL,
+                           lsm_disk_record_free, lsm_disk_record_array_free,
+                           &disks, &count, &next);
+            get_disks(p, rc, disks, count, response);
+            page_response(rc, limit, next, response);
         } else {
             if (rc == LSM_ERR_NO_SUPPORT) {
                 rc = LSM_ERR_TRANSPORT_INVALID_ARG;
             }
         }
+        free(key);
+        free(val);
+        free(cursor);
+        free(next);
     }
     return rc;
 }
@@ -710,8 +1090,9 @@ static int handle_volume_create(lsm_plugin_ptr p, Value &params,
             Value::numeric_t == v_prov.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_pool *pool = value_to_pool(v_p);
-            if (pool) {
+            lsm_pool *pool = NULL;
+            rc = value_to_pool(v_p, &pool);
+            if (LSM_ERR_OK == rc) {
                 lsm_volume *vol = NULL;
                 char *job = NULL;
                 const char *name = v_name.asC_str();
@@ -729,9 +1110,6 @@ static int handle_volume_create(lsm_plugin_ptr p, Value &params,
                 lsm_pool_record_free(pool);
                 lsm_volume_record_free(vol);
                 free(job);
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -751,8 +1129,9 @@ static int handle_volume_resize(lsm_plugin_ptr p, Value &params,
         if (IS_CLASS_VOLUME(v_vol) && Value::numeric_t == v_size.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_volume *vol = value_to_volume(v_vol);
-            if (vol) {
+            lsm_volume *vol = NULL;
+            rc = value_to_volume(v_vol, &vol);
+            if (LSM_ERR_OK == rc) {
                 lsm_volume *resized_vol = NULL;
                 uint64_t size = v_size.asUint64_t();
                 char *job = NULL;
@@ -766,9 +1145,6 @@ static int handle_volume_resize(lsm_plugin_ptr p, Value &params,
                 lsm_volume_record_free(vol);
                 lsm_volume_record_free(resized_vol);
                 free(job);
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -796,17 +1172,19 @@ static int handle_volume_replicate(lsm_plugin_ptr p, Value &params,
             Value::string_t == v_name.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_pool *pool = (Value::null_t == v_pool.valueType())
-                                 ? NULL
-                                 : value_to_pool(v_pool);
-            lsm_volume *vol = value_to_volume(v_vol_src);
+            lsm_pool *pool = NULL;
+            lsm_volume *vol = NULL;
             lsm_volume *newVolume = NULL;
             lsm_replication_type rep = (lsm_replication_type)v_rep.asInt32_t();
             const char *name = v_name.asC_str();
             char *job = NULL;
 
-            if (vol &&
-                (pool || (!pool && Value::null_t == v_pool.valueType()))) {
+            rc = value_to_volume(v_vol_src, &vol);
+            if (LSM_ERR_OK == rc && Value::null_t != v_pool.valueType()) {
+                rc = value_to_pool(v_pool, &pool);
+            }
+
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->vol_replicate(p, pool, rep, vol, name,
                                                &newVolume, &job,
                                                LSM_FLAG_GET_VALUE(params));
@@ -816,8 +1194,6 @@ static int handle_volume_replicate(lsm_plugin_ptr p, Value &params,
 
                 lsm_volume_record_free(newVolume);
                 free(job);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_pool_record_free(pool);
@@ -840,9 +1216,10 @@ static int handle_volume_replicate_range_block_size(lsm_plugin_ptr p,
         Value v_s = params["system"];
 
         if (IS_CLASS_SYSTEM(v_s) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_system *sys = value_to_system(v_s);
+            lsm_system *sys = NULL;
+            rc = value_to_system(v_s, &sys);
 
-            if (sys) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->vol_rep_range_bs(p, sys, &block_size,
                                                   LSM_FLAG_GET_VALUE(params));
 
@@ -851,8 +1228,6 @@ static int handle_volume_replicate_range_block_size(lsm_plugin_ptr p,
                 }
 
                 lsm_system_record_free(sys);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
         } else {
             rc = LSM_ERR_TRANSPORT_INVALID_ARG;
@@ -879,13 +1254,22 @@ static int handle_volume_replicate_range(lsm_plugin_ptr p, Value &params,
 
             lsm_replication_type repType =
                 (lsm_replication_type)v_rep.asInt32_t();
-            lsm_volume *source = value_to_volume(v_vol_src);
-            lsm_volume *dest = value_to_volume(v_vol_dest);
-            lsm_block_range **ranges =
-                value_to_block_range_list(v_ranges, &range_count);
+            lsm_volume *source = NULL;
+            lsm_volume *dest = NULL;
+            lsm_block_range **ranges = NULL;
 
-            if (source && dest && ranges) {
+            rc = value_to_volume(v_vol_src, &source);
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_volume(v_vol_dest, &dest);
+            }
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_block_range_list(v_ranges, &ranges, &range_count);
+            }
+            if (LSM_ERR_OK == rc && !range_count) {
+                rc = LSM_ERR_TRANSPORT_INVALID_ARG;
+            }
 
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->vol_rep_range(p, repType, source, dest, ranges,
                                                range_count, &job,
                                                LSM_FLAG_GET_VALUE(params));
@@ -895,9 +1279,6 @@ static int handle_volume_replicate_range(lsm_plugin_ptr p, Value &params,
                     free(job);
                     job = NULL;
                 }
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_volume_record_free(source);
@@ -918,9 +1299,10 @@ static int handle_volume_delete(lsm_plugin_ptr p, Value &params,
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *vol = value_to_volume(v_vol);
+            lsm_volume *vol = NULL;
+            rc = value_to_volume(v_vol, &vol);
 
-            if (vol) {
+            if (LSM_ERR_OK == rc) {
                 char *job = NULL;
 
                 rc = p->san_ops->vol_delete(p, vol, &job,
@@ -932,8 +1314,6 @@ static int handle_volume_delete(lsm_plugin_ptr p, Value &params,
 
                 lsm_volume_record_free(vol);
                 free(job);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -954,8 +1334,9 @@ static int handle_vol_enable_disable(lsm_plugin_ptr p, Value &params,
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *vol = value_to_volume(v_vol);
-            if (vol) {
+            lsm_volume *vol = NULL;
+            rc = value_to_volume(v_vol, &vol);
+            if (LSM_ERR_OK == rc) {
                 if (online) {
                     rc = p->san_ops->vol_enable(p, vol,
                                                 LSM_FLAG_GET_VALUE(params));
@@ -965,8 +1346,6 @@ static int handle_vol_enable_disable(lsm_plugin_ptr p, Value &params,
                 }
 
                 lsm_volume_record_free(vol);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
         } else {
             rc = LSM_ERR_TRANSPORT_INVALID_ARG;
@@ -992,10 +1371,11 @@ static int handle_volume_raid_info(lsm_plugin_ptr p, Value &params,
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *vol = value_to_volume(v_vol);
+            lsm_volume *vol = NULL;
+            rc = value_to_volume(v_vol, &vol);
             std::vector<Value> result;
 
-            if (vol) {
+            if (LSM_ERR_OK == rc) {
                 lsm_volume_raid_type raid_type;
                 uint32_t strip_size;
                 uint32_t disk_count;
@@ -1016,8 +1396,6 @@ static int handle_volume_raid_info(lsm_plugin_ptr p, Value &params,
                 }
 
                 lsm_volume_record_free(vol);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1034,10 +1412,11 @@ static int handle_pool_member_info(lsm_plugin_ptr p, Value &params,
         Value v_pool = params["pool"];
 
         if (IS_CLASS_POOL(v_pool) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_pool *pool = value_to_pool(v_pool);
+            lsm_pool *pool = NULL;
+            rc = value_to_pool(v_pool, &pool);
             std::vector<Value> result;
 
-            if (pool) {
+            if (LSM_ERR_OK == rc) {
                 lsm_volume_raid_type raid_type = LSM_VOLUME_RAID_TYPE_UNKNOWN;
                 lsm_pool_member_type member_type = LSM_POOL_MEMBER_TYPE_UNKNOWN;
                 lsm_string_list *member_ids = NULL;
@@ -1057,8 +1436,6 @@ static int handle_pool_member_info(lsm_plugin_ptr p, Value &params,
                 }
 
                 lsm_pool_record_free(pool);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1072,29 +1449,40 @@ static int ag_list(lsm_plugin_ptr p, Value &params, Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t limit = 0;
 
     if (p && p->san_ops && p->san_ops->ag_list) {
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
+            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK &&
+            (rc = get_page_params(params, &limit, &cursor)) == LSM_ERR_OK) {
             lsm_access_group **groups = NULL;
             uint32_t count;
 
-            rc = p->san_ops->ag_list(p, key, val, &groups, &count,
-                                     LSM_FLAG_GET_VALUE(params));
+            rc = list_call(p, key, val, limit, cursor,
+                           LSM_FLAG_GET_VALUE(params), p->san_ops->ag_list,
+                           p->ops_v1_11 ? p->ops_v1_11->ag_list_page : NULL,
+                           lsm_access_group_record_free,
+                           lsm_access_group_record_array_free, &groups, &count,
+                           &next);
             if (LSM_ERR_OK == rc) {
                 response = access_group_list_to_value(groups, count);
 
                 /* Free the memory */
                 lsm_access_group_record_array_free(groups, count);
             }
-            free(key);
-            free(val);
+            page_response(rc, limit, next, response);
         } else {
             if (rc == LSM_ERR_NO_SUPPORT) {
                 rc = LSM_ERR_TRANSPORT_INVALID_ARG;
             }
         }
+        free(key);
+        free(val);
+        free(cursor);
+        free(next);
     }
     return rc;
 }
@@ -1114,9 +1502,10 @@ static int ag_create(lsm_plugin_ptr p, Value &params, Value &response) {
             IS_CLASS_SYSTEM(v_system) && LSM_FLAG_EXPECTED_TYPE(params)) {
 
             lsm_access_group *ag = NULL;
-            lsm_system *system = value_to_system(v_system);
+            lsm_system *system = NULL;
 
-            if (system) {
+            rc = value_to_system(v_system, &system);
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->ag_create(
                     p, v_name.asC_str(), v_init_id.asC_str(),
                     (lsm_access_group_init_type)v_init_type.asInt32_t(), system,
@@ -1146,13 +1535,12 @@ static int ag_delete(lsm_plugin_ptr p, Value &params, Value &response) {
         if (IS_CLASS_ACCESS_GROUP(v_access_group) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_access_group *ag = value_to_access_group(v_access_group);
+            lsm_access_group *ag = NULL;
+            rc = value_to_access_group(v_access_group, &ag);
 
-            if (ag) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->ag_delete(p, ag, LSM_FLAG_GET_VALUE(params));
                 lsm_access_group_record_free(ag);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1176,8 +1564,9 @@ static int ag_initiator_add(lsm_plugin_ptr p, Value &params, Value &response) {
             Value::numeric_t == v_init_type.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_access_group *ag = value_to_access_group(v_group);
-            if (ag) {
+            lsm_access_group *ag = NULL;
+            rc = value_to_access_group(v_group, &ag);
+            if (LSM_ERR_OK == rc) {
                 lsm_access_group *updated_access_group = NULL;
                 const char *id = v_init_id.asC_str();
                 lsm_access_group_init_type id_type =
@@ -1193,8 +1582,6 @@ static int ag_initiator_add(lsm_plugin_ptr p, Value &params, Value &response) {
                 }
 
                 lsm_access_group_record_free(ag);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1219,9 +1606,10 @@ static int ag_initiator_del(lsm_plugin_ptr p, Value &params, Value &response) {
             Value::numeric_t == v_init_type.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_access_group *ag = value_to_access_group(v_group);
+            lsm_access_group *ag = NULL;
+            rc = value_to_access_group(v_group, &ag);
 
-            if (ag) {
+            if (LSM_ERR_OK == rc) {
                 lsm_access_group *updated_access_group = NULL;
                 const char *id = v_init_id.asC_str();
                 lsm_access_group_init_type id_type =
@@ -1236,8 +1624,6 @@ static int ag_initiator_del(lsm_plugin_ptr p, Value &params, Value &response) {
                 }
 
                 lsm_access_group_record_free(ag);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1259,14 +1645,17 @@ static int volume_mask(lsm_plugin_ptr p, Value &params, Value &response) {
         if (IS_CLASS_ACCESS_GROUP(v_group) && IS_CLASS_VOLUME(v_vol) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_access_group *ag = value_to_access_group(v_group);
-            lsm_volume *vol = value_to_volume(v_vol);
+            lsm_access_group *ag = NULL;
+            lsm_volume *vol = NULL;
+
+            rc = value_to_access_group(v_group, &ag);
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_volume(v_vol, &vol);
+            }
 
-            if (ag && vol) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->ag_grant(p, ag, vol,
                                           LSM_FLAG_GET_VALUE(params));
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_access_group_record_free(ag);
@@ -1292,14 +1681,17 @@ static int volume_unmask(lsm_plugin_ptr p, Value &params, Value &response) {
         if (IS_CLASS_ACCESS_GROUP(v_group) && IS_CLASS_VOLUME(v_vol) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_access_group *ag = value_to_access_group(v_group);
-            lsm_volume *vol = value_to_volume(v_vol);
+            lsm_access_group *ag = NULL;
+            lsm_volume *vol = NULL;
+
+            rc = value_to_access_group(v_group, &ag);
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_volume(v_vol, &vol);
+            }
 
-            if (ag && vol) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->san_ops->ag_revoke(p, ag, vol,
                                            LSM_FLAG_GET_VALUE(params));
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_access_group_record_free(ag);
@@ -1322,9 +1714,10 @@ static int vol_accessible_by_ag(lsm_plugin_ptr p, Value &params,
 
         if (IS_CLASS_ACCESS_GROUP(v_access_group) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_access_group *ag = value_to_access_group(v_access_group);
+            lsm_access_group *ag = NULL;
+            rc = value_to_access_group(v_access_group, &ag);
 
-            if (ag) {
+            if (LSM_ERR_OK == rc) {
                 lsm_volume **vols = NULL;
                 uint32_t count = 0;
 
@@ -1344,8 +1737,6 @@ static int vol_accessible_by_ag(lsm_plugin_ptr p, Value &params,
                 lsm_access_group_record_free(ag);
                 lsm_volume_record_array_free(vols, count);
                 vols = NULL;
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1364,9 +1755,10 @@ static int ag_granted_to_volume(lsm_plugin_ptr p, Value &params,
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *volume = value_to_volume(v_vol);
+            lsm_volume *volume = NULL;
+            rc = value_to_volume(v_vol, &volume);
 
-            if (volume) {
+            if (LSM_ERR_OK == rc) {
                 lsm_access_group **groups = NULL;
                 uint32_t count = 0;
 
@@ -1386,8 +1778,6 @@ static int ag_granted_to_volume(lsm_plugin_ptr p, Value &params,
                 lsm_volume_record_free(volume);
                 lsm_access_group_record_array_free(groups, count);
                 groups = NULL;
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
         } else {
             rc = LSM_ERR_TRANSPORT_INVALID_ARG;
@@ -1404,9 +1794,10 @@ static int volume_dependency(lsm_plugin_ptr p, Value &params, Value &response) {
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *volume = value_to_volume(v_vol);
+            lsm_volume *volume = NULL;
+            rc = value_to_volume(v_vol, &volume);
 
-            if (volume) {
+            if (LSM_ERR_OK == rc) {
                 uint8_t yes;
 
                 rc = p->san_ops->vol_child_depends(p, volume, &yes,
@@ -1417,8 +1808,6 @@ static int volume_dependency(lsm_plugin_ptr p, Value &params, Value &response) {
                 }
 
                 lsm_volume_record_free(volume);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1438,9 +1827,10 @@ static int volume_dependency_rm(lsm_plugin_ptr p, Value &params,
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *volume = value_to_volume(v_vol);
+            lsm_volume *volume = NULL;
+            rc = value_to_volume(v_vol, &volume);
 
-            if (volume) {
+            if (LSM_ERR_OK == rc) {
 
                 char *job = NULL;
 
@@ -1452,9 +1842,6 @@ static int volume_dependency_rm(lsm_plugin_ptr p, Value &params,
                     free(job);
                 }
                 lsm_volume_record_free(volume);
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1468,36 +1855,39 @@ static int fs(lsm_plugin_ptr p, Value &params, Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t limit = 0;
 
     if (p && p->fs_ops && p->fs_ops->fs_list) {
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            ((rc = get_search_params(params, &key, &val)) == LSM_ERR_OK)) {
+            ((rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) &&
+            ((rc = get_page_params(params, &limit, &cursor)) == LSM_ERR_OK)) {
 
             lsm_fs **fs = NULL;
             uint32_t count = 0;
 
-            rc = p->fs_ops->fs_list(p, key, val, &fs, &count,
-                                    LSM_FLAG_GET_VALUE(params));
+            rc = list_call(p, key, val, limit, cursor,
+                           LSM_FLAG_GET_VALUE(params), p->fs_ops->fs_list,
+                           p->ops_v1_11 ? p->ops_v1_11->fs_list_page : NULL,
+                           lsm_fs_record_free, lsm_fs_record_array_free, &fs,
+                           &count, &next);
 
             if (LSM_ERR_OK == rc) {
-                std::vector<Value> result;
-                result.reserve(count);
-
-                for (uint32_t i = 0; i < count; ++i) {
-                    result.push_back(fs_to_value(fs[i]));
-                }
-
-                response = Value(result);
+                response = records_to_value(p, fs, count, fs_to_value);
                 lsm_fs_record_array_free(fs, count);
                 fs = NULL;
             }
-            free(key);
-            free(val);
+            page_response(rc, limit, next, response);
         } else {
             if (rc == LSM_ERR_NO_SUPPORT) {
                 rc = LSM_ERR_TRANSPORT_INVALID_ARG;
             }
         }
+        free(key);
+        free(val);
+        free(cursor);
+        free(next);
     }
     return rc;
 }
@@ -1515,9 +1905,10 @@ static int fs_create(lsm_plugin_ptr p, Value &params, Value &response) {
             Value::numeric_t == v_size.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_pool *pool = value_to_pool(v_pool);
+            lsm_pool *pool = NULL;
+            rc = value_to_pool(v_pool, &pool);
 
-            if (pool) {
+            if (LSM_ERR_OK == rc) {
                 const char *name = params["name"].asC_str();
                 uint64_t size_bytes = params["size_bytes"].asUint64_t();
                 lsm_fs *fs = NULL;
@@ -1540,9 +1931,6 @@ static int fs_create(lsm_plugin_ptr p, Value &params, Value &response) {
                     free(job);
                 }
                 lsm_pool_record_free(pool);
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1561,9 +1949,10 @@ static int fs_delete(lsm_plugin_ptr p, Value &params, Value &response) {
 
         if (IS_CLASS_FILE_SYSTEM(v_fs) && LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
+            lsm_fs *fs = NULL;
+            rc = value_to_fs(v_fs, &fs);
 
-            if (fs) {
+            if (LSM_ERR_OK == rc) {
                 char *job = NULL;
 
                 rc = p->fs_ops->fs_delete(p, fs, &job,
@@ -1574,8 +1963,6 @@ static int fs_delete(lsm_plugin_ptr p, Value &params, Value &response) {
                     free(job);
                 }
                 lsm_fs_record_free(fs);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1597,9 +1984,10 @@ static int fs_resize(lsm_plugin_ptr p, Value &params, Value &response) {
             Value::numeric_t == v_size.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
+            lsm_fs *fs = NULL;
+            rc = value_to_fs(v_fs, &fs);
 
-            if (fs) {
+            if (LSM_ERR_OK == rc) {
                 uint64_t size_bytes = v_size.asUint64_t();
                 lsm_fs *rfs = NULL;
                 char *job = NULL;
@@ -1621,8 +2009,6 @@ static int fs_resize(lsm_plugin_ptr p, Value &params, Value &response) {
                     free(job);
                 }
                 lsm_fs_record_free(fs);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -1649,14 +2035,16 @@ static int fs_clone(lsm_plugin_ptr p, Value &params, Value &response) {
 
             lsm_fs *clonedFs = NULL;
             char *job = NULL;
-            lsm_fs *fs = value_to_fs(v_src_fs);
+            lsm_fs *fs = NULL;
             const char *name = v_name.asC_str();
-            lsm_fs_ss *ss =
-                (Value::null_t == v_ss.valueType()) ? NULL : value_to_ss(v_ss);
+            lsm_fs_ss *ss = NULL;
 
-            if (fs && ((ss && v_ss.valueType() == Value::object_t) ||
-                       (!ss && v_ss.valueType() == Value::null_t))) {
+            rc = value_to_fs(v_src_fs, &fs);
+            if (LSM_ERR_OK == rc && Value::null_t != v_ss.valueType()) {
+                rc = value_to_ss(v_ss, &ss);
+            }
 
+            if (LSM_ERR_OK == rc) {
                 rc = p->fs_ops->fs_clone(p, fs, name, &clonedFs, ss, &job,
                                          LSM_FLAG_GET_VALUE(params));
 
@@ -1672,9 +2060,6 @@ static int fs_clone(lsm_plugin_ptr p, Value &params, Value &response) {
                     response = Value(r);
                     free(job);
                 }
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -1704,13 +2089,15 @@ static int fs_file_clone(lsm_plugin_ptr p, Value &params, Value &response) {
              Value::object_t == v_ss.valueType()) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
-            lsm_fs_ss *ss =
-                (Value::null_t == v_ss.valueType()) ? NULL : value_to_ss(v_ss);
+            lsm_fs *fs = NULL;
+            lsm_fs_ss *ss = NULL;
 
-            if (fs && ((ss && v_ss.valueType() == Value::object_t) ||
-                       (!ss && v_ss.valueType() == Value::null_t))) {
+            rc = value_to_fs(v_fs, &fs);
+            if (LSM_ERR_OK == rc && Value::null_t != v_ss.valueType()) {
+                rc = value_to_ss(v_ss, &ss);
+            }
 
+            if (LSM_ERR_OK == rc) {
                 const char *src = v_src_name.asC_str();
                 const char *dest = v_dest_name.asC_str();
 
@@ -1723,9 +2110,6 @@ static int fs_file_clone(lsm_plugin_ptr p, Value &params, Value &response) {
                     response = Value(job);
                     free(job);
                 }
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -1751,13 +2135,15 @@ static int fs_child_dependency(lsm_plugin_ptr p, Value &params,
              Value::null_t == v_files.valueType()) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
-            lsm_string_list *files = (Value::null_t == v_files.valueType())
-                                         ? NULL
-                                         : value_to_string_list(v_files);
+            lsm_fs *fs = NULL;
+            lsm_string_list *files = NULL;
 
-            if (fs &&
-                (files || (!files && Value::null_t == v_files.valueType()))) {
+            rc = value_to_fs(v_fs, &fs);
+            if (LSM_ERR_OK == rc && Value::null_t != v_files.valueType()) {
+                rc = value_to_string_list(v_files, &files);
+            }
+
+            if (LSM_ERR_OK == rc) {
                 uint8_t yes = 0;
 
                 rc = p->fs_ops->fs_child_dependency(p, fs, files, &yes);
@@ -1765,8 +2151,6 @@ static int fs_child_dependency(lsm_plugin_ptr p, Value &params,
                 if (LSM_ERR_OK == rc) {
                     response = Value((bool)yes);
                 }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -1792,13 +2176,15 @@ static int fs_child_dependency_rm(lsm_plugin_ptr p, Value &params,
              Value::null_t == v_files.valueType()) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
-            lsm_string_list *files = (Value::null_t == v_files.valueType())
-                                         ? NULL
-                                         : value_to_string_list(v_files);
+            lsm_fs *fs = NULL;
+            lsm_string_list *files = NULL;
+
+            rc = value_to_fs(v_fs, &fs);
+            if (LSM_ERR_OK == rc && Value::null_t != v_files.valueType()) {
+                rc = value_to_string_list(v_files, &files);
+            }
 
-            if (fs &&
-                (files || (!files && Value::null_t == v_files.valueType()))) {
+            if (LSM_ERR_OK == rc) {
                 char *job = NULL;
 
                 rc = p->fs_ops->fs_child_dependency_rm(
@@ -1808,8 +2194,6 @@ static int fs_child_dependency_rm(lsm_plugin_ptr p, Value &params,
                     response = Value(job);
                     free(job);
                 }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -1829,9 +2213,10 @@ static int ss_list(lsm_plugin_ptr p, Value &params, Value &response) {
 
         if (IS_CLASS_FILE_SYSTEM(v_fs) && LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
+            lsm_fs *fs = NULL;
 
-            if (fs) {
+            rc = value_to_fs(v_fs, &fs);
+            if (LSM_ERR_OK == rc) {
                 lsm_fs_ss **ss = NULL;
                 uint32_t count = 0;
 
@@ -1871,9 +2256,10 @@ static int ss_create(lsm_plugin_ptr p, Value &params, Value &response) {
         if (IS_CLASS_FILE_SYSTEM(v_fs) &&
             Value::string_t == v_ss_name.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_fs *fs = value_to_fs(v_fs);
+            lsm_fs *fs = NULL;
+            rc = value_to_fs(v_fs, &fs);
 
-            if (fs) {
+            if (LSM_ERR_OK == rc) {
                 lsm_fs_ss *ss = NULL;
                 char *job = NULL;
 
@@ -1894,9 +2280,6 @@ static int ss_create(lsm_plugin_ptr p, Value &params, Value &response) {
                     response = Value(r);
                     free(job);
                 }
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -1918,10 +2301,15 @@ static int ss_delete(lsm_plugin_ptr p, Value &params, Value &response) {
         if (IS_CLASS_FILE_SYSTEM(v_fs) && IS_CLASS_FS_SNAPSHOT(v_ss) &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_fs *fs = value_to_fs(v_fs);
-            lsm_fs_ss *ss = value_to_ss(v_ss);
+            lsm_fs *fs = NULL;
+            lsm_fs_ss *ss = NULL;
+
+            rc = value_to_fs(v_fs, &fs);
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_ss(v_ss, &ss);
+            }
 
-            if (fs && ss) {
+            if (LSM_ERR_OK == rc) {
                 char *job = NULL;
                 rc = p->fs_ops->fs_ss_delete(p, fs, ss, &job,
                                              LSM_FLAG_GET_VALUE(params));
@@ -1930,8 +2318,6 @@ static int ss_delete(lsm_plugin_ptr p, Value &params, Value &response) {
                     response = Value(job);
                     free(job);
                 }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -1962,22 +2348,25 @@ static int ss_restore(lsm_plugin_ptr p, Value &params, Value &response) {
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
             char *job = NULL;
-            lsm_fs *fs = value_to_fs(v_fs);
-            lsm_fs_ss *ss = value_to_ss(v_ss);
-            lsm_string_list *files = (Value::null_t == v_files.valueType())
-                                         ? NULL
-                                         : value_to_string_list(v_files);
-            lsm_string_list *restore_files =
-                (Value::null_t == v_restore_files.valueType())
-                    ? NULL
-                    : value_to_string_list(v_restore_files);
+            lsm_fs *fs = NULL;
+            lsm_fs_ss *ss = NULL;
+            lsm_string_list *files = NULL;
+            lsm_string_list *restore_files = NULL;
             int all_files = (v_all_files.asBool()) ? 1 : 0;
 
-            if (fs && ss &&
-                (files || (!files && Value::null_t == v_files.valueType())) &&
-                (restore_files ||
-                 (!restore_files &&
-                  Value::null_t == v_restore_files.valueType()))) {
+            rc = value_to_fs(v_fs, &fs);
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_ss(v_ss, &ss);
+            }
+            if (LSM_ERR_OK == rc && Value::null_t != v_files.valueType()) {
+                rc = value_to_string_list(v_files, &files);
+            }
+            if (LSM_ERR_OK == rc &&
+                Value::null_t != v_restore_files.valueType()) {
+                rc = value_to_string_list(v_restore_files, &restore_files);
+            }
+
+            if (LSM_ERR_OK == rc) {
                 rc = p->fs_ops->fs_ss_restore(p, fs, ss, files, restore_files,
                                               all_files, &job,
                                               LSM_FLAG_GET_VALUE(params));
@@ -1986,8 +2375,6 @@ static int ss_restore(lsm_plugin_ptr p, Value &params, Value &response) {
                     response = Value(job);
                     free(job);
                 }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_fs_record_free(fs);
@@ -2025,15 +2412,23 @@ static int exports(lsm_plugin_ptr p, Value &params, Value &response) {
     int rc = LSM_ERR_NO_SUPPORT;
     char *key = NULL;
     char *val = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t limit = 0;
 
     if (p && p->nas_ops && p->nas_ops->nfs_list) {
         lsm_nfs_export **exports = NULL;
         uint32_t count = 0;
 
         if (LSM_FLAG_EXPECTED_TYPE(params) &&
-            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK) {
-            rc = p->nas_ops->nfs_list(p, key, val, &exports, &count,
-                                      LSM_FLAG_GET_VALUE(params));
+            (rc = get_search_params(params, &key, &val)) == LSM_ERR_OK &&
+            (rc = get_page_params(params, &limit, &cursor)) == LSM_ERR_OK) {
+            rc = list_call(p, key, val, limit, cursor,
+                           LSM_FLAG_GET_VALUE(params), p->nas_ops->nfs_list,
+                           p->ops_v1_11 ? p->ops_v1_11->nfs_list_page : NULL,
+                           lsm_nfs_export_record_free,
+                           lsm_nfs_export_record_array_free, &exports, &count,
+                           &next);
 
             if (LSM_ERR_OK == rc) {
                 std::vector<Value> result;
@@ -2048,13 +2443,16 @@ static int exports(lsm_plugin_ptr p, Value &params, Value &response) {
                 exports = NULL;
                 count = 0;
             }
-            free(key);
-            free(val);
+            page_response(rc, limit, next, response);
         } else {
             if (rc == LSM_ERR_NO_SUPPORT) {
                 rc = LSM_ERR_TRANSPORT_INVALID_ARG;
             }
         }
+        free(key);
+        free(val);
+        free(cursor);
+        free(next);
     }
 
     return rc;
@@ -2097,11 +2495,19 @@ static int export_fs(lsm_plugin_ptr p, Value &params, Value &response) {
             Value::numeric_t == v_anon_gid.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_string_list *root_list = value_to_string_list(v_root_list);
-            lsm_string_list *rw_list = value_to_string_list(v_rw_list);
-            lsm_string_list *ro_list = value_to_string_list(v_ro_list);
+            lsm_string_list *root_list = NULL;
+            lsm_string_list *rw_list = NULL;
+            lsm_string_list *ro_list = NULL;
 
-            if (root_list && rw_list && ro_list) {
+            rc = value_to_string_list(v_root_list, &root_list);
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_string_list(v_rw_list, &rw_list);
+            }
+            if (LSM_ERR_OK == rc) {
+                rc = value_to_string_list(v_ro_list, &ro_list);
+            }
+
+            if (LSM_ERR_OK == rc) {
                 const char *fs_id = v_fs_id.asC_str();
                 const char *export_path = v_export_path.asC_str();
                 const char *auth_type = v_auth_type.asC_str();
@@ -2119,9 +2525,6 @@ static int export_fs(lsm_plugin_ptr p, Value &params, Value &response) {
                     response = nfs_export_to_value(exported);
                     lsm_nfs_export_record_free(exported);
                 }
-
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_string_list_free(root_list);
@@ -2143,15 +2546,14 @@ static int export_remove(lsm_plugin_ptr p, Value &params, Value &response) {
         Value v_export = params["export"];
 
         if (IS_CLASS_FS_EXPORT(v_export) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_nfs_export *exp = value_to_nfs_export(v_export);
+            lsm_nfs_export *exp = NULL;
+            rc = value_to_nfs_export(v_export, &exp);
 
-            if (exp) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->nas_ops->nfs_export_remove(p, exp,
                                                    LSM_FLAG_GET_VALUE(params));
                 lsm_nfs_export_record_free(exp);
                 exp = NULL;
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
         } else {
             rc = LSM_ERR_TRANSPORT_INVALID_ARG;
@@ -2208,9 +2610,10 @@ static int handle_volume_raid_create_cap_get(lsm_plugin_ptr p, Value &params,
             uint32_t *supported_strip_sizes = NULL;
             uint32_t supported_strip_size_count = 0;
 
-            lsm_system *sys = value_to_system(v_system);
+            lsm_system *sys = NULL;
+            rc = value_to_system(v_system, &sys);
 
-            if (sys) {
+            if (LSM_ERR_OK == rc) {
 
                 rc = p->ops_v1_2->vol_create_raid_cap_get(
                     p, sys, &supported_raid_types, &supported_raid_type_count,
@@ -2227,8 +2630,6 @@ static int handle_volume_raid_create_cap_get(lsm_plugin_ptr p, Value &params,
                     free(supported_raid_types);
                     free(supported_strip_sizes);
                 }
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
             lsm_system_record_free(sys);
@@ -2297,14 +2698,13 @@ static int handle_volume_ident_led_on(lsm_plugin_ptr p, Value &params,
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_volume *volume = value_to_volume(v_vol);
+            lsm_volume *volume = NULL;
+            rc = value_to_volume(v_vol, &volume);
 
-            if (volume) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->ops_v1_3->vol_ident_on(p, volume,
                                                LSM_FLAG_GET_VALUE(params));
                 lsm_volume_record_free(volume);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -2323,14 +2723,13 @@ static int handle_volume_ident_led_off(lsm_plugin_ptr p, Value &params,
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_volume *volume = value_to_volume(v_vol);
+            lsm_volume *volume = NULL;
+            rc = value_to_volume(v_vol, &volume);
 
-            if (volume) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->ops_v1_3->vol_ident_off(p, volume,
                                                 LSM_FLAG_GET_VALUE(params));
                 lsm_volume_record_free(volume);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -2352,15 +2751,14 @@ static int handle_system_read_cache_pct_update(lsm_plugin_ptr p, Value &params,
             Value::numeric_t == v_read_pct.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_system *system = value_to_system(v_sys);
+            lsm_system *system = NULL;
+            rc = value_to_system(v_sys, &system);
             uint32_t read_pct = v_read_pct.asUint32_t();
 
-            if (system) {
+            if (LSM_ERR_OK == rc) {
                 rc = p->ops_v1_3->sys_read_cache_pct_update(
                     p, system, read_pct, LSM_FLAG_GET_VALUE(params));
                 lsm_system_record_free(system);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -2370,6 +2768,325 @@ static int handle_system_read_cache_pct_update(lsm_plugin_ptr p, Value &params,
     return rc;
 }
 
+/**
+ * Drops the error a plug-in logged for one item of a bulk call, its code is
+ * all that goes back.
+ */
+static void error_drop(lsm_plugin_ptr p) {
+    lsm_error_free(p->error);
+    p->error = NULL;
+}
+
+static Value results_to_value(const std::vector<int32_t> &results) {
+    std::vector<Value> r;
+    r.reserve(results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        r.push_back(Value(results[i]));
+    }
+    return Value(std::move(r));
+}
+
+/**
+ * Masks or unmasks many volumes, with the bulk call of the plug-in when it
+ * has one, else a volume at a time.  The response holds the error code of
+ * each volume.
+ */
+static int volume_mask_bulk_common(lsm_plugin_ptr p, Value &params,
+                                   Value &response, bool mask) {
+    if (!p || !p->san_ops) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    lsm_plug_volume_mask_bulk bulk = NULL;
+    lsm_plug_volume_mask one = mask ? p->san_ops->ag_grant
+                                    : p->san_ops->ag_revoke;
+    if (p->ops_v1_11) {
+        bulk = mask ? p->ops_v1_11->vol_mask_bulk
+                    : p->ops_v1_11->vol_unmask_bulk;
+    }
+    if (!bulk && !one) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    Value v_group = params["access_group"];
+    Value v_vols = params["volumes"];
+    if (!IS_CLASS_ACCESS_GROUP(v_group) ||
+        Value::array_t != v_vols.valueType() ||
+        !LSM_FLAG_EXPECTED_TYPE(params)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    lsm_access_group *ag = NULL;
+    lsm_volume **vols = NULL;
+    uint32_t count = 0;
+    lsm_flag flags = LSM_FLAG_GET_VALUE(params);
+
+    int rc = value_to_access_group(v_group, &ag);
+    if (LSM_ERR_OK == rc) {
+        rc = value_array_to_volumes(v_vols, &vols, &count);
+    }
+
+    if (LSM_ERR_OK == rc) {
+        std::vector<int32_t> results(count, LSM_ERR_OK);
+
+        if (bulk) {
+            rc = bulk(p, ag, vols, count, results.data(), flags);
+        } else {
+            for (uint32_t i = 0; i < count; ++i) {
+                results[i] = one(p, ag, vols[i], flags);
+                error_drop(p);
+            }
+        }
+
+        if (LSM_ERR_OK == rc) {
+            response = results_to_value(results);
+        }
+    }
+
+    lsm_access_group_record_free(ag);
+    lsm_volume_record_array_free(vols, count);
+    return rc;
+}
+
+static int volume_mask_bulk(lsm_plugin_ptr p, Value &params,
+                            Value &response) {
+    return volume_mask_bulk_common(p, params, response, true);
+}
+
+static int volume_unmask_bulk(lsm_plugin_ptr p, Value &params,
+                              Value &response) {
+    return volume_mask_bulk_common(p, params, response, false);
+}
+
+/**
+ * The response holds the error code of each volume, then the job of each
+ * volume, null for those without one.
+ */
+static int handle_volume_delete_bulk(lsm_plugin_ptr p, Value &params,
+                                     Value &response) {
+    if (!p || !p->san_ops) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    lsm_plug_volume_delete_bulk bulk =
+        p->ops_v1_11 ? p->ops_v1_11->vol_delete_bulk : NULL;
+    if (!bulk && !p->san_ops->vol_delete) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    Value v_vols = params["volumes"];
+    if (Value::array_t != v_vols.valueType() ||
+        !LSM_FLAG_EXPECTED_TYPE(params)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    lsm_volume **vols = NULL;
+    uint32_t count = 0;
+    lsm_flag flags = LSM_FLAG_GET_VALUE(params);
+
+    int rc = value_array_to_volumes(v_vols, &vols, &count);
+    if (LSM_ERR_OK == rc) {
+        std::vector<int32_t> results(count, LSM_ERR_OK);
+        std::vector<char *> jobs(count, (char *)NULL);
+
+        if (bulk) {
+            rc = bulk(p, vols, count, results.data(), jobs.data(), flags);
+        } else {
+            for (uint32_t i = 0; i < count; ++i) {
+                results[i] = p->san_ops->vol_delete(p, vols[i], &jobs[i],
+                                                    flags);
+                error_drop(p);
+            }
+        }
+
+        if (LSM_ERR_OK == rc) {
+            std::vector<Value> job_values;
+            job_values.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                job_values.push_back(
+                    Value(LSM_ERR_JOB_STARTED == results[i] ? jobs[i] : NULL));
+            }
+
+            std::vector<Value> r;
+            r.push_back(results_to_value(results));
+            r.push_back(Value(std::move(job_values)));
+            response = Value(std::move(r));
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            free(jobs[i]);
+        }
+    }
+
+    lsm_volume_record_array_free(vols, count);
+    return rc;
+}
+
+/**
+ * The response holds the error code of each initiator, then the access group
+ * as it ends up.
+ */
+static int ag_initiator_add_bulk(lsm_plugin_ptr p, Value &params,
+                                 Value &response) {
+    if (!p || !p->san_ops) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    lsm_plug_access_group_initiator_add_bulk bulk =
+        p->ops_v1_11 ? p->ops_v1_11->ag_add_initiator_bulk : NULL;
+    if (!bulk && !p->san_ops->ag_add_initiator) {
+        return LSM_ERR_NO_SUPPORT;
+    }
+
+    Value v_group = params["access_group"];
+    Value v_init_ids = params["init_ids"];
+    Value v_init_type = params["init_type"];
+    int32_t init_type = 0;
+
+    if (!IS_CLASS_ACCESS_GROUP(v_group) ||
+        Value::array_t != v_init_ids.valueType() ||
+        !v_init_type.tryInt32_t(init_type) ||
+        !LSM_FLAG_EXPECTED_TYPE(params)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    lsm_access_group *ag = NULL;
+    lsm_access_group *updated = NULL;
+    lsm_string_list *ids = NULL;
+    lsm_access_group_init_type id_type = (lsm_access_group_init_type)init_type;
+    lsm_flag flags = LSM_FLAG_GET_VALUE(params);
+
+    int rc = value_to_access_group(v_group, &ag);
+    if (LSM_ERR_OK == rc) {
+        rc = value_to_string_list(v_init_ids, &ids);
+    }
+
+    if (LSM_ERR_OK == rc) {
+        uint32_t count = lsm_string_list_size(ids);
+        std::vector<int32_t> results(count, LSM_ERR_OK);
+
+        if (bulk) {
+            rc = bulk(p, ag, ids, id_type, results.data(), &updated, flags);
+        } else {
+            // Each initiator goes to the group as the one before left it
+            for (uint32_t i = 0; i < count; ++i) {
+                lsm_access_group *next = NULL;
+                results[i] = p->san_ops->ag_add_initiator(
+                    p, updated ? updated : ag,
+                    lsm_string_list_elem_get(ids, i), id_type, &next, flags);
+                if (LSM_ERR_OK == results[i]) {
+                    lsm_access_group_record_free(updated);
+                    updated = next;
+                }
+                error_drop(p);
+            }
+        }
+
+        if (LSM_ERR_OK == rc) {
+            std::vector<Value> r;
+            r.push_back(results_to_value(results));
+            r.push_back(access_group_to_value(updated ? updated : ag));
+            response = Value(std::move(r));
+        }
+    }
+
+    lsm_access_group_record_free(updated);
+    lsm_access_group_record_free(ag);
+    lsm_string_list_free(ids);
+    return rc;
+}
+
+/**
+ * Error of a batched request which threw, the plugin's own error if it
+ * set one is stale.
+ */
+static Value exception_value(lsm_plugin_ptr p, int error_code,
+                             const char *msg, const std::string &debug) {
+    std::map<std::string, Value> e;
+
+    error_drop(p);
+    e["code"] = Value(error_code);
+    e["message"] = Value(msg);
+    e["data"] = Value(debug);
+    return Value(std::move(e));
+}
+
+/**
+ * Puts the plugin's stream chunk back however the batch is left.
+ */
+class LSM_DLL_LOCAL StreamChunkRestore {
+  public:
+    explicit StreamChunkRestore(lsm_plugin_ptr p)
+        : p(p), chunk(p->stream_chunk) {}
+    ~StreamChunkRestore() { p->stream_chunk = chunk; }
+
+  private:
+    lsm_plugin_ptr p;
+    uint32_t chunk;
+};
+
+/**
+ * Runs each of the requests of a batch in turn, whether the ones before
+ * failed or not.  Every request gets a result or an error of its own, as
+ * its response would hold, a request which throws included.
+ */
+static int handle_batch(lsm_plugin_ptr p, Value &params, Value &response) {
+    Value &requests = params["requests"];
+    const std::vector<Value> *list = NULL;
+
+    if (!requests.tryArray(list) || !LSM_FLAG_EXPECTED_TYPE(params)) {
+        return LSM_ERR_TRANSPORT_INVALID_ARG;
+    }
+
+    // Listings go back in one piece along with everything else
+    StreamChunkRestore restore(p);
+    p->stream_chunk = 0;
+
+    std::vector<Value> results;
+    results.reserve(list->size());
+
+    for (uint32_t i = 0; i < list->size(); ++i) {
+        Value &req = requests[i];
+        const char *method = NULL;
+        int rc = LSM_ERR_TRANSPORT_INVALID_ARG;
+        Value result;
+        std::map<std::string, Value> r;
+
+        try {
+            if (Value::object_t == req.valueType() &&
+                req["method"].tryC_str(method) && method &&
+                strcmp(method, "batch") != 0 &&
+                strcmp(method, "plugin_register") != 0 &&
+                strcmp(method, "plugin_unregister") != 0) {
+                rc = process_request(p, method, req, result);
+            }
+
+            if (LSM_ERR_OK == rc || LSM_ERR_JOB_STARTED == rc) {
+                r["result"] = std::move(result);
+            } else {
+                r["error"] = error_value(p, rc);
+            }
+        } catch (ValueException &ve) {
+            r["error"] = exception_value(p, LSM_ERR_TRANSPORT_INVALID_ARG,
+                                         ve.what(), "");
+        } catch (LsmException &le) {
+            r["error"] = exception_value(p, le.error_code, le.what(),
+                                         le.debug);
+        } catch (EOFException &eof) {
+            // The client is gone, there is no one to answer
+            throw;
+        } catch (std::bad_alloc &ba) {
+            r["error"] = exception_value(p, LSM_ERR_NO_MEMORY, ba.what(), "");
+        } catch (std::exception &e) {
+            r["error"] = exception_value(p, LSM_ERR_PLUGIN_BUG, e.what(), "");
+        }
+        results.push_back(Value(std::move(r)));
+    }
+
+    response = Value(std::move(results));
+    return LSM_ERR_OK;
+}
+
 /**
  * map of function pointers
  */
@@ -2392,7 +3109,9 @@ static std::map<std::string, handler> dispatch =
         "fs_snapshot_delete", ss_delete)("fs_snapshot_restore", ss_restore)(
         "fs_snapshots", ss_list)("time_out_get", handle_get_time_out)(
         "iscsi_chap_auth", iscsi_chap)("job_free", handle_job_free)(
-        "job_status", handle_job_status)("plugin_info", handle_plugin_info)(
+        "job_status", handle_job_status)("jobs_wait_any",
+                                         handle_jobs_wait_any)(
+        "plugin_info", handle_plugin_info)(
         "pools", handle_pools)("target_ports", handle_target_ports)(
         "time_out_set", handle_set_time_out)("plugin_unregister",
                                              handle_unregister)(
@@ -2420,7 +3139,11 @@ static std::map<std::string, handler> dispatch =
                                        handle_volume_cache_info)(
         "volume_physical_disk_cache_update", handle_volume_pdc_update)(
         "volume_write_cache_policy_update", handle_volume_wcp_update)(
-        "volume_read_cache_policy_update", handle_volume_rcp_update);
+        "volume_read_cache_policy_update", handle_volume_rcp_update)(
+        "batch", handle_batch)("volume_mask_bulk", volume_mask_bulk)(
+        "volume_unmask_bulk", volume_unmask_bulk)(
+        "volume_delete_bulk", handle_volume_delete_bulk)(
+        "access_group_initiator_add_bulk", ag_initiator_add_bulk);
 
 static int process_request(lsm_plugin_ptr p, const std::string &method,
                            Value &request, Value &response) {
@@ -2428,7 +3151,9 @@ static int process_request(lsm_plugin_ptr p, const std::string &method,
 
     response = Value(); // Default response will be null
 
-    if (dispatch.find(method) != dispatch.end()) {
+    if (Value::object_t != request["params"].valueType()) {
+        rc = LSM_ERR_TRANSPORT_INVALID_ARG;
+    } else if (dispatch.find(method) != dispatch.end()) {
         rc = (dispatch[method])(p, request["params"], response);
     } else {
         rc = LSM_ERR_NO_SUPPORT;
@@ -2455,13 +3180,47 @@ static int lsm_plugin_run(lsm_plugin_ptr p) {
                 Value resp;
 
                 if (req.isValidRequest()) {
-                    std::string method = req["method"].asString();
+                    const char *method_name = NULL;
+                    uint32_t id = 100;
+
+                    // Echo the id back so the client can match the response
+                    // to its request.
+                    req["id"].tryUint32_t(id);
+
+                    if (!req["method"].tryC_str(method_name) || !method_name) {
+                        error_send(p, LSM_ERR_TRANSPORT_INVALID_ARG, id);
+                        continue;
+                    }
+                    std::string method = method_name;
+
+                    // Listings may be sent in parts as they are converted,
+                    // pages are small enough to go in one.
+                    p->stream_id = id;
+                    p->stream_chunk = 0;
+                    if (Value::null_t ==
+                        req["params"].getValue("limit").valueType()) {
+                        req["stream"].tryUint32_t(p->stream_chunk);
+                    }
+
                     rc = process_request(p, method, req, resp);
 
+                    // Clients offer the encodings they support when they
+                    // register, older ones don't and stay with json.
+                    if (method == "plugin_register" && LSM_ERR_OK == rc &&
+                        req.hasKey("encodings")) {
+                        p->tp->encodingAccept(req["encodings"]);
+                    }
+
+                    // Same for receiving large responses in a memfd
+                    if (method == "plugin_register" && LSM_ERR_OK == rc &&
+                        req.hasKey("transfers")) {
+                        p->tp->transferAccept(req["transfers"]);
+                    }
+
                     if (LSM_ERR_OK == rc || LSM_ERR_JOB_STARTED == rc) {
-                        p->tp->responseSend(resp);
+                        p->tp->responseSend(resp, id);
                     } else {
-                        error_send(p, rc);
+                        error_send(p, rc, id);
                     }
 
                     if (method == "plugin_unregister") {
@@ -2887,10 +3646,11 @@ static int handle_volume_cache_info(lsm_plugin_ptr p, Value &params,
         Value v_vol = params["volume"];
 
         if (IS_CLASS_VOLUME(v_vol) && LSM_FLAG_EXPECTED_TYPE(params)) {
-            lsm_volume *vol = value_to_volume(v_vol);
+            lsm_volume *vol = NULL;
+            rc = value_to_volume(v_vol, &vol);
             std::vector<Value> result;
 
-            if (vol) {
+            if (LSM_ERR_OK == rc) {
                 uint32_t write_cache_policy;
                 uint32_t write_cache_status;
                 uint32_t read_cache_policy;
@@ -2912,8 +3672,6 @@ static int handle_volume_cache_info(lsm_plugin_ptr p, Value &params,
                 }
 
                 lsm_volume_record_free(vol);
-            } else {
-                rc = LSM_ERR_NO_MEMORY;
             }
 
         } else {
@@ -2938,7 +3696,11 @@ static int handle_volume_pdc_update(lsm_plugin_ptr p, Value &params,
             Value::numeric_t == v_pdc.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_vol = value_to_volume(v_vol);
+            rc = value_to_volume(v_vol, &lsm_vol);
+            if (LSM_ERR_OK != rc) {
+                return rc;
+            }
+
             pdc = v_pdc.asUint32_t();
             if ((pdc != LSM_VOLUME_PHYSICAL_DISK_CACHE_ENABLED) &&
                 (pdc != LSM_VOLUME_PHYSICAL_DISK_CACHE_DISABLED)) {
@@ -2972,7 +3734,11 @@ static int handle_volume_wcp_update(lsm_plugin_ptr p, Value &params,
             Value::numeric_t == v_wcp.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_vol = value_to_volume(v_vol);
+            rc = value_to_volume(v_vol, &lsm_vol);
+            if (LSM_ERR_OK != rc) {
+                return rc;
+            }
+
             wcp = v_wcp.asUint32_t();
             if ((wcp != LSM_VOLUME_WRITE_CACHE_POLICY_WRITE_BACK) &&
                 (wcp != LSM_VOLUME_WRITE_CACHE_POLICY_WRITE_THROUGH) &&
@@ -3007,7 +3773,11 @@ static int handle_volume_rcp_update(lsm_plugin_ptr p, Value &params,
             Value::numeric_t == v_rcp.valueType() &&
             LSM_FLAG_EXPECTED_TYPE(params)) {
 
-            lsm_vol = value_to_volume(v_vol);
+            rc = value_to_volume(v_vol, &lsm_vol);
+            if (LSM_ERR_OK != rc) {
+                return rc;
+            }
+
             rcp = v_rcp.asUint32_t();
             if ((rcp != LSM_VOLUME_READ_CACHE_POLICY_ENABLED) &&
                 (rcp != LSM_VOLUME_READ_CACHE_POLICY_DISABLED)) {
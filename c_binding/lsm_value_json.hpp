@@ -0,0 +1,865 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2020-2023 Red Hat, Inc.
+ *
+ * Author: Tony Asleson <tasleson@redhat.com>
+ */
+
+static const std::string empty_string;
+static const Value null_value;
+
+/**
+ * Orders members by key, for a key given more than once only the last
+ * member is kept, as std::map assignment would have done.
+ */
+static void object_sort(Value::object_type &o) {
+    typedef Value::object_type::value_type member;
+
+    struct by_key {
+        bool operator()(const member &a, const member &b) const {
+            return a.first < b.first;
+        }
+    };
+
+    bool sorted = true;
+    for (size_t i = 1; i < o.size(); ++i) {
+        if (!(o[i - 1].first < o[i].first)) {
+            sorted = false;
+            break;
+        }
+    }
+    if (sorted) {
+        return;
+    }
+
+    std::stable_sort(o.begin(), o.end(), by_key());
+
+    size_t out = 0;
+    for (size_t i = 0; i < o.size(); ++i) {
+        if (i + 1 < o.size() && o[i].first == o[i + 1].first) {
+            continue;
+        }
+        if (out != i) {
+            o[out] = std::move(o[i]);
+        }
+        ++out;
+    }
+    o.erase(o.begin() + out, o.end());
+}
+
+Value::Value(void) : t(null_t), n(int_n), i(0) {}
+
+Value::Value(bool v) : t(boolean_t), n(int_n), b(v) {}
+
+Value::Value(uint32_t v) : t(numeric_t), n(int_n), i(v) {}
+
+Value::Value(int32_t v) : t(numeric_t), n(int_n), i(v) {}
+
+Value::Value(uint64_t v) : t(numeric_t), n(int_n) {
+    if (v > INT64_MAX) {
+        n = uint_n;
+        u = v;
+    } else {
+        i = (int64_t)v;
+    }
+}
+
+Value::Value(int64_t v) : t(numeric_t), n(int_n), i(v) {}
+
+Value::Value(value_type type, const std::string &v) : t(type), n(int_n) {
+    switch (t) {
+    case (null_t):
+        i = 0;
+        break;
+    case (boolean_t):
+        b = (v == "true");
+        break;
+    case (numeric_t): {
+        // Integers are what we get nearly all of the time, keep anything
+        // else as the text it came in as.
+        const char *str = v.c_str();
+        char *end = NULL;
+
+        errno = 0;
+        if (str[0] == '-') {
+            long long sv = strtoll(str, &end, 10);
+            if (!errno && end != str && *end == '\0') {
+                i = sv;
+                return;
+            }
+        } else if (str[0] >= '0' && str[0] <= '9') {
+            unsigned long long uv = strtoull(str, &end, 10);
+            if (!errno && *end == '\0') {
+                if (uv > INT64_MAX) {
+                    n = uint_n;
+                    u = uv;
+                } else {
+                    i = (int64_t)uv;
+                }
+                return;
+            }
+        }
+        n = text_n;
+        new (&s) std::string(v);
+        break;
+    }
+    case (string_t):
+        new (&s) std::string(v);
+        break;
+    case (object_t):
+        new (&o) object_type();
+        break;
+    case (array_t):
+        new (&a) std::vector<Value>();
+        break;
+    }
+}
+
+Value::Value(const std::vector<Value> &v) : t(array_t), n(int_n) {
+    new (&a) std::vector<Value>(v);
+}
+
+Value::Value(std::vector<Value> &&v) : t(array_t), n(int_n) {
+    new (&a) std::vector<Value>(std::move(v));
+}
+
+Value::Value(const char *v) : n(int_n) {
+    if (v) {
+        t = string_t;
+        new (&s) std::string(v);
+    } else {
+        t = null_t;
+        i = 0;
+    }
+}
+
+Value::Value(const std::string &v) : t(string_t), n(int_n) {
+    new (&s) std::string(v);
+}
+
+Value::Value(std::string &&v) : t(string_t), n(int_n) {
+    new (&s) std::string(std::move(v));
+}
+
+Value::Value(const std::map<std::string, Value> &v) : t(object_t), n(int_n) {
+    new (&o) object_type(v.begin(), v.end());
+}
+
+Value::Value(std::map<std::string, Value> &&v) : t(object_t), n(int_n) {
+    new (&o) object_type();
+    o.reserve(v.size());
+    for (auto &m : v) {
+        o.emplace_back(m.first, std::move(m.second));
+    }
+}
+
+Value::Value(object_type &&v) : t(object_t), n(int_n) {
+    new (&o) object_type(std::move(v));
+    object_sort(o);
+}
+
+void Value::init(const Value &v) {
+    t = v.t;
+    n = v.n;
+    switch (t) {
+    case (null_t):
+        i = 0;
+        break;
+    case (boolean_t):
+        b = v.b;
+        break;
+    case (numeric_t):
+        if (n == text_n) {
+            new (&s) std::string(v.s);
+        } else {
+            u = v.u;
+        }
+        break;
+    case (string_t):
+        new (&s) std::string(v.s);
+        break;
+    case (object_t):
+        new (&o) object_type(v.o);
+        break;
+    case (array_t):
+        new (&a) std::vector<Value>(v.a);
+        break;
+    }
+}
+
+void Value::take(Value &v) {
+    t = v.t;
+    n = v.n;
+    switch (t) {
+    case (null_t):
+        i = 0;
+        break;
+    case (boolean_t):
+        b = v.b;
+        break;
+    case (numeric_t):
+        if (n == text_n) {
+            new (&s) std::string(std::move(v.s));
+        } else {
+            u = v.u;
+        }
+        break;
+    case (string_t):
+        new (&s) std::string(std::move(v.s));
+        break;
+    case (object_t):
+        new (&o) object_type(std::move(v.o));
+        break;
+    case (array_t):
+        new (&a) std::vector<Value>(std::move(v.a));
+        break;
+    }
+}
+
+void Value::release() {
+    if (t == string_t || (t == numeric_t && n == text_n)) {
+        s.~basic_string();
+    } else if (t == object_t) {
+        o.~object_type();
+    } else if (t == array_t) {
+        a.~vector();
+    }
+    t = null_t;
+    n = int_n;
+    i = 0;
+}
+
+Value::Value(const Value &v) { init(v); }
+
+Value::Value(Value &&v) noexcept { take(v); }
+
+Value &Value::operator=(const Value &v) {
+    if (this != &v) {
+        // v may live inside of us
+        Value tmp(v);
+        release();
+        take(tmp);
+    }
+    return *this;
+}
+
+Value &Value::operator=(Value &&v) noexcept {
+    if (this != &v) {
+        Value tmp(std::move(v));
+        release();
+        take(tmp);
+    }
+    return *this;
+}
+
+Value::~Value() { release(); }
+
+static const char json_hex[] = "0123456789abcdef";
+
+/**
+ * Appends s as a json string, quoted and with '"', '\' and the control
+ * characters escaped.  Everything else, UTF-8 included, goes out as is.
+ */
+static void json_put_str(std::string &out, const char *s, size_t len) {
+    size_t run = 0;
+
+    out.push_back('"');
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = (unsigned char)s[i];
+        char esc;
+
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out.append(s + run, i - run);
+        run = i + 1;
+
+        switch (c) {
+        case ('"'):
+            esc = '"';
+            break;
+        case ('\\'):
+            esc = '\\';
+            break;
+        case ('\b'):
+            esc = 'b';
+            break;
+        case ('\f'):
+            esc = 'f';
+            break;
+        case ('\n'):
+            esc = 'n';
+            break;
+        case ('\r'):
+            esc = 'r';
+            break;
+        case ('\t'):
+            esc = 't';
+            break;
+        default: {
+            char u[6] = {'\\', 'u', '0', '0', json_hex[c >> 4],
+                         json_hex[c & 0xf]};
+            out.append(u, sizeof(u));
+            continue;
+        }
+        }
+        out.push_back('\\');
+        out.push_back(esc);
+    }
+    out.append(s + run, len - run);
+    out.push_back('"');
+}
+
+static void json_put_uint(std::string &out, uint64_t v) {
+    char buf[20];
+    char *p = buf + sizeof(buf);
+
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    out.append(p, buf + sizeof(buf) - p);
+}
+
+static void json_put_int(std::string &out, int64_t v) {
+    if (v < 0) {
+        out.push_back('-');
+        json_put_uint(out, 0 - (uint64_t)v);
+    } else {
+        json_put_uint(out, (uint64_t)v);
+    }
+}
+
+void Value::serializeJson(std::string &out) const {
+    switch (t) {
+    case (null_t):
+        out.append("null", 4);
+        break;
+    case (boolean_t):
+        if (b) {
+            out.append("true", 4);
+        } else {
+            out.append("false", 5);
+        }
+        break;
+    case (numeric_t):
+        if (n == int_n) {
+            json_put_int(out, i);
+        } else if (n == uint_n) {
+            json_put_uint(out, u);
+        } else {
+            out.append(s);
+        }
+        break;
+    case (string_t):
+        json_put_str(out, s.data(), s.size());
+        break;
+    case (object_t):
+        out.push_back('{');
+        for (size_t m = 0; m < o.size(); ++m) {
+            if (m) {
+                out.append(", ", 2);
+            }
+            json_put_str(out, o[m].first.data(), o[m].first.size());
+            out.append(": ", 2);
+            o[m].second.serializeJson(out);
+        }
+        out.push_back('}');
+        break;
+    case (array_t):
+        out.push_back('[');
+        for (size_t e = 0; e < a.size(); ++e) {
+            if (e) {
+                out.append(", ", 2);
+            }
+            a[e].serializeJson(out);
+        }
+        out.push_back(']');
+        break;
+    }
+}
+
+std::string Value::serialize(void) const {
+    std::string out;
+    serializeJson(out);
+    return out;
+}
+
+Value::value_type Value::valueType() const { return t; }
+
+const Value *Value::find(const std::string &key) const {
+    object_type::const_iterator iter = std::lower_bound(
+        o.begin(), o.end(), key,
+        [](const object_type::value_type &m, const std::string &k) {
+            return m.first < k;
+        });
+
+    if (iter != o.end() && iter->first == key) {
+        return &iter->second;
+    }
+    return NULL;
+}
+
+Value &Value::operator[](const std::string &key) {
+    if (t == object_t) {
+        object_type::iterator iter = std::lower_bound(
+            o.begin(), o.end(), key,
+            [](const object_type::value_type &m, const std::string &k) {
+                return m.first < k;
+            });
+
+        if (iter == o.end() || iter->first != key) {
+            iter = o.emplace(iter, key, Value());
+        }
+        return iter->second;
+    }
+    throw ValueException("Value not object");
+}
+
+const Value &Value::operator[](const std::string &key) const {
+    if (t == object_t) {
+        const Value *v = find(key);
+        return (v) ? *v : null_value;
+    }
+    throw ValueException("Value not object");
+}
+
+Value &Value::operator[](uint32_t e) {
+    if (t == array_t) {
+        return a[e];
+    }
+    throw ValueException("Value not array");
+}
+
+const Value &Value::operator[](uint32_t e) const {
+    if (t == array_t) {
+        return a[e];
+    }
+    throw ValueException("Value not array");
+}
+
+bool Value::hasKey(const std::string &k) const {
+    return (t == object_t && find(k) != NULL);
+}
+
+bool Value::isValidRequest() const {
+    return (t == Value::object_t && hasKey("method") && hasKey("id") &&
+            hasKey("params"));
+}
+
+const Value &Value::getValue(const char *key) const {
+    if (t == object_t) {
+        const Value *v = find(key);
+        if (v) {
+            return *v;
+        }
+    }
+    return null_value;
+}
+
+bool Value::tryBool(bool &v) const {
+    if (t == boolean_t) {
+        v = b;
+        return true;
+    }
+    return false;
+}
+
+bool Value::tryInt32_t(int32_t &v) const {
+    if (t != numeric_t) {
+        return false;
+    }
+    if (n != text_n) {
+        v = (int32_t)i;
+        return true;
+    }
+    return sscanf(s.c_str(), "%d", &v) > 0;
+}
+
+bool Value::tryInt64_t(int64_t &v) const {
+    if (t != numeric_t) {
+        return false;
+    }
+    if (n == int_n) {
+        v = i;
+        return true;
+    } else if (n == uint_n) {
+        v = INT64_MAX;
+        return true;
+    }
+    return sscanf(s.c_str(), "%lld", (long long int *)&v) > 0;
+}
+
+bool Value::tryUint32_t(uint32_t &v) const {
+    if (t != numeric_t) {
+        return false;
+    }
+    if (n != text_n) {
+        v = (uint32_t)u;
+        return true;
+    }
+    return sscanf(s.c_str(), "%u", &v) > 0;
+}
+
+bool Value::tryUint64_t(uint64_t &v) const {
+    if (t != numeric_t) {
+        return false;
+    }
+    if (n != text_n) {
+        v = u;
+        return true;
+    }
+    return sscanf(s.c_str(), "%llu", (long long unsigned int *)&v) > 0;
+}
+
+bool Value::tryC_str(const char *&v) const {
+    if (t == string_t) {
+        v = s.c_str();
+        return true;
+    } else if (t == null_t) {
+        v = NULL;
+        return true;
+    }
+    return false;
+}
+
+bool Value::tryObject(const object_type *&v) const {
+    if (t == object_t) {
+        v = &o;
+        return true;
+    }
+    return false;
+}
+
+bool Value::tryArray(const std::vector<Value> *&v) const {
+    if (t == array_t) {
+        v = &a;
+        return true;
+    }
+    return false;
+}
+
+bool Value::asBool() const {
+    bool rc;
+
+    if (tryBool(rc)) {
+        return rc;
+    }
+    throw ValueException("Value not boolean");
+}
+
+int32_t Value::asInt32_t() const {
+    int32_t rc;
+
+    if (tryInt32_t(rc)) {
+        return rc;
+    }
+    throw ValueException((t == numeric_t) ? "Value not int32"
+                                          : "Value not numeric");
+}
+
+int64_t Value::asInt64_t() const {
+    int64_t rc;
+
+    if (tryInt64_t(rc)) {
+        return rc;
+    }
+    throw ValueException((t == numeric_t) ? "Not an integer"
+                                          : "Value not numeric");
+}
+
+uint32_t Value::asUint32_t() const {
+    uint32_t rc;
+
+    if (tryUint32_t(rc)) {
+        return rc;
+    }
+    throw ValueException((t == numeric_t) ? "Not an integer"
+                                          : "Value not numeric");
+}
+
+uint64_t Value::asUint64_t() const {
+    uint64_t rc;
+
+    if (tryUint64_t(rc)) {
+        return rc;
+    }
+    throw ValueException((t == numeric_t) ? "Not an integer"
+                                          : "Value not numeric");
+}
+
+const std::string &Value::asString() const {
+    if (t == string_t) {
+        return s;
+    } else if (t == null_t) {
+        return empty_string;
+    }
+    throw ValueException("Value not string");
+}
+
+const char *Value::asC_str() const {
+    const char *rc;
+
+    if (tryC_str(rc)) {
+        return rc;
+    }
+    throw ValueException("Value not string");
+}
+
+const Value::object_type &Value::asObject() const {
+    const object_type *rc;
+
+    if (tryObject(rc)) {
+        return *rc;
+    }
+    throw ValueException("Value not object");
+}
+
+const std::vector<Value> &Value::asArray() const {
+    const std::vector<Value> *rc;
+
+    if (tryArray(rc)) {
+        return *rc;
+    }
+    throw ValueException("Value not array");
+}
+
+std::string Payload::serialize(const Value &v) { return v.serialize(); }
+
+static int json_hex_value(const char *h) {
+    int v = 0;
+
+    for (int k = 0; k < 4; ++k) {
+        char c = h[k];
+        v <<= 4;
+        if (c >= '0' && c <= '9') {
+            v |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            v |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            v |= c - 'A' + 10;
+        } else {
+            throw ValueException("In-valid json string escape");
+        }
+    }
+    return v;
+}
+
+static void utf8_put(std::string &out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back((char)cp);
+    } else if (cp < 0x800) {
+        out.push_back((char)(0xc0 | (cp >> 6)));
+        out.push_back((char)(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        out.push_back((char)(0xe0 | (cp >> 12)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back((char)(0x80 | (cp & 0x3f)));
+    } else {
+        out.push_back((char)(0xf0 | (cp >> 18)));
+        out.push_back((char)(0x80 | ((cp >> 12) & 0x3f)));
+        out.push_back((char)(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back((char)(0x80 | (cp & 0x3f)));
+    }
+}
+
+/**
+ * Stores the contents of a json string in out with the escapes undone.
+ */
+static void json_get_str(std::string &out, const char *s, size_t len) {
+    const char *esc = (const char *)memchr(s, '\\', len);
+
+    if (!esc) {
+        out.assign(s, len);
+        return;
+    }
+
+    const char *end = s + len;
+
+    out.clear();
+    out.reserve(len);
+    while (esc) {
+        out.append(s, esc - s);
+        if (esc + 1 >= end) {
+            throw ValueException("In-valid json string escape");
+        }
+
+        s = esc + 2;
+        switch (esc[1]) {
+        case ('"'):
+        case ('\\'):
+        case ('/'):
+            out.push_back(esc[1]);
+            break;
+        case ('b'):
+            out.push_back('\b');
+            break;
+        case ('f'):
+            out.push_back('\f');
+            break;
+        case ('n'):
+            out.push_back('\n');
+            break;
+        case ('r'):
+            out.push_back('\r');
+            break;
+        case ('t'):
+            out.push_back('\t');
+            break;
+        case ('u'): {
+            if (end - s < 4) {
+                throw ValueException("In-valid json string escape");
+            }
+            uint32_t cp = json_hex_value(s);
+            s += 4;
+
+            if (cp >= 0xd800 && cp <= 0xdbff) {
+                // Characters outside of the BMP come as a surrogate pair
+                if (end - s < 6 || s[0] != '\\' || s[1] != 'u') {
+                    throw ValueException("In-valid json surrogate pair");
+                }
+                uint32_t low = json_hex_value(s + 2);
+                if (low < 0xdc00 || low > 0xdfff) {
+                    throw ValueException("In-valid json surrogate pair");
+                }
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                s += 6;
+            } else if (cp >= 0xdc00 && cp <= 0xdfff) {
+                throw ValueException("In-valid json surrogate pair");
+            }
+            utf8_put(out, cp);
+            break;
+        }
+        default:
+            throw ValueException("In-valid json string escape");
+        }
+        esc = (const char *)memchr(s, '\\', end - s);
+    }
+    out.append(s, end - s);
+}
+
+static bool json_is_ws(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static const char *json_ws(const char *p, const char *end) {
+    while (p < end && json_is_ws(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Given p just past the opening quote of a string returns where the closing
+ * quote is.
+ */
+static const char *json_str_end(const char *p, const char *end,
+                                const JsonScanner &scan) {
+    for (;;) {
+        p = scan.string_stop(p, end);
+        if (p == end) {
+            break;
+        }
+        if (*p == '"') {
+            return p;
+        }
+        // Step over the escaped character
+        if (end - p < 2) {
+            break;
+        }
+        p += 2;
+    }
+    throw ValueException("Unterminated json string");
+}
+
+/**
+ * Given p at the opening bracket of an object or array returns just past
+ * the closing one.  Only strings and the nesting are checked, the rest is
+ * left to whoever decodes the value.
+ */
+static const char *json_nest_end(const char *p, const char *end,
+                                 const JsonScanner &scan, std::string &nest) {
+    nest.clear();
+    for (;;) {
+        p = scan.nest_stop(p, end);
+        if (p == end) {
+            throw ValueException("Truncated json payload");
+        }
+
+        switch (*p++) {
+        case ('"'):
+            p = json_str_end(p, end, scan) + 1;
+            break;
+        case ('{'):
+            nest.push_back('}');
+            break;
+        case ('['):
+            nest.push_back(']');
+            break;
+        default:
+            if (nest.empty() || nest.back() != p[-1]) {
+                throw ValueException("Mismatched json brackets");
+            }
+            nest.pop_back();
+            if (nest.empty()) {
+                return p;
+            }
+        }
+    }
+}
+
+static bool json_is_num(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+           c == 'e' || c == 'E';
+}
+
+/**
+ * Reads the number at p, integers end up in native form without going
+ * through text.
+ */
+static Value json_number(const char *&p, const char *end) {
+    const char *start = p;
+    bool neg = false;
+    bool integer = true;
+    uint64_t v = 0;
+
+    if (p < end && *p == '-') {
+        neg = true;
+        ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        throw ValueException("In-valid json number");
+    }
+
+    for (; p < end && json_is_num(*p); ++p) {
+        if (*p < '0' || *p > '9') {
+            integer = false;
+        } else if (integer) {
+            uint64_t d = *p - '0';
+            if (v > (UINT64_MAX - d) / 10) {
+                integer = false;
+            } else {
+                v = v * 10 + d;
+            }
+        }
+    }
+
+    if (integer) {
+        if (!neg) {
+            return Value(v);
+        } else if (v <= (uint64_t)INT64_MAX + 1) {
+            return Value((int64_t)(0 - v));
+        }
+    }
+    return Value(Value::numeric_t, std::string(start, p - start));
+}
+
+static void json_literal(const char *&p, const char *end, const char *lit,
+                         size_t len) {
+    if ((size_t)(end - p) < len || memcmp(p, lit, len)) {
+        throw ValueException("In-valid json");
+    }
+    p += len;
+}
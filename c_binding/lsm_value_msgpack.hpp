@@ -0,0 +1,396 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ */
+
+/*
+ * MessagePack (https://msgpack.org/) encoding of Value.  Only the subset of
+ * the format needed to carry what json can is supported: nil, boolean,
+ * integer, float 64, str, array and map (with str keys).  Anything else in a
+ * received payload is treated as invalid.
+ */
+
+static void mp_put_be(std::string &out, uint8_t tag, uint64_t v, int bytes) {
+    char b[9];
+
+    b[0] = (char)tag;
+    for (int i = bytes; i > 0; --i) {
+        b[i] = (char)(v & 0xff);
+        v >>= 8;
+    }
+    out.append(b, bytes + 1);
+}
+
+static void mp_put_uint(std::string &out, uint64_t v) {
+    if (v < 0x80) {
+        out.push_back((char)v);
+    } else if (v <= 0xff) {
+        mp_put_be(out, 0xcc, v, 1);
+    } else if (v <= 0xffff) {
+        mp_put_be(out, 0xcd, v, 2);
+    } else if (v <= 0xffffffff) {
+        mp_put_be(out, 0xce, v, 4);
+    } else {
+        mp_put_be(out, 0xcf, v, 8);
+    }
+}
+
+static void mp_put_int(std::string &out, int64_t v) {
+    if (v >= 0) {
+        mp_put_uint(out, (uint64_t)v);
+    } else if (v >= -32) {
+        out.push_back((char)(uint8_t)v);
+    } else if (v >= INT8_MIN) {
+        mp_put_be(out, 0xd0, (uint8_t)v, 1);
+    } else if (v >= INT16_MIN) {
+        mp_put_be(out, 0xd1, (uint16_t)v, 2);
+    } else if (v >= INT32_MIN) {
+        mp_put_be(out, 0xd2, (uint32_t)v, 4);
+    } else {
+        mp_put_be(out, 0xd3, (uint64_t)v, 8);
+    }
+}
+
+/**
+ * Numbers Value keeps as text, write them out as the smallest integer which
+ * holds them, or as a float 64 if they are not integers.
+ */
+static void mp_put_numeric(std::string &out, const std::string &s) {
+    const char *str = s.c_str();
+    char *end = NULL;
+
+    errno = 0;
+    if (str[0] == '-') {
+        long long v = strtoll(str, &end, 10);
+        if (!errno && end != str && *end == '\0') {
+            mp_put_int(out, v);
+            return;
+        }
+    } else {
+        unsigned long long v = strtoull(str, &end, 10);
+        if (!errno && end != str && *end == '\0') {
+            mp_put_uint(out, v);
+            return;
+        }
+    }
+
+    errno = 0;
+    double d = strtod(str, &end);
+    if (errno || end == str || *end != '\0') {
+        throw ValueException("Value not numeric: " + s);
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    mp_put_be(out, 0xcb, bits, 8);
+}
+
+static void mp_put_len(std::string &out, size_t len, uint8_t fix_tag,
+                       size_t fix_max, uint8_t tag16) {
+    if (len <= fix_max) {
+        out.push_back((char)(fix_tag | len));
+    } else if (len <= 0xffff) {
+        mp_put_be(out, tag16, len, 2);
+    } else if (len <= 0xffffffff) {
+        mp_put_be(out, tag16 + 1, len, 4);
+    } else {
+        throw ValueException("Value too large to serialize");
+    }
+}
+
+static void mp_put_str(std::string &out, const std::string &s) {
+    if (s.size() > 31 && s.size() <= 0xff) {
+        mp_put_be(out, 0xd9, s.size(), 1);
+    } else {
+        mp_put_len(out, s.size(), 0xa0, 31, 0xda);
+    }
+    out.append(s);
+}
+
+void Value::serializeMsgpack(std::string &out) const {
+    switch (t) {
+    case (null_t):
+        out.push_back((char)0xc0);
+        break;
+    case (boolean_t):
+        out.push_back((char)((b) ? 0xc3 : 0xc2));
+        break;
+    case (numeric_t):
+        if (n == int_n) {
+            mp_put_int(out, i);
+        } else if (n == uint_n) {
+            mp_put_uint(out, u);
+        } else {
+            mp_put_numeric(out, s);
+        }
+        break;
+    case (string_t):
+        mp_put_str(out, s);
+        break;
+    case (object_t): {
+        mp_put_len(out, o.size(), 0x80, 15, 0xde);
+
+        for (size_t m = 0; m < o.size(); ++m) {
+            mp_put_str(out, o[m].first);
+            o[m].second.serializeMsgpack(out);
+        }
+        break;
+    }
+    case (array_t):
+        mp_put_len(out, a.size(), 0x90, 15, 0xdc);
+        for (size_t e = 0; e < a.size(); ++e) {
+            a[e].serializeMsgpack(out);
+        }
+        break;
+    }
+}
+
+/**
+ * Cursor over a received MessagePack payload, every read is bounds checked.
+ */
+struct mp_reader {
+    const uint8_t *p;
+    const uint8_t *end;
+
+    const uint8_t *take(size_t n) {
+        if ((size_t)(end - p) < n) {
+            throw ValueException("Truncated MessagePack payload");
+        }
+        const uint8_t *r = p;
+        p += n;
+        return r;
+    }
+
+    uint64_t be(int bytes) {
+        const uint8_t *b = take(bytes);
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) {
+            v = (v << 8) | b[i];
+        }
+        return v;
+    }
+};
+
+static Value mp_uint_value(uint64_t v) { return Value(v); }
+
+static Value mp_int_value(int64_t v) { return Value(v); }
+
+static std::string mp_get_str(mp_reader &r, size_t len) {
+    const uint8_t *b = r.take(len);
+    return std::string((const char *)b, len);
+}
+
+static Value mp_parse(mp_reader &r);
+
+static Value mp_get_array(mp_reader &r, size_t num) {
+    std::vector<Value> values;
+
+    // Every element takes at least a byte, don't trust num any further
+    values.reserve(std::min(num, (size_t)(r.end - r.p)));
+    for (size_t i = 0; i < num; ++i) {
+        values.emplace_back(mp_parse(r));
+    }
+    return Value(std::move(values));
+}
+
+/**
+ * Length of the str whose tag was just read, throws if it is not a str.
+ */
+static bool mp_str_len(mp_reader &r, uint8_t tag, size_t &len) {
+    if ((tag & 0xe0) == 0xa0) {
+        len = tag & 0x1f;
+    } else if (tag == 0xd9) {
+        len = r.be(1);
+    } else if (tag == 0xda) {
+        len = r.be(2);
+    } else if (tag == 0xdb) {
+        len = r.be(4);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void mp_get_key(mp_reader &r, std::string &key) {
+    size_t len;
+
+    if (!mp_str_len(r, *r.take(1), len)) {
+        throw ValueException("Expecting MessagePack map key to be str");
+    }
+    const uint8_t *b = r.take(len);
+    key.assign((const char *)b, len);
+}
+
+static Value mp_get_map(mp_reader &r, size_t num) {
+    Value::object_type values;
+
+    // A member takes at least two bytes
+    values.reserve(std::min(num, (size_t)(r.end - r.p) / 2));
+    for (size_t i = 0; i < num; ++i) {
+        std::string key;
+        mp_get_key(r, key);
+        values.emplace_back(std::move(key), mp_parse(r));
+    }
+    return Value(std::move(values));
+}
+
+static Value mp_parse(mp_reader &r) {
+    uint8_t tag = *r.take(1);
+
+    if (tag < 0x80) {
+        return mp_uint_value(tag);
+    } else if (tag >= 0xe0) {
+        return mp_int_value((int8_t)tag);
+    } else if ((tag & 0xf0) == 0x80) {
+        return mp_get_map(r, tag & 0x0f);
+    } else if ((tag & 0xf0) == 0x90) {
+        return mp_get_array(r, tag & 0x0f);
+    } else if ((tag & 0xe0) == 0xa0) {
+        return Value(mp_get_str(r, tag & 0x1f));
+    }
+
+    switch (tag) {
+    case (0xc0):
+        return Value();
+    case (0xc2):
+        return Value(false);
+    case (0xc3):
+        return Value(true);
+    case (0xca): {
+        uint32_t bits = (uint32_t)r.be(4);
+        float f;
+        char buf[32];
+        memcpy(&f, &bits, sizeof(f));
+        snprintf(buf, sizeof(buf), "%.9g", f);
+        return Value(Value::numeric_t, buf);
+    }
+    case (0xcb): {
+        uint64_t bits = r.be(8);
+        double d;
+        char buf[32];
+        memcpy(&d, &bits, sizeof(d));
+        snprintf(buf, sizeof(buf), "%.17g", d);
+        return Value(Value::numeric_t, buf);
+    }
+    case (0xcc):
+        return mp_uint_value(r.be(1));
+    case (0xcd):
+        return mp_uint_value(r.be(2));
+    case (0xce):
+        return mp_uint_value(r.be(4));
+    case (0xcf):
+        return mp_uint_value(r.be(8));
+    case (0xd0):
+        return mp_int_value((int8_t)r.be(1));
+    case (0xd1):
+        return mp_int_value((int16_t)r.be(2));
+    case (0xd2):
+        return mp_int_value((int32_t)r.be(4));
+    case (0xd3):
+        return mp_int_value((int64_t)r.be(8));
+    case (0xd9):
+        return Value(mp_get_str(r, r.be(1)));
+    case (0xda):
+        return Value(mp_get_str(r, r.be(2)));
+    case (0xdb):
+        return Value(mp_get_str(r, r.be(4)));
+    case (0xdc):
+        return mp_get_array(r, r.be(2));
+    case (0xdd):
+        return mp_get_array(r, r.be(4));
+    case (0xde):
+        return mp_get_map(r, r.be(2));
+    case (0xdf):
+        return mp_get_map(r, r.be(4));
+    default:
+        throw ValueException("Unsupported MessagePack type " +
+                             ::to_string((int)tag));
+    }
+}
+
+/**
+ * What the value starting with tag is, throws for anything unsupported.
+ */
+static Value::value_type mp_type(uint8_t tag) {
+    if (tag < 0x80 || tag >= 0xe0 || (tag >= 0xca && tag <= 0xd3)) {
+        return Value::numeric_t;
+    } else if ((tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf) {
+        return Value::object_t;
+    } else if ((tag & 0xf0) == 0x90 || tag == 0xdc || tag == 0xdd) {
+        return Value::array_t;
+    } else if ((tag & 0xe0) == 0xa0 || (tag >= 0xd9 && tag <= 0xdb)) {
+        return Value::string_t;
+    } else if (tag == 0xc0) {
+        return Value::null_t;
+    } else if (tag == 0xc2 || tag == 0xc3) {
+        return Value::boolean_t;
+    }
+    throw ValueException("Unsupported MessagePack type " +
+                         ::to_string((int)tag));
+}
+
+/**
+ * Number of members or elements of the map or array whose tag was just read.
+ */
+static size_t mp_container_len(mp_reader &r, uint8_t tag) {
+    if (tag < 0xa0) {
+        return tag & 0x0f;
+    }
+    return r.be((tag == 0xdc || tag == 0xde) ? 2 : 4);
+}
+
+/**
+ * Reads the header of a map or an array, returning how many members or
+ * elements follow.
+ */
+static size_t mp_get_len(mp_reader &r, Value::value_type t) {
+    uint8_t tag = *r.take(1);
+
+    if (mp_type(tag) != t) {
+        throw ValueException(t == Value::object_t ? "Value not object"
+                                                  : "Value not array");
+    }
+    return mp_container_len(r, tag);
+}
+
+/**
+ * Steps over a value without decoding it.
+ */
+static void mp_skip(mp_reader &r) {
+    uint8_t tag = *r.take(1);
+    size_t len;
+
+    switch (mp_type(tag)) {
+    case (Value::object_t): {
+        size_t num = mp_container_len(r, tag);
+        for (size_t i = 0; i < num; ++i) {
+            if (!mp_str_len(r, *r.take(1), len)) {
+                throw ValueException("Expecting MessagePack map key to be str");
+            }
+            r.take(len);
+            mp_skip(r);
+        }
+        break;
+    }
+    case (Value::array_t): {
+        size_t num = mp_container_len(r, tag);
+        for (size_t i = 0; i < num; ++i) {
+            mp_skip(r);
+        }
+        break;
+    }
+    case (Value::string_t):
+        mp_str_len(r, tag, len);
+        r.take(len);
+        break;
+    case (Value::numeric_t):
+        if (tag >= 0xca && tag <= 0xd3) {
+            static const uint8_t sizes[] = {4, 8, 1, 2, 4, 8, 1, 2, 4, 8};
+            r.take(sizes[tag - 0xca]);
+        }
+        break;
+    default:
+        break;
+    }
+}
@@ -24,10 +24,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/epoll.h>
 #include <sys/queue.h>
+#include <sys/signalfd.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
-#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <sys/wait.h>
@@ -43,13 +44,9 @@
 #define LSMD_CONF_FILE                 "lsmd.conf"
 #define LSM_CONF_ALLOW_ROOT_OPT_NAME   "allow-plugin-root-privilege"
 #define LSM_CONF_REQUIRE_ROOT_OPT_NAME "require-root-privilege"
-
-#define max(a, b)                                                              \
-    ({                                                                         \
-        __typeof__(a) _a = (a);                                                \
-        __typeof__(b) _b = (b);                                                \
-        _a > _b ? _a : _b;                                                     \
-    })
+#define LSM_CONF_WARM_POOL_OPT_NAME    "plugin-warm-pool-size"
+#define WARM_POOL_MAX                  64
+#define EPOLL_EVENTS_MAX               64
 
 int verbose_flag = 0;
 int systemd = 0;
@@ -63,12 +60,18 @@ char plugin_extension[] = "_lsmplugin";
 char plugin_conf_extension[] = ".conf";
 
 enum { SERVE_RUNNING, SERVE_RESTART, SERVE_EXIT };
-volatile sig_atomic_t serve_state = SERVE_RUNNING;
+int serve_state = SERVE_RUNNING;
+
+/* Signals we handle, delivered through signal_fd instead of a handler */
+sigset_t handled_signals;
+sigset_t orig_sigmask;
+int signal_fd = -1;
 
 int plugin_mem_debug = 0;
 
 int allow_root_plugin = 0;
 int has_root_plugin = 0;
+int warm_pool_size = 0;
 
 /**
  * Each item in plugin list contains this information
@@ -77,6 +80,9 @@ struct plugin {
     char *file_path;
     int require_root;
     int fd;
+    int warm_size;  /* Idle plug-in processes to keep started */
+    int warm_count; /* Idle plug-in processes started */
+    int *warm_fd;   /* Our end of the control socket of each idle process */
     LIST_ENTRY(plugin) pointers;
 };
 
@@ -118,7 +124,39 @@ void logger(int severity, const char *fmt, ...) {
 #define info(fmt, ...)         logger(LOG_INFO, fmt, ##__VA_ARGS__)
 
 /**
- * Our signal handler.
+ * Cleans up any children that have exited.
+ */
+void child_cleanup(void) {
+    int rc;
+    int err;
+
+    do {
+        siginfo_t si;
+        memset(&si, 0, sizeof(siginfo_t));
+
+        rc = waitid(P_ALL, 0, &si, WNOHANG | WEXITED);
+
+        if (-1 == rc) {
+            err = errno;
+            if (err != ECHILD) {
+                info("waitid %d - %s\n", err, strerror(err));
+            }
+            break;
+        } else {
+            if (0 == rc && si.si_pid == 0) {
+                break;
+            } else {
+                if (si.si_code == CLD_EXITED && si.si_status != 0) {
+                    info("Plug-in process %d exited with %d\n", si.si_pid,
+                         si.si_status);
+                }
+            }
+        }
+    } while (1);
+}
+
+/**
+ * Handles the signals read from signal_fd.
  * @param s     Received signal
  */
 void signal_handler(int s) {
@@ -126,19 +164,57 @@ void signal_handler(int s) {
         serve_state = SERVE_EXIT;
     } else if (SIGHUP == s) {
         serve_state = SERVE_RESTART;
+    } else if (SIGCHLD == s) {
+        child_cleanup();
     }
 }
 
 /**
- * Installs our signal handler
+ * Blocks the signals we handle and creates signal_fd to read them from, so
+ * they get handled in the main event loop.
  */
 void install_sh(void) {
-    if (signal(SIGTERM, signal_handler) == SIG_ERR) {
-        log_and_exit("Can't catch signal SIGTERM\n");
+    int err = 0;
+
+    sigemptyset(&handled_signals);
+    sigaddset(&handled_signals, SIGTERM);
+    sigaddset(&handled_signals, SIGHUP);
+    sigaddset(&handled_signals, SIGCHLD);
+
+    if (-1 == sigprocmask(SIG_BLOCK, &handled_signals, &orig_sigmask)) {
+        err = errno;
+        log_and_exit("Can't block signals: %s\n", strerror(err));
     }
 
-    if (signal(SIGHUP, signal_handler) == SIG_ERR) {
-        log_and_exit("Can't catch signal SIGHUP\n");
+    signal_fd = signalfd(-1, &handled_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (-1 == signal_fd) {
+        err = errno;
+        log_and_exit("Error on signalfd: %s\n", strerror(err));
+    }
+}
+
+/**
+ * Reads and handles all the signals pending on signal_fd.
+ */
+void signals_read(void) {
+    struct signalfd_siginfo si;
+    ssize_t rd = 0;
+    int err = 0;
+
+    while (1) {
+        rd = read(signal_fd, &si, sizeof(si));
+        if (rd != sizeof(si)) {
+            if (-1 == rd && EINTR == errno) {
+                continue;
+            }
+            if (-1 == rd && EAGAIN != errno) {
+                err = errno;
+                log_and_exit("Error on reading signalfd: %s\n",
+                             strerror(err));
+            }
+            break;
+        }
+        signal_handler(si.ssi_signo);
     }
 }
 
@@ -353,7 +429,8 @@ int setup_socket(char *name) {
     char *socket_file = path_form(socket_dir, name);
     delete_socket(NULL, socket_file);
 
-    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    /* Non-blocking so we can accept until there is nobody left waiting */
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (-1 != fd) {
         struct sockaddr_un addr;
         memset(&addr, 0, sizeof(addr));
@@ -375,7 +452,7 @@ int setup_socket(char *name) {
                          strerror(err));
         }
 
-        if (-1 == listen(fd, 5)) {
+        if (-1 == listen(fd, SOMAXCONN)) {
             err = errno;
             log_and_exit("Error on listening %s: %s\n", socket_file,
                          strerror(err));
@@ -409,6 +486,13 @@ void empty_plugin_list(struct plugin_list *list) {
                  item->file_path, strerror(err));
         }
 
+        /* Idle plug-in processes exit once their control socket closes */
+        while (item->warm_count > 0) {
+            close(item->warm_fd[--item->warm_count]);
+        }
+        free(item->warm_fd);
+        item->warm_fd = NULL;
+
         free(item->file_path);
         item->file_path = NULL;
         item->fd = INT_MAX;
@@ -452,13 +536,47 @@ void parse_conf_bool(const char *conf_path, const char *key_name, int *value) {
 }
 
 /**
- * Load plugin config for root privilege setting.
- * If config not found, return 0 for no root privilege required.
+ * Parse config and seeking provided key name integer, same rules as
+ * parse_conf_bool().
+ * @param conf_path     config file path
+ * @param key_name      string, searching key
+ * @param value         int, output, value of this config key
+ */
+
+void parse_conf_int(const char *conf_path, const char *key_name, int *value) {
+    if (access(conf_path, F_OK) == -1) {
+        /* file not exist. */
+        return;
+    }
+    config_t *cfg = (config_t *)malloc(sizeof(config_t));
+    if (cfg) {
+        config_init(cfg);
+        if (CONFIG_TRUE == config_read_file(cfg, conf_path)) {
+            config_lookup_int(cfg, key_name, value);
+        } else {
+            log_and_exit("configure %s parsing failed: %s at line %d\n",
+                         conf_path, config_error_text(cfg),
+                         config_error_line(cfg));
+        }
+    } else {
+        log_and_exit(
+            "malloc failure while trying to allocate memory for config_t\n");
+    }
+
+    config_destroy(cfg);
+    free(cfg);
+}
+
+/**
+ * Load plugin config for root privilege and warm pool settings.
+ * If config not found, no root privilege is required and the warm pool size
+ * from lsmd.conf is used.
  * @param plugin_name plugin name.
+ * @param warm_size   int, output, number of idle processes to keep started.
  * @return 1 for require root privilege, 0 or not.
  */
 
-int chk_pconf_root_pri(char *plugin_name) {
+int chk_pconf_root_pri(char *plugin_name, int *warm_size) {
     int require_root = 0;
     size_t plugin_name_len = strlen(plugin_name);
     size_t conf_ext_len = strlen(plugin_conf_extension);
@@ -477,6 +595,16 @@ int chk_pconf_root_pri(char *plugin_name) {
         parse_conf_bool(plugin_conf_path, LSM_CONF_REQUIRE_ROOT_OPT_NAME,
                         &require_root);
 
+        *warm_size = warm_pool_size;
+        parse_conf_int(plugin_conf_path, LSM_CONF_WARM_POOL_OPT_NAME,
+                       warm_size);
+        if (*warm_size < 0 || *warm_size > WARM_POOL_MAX) {
+            warn("Plugin %s %s %d out of range 0-%d, using %d\n", plugin_name,
+                 LSM_CONF_WARM_POOL_OPT_NAME, *warm_size, WARM_POOL_MAX,
+                 warm_pool_size);
+            *warm_size = warm_pool_size;
+        }
+
         if (require_root == 1 && allow_root_plugin == 0) {
             warn("Plugin %s require root privilege while %s disable globally\n",
                  plugin_name, LSMD_CONF_FILE);
@@ -535,7 +663,7 @@ int process_plugin(void *p, char *full_name) {
 
     item->file_path = strdup(full_name);
     item->fd = setup_socket(plugin_name);
-    item->require_root = chk_pconf_root_pri(plugin_name);
+    item->require_root = chk_pconf_root_pri(plugin_name, &item->warm_size);
     has_root_plugin |= item->require_root;
 
     if (item->file_path && item->fd >= 0) {
@@ -556,38 +684,6 @@ int process_plugin(void *p, char *full_name) {
     return 0;
 }
 
-/**
- * Cleans up any children that have exited.
- */
-void child_cleanup(void) {
-    int rc;
-    int err;
-
-    do {
-        siginfo_t si;
-        memset(&si, 0, sizeof(siginfo_t));
-
-        rc = waitid(P_ALL, 0, &si, WNOHANG | WEXITED);
-
-        if (-1 == rc) {
-            err = errno;
-            if (err != ECHILD) {
-                info("waitid %d - %s\n", err, strerror(err));
-            }
-            break;
-        } else {
-            if (0 == rc && si.si_pid == 0) {
-                break;
-            } else {
-                if (si.si_code == CLD_EXITED && si.si_status != 0) {
-                    info("Plug-in process %d exited with %d\n", si.si_pid,
-                         si.si_status);
-                }
-            }
-        }
-    } while (1);
-}
-
 /**
  * Closes and frees memory and removes Unix domain sockets.
  */
@@ -614,18 +710,121 @@ int process_plugins(void) {
 }
 
 /**
- * Given a socket descriptor looks it up and returns the plug-in
- * @param fd        Socket descriptor to lookup
- * @return struct plugin
+ * Sets up the privileges of a freshly forked plug-in process.
+ * @param plugin        Full filename and path of plug-in.
+ * @param client_fd     Client connected file descriptor, -1 when the client
+ *                      is not known yet
+ * @param require_root  int, indicate whether this plugin require root
+ *                      privilege or not
  */
-struct plugin *plugin_lookup(int fd) {
-    struct plugin *plug = NULL;
-    LIST_FOREACH(plug, &head, pointers) {
-        if (plug->fd == fd) {
-            return plug;
+void plugin_privileges(char *plugin, int client_fd, int require_root) {
+    struct ucred cli_user_cred;
+    socklen_t cli_user_cred_len = sizeof(cli_user_cred);
+
+    /*
+     * The plugin will still run no matter with root privilege or not.
+     * so that client could get detailed error message.
+     */
+    if (require_root == 0) {
+        drop_privileges();
+    } else {
+        if (getuid()) {
+            warn("Plugin %s requires root privileges, but lsmd daemon "
+                 "is not running as root user\n",
+                 plugin);
+        } else if (allow_root_plugin == 0) {
+            warn("Plugin %s requires root privileges, but %s disables "
+                 "it globally\n",
+                 plugin, LSMD_CONF_FILE);
+            drop_privileges();
+        } else if (client_fd < 0) {
+            /* Never pre-started, see plugin_can_prestart() */
+            drop_privileges();
+        } else {
+            /* Check socket client uid */
+            int rc_get_cli_uid =
+                getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED, &cli_user_cred,
+                           &cli_user_cred_len);
+            if (0 == rc_get_cli_uid) {
+                if (cli_user_cred.uid != 0) {
+                    warn("Plugin %s requires root privileges, but "
+                         "client is not running as root user\n",
+                         plugin);
+                    drop_privileges();
+                } else {
+                    info("Plugin %s is running as root privilege\n", plugin);
+                }
+            } else {
+                warn("Failed to get client socket uid, getsockopt() "
+                     "error: %d\n",
+                     errno);
+                drop_privileges();
+            }
         }
     }
-    return NULL;
+}
+
+/**
+ * Replaces the forked child with the plug-in, does not return.
+ * @param plugin    Full filename and path of plug-in to exec.
+ * @param fd        File descriptor handed to the plug-in
+ * @param warm      When set fd is a control socket the client connection
+ *                  will be passed over later, else it is the client.
+ */
+void plugin_exec(char *plugin, int fd, int warm) {
+    int err = 0;
+    int exec_rc = 0;
+    int i = 0;
+    char fd_str[12];
+    const char *plugin_argv[8];
+    extern char **environ;
+
+    /* Make copy of plug-in string as once we call empty_plugin_list it
+     * will be deleted :-) */
+    char *p_copy = strdup(plugin);
+
+    empty_plugin_list(&head);
+    snprintf(fd_str, sizeof(fd_str), "%d", fd);
+
+    /* Blocked signals stay blocked across execve */
+    sigprocmask(SIG_SETMASK, &orig_sigmask, NULL);
+
+    if (plugin_mem_debug) {
+        char debug_out[64];
+        snprintf(debug_out, (sizeof(debug_out) - 1),
+                 "--log-file=/tmp/leaking_%d-%d", getppid(), getpid());
+
+        plugin_argv[i++] = "valgrind";
+        plugin_argv[i++] = "--leak-check=full";
+        plugin_argv[i++] = "--show-reachable=no";
+        plugin_argv[i++] = debug_out;
+        plugin_argv[i++] = p_copy;
+    } else {
+        plugin_argv[i++] = basename(p_copy);
+    }
+
+    if (warm) {
+        plugin_argv[i++] = "--warm";
+    }
+    plugin_argv[i++] = fd_str;
+    plugin_argv[i] = NULL;
+
+    if (plugin_mem_debug) {
+        exec_rc =
+            execve("/usr/bin/valgrind", (char *const *)plugin_argv, environ);
+    } else {
+        exec_rc = execve(p_copy, (char *const *)plugin_argv, environ);
+    }
+
+    /*
+     * The only reason we would get here is if execve fails as execve
+     * does not return on success.
+     */
+    err = errno;
+    warn("Error on exec'ing Plugin: %s: %s (execve rc: %d)\n", p_copy,
+         strerror(err), exec_rc);
+    free(p_copy);
+    exit(1);
 }
 
 /**
@@ -658,91 +857,216 @@ void exec_plugin(char *plugin, int client_fd, int require_root) {
 
     } else {
         /* Child */
-        int exec_rc = 0;
-        char fd_str[12];
-        const char *plugin_argv[7];
-        extern char **environ;
-        struct ucred cli_user_cred;
-        socklen_t cli_user_cred_len = sizeof(cli_user_cred);
+        plugin_privileges(plugin, client_fd, require_root);
+        plugin_exec(plugin, client_fd, 0);
+    }
+}
 
-        /*
-         * The plugin will still run no matter with root privilege or not.
-         * so that client could get detailed error message.
-         */
-        if (require_root == 0) {
-            drop_privileges();
-        } else {
-            if (getuid()) {
-                warn("Plugin %s requires root privileges, but lsmd daemon "
-                     "is not running as root user\n",
-                     plugin);
-            } else if (allow_root_plugin == 0) {
-                warn("Plugin %s requires root privileges, but %s disables "
-                     "it globally\n",
-                     plugin, LSMD_CONF_FILE);
-                drop_privileges();
-            } else {
-                /* Check socket client uid */
-                int rc_get_cli_uid =
-                    getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED,
-                               &cli_user_cred, &cli_user_cred_len);
-                if (0 == rc_get_cli_uid) {
-                    if (cli_user_cred.uid != 0) {
-                        warn("Plugin %s requires root privileges, but "
-                             "client is not running as root user\n",
-                             plugin);
-                        drop_privileges();
-                    } else {
-                        info("Plugin %s is running as root privilege\n",
-                             plugin);
-                    }
-                } else {
-                    warn("Failed to get client socket uid, getsockopt() "
-                         "error: %d\n",
-                         errno);
-                    drop_privileges();
-                }
-            }
+/**
+ * Plug-ins which may get root privileges can only be started once we know
+ * who the client is, the others can be started ahead of time.
+ * @param plug      Plug-in
+ * @return 1 if idle processes should be kept started for the plug-in
+ */
+int plugin_can_prestart(struct plugin *plug) {
+    return plug->warm_size > 0 &&
+           (!plug->require_root || getuid() || !allow_root_plugin);
+}
+
+/**
+ * Starts an idle plug-in process which waits for us to hand it a client
+ * connection.
+ * @param plug      Plug-in to start
+ * @return 0 on success, else -1
+ */
+int warm_plugin_start(struct plugin *plug) {
+    int err = 0;
+    int sv[2];
+
+    /* Our end must not leak into any of the plug-ins we start */
+    if (-1 == socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv)) {
+        err = errno;
+        info("Error on socketpair: %s\n", strerror(err));
+        return -1;
+    }
+
+    pid_t process = fork();
+    if (process < 0) {
+        err = errno;
+        info("Error on fork: %s\n", strerror(err));
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    } else if (process > 0) {
+        /* Parent */
+        close(sv[1]);
+        plug->warm_fd[plug->warm_count++] = sv[0];
+        return 0;
+    }
+
+    /* Child */
+    close(sv[0]);
+    if (-1 == fcntl(sv[1], F_SETFD, 0)) {
+        err = errno;
+        warn("Error on fcntl for plug-in %s: %s\n", plug->file_path,
+             strerror(err));
+        exit(1);
+    }
+    plugin_privileges(plug->file_path, -1, plug->require_root);
+    plugin_exec(plug->file_path, sv[1], 1);
+    return -1;
+}
+
+/**
+ * Starts idle plug-in processes until the plug-in has as many as configured.
+ * @param plug      Plug-in
+ */
+void warm_pool_fill(struct plugin *plug) {
+    if (!plugin_can_prestart(plug)) {
+        return;
+    }
+
+    if (!plug->warm_fd) {
+        plug->warm_fd = calloc(plug->warm_size, sizeof(int));
+        if (!plug->warm_fd) {
+            log_and_exit("Memory allocation failure!\n");
         }
+    }
 
-        /* Make copy of plug-in string as once we call empty_plugin_list it
-         * will be deleted :-) */
-        char *p_copy = strdup(plugin);
+    while (plug->warm_count < plug->warm_size) {
+        if (warm_plugin_start(plug)) {
+            break;
+        }
+    }
+}
 
-        empty_plugin_list(&head);
-        snprintf(fd_str, sizeof(fd_str), "%d", client_fd);
+/**
+ * Passes a file descriptor over a unix domain socket.
+ * @param sock      Connected unix domain socket
+ * @param fd        File descriptor to pass
+ * @return 0 on success, else -1 with errno set
+ */
+int fd_send(int sock, int fd) {
+    char byte = 0;
+    struct iovec iov;
+    struct msghdr mh;
+    struct cmsghdr *cm = NULL;
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+    ssize_t rc = 0;
+
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+
+    memset(&mh, 0, sizeof(mh));
+    memset(&ctl, 0, sizeof(ctl));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = ctl.buf;
+    mh.msg_controllen = sizeof(ctl.buf);
+
+    cm = CMSG_FIRSTHDR(&mh);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cm), &fd, sizeof(int));
 
-        if (plugin_mem_debug) {
-            char debug_out[64];
-            snprintf(debug_out, (sizeof(debug_out) - 1),
-                     "--log-file=/tmp/leaking_%d-%d", getppid(), getpid());
+    do {
+        rc = sendmsg(sock, &mh, MSG_NOSIGNAL);
+    } while (-1 == rc && EINTR == errno);
 
-            plugin_argv[0] = "valgrind";
-            plugin_argv[1] = "--leak-check=full";
-            plugin_argv[2] = "--show-reachable=no";
-            plugin_argv[3] = debug_out;
-            plugin_argv[4] = p_copy;
-            plugin_argv[5] = fd_str;
-            plugin_argv[6] = NULL;
+    return (rc == sizeof(byte)) ? 0 : -1;
+}
 
-            exec_rc = execve("/usr/bin/valgrind", (char *const *)plugin_argv,
-                             environ);
-        } else {
-            plugin_argv[0] = basename(p_copy);
-            plugin_argv[1] = fd_str;
-            plugin_argv[2] = NULL;
-            exec_rc = execve(p_copy, (char *const *)plugin_argv, environ);
+/**
+ * Hands a client connection to an idle plug-in process and starts another
+ * one in its place.
+ * @param plug          Plug-in
+ * @param client_fd     Client connected file descriptor, closed on success
+ * @return 0 on success, -1 if no idle process took the connection
+ */
+int warm_plugin_handoff(struct plugin *plug, int client_fd) {
+    int err = 0;
+
+    while (plug->warm_count > 0) {
+        int ctl_fd = plug->warm_fd[--plug->warm_count];
+        int rc = fd_send(ctl_fd, client_fd);
+
+        err = errno;
+        close(ctl_fd);
+
+        if (0 == rc) {
+            close(client_fd);
+            warm_pool_fill(plug);
+            return 0;
         }
 
         /*
-         * The only reason we would get here is if execve fails as execve
-         * does not return on success.
+         * The idle process is gone, most likely the plug-in does not know
+         * how to be started ahead of time.  Don't keep trying.
          */
+        warn("Idle plug-in %s went away (%s), disabling %s\n",
+             plug->file_path, strerror(err), LSM_CONF_WARM_POOL_OPT_NAME);
+        plug->warm_size = 0;
+    }
+    return -1;
+}
+
+/**
+ * Starts the idle processes of every plug-in which has a warm pool.
+ */
+void warm_pools_fill(void) {
+    struct plugin *plug = NULL;
+    LIST_FOREACH(plug, &head, pointers) { warm_pool_fill(plug); }
+}
+
+/**
+ * Accepts every client waiting on a plug-in socket and starts the plug-in
+ * for each one.
+ * @param plug      Plug-in with a readable listening socket
+ */
+void plugin_accept(struct plugin *plug) {
+    int err = 0;
+
+    while (1) {
+        int cfd = accept(plug->fd, NULL, NULL);
+        if (-1 == cfd) {
+            err = errno;
+            if (EINTR == err) {
+                continue;
+            }
+            if (EAGAIN != err && EWOULDBLOCK != err) {
+                info("Error on accepting request: %s", strerror(err));
+            }
+            break;
+        }
+
+        if (warm_plugin_handoff(plug, cfd)) {
+            exec_plugin(plug->file_path, cfd, plug->require_root);
+        }
+    }
+}
+
+/**
+ * Adds a file descriptor to the epoll set for read events.
+ * @param epfd      epoll file descriptor
+ * @param fd        File descriptor to watch
+ * @param data      Pointer returned with its events, NULL for signal_fd
+ */
+void epoll_watch(int epfd, int fd, void *data) {
+    int err = 0;
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = data;
+
+    if (-1 == epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev)) {
         err = errno;
-        warn("Error on exec'ing Plugin: %s: %s (execve rc: %d)\n", p_copy,
-             strerror(err), exec_rc);
-        free(p_copy);
-        exit(1);
+        log_and_exit("Error on adding fd %d to epoll: %s\n", fd,
+                     strerror(err));
     }
 }
 
@@ -751,67 +1075,51 @@ void exec_plugin(char *plugin, int client_fd, int require_root) {
  */
 void _serving(void) {
     struct plugin *plug = NULL;
-    struct timeval tmo;
-    fd_set readfds;
-    int nfds = 0;
+    struct epoll_event events[EPOLL_EVENTS_MAX];
+    int nplugins = 0;
     int err = 0;
+    int i = 0;
 
     process_plugins();
 
-    while (serve_state == SERVE_RUNNING) {
-        FD_ZERO(&readfds);
-        nfds = 0;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == epfd) {
+        err = errno;
+        log_and_exit("Error on epoll_create1: %s\n", strerror(err));
+    }
 
-        tmo.tv_sec = 15;
-        tmo.tv_usec = 0;
+    epoll_watch(epfd, signal_fd, NULL);
+    LIST_FOREACH(plug, &head, pointers) {
+        epoll_watch(epfd, plug->fd, plug);
+        nplugins++;
+    }
 
-        LIST_FOREACH(plug, &head, pointers) {
-            if (plug->fd >= FD_SETSIZE) {
-                log_and_exit("File descriptor %d exceeds FD_SETSIZE (%d)\n",
-                             plug->fd, FD_SETSIZE);
-            }
-            nfds = max(plug->fd, nfds);
-            FD_SET(plug->fd, &readfds);
-        }
+    if (!nplugins) {
+        log_and_exit("No plugins found in directory %s\n", plugin_dir);
+    }
 
-        if (!nfds) {
-            log_and_exit("No plugins found in directory %s\n", plugin_dir);
-        }
+    warm_pools_fill();
 
-        nfds += 1;
-        int ready = select(nfds, &readfds, NULL, NULL, &tmo);
+    while (serve_state == SERVE_RUNNING) {
+        int ready = epoll_wait(epfd, events, EPOLL_EVENTS_MAX, -1);
 
         if (-1 == ready) {
-            if (serve_state != SERVE_RUNNING) {
-                return;
-            } else if (errno == EINTR) {
+            if (errno == EINTR) {
                 continue;
-            } else {
-                err = errno;
-                log_and_exit("Error on selecting Plugin: %s", strerror(err));
             }
-        } else if (ready > 0) {
-            int fd = 0;
-            for (fd = 0; fd < nfds; fd++) {
-                if (FD_ISSET(fd, &readfds)) {
-                    int cfd = accept(fd, NULL, NULL);
-                    if (-1 != cfd) {
-                        struct plugin *p = plugin_lookup(fd);
-                        if (p != NULL) {
-                            exec_plugin(p->file_path, cfd, p->require_root);
-                        } else {
-                            info("plugin_lookup failed for fd %d", fd);
-                            close(cfd);
-                        }
-                    } else {
-                        err = errno;
-                        info("Error on accepting request: %s", strerror(err));
-                    }
-                }
+            err = errno;
+            log_and_exit("Error on waiting for Plugin: %s", strerror(err));
+        }
+
+        for (i = 0; i < ready; i++) {
+            if (events[i].data.ptr == NULL) {
+                signals_read();
+            } else if (serve_state == SERVE_RUNNING) {
+                plugin_accept((struct plugin *)events[i].data.ptr);
             }
         }
-        child_cleanup();
     }
+    close(epfd);
     clean_up();
 }
 
@@ -924,6 +1232,13 @@ int main(int argc, char *argv[]) {
     char *lsmd_conf_path = path_form(conf_dir, LSMD_CONF_FILE);
     parse_conf_bool(lsmd_conf_path, (char *)LSM_CONF_ALLOW_ROOT_OPT_NAME,
                     &allow_root_plugin);
+    parse_conf_int(lsmd_conf_path, LSM_CONF_WARM_POOL_OPT_NAME,
+                   &warm_pool_size);
+    if (warm_pool_size < 0 || warm_pool_size > WARM_POOL_MAX) {
+        warn("%s %d out of range 0-%d, not keeping idle plug-ins\n",
+             LSM_CONF_WARM_POOL_OPT_NAME, warm_pool_size, WARM_POOL_MAX);
+        warm_pool_size = 0;
+    }
     free(lsmd_conf_path);
 
     /* Check to see if we want to check plugin for memory errors */
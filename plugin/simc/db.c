@@ -677,6 +677,25 @@ void _db_sql_trans_rollback(sqlite3 *db) {
                      NULL /* don't parse output */);
 }
 
+int _db_sql_savepoint(char *err_msg, sqlite3 *db) {
+    assert(db != NULL);
+    return _db_sql_exec(err_msg, db, "SAVEPOINT bulk_item;",
+                        NULL /* don't parse output */);
+}
+
+int _db_sql_savepoint_release(char *err_msg, sqlite3 *db) {
+    assert(db != NULL);
+    return _db_sql_exec(err_msg, db, "RELEASE bulk_item;",
+                        NULL /* don't parse output */);
+}
+
+int _db_sql_savepoint_rollback(char *err_msg, sqlite3 *db) {
+    assert(db != NULL);
+    return _db_sql_exec(err_msg, db,
+                        "ROLLBACK TO bulk_item; RELEASE bulk_item;",
+                        NULL /* don't parse output */);
+}
+
 static void remove_trail_sep(int items_printed, char *s) {
     int nul_pos = items_printed - (int)strlen(", ");
     if (nul_pos >= 0 && nul_pos < _BUFF_SIZE) {
@@ -821,6 +840,45 @@ uint64_t _db_lsm_id_to_sim_id(const char *lsm_id) {
     return sim_id;
 }
 
+int _db_page_sql_gen(char *err_msg, char *sql_cmd, const char *table,
+                     const char *search_key, const char *search_value,
+                     uint32_t limit, const char *cursor) {
+    uint64_t last_sim_id = _DB_SIM_ID_NONE;
+    char condition[_BUFF_SIZE];
+    int printed = 0;
+
+    condition[0] = '\0';
+
+    if ((cursor != NULL) &&
+        (_str_to_uint64(err_msg, cursor, &last_sim_id) != LSM_ERR_OK)) {
+        _lsm_err_msg_set(err_msg, "Invalid cursor '%s'", cursor);
+        return LSM_ERR_INVALID_ARGUMENT;
+    }
+
+    /* Every view has the sim id columns the id search keys name. */
+    if ((search_key != NULL) && (search_value != NULL)) {
+        if (strcmp(search_key, "system_id") == 0) {
+            if (strcmp(search_value, _SYS_ID) != 0)
+                snprintf(condition, sizeof(condition), " AND 0");
+        } else if ((strcmp(search_key, "id") == 0) ||
+                   (strcmp(search_key, "pool_id") == 0) ||
+                   (strcmp(search_key, "fs_id") == 0)) {
+            snprintf(condition, sizeof(condition), " AND %s = %" PRIu64,
+                     search_key, _db_lsm_id_to_sim_id(search_value));
+        }
+    }
+
+    printed = snprintf(sql_cmd, _BUFF_SIZE,
+                       "SELECT * FROM %s WHERE id > %" PRIu64
+                       "%s ORDER BY id LIMIT %" PRIu32 ";",
+                       table, last_sim_id, condition, limit);
+    if ((printed < 0) || (printed >= _BUFF_SIZE)) {
+        _lsm_err_msg_set(err_msg, "Buff too small");
+        return LSM_ERR_PLUGIN_BUG;
+    }
+    return LSM_ERR_OK;
+}
+
 const char *_db_sim_id_to_lsm_id(char *buff, const char *prefix,
                                  uint64_t sim_id) {
     assert(buff != NULL);
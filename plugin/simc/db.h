@@ -89,6 +89,14 @@ int _db_sql_trans_begin(char *err_msg, sqlite3 *db);
 int _db_sql_trans_commit(char *err_msg, sqlite3 *db);
 void _db_sql_trans_rollback(sqlite3 *db);
 
+/*
+ * Savepoint around one item of a bulk call, inside the transaction of the
+ * whole call.  Rolling back undoes the item alone.
+ */
+int _db_sql_savepoint(char *err_msg, sqlite3 *db);
+int _db_sql_savepoint_release(char *err_msg, sqlite3 *db);
+int _db_sql_savepoint_rollback(char *err_msg, sqlite3 *db);
+
 /*
  * The ... va_arg should be NULL terminated strings.
  */
@@ -107,6 +115,17 @@ const char *_db_lsm_id_to_sim_id_str(const char *lsm_id);
 
 uint64_t _db_lsm_id_to_sim_id(const char *lsm_id);
 
+/*
+ * Generate the query of one page of a listing from a view, keyset paged on
+ * the sim id: rows after the sim id in cursor (NULL for the first page),
+ * at most limit of them.  Search keys naming a sim id column are matched in
+ * the query, the search filter still has to be applied to the result.
+ * sql_cmd: char[_BUFF_SIZE]
+ */
+int _db_page_sql_gen(char *err_msg, char *sql_cmd, const char *table,
+                     const char *search_key, const char *search_value,
+                     uint32_t limit, const char *cursor);
+
 /*
  * buff: char[_BUFF_SIZE]
  */
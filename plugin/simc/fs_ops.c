@@ -27,6 +27,10 @@ static int _fs_create_internal(char *err_msg, sqlite3 *db, const char *name,
 _xxx_list_func_gen(fs_list, lsm_fs, _sim_fs_to_lsm, lsm_plug_fs_search_filter,
                    _DB_TABLE_FSS_VIEW, lsm_fs_record_array_free);
 
+_xxx_list_page_func_gen(fs_list_page, lsm_fs, _sim_fs_to_lsm,
+                        lsm_plug_fs_search_filter, _DB_TABLE_FSS_VIEW,
+                        lsm_fs_record_array_free);
+
 lsm_fs *_sim_fs_to_lsm(char *err_msg, lsm_hash *sim_fs) {
     const char *plugin_data = NULL;
     uint64_t total_space = 0;
@@ -17,6 +17,11 @@
 int fs_list(lsm_plugin_ptr c, const char *search_key, const char *search_value,
             lsm_fs **fs[], uint32_t *fs_count, lsm_flag flags);
 
+int fs_list_page(lsm_plugin_ptr c, const char *search_key,
+                 const char *search_value, uint32_t limit, const char *cursor,
+                 lsm_fs **fs[], uint32_t *fs_count, char **next_cursor,
+                 lsm_flag flags);
+
 int fs_create(lsm_plugin_ptr c, lsm_pool *pool, const char *name,
               uint64_t size_bytes, lsm_fs **fs, char **job, lsm_flag flags);
 
@@ -30,6 +30,10 @@ _xxx_list_func_gen(pool_list, lsm_pool, sim_p_to_lsm,
                    lsm_plug_pool_search_filter, _DB_TABLE_POOLS_VIEW,
                    lsm_pool_record_array_free);
 
+_xxx_list_page_func_gen(pool_list_page, lsm_pool, sim_p_to_lsm,
+                        lsm_plug_pool_search_filter, _DB_TABLE_POOLS_VIEW,
+                        lsm_pool_record_array_free);
+
 static lsm_system *sim_sys_to_lsm(char *err_msg, lsm_hash *sim_sys) {
     lsm_system *sys = NULL;
     uint32_t status = LSM_SYSTEM_STATUS_OK;
@@ -97,7 +101,7 @@ static const char *time_stamp_str_get(char *buff) {
     memset(buff, 0, _BUFF_SIZE);
 
     if (clock_gettime(CLOCK_REALTIME, &ts) == 0)
-        snprintf(buff, _BUFF_SIZE, "%ld.%ld", (long)difftime(ts.tv_sec, 0),
+        snprintf(buff, _BUFF_SIZE, "%ld.%09ld", (long)difftime(ts.tv_sec, 0),
                  ts.tv_nsec);
 
     return buff;
@@ -253,33 +257,18 @@ out:
     return rc;
 }
 
-int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
-               uint8_t *percent_complete, lsm_data_type *type, void **value,
-               lsm_flag flags) {
+/*
+ * Looks a job up and reads when it was created and for how many seconds it
+ * runs.  The caller frees *sim_job.
+ */
+static int _job_times_get(char *err_msg, sqlite3 *db, const char *job,
+                          lsm_hash **sim_job, double *start,
+                          double *duration) {
     int rc = LSM_ERR_OK;
-    sqlite3 *db = NULL;
-    char err_msg[_LSM_ERR_MSG_LEN];
-    lsm_hash *sim_job = NULL;
     uint64_t sim_job_id = 0;
-    uint64_t sim_data_id = 0;
-    lsm_hash *sim_data = NULL;
     const char *time_stamp_str = NULL;
-    char cur_time_stamp_str[_BUFF_SIZE];
-    double job_start_time = 0;
-    double cur_time = 0;
-    double duration = 0;
     const char *duration_str = NULL;
-
-    _UNUSED(flags);
-    _lsm_err_msg_clear(err_msg);
-
-    _good(_check_null_ptr(err_msg, 5 /* argument count */, job, status,
-                          percent_complete, type, value),
-          rc, out);
-
-    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    char *endptr = NULL;
 
     sim_job_id = _db_lsm_id_to_sim_id(job);
     if (sim_job_id == 0) {
@@ -287,9 +276,9 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
         _lsm_err_msg_set(err_msg, "Job not found");
         goto out;
     }
-    _good(_db_sim_job_of_sim_id(err_msg, db, sim_job_id, &sim_job), rc, out);
+    _good(_db_sim_job_of_sim_id(err_msg, db, sim_job_id, sim_job), rc, out);
 
-    time_stamp_str = lsm_hash_string_get(sim_job, "timestamp");
+    time_stamp_str = lsm_hash_string_get(*sim_job, "timestamp");
     if ((time_stamp_str == NULL) || (strlen(time_stamp_str) == 0)) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg,
@@ -298,8 +287,8 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
                          job);
         goto out;
     }
-    job_start_time = strtod(time_stamp_str, NULL);
-    if (job_start_time == 0) {
+    *start = strtod(time_stamp_str, NULL);
+    if (*start == 0) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg,
                          "BUG: Failed to convert job creation "
@@ -308,49 +297,94 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
         goto out;
     }
 
-    time_stamp_str_get(cur_time_stamp_str);
-    cur_time = strtod(cur_time_stamp_str, NULL);
-    if (cur_time == 0) {
+    duration_str = lsm_hash_string_get(*sim_job, "duration");
+    if (duration_str == NULL || *duration_str == '\0') {
         rc = LSM_ERR_PLUGIN_BUG;
-        _lsm_err_msg_set(err_msg,
-                         "BUG: Failed to convert current time stamp "
-                         "'%s'",
-                         cur_time_stamp_str);
+        _lsm_err_msg_set(err_msg, "BUG: Got NULL or empty duration");
         goto out;
     }
-
-    duration_str = lsm_hash_string_get(sim_job, "duration");
-    if (duration_str == NULL || *duration_str == '\0') {
+    errno = 0;
+    *duration = strtod(duration_str, &endptr);
+    if (endptr == duration_str || *endptr != '\0' || errno == ERANGE ||
+        !isfinite(*duration)) {
         rc = LSM_ERR_PLUGIN_BUG;
-        _lsm_err_msg_set(err_msg, "BUG: Got NULL or empty duration");
+        _lsm_err_msg_set(err_msg, "BUG: Failed to parse duration '%s'",
+                         duration_str);
         goto out;
     }
-    {
-        char *endptr = NULL;
-        errno = 0;
-        duration = strtod(duration_str, &endptr);
-        if (endptr == duration_str || *endptr != '\0' || errno == ERANGE ||
-            !isfinite(duration)) {
-            rc = LSM_ERR_PLUGIN_BUG;
-            _lsm_err_msg_set(err_msg, "BUG: Failed to parse duration '%s'",
-                             duration_str);
-            goto out;
-        }
+
+out:
+    return rc;
+}
+
+static int _cur_time_get(char *err_msg, double *cur_time) {
+    char cur_time_stamp_str[_BUFF_SIZE];
+
+    time_stamp_str_get(cur_time_stamp_str);
+    *cur_time = strtod(cur_time_stamp_str, NULL);
+    if (*cur_time == 0) {
+        _lsm_err_msg_set(err_msg,
+                         "BUG: Failed to convert current time stamp "
+                         "'%s'",
+                         cur_time_stamp_str);
+        return LSM_ERR_PLUGIN_BUG;
     }
+    return LSM_ERR_OK;
+}
 
+/*
+ * How far a job created at start and running for duration seconds got by
+ * cur_time.
+ */
+static void _job_progress(double start, double duration, double cur_time,
+                          lsm_job_status *status, uint8_t *percent_complete) {
     if (duration <= 0) {
         *percent_complete = 100;
         *status = LSM_JOB_COMPLETE;
-    } else if (cur_time <= job_start_time) {
+    } else if (cur_time <= start) {
         *percent_complete = 0;
         *status = LSM_JOB_INPROGRESS;
-    } else if ((cur_time - job_start_time) >= duration) {
+    } else if ((cur_time - start) >= duration) {
         *percent_complete = 100;
         *status = LSM_JOB_COMPLETE;
     } else {
-        *percent_complete = ((cur_time - job_start_time) / duration * 100);
+        *percent_complete = ((cur_time - start) / duration * 100);
         *status = LSM_JOB_INPROGRESS;
     }
+}
+
+int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
+               uint8_t *percent_complete, lsm_data_type *type, void **value,
+               lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    lsm_hash *sim_job = NULL;
+    uint64_t sim_data_id = 0;
+    lsm_hash *sim_data = NULL;
+    double job_start_time = 0;
+    double cur_time = 0;
+    double duration = 0;
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+
+    _good(_check_null_ptr(err_msg, 5 /* argument count */, job, status,
+                          percent_complete, type, value),
+          rc, out);
+
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+
+    _good(_job_times_get(err_msg, db, job, &sim_job, &job_start_time,
+                         &duration),
+          rc, out);
+
+    _good(_cur_time_get(err_msg, &cur_time), rc, out);
+
+    _job_progress(job_start_time, duration, cur_time, status,
+                  percent_complete);
 
     _good(_str_to_int(err_msg, lsm_hash_string_get(sim_job, "data_type"), type),
           rc, out);
@@ -450,6 +484,109 @@ out:
     return rc;
 }
 
+int jobs_wait_any(lsm_plugin_ptr c, const char *jobs[], uint32_t count,
+                  uint8_t percent, uint32_t timeout, uint32_t *index,
+                  lsm_job_status *status, uint8_t *percent_complete,
+                  lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    lsm_hash *sim_job = NULL;
+    double *starts = NULL;
+    double *durations = NULL;
+    double cur_time = 0;
+    double deadline = 0;
+    double wake = 0;
+    double reach = 0;
+    lsm_job_status job_status = LSM_JOB_INPROGRESS;
+    uint8_t done = 0;
+    struct timespec ts;
+    uint32_t i = 0;
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+
+    _good(_check_null_ptr(err_msg, 4 /* argument count */, jobs, index,
+                          status, percent_complete),
+          rc, out);
+
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+
+    starts = (double *)malloc(sizeof(double) * count);
+    _alloc_null_check(err_msg, starts, rc, out);
+    durations = (double *)malloc(sizeof(double) * count);
+    _alloc_null_check(err_msg, durations, rc, out);
+
+    /* How far a job got only depends on the time, so one look at the jobs
+     * tells how long to sleep.
+     */
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    for (i = 0; i < count; ++i) {
+        rc = _job_times_get(err_msg, db, jobs[i], &sim_job, &starts[i],
+                            &durations[i]);
+        if (sim_job != NULL) {
+            lsm_hash_free(sim_job);
+            sim_job = NULL;
+        }
+        if (rc != LSM_ERR_OK) {
+            *index = i;
+            goto out;
+        }
+    }
+    _db_sql_trans_rollback(db);
+
+    _good(_cur_time_get(err_msg, &cur_time), rc, out);
+    deadline = cur_time + timeout / 1000.0;
+
+    for (;;) {
+        *index = 0;
+        *status = LSM_JOB_INPROGRESS;
+        *percent_complete = 0;
+        wake = deadline;
+
+        for (i = 0; i < count; ++i) {
+            _job_progress(starts[i], durations[i], cur_time, &job_status,
+                          &done);
+            if ((job_status != LSM_JOB_INPROGRESS) || (done >= percent)) {
+                *index = i;
+                *status = job_status;
+                *percent_complete = done;
+                goto out;
+            }
+            if (done > *percent_complete) {
+                *index = i;
+                *percent_complete = done;
+            }
+            reach = starts[i] + durations[i] * percent / 100;
+            if (reach < wake)
+                wake = reach;
+        }
+
+        if (cur_time >= deadline)
+            goto out;
+
+        /* A millisecond later the rounded down percentage has got there */
+        wake = (wake > cur_time ? wake : cur_time) + 0.001;
+        if (wake > deadline)
+            wake = deadline;
+        ts.tv_sec = (time_t)(wake - cur_time);
+        ts.tv_nsec = (long)((wake - cur_time - ts.tv_sec) * 1e9);
+        nanosleep(&ts, NULL);
+
+        _good(_cur_time_get(err_msg, &cur_time), rc, out);
+    }
+
+out:
+    _db_sql_trans_rollback(db);
+    free(starts);
+    free(durations);
+
+    if (rc != LSM_ERR_OK)
+        lsm_log_error_basic(c, rc, err_msg);
+
+    return rc;
+}
+
 int system_list(lsm_plugin_ptr c, lsm_system **systems[],
                 uint32_t *system_count, lsm_flag flags) {
     int rc = LSM_ERR_OK;
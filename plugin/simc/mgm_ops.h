@@ -31,10 +31,20 @@ int job_status(lsm_plugin_ptr c, const char *job, lsm_job_status *status,
 
 int job_free(lsm_plugin_ptr c, char *job_id, lsm_flag flags);
 
+int jobs_wait_any(lsm_plugin_ptr c, const char *jobs[], uint32_t count,
+                  uint8_t percent, uint32_t timeout, uint32_t *index,
+                  lsm_job_status *status, uint8_t *percent_complete,
+                  lsm_flag flags);
+
 int pool_list(lsm_plugin_ptr c, const char *search_key,
               const char *search_value, lsm_pool **pool_array[],
               uint32_t *count, lsm_flag flags);
 
+int pool_list_page(lsm_plugin_ptr c, const char *search_key,
+                   const char *search_value, uint32_t limit,
+                   const char *cursor, lsm_pool **pool_array[],
+                   uint32_t *count, char **next_cursor, lsm_flag flags);
+
 int system_list(lsm_plugin_ptr c, lsm_system **systems[],
                 uint32_t *system_count, lsm_flag flags);
 
@@ -35,6 +35,11 @@ _xxx_list_func_gen(nfs_list, lsm_nfs_export, _sim_exp_to_lsm,
                    lsm_plug_nfs_export_search_filter, _DB_TABLE_NFS_EXPS_VIEW,
                    lsm_nfs_export_record_array_free);
 
+_xxx_list_page_func_gen(nfs_list_page, lsm_nfs_export, _sim_exp_to_lsm,
+                        lsm_plug_nfs_export_search_filter,
+                        _DB_TABLE_NFS_EXPS_VIEW,
+                        lsm_nfs_export_record_array_free);
+
 static lsm_nfs_export *_sim_exp_to_lsm(char *err_msg, lsm_hash *sim_exp) {
     const char *plugin_data = NULL;
     uint64_t anon_uid = 0;
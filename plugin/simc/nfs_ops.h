@@ -20,6 +20,11 @@ int nfs_auth_types(lsm_plugin_ptr c, lsm_string_list **types, lsm_flag flags);
 int nfs_list(lsm_plugin_ptr c, const char *search_key, const char *search_value,
              lsm_nfs_export **exports[], uint32_t *count, lsm_flag flags);
 
+int nfs_list_page(lsm_plugin_ptr c, const char *search_key,
+                  const char *search_value, uint32_t limit, const char *cursor,
+                  lsm_nfs_export **exports[], uint32_t *count,
+                  char **next_cursor, lsm_flag flags);
+
 int nfs_export_fs(lsm_plugin_ptr c, const char *fs_id, const char *export_path,
                   lsm_string_list *root_list, lsm_string_list *rw_list,
                   lsm_string_list *ro_list, uint64_t anon_uid,
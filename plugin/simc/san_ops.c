@@ -42,6 +42,18 @@ _xxx_list_func_gen(access_group_list, lsm_access_group, _sim_ag_to_lsm,
                    lsm_plug_access_group_search_filter, _DB_TABLE_AGS_VIEW,
                    lsm_access_group_record_array_free);
 
+_xxx_list_page_func_gen(volume_list_page, lsm_volume, _sim_vol_to_lsm,
+                        lsm_plug_volume_search_filter, _DB_TABLE_VOLS_VIEW,
+                        lsm_volume_record_array_free);
+
+_xxx_list_page_func_gen(disk_list_page, lsm_disk, _sim_disk_to_lsm,
+                        lsm_plug_disk_search_filter, _DB_TABLE_DISKS_VIEW,
+                        lsm_disk_record_array_free);
+
+_xxx_list_page_func_gen(access_group_list_page, lsm_access_group,
+                        _sim_ag_to_lsm, lsm_plug_access_group_search_filter,
+                        _DB_TABLE_AGS_VIEW, lsm_access_group_record_array_free);
+
 _xxx_list_func_gen(target_port_list, lsm_target_port, _sim_tgt_to_lsm,
                    lsm_plug_target_port_search_filter, _DB_TABLE_TGTS_VIEW,
                    lsm_target_port_record_array_free);
@@ -267,11 +279,13 @@ out:
     return rc;
 }
 
-int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
-                  lsm_flag flags) {
+/*
+ * Everything volume_delete() does but the transaction, so volume_delete_bulk()
+ * can run many in one.  A job is created on success.
+ */
+static int _volume_delete_in_trans(char *err_msg, sqlite3 *db,
+                                   lsm_volume *volume, char **job) {
     int rc = LSM_ERR_OK;
-    sqlite3 *db = NULL;
-    char err_msg[_LSM_ERR_MSG_LEN];
     lsm_hash *sim_vol = NULL;
     uint64_t sim_vol_id = 0;
     char sql_cmd[_BUFF_SIZE];
@@ -281,13 +295,6 @@ int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
     uint64_t sim_disk_id = 0;
     uint32_t i = 0;
 
-    _UNUSED(flags);
-    _lsm_err_msg_clear(err_msg);
-    _good(_check_null_ptr(err_msg, 2 /* argument count */, volume, job), rc,
-          out);
-    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
     /* Check volume existence */
     _good(_db_sim_vol_of_sim_id(err_msg, db, sim_vol_id, &sim_vol), rc, out);
@@ -345,7 +352,6 @@ int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
 
     _good(_job_create(err_msg, db, LSM_DATA_TYPE_NONE, _DB_SIM_ID_NONE, job),
           rc, out);
-    _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
 out:
     _db_sql_exec_vec_free(vec);
@@ -353,6 +359,26 @@ out:
     if (sim_vol != NULL)
         lsm_hash_free(sim_vol);
 
+    return rc;
+}
+
+int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
+                  lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+    _good(_check_null_ptr(err_msg, 2 /* argument count */, volume, job), rc,
+          out);
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(_volume_delete_in_trans(err_msg, db, volume, job), rc, out);
+    _good(_db_sql_trans_commit(err_msg, db), rc, out);
+
+out:
     if (rc != LSM_ERR_OK) {
         _db_sql_trans_rollback(db);
         lsm_log_error_basic(c, rc, err_msg);
@@ -364,6 +390,50 @@ out:
     return rc;
 }
 
+/*
+ * Ends the savepoint of one item of a bulk call, keeping what the item did
+ * only if it succeeded.  Its error message isn't passed on, the code is.
+ */
+static int _bulk_item_end(char *err_msg, sqlite3 *db, int item_rc) {
+    _lsm_err_msg_clear(err_msg);
+    if (item_rc == LSM_ERR_OK)
+        return _db_sql_savepoint_release(err_msg, db);
+    return _db_sql_savepoint_rollback(err_msg, db);
+}
+
+int volume_delete_bulk(lsm_plugin_ptr c, lsm_volume *volumes[],
+                       uint32_t count, int32_t results[], char *jobs[],
+                       lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    uint32_t i = 0;
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+    _good(_check_null_ptr(err_msg, 3 /* argument count */, volumes, results,
+                          jobs),
+          rc, out);
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    for (i = 0; i < count; ++i) {
+        _good(_db_sql_savepoint(err_msg, db), rc, out);
+        results[i] = _volume_delete_in_trans(err_msg, db, volumes[i], &jobs[i]);
+        _good(_bulk_item_end(err_msg, db, results[i]), rc, out);
+        if (results[i] == LSM_ERR_OK)
+            results[i] = LSM_ERR_JOB_STARTED;
+    }
+    _good(_db_sql_trans_commit(err_msg, db), rc, out);
+
+out:
+    if (rc != LSM_ERR_OK) {
+        _db_sql_trans_rollback(db);
+        lsm_log_error_basic(c, rc, err_msg);
+    }
+    return rc;
+}
+
 int volume_replicate(lsm_plugin_ptr c, lsm_pool *pool,
                      lsm_replication_type rep_type, lsm_volume *volume_src,
                      const char *name, lsm_volume **new_replicant, char **job,
@@ -801,14 +871,15 @@ out:
     return rc;
 }
 
-int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
-                               const char *initiator_id,
-                               lsm_access_group_init_type init_type,
-                               lsm_access_group **updated_access_group,
-                               lsm_flag flags) {
+/*
+ * Everything access_group_initiator_add() does but the transaction and
+ * handing back the updated access group.
+ */
+static int _ag_initiator_add_in_trans(char *err_msg, sqlite3 *db,
+                                      lsm_access_group *access_group,
+                                      const char *initiator_id,
+                                      lsm_access_group_init_type init_type) {
     int rc = LSM_ERR_OK;
-    sqlite3 *db = NULL;
-    char err_msg[_LSM_ERR_MSG_LEN];
     uint64_t sim_ag_id = 0;
     lsm_hash *sim_ag = NULL;
     struct _vector *vec = NULL;
@@ -818,14 +889,6 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
     const char *sim_ag_id_str = NULL;
     const char *tmp_sim_ag_id_str = NULL;
 
-    _UNUSED(flags);
-    _lsm_err_msg_clear(err_msg);
-    _good(_check_null_ptr(err_msg, 3 /* argument count */, access_group,
-                          initiator_id, updated_access_group),
-          rc, out);
-    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
-
     if (strlen(initiator_id) == 0) {
         rc = LSM_ERR_INVALID_ARGUMENT;
         _lsm_err_msg_set(err_msg, "Invalid argument: empty initiator_id");
@@ -871,8 +934,28 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
                        "init_type", init_type_str, "owner_ag_id", sim_ag_id_str,
                        NULL),
           rc, out);
-    lsm_hash_free(sim_ag);
-    rc = _db_sim_ag_of_sim_id(err_msg, db, sim_ag_id, &sim_ag);
+
+out:
+    if (sim_ag != NULL)
+        lsm_hash_free(sim_ag);
+
+    _db_sql_exec_vec_free(vec);
+
+    return rc;
+}
+
+/*
+ * Reads an access group back once initiators of it changed.
+ */
+static int _ag_updated_get(char *err_msg, sqlite3 *db,
+                           lsm_access_group *access_group,
+                           lsm_access_group **updated_access_group) {
+    int rc = LSM_ERR_OK;
+    lsm_hash *sim_ag = NULL;
+
+    rc = _db_sim_ag_of_sim_id(
+        err_msg, db,
+        _db_lsm_id_to_sim_id(lsm_access_group_id_get(access_group)), &sim_ag);
     if (rc == LSM_ERR_NOT_FOUND_ACCESS_GROUP) {
         rc = LSM_ERR_PLUGIN_BUG;
         _lsm_err_msg_set(err_msg, "BUG: Failed to find updated access group");
@@ -881,23 +964,91 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
     if (rc != LSM_ERR_OK)
         goto out;
     *updated_access_group = _sim_ag_to_lsm(err_msg, sim_ag);
-    if (*updated_access_group == NULL) {
+    if (*updated_access_group == NULL)
         rc = LSM_ERR_PLUGIN_BUG;
-        goto out;
-    }
-
-    _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
 out:
     if (sim_ag != NULL)
         lsm_hash_free(sim_ag);
+    return rc;
+}
 
-    _db_sql_exec_vec_free(vec);
+int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
+                               const char *initiator_id,
+                               lsm_access_group_init_type init_type,
+                               lsm_access_group **updated_access_group,
+                               lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+    _good(_check_null_ptr(err_msg, 3 /* argument count */, access_group,
+                          initiator_id, updated_access_group),
+          rc, out);
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+
+    _good(_ag_initiator_add_in_trans(err_msg, db, access_group, initiator_id,
+                                     init_type),
+          rc, out);
+    _good(_ag_updated_get(err_msg, db, access_group, updated_access_group), rc,
+          out);
 
+    _good(_db_sql_trans_commit(err_msg, db), rc, out);
+
+out:
     if (rc != LSM_ERR_OK) {
         _db_sql_trans_rollback(db);
-        if (updated_access_group != NULL)
+        if (updated_access_group != NULL) {
+            lsm_access_group_record_free(*updated_access_group);
             *updated_access_group = NULL;
+        }
+        lsm_log_error_basic(c, rc, err_msg);
+    }
+    return rc;
+}
+
+int access_group_initiator_add_bulk(lsm_plugin_ptr c,
+                                    lsm_access_group *access_group,
+                                    lsm_string_list *initiator_ids,
+                                    lsm_access_group_init_type init_type,
+                                    int32_t results[],
+                                    lsm_access_group **updated_access_group,
+                                    lsm_flag flags) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    uint32_t i = 0;
+
+    _UNUSED(flags);
+    _lsm_err_msg_clear(err_msg);
+    _good(_check_null_ptr(err_msg, 4 /* argument count */, access_group,
+                          initiator_ids, results, updated_access_group),
+          rc, out);
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+
+    for (i = 0; i < lsm_string_list_size(initiator_ids); ++i) {
+        _good(_db_sql_savepoint(err_msg, db), rc, out);
+        results[i] = _ag_initiator_add_in_trans(
+            err_msg, db, access_group,
+            lsm_string_list_elem_get(initiator_ids, i), init_type);
+        _good(_bulk_item_end(err_msg, db, results[i]), rc, out);
+    }
+    _good(_ag_updated_get(err_msg, db, access_group, updated_access_group), rc,
+          out);
+
+    _good(_db_sql_trans_commit(err_msg, db), rc, out);
+
+out:
+    if (rc != LSM_ERR_OK) {
+        _db_sql_trans_rollback(db);
+        if (updated_access_group != NULL) {
+            lsm_access_group_record_free(*updated_access_group);
+            *updated_access_group = NULL;
+        }
         lsm_log_error_basic(c, rc, err_msg);
     }
     return rc;
@@ -998,26 +1149,19 @@ out:
     return rc;
 }
 
-int volume_mask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
-                lsm_flag flags) {
+/*
+ * Everything volume_mask() does but the transaction.
+ */
+static int _volume_mask_in_trans(char *err_msg, sqlite3 *db,
+                                 lsm_access_group *group, lsm_volume *volume) {
     int rc = LSM_ERR_OK;
     lsm_hash *sim_vol = NULL;
     lsm_hash *sim_ag = NULL;
     uint64_t sim_vol_id = 0;
     uint64_t sim_ag_id = 0;
-    sqlite3 *db = NULL;
-    char err_msg[_LSM_ERR_MSG_LEN];
     char sql_cmd_check_mask[_BUFF_SIZE];
     struct _vector *vec = NULL;
 
-    _UNUSED(flags);
-    _lsm_err_msg_clear(err_msg);
-
-    _good(_check_null_ptr(err_msg, 2 /* argument count */, group, volume), rc,
-          out);
-    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
-
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
     sim_ag_id = _db_lsm_id_to_sim_id(lsm_access_group_id_get(group));
 
@@ -1045,8 +1189,6 @@ int volume_mask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
               _db_lsm_id_to_sim_id_str(lsm_access_group_id_get(group)), NULL),
           rc, out);
 
-    _good(_db_sql_trans_commit(err_msg, db), rc, out);
-
 out:
     if (sim_ag != NULL)
         lsm_hash_free(sim_ag);
@@ -1055,35 +1197,24 @@ out:
     if (vec != NULL)
         _db_sql_exec_vec_free(vec);
 
-    if (rc != LSM_ERR_OK) {
-        _db_sql_trans_rollback(db);
-        lsm_log_error_basic(c, rc, err_msg);
-    }
-
     return rc;
 }
 
-int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
-                  lsm_flag flags) {
+/*
+ * Everything volume_unmask() does but the transaction.
+ */
+static int _volume_unmask_in_trans(char *err_msg, sqlite3 *db,
+                                   lsm_access_group *group,
+                                   lsm_volume *volume) {
     int rc = LSM_ERR_OK;
     lsm_hash *sim_vol = NULL;
     lsm_hash *sim_ag = NULL;
     uint64_t sim_vol_id = 0;
     uint64_t sim_ag_id = 0;
-    sqlite3 *db = NULL;
-    char err_msg[_LSM_ERR_MSG_LEN];
     char condition[_BUFF_SIZE];
     struct _vector *vec = NULL;
     char sql_cmd_check_mask[_BUFF_SIZE * 4];
 
-    _UNUSED(flags);
-    _lsm_err_msg_clear(err_msg);
-
-    _good(_check_null_ptr(err_msg, 2 /* argument count */, group, volume), rc,
-          out);
-    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
-    _good(_db_sql_trans_begin(err_msg, db), rc, out);
-
     sim_vol_id = _db_lsm_id_to_sim_id(lsm_volume_id_get(volume));
     sim_ag_id = _db_lsm_id_to_sim_id(lsm_access_group_id_get(group));
 
@@ -1110,7 +1241,6 @@ int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
     _good(
         _db_data_delete_condition(err_msg, db, _DB_TABLE_VOL_MASKS, condition),
         rc, out);
-    _good(_db_sql_trans_commit(err_msg, db), rc, out);
 
 out:
     if (sim_ag != NULL)
@@ -1121,6 +1251,28 @@ out:
     if (vec != NULL)
         _db_sql_exec_vec_free(vec);
 
+    return rc;
+}
+
+typedef int (*_volume_mask_func)(char *err_msg, sqlite3 *db,
+                                 lsm_access_group *group, lsm_volume *volume);
+
+static int _volume_mask_one(lsm_plugin_ptr c, lsm_access_group *group,
+                            lsm_volume *volume, _volume_mask_func func) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+
+    _lsm_err_msg_clear(err_msg);
+
+    _good(_check_null_ptr(err_msg, 2 /* argument count */, group, volume), rc,
+          out);
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    _good(func(err_msg, db, group, volume), rc, out);
+    _good(_db_sql_trans_commit(err_msg, db), rc, out);
+
+out:
     if (rc != LSM_ERR_OK) {
         _db_sql_trans_rollback(db);
         lsm_log_error_basic(c, rc, err_msg);
@@ -1129,6 +1281,65 @@ out:
     return rc;
 }
 
+static int _volume_mask_bulk(lsm_plugin_ptr c, lsm_access_group *group,
+                             lsm_volume *volumes[], uint32_t count,
+                             int32_t results[], _volume_mask_func func) {
+    int rc = LSM_ERR_OK;
+    sqlite3 *db = NULL;
+    char err_msg[_LSM_ERR_MSG_LEN];
+    uint32_t i = 0;
+
+    _lsm_err_msg_clear(err_msg);
+
+    _good(_check_null_ptr(err_msg, 3 /* argument count */, group, volumes,
+                          results),
+          rc, out);
+    _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);
+    _good(_db_sql_trans_begin(err_msg, db), rc, out);
+    for (i = 0; i < count; ++i) {
+        _good(_db_sql_savepoint(err_msg, db), rc, out);
+        results[i] = func(err_msg, db, group, volumes[i]);
+        _good(_bulk_item_end(err_msg, db, results[i]), rc, out);
+    }
+    _good(_db_sql_trans_commit(err_msg, db), rc, out);
+
+out:
+    if (rc != LSM_ERR_OK) {
+        _db_sql_trans_rollback(db);
+        lsm_log_error_basic(c, rc, err_msg);
+    }
+
+    return rc;
+}
+
+int volume_mask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
+                lsm_flag flags) {
+    _UNUSED(flags);
+    return _volume_mask_one(c, group, volume, _volume_mask_in_trans);
+}
+
+int volume_mask_bulk(lsm_plugin_ptr c, lsm_access_group *group,
+                     lsm_volume *volumes[], uint32_t count, int32_t results[],
+                     lsm_flag flags) {
+    _UNUSED(flags);
+    return _volume_mask_bulk(c, group, volumes, count, results,
+                             _volume_mask_in_trans);
+}
+
+int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
+                  lsm_flag flags) {
+    _UNUSED(flags);
+    return _volume_mask_one(c, group, volume, _volume_unmask_in_trans);
+}
+
+int volume_unmask_bulk(lsm_plugin_ptr c, lsm_access_group *group,
+                       lsm_volume *volumes[], uint32_t count,
+                       int32_t results[], lsm_flag flags) {
+    _UNUSED(flags);
+    return _volume_mask_bulk(c, group, volumes, count, results,
+                             _volume_unmask_in_trans);
+}
+
 int volumes_accessible_by_access_group(lsm_plugin_ptr c,
                                        lsm_access_group *group,
                                        lsm_volume **volumes[], uint32_t *count,
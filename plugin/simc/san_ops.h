@@ -22,6 +22,16 @@ int disk_list(lsm_plugin_ptr c, const char *search_key,
               const char *search_value, lsm_disk **disk_array[],
               uint32_t *count, lsm_flag flags);
 
+int volume_list_page(lsm_plugin_ptr c, const char *search_key,
+                     const char *search_value, uint32_t limit,
+                     const char *cursor, lsm_volume **vol_array[],
+                     uint32_t *count, char **next_cursor, lsm_flag flags);
+
+int disk_list_page(lsm_plugin_ptr c, const char *search_key,
+                   const char *search_value, uint32_t limit,
+                   const char *cursor, lsm_disk **disk_array[],
+                   uint32_t *count, char **next_cursor, lsm_flag flags);
+
 int volume_create(lsm_plugin_ptr c, lsm_pool *pool, const char *volume_name,
                   uint64_t size, lsm_volume_provision_type provisioning,
                   lsm_volume **new_volume, char **job, lsm_flag flags);
@@ -49,6 +59,10 @@ int volume_disable(lsm_plugin_ptr c, lsm_volume *v, lsm_flag flags);
 int volume_delete(lsm_plugin_ptr c, lsm_volume *volume, char **job,
                   lsm_flag flags);
 
+int volume_delete_bulk(lsm_plugin_ptr c, lsm_volume *volumes[],
+                       uint32_t count, int32_t results[], char *jobs[],
+                       lsm_flag flags);
+
 int access_group_delete(lsm_plugin_ptr c, lsm_access_group *group,
                         lsm_flag flags);
 
@@ -60,6 +74,12 @@ int access_group_list(lsm_plugin_ptr c, const char *search_key,
                       const char *search_value, lsm_access_group **groups[],
                       uint32_t *count, lsm_flag flags);
 
+int access_group_list_page(lsm_plugin_ptr c, const char *search_key,
+                           const char *search_value, uint32_t limit,
+                           const char *cursor, lsm_access_group **groups[],
+                           uint32_t *count, char **next_cursor,
+                           lsm_flag flags);
+
 int access_group_create(lsm_plugin_ptr c, const char *name,
                         const char *initiator_id,
                         lsm_access_group_init_type init_type,
@@ -72,6 +92,14 @@ int access_group_initiator_add(lsm_plugin_ptr c, lsm_access_group *access_group,
                                lsm_access_group **updated_access_group,
                                lsm_flag flags);
 
+int access_group_initiator_add_bulk(lsm_plugin_ptr c,
+                                    lsm_access_group *access_group,
+                                    lsm_string_list *initiator_ids,
+                                    lsm_access_group_init_type init_type,
+                                    int32_t results[],
+                                    lsm_access_group **updated_access_group,
+                                    lsm_flag flags);
+
 int access_group_initiator_delete(lsm_plugin_ptr c,
                                   lsm_access_group *access_group,
                                   const char *initiator_id,
@@ -85,6 +113,14 @@ int volume_mask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
 int volume_unmask(lsm_plugin_ptr c, lsm_access_group *group, lsm_volume *volume,
                   lsm_flag flags);
 
+int volume_mask_bulk(lsm_plugin_ptr c, lsm_access_group *group,
+                     lsm_volume *volumes[], uint32_t count, int32_t results[],
+                     lsm_flag flags);
+
+int volume_unmask_bulk(lsm_plugin_ptr c, lsm_access_group *group,
+                       lsm_volume *volumes[], uint32_t count,
+                       int32_t results[], lsm_flag flags);
+
 int volumes_accessible_by_access_group(lsm_plugin_ptr c,
                                        lsm_access_group *group,
                                        lsm_volume **volumes[], uint32_t *count,
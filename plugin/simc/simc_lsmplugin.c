@@ -105,6 +105,20 @@ static struct lsm_ops_v1_3 ops_v1_3 = {
     volume_read_cache_policy_update,
 };
 
+static struct lsm_ops_v1_11 ops_v1_11 = {
+    pool_list_page,
+    volume_list_page,
+    disk_list_page,
+    access_group_list_page,
+    fs_list_page,
+    nfs_list_page,
+    volume_mask_bulk,
+    volume_unmask_bulk,
+    volume_delete_bulk,
+    access_group_initiator_add_bulk,
+    jobs_wait_any,
+};
+
 int plugin_register(lsm_plugin_ptr c, const char *uri, const char *password,
                     uint32_t timeout, lsm_flag flags) {
     int rc = LSM_ERR_OK;
@@ -165,8 +179,8 @@ int plugin_register(lsm_plugin_ptr c, const char *uri, const char *password,
     pri_data->db = db;
     pri_data->timeout = timeout;
 
-    rc = lsm_register_plugin_v1_3(c, pri_data, &mgm_ops, &san_ops, &fs_ops,
-                                  &nfs_ops, &ops_v1_2, &ops_v1_3);
+    rc = lsm_register_plugin_v1_11(c, pri_data, &mgm_ops, &san_ops, &fs_ops,
+                                   &nfs_ops, &ops_v1_2, &ops_v1_3, &ops_v1_11);
 
 out:
     free(scheme);
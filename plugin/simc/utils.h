@@ -137,6 +137,70 @@ struct _simc_private_data {
         }                                                                      \
         return rc;                                                             \
     }
+
+/*
+ * Same as _xxx_list_func_gen, for the paged listing callbacks of
+ * struct lsm_ops_v1_11.  The cursor is the sim id of the last row of the
+ * page, handed out only when the page is full.
+ */
+#define _xxx_list_page_func_gen(func_name, rc_type, conv_func, filter_func,    \
+                                table, lsm_xxx_array_free_func)                \
+    int func_name(lsm_plugin_ptr c, const char *search_key,                    \
+                  const char *search_value, uint32_t limit,                    \
+                  const char *cursor, rc_type **array[], uint32_t *count,      \
+                  char **next_cursor, lsm_flag flags) {                        \
+        int rc = LSM_ERR_OK;                                                   \
+        struct _vector *vec = NULL;                                            \
+        sqlite3 *db = NULL;                                                    \
+        lsm_hash *last = NULL;                                                 \
+        char err_msg[_LSM_ERR_MSG_LEN];                                        \
+        char sql_cmd[_BUFF_SIZE];                                              \
+        _UNUSED(flags);                                                        \
+        _lsm_err_msg_clear(err_msg);                                           \
+        _good(_check_null_ptr(err_msg, 3 /* argument count */, array, count,   \
+                              next_cursor),                                    \
+              rc, out);                                                        \
+        *next_cursor = NULL;                                                   \
+        _good(_db_page_sql_gen(err_msg, sql_cmd, table, search_key,            \
+                               search_value, limit, cursor),                   \
+              rc, out);                                                        \
+        _good(_get_db_from_plugin_ptr(err_msg, c, &db), rc, out);              \
+        _good(_db_sql_trans_begin(err_msg, db), rc, out);                      \
+        _good(_db_sql_exec(err_msg, db, sql_cmd, &vec), rc, out);              \
+        if (_vector_size(vec) == 0) {                                          \
+            *array = NULL;                                                     \
+            *count = 0;                                                        \
+            goto out;                                                          \
+        }                                                                      \
+        if (_vector_size(vec) == limit) {                                      \
+            last = _vector_get(vec, limit - 1);                                \
+            *next_cursor = strdup(lsm_hash_string_get(last, "id"));            \
+            _alloc_null_check(err_msg, *next_cursor, rc, out);                 \
+        }                                                                      \
+        _vec_to_lsm_xxx_array(err_msg, vec, rc_type, conv_func, array, count,  \
+                              rc, out);                                        \
+    out:                                                                       \
+        _db_sql_trans_rollback(db);                                            \
+        _db_sql_exec_vec_free(vec);                                            \
+        if (rc != LSM_ERR_OK) {                                                \
+            if (array != NULL && count != NULL) {                              \
+                if (*array != NULL) {                                          \
+                    lsm_xxx_array_free_func(*array, *count);                   \
+                }                                                              \
+                *array = NULL;                                                 \
+                *count = 0;                                                    \
+            }                                                                  \
+            if (next_cursor != NULL) {                                         \
+                free(*next_cursor);                                            \
+                *next_cursor = NULL;                                           \
+            }                                                                  \
+            lsm_log_error_basic(c, rc, err_msg);                               \
+        } else {                                                               \
+            filter_func(search_key, search_value, *array, count);              \
+        }                                                                      \
+        return rc;                                                             \
+    }
+
 int _get_db_from_plugin_ptr(char *err_msg, lsm_plugin_ptr c, sqlite3 **db);
 
 /*
@@ -11,6 +11,7 @@
 #include <Python.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <libstoragemgmt/libstoragemgmt.h>
 
@@ -492,6 +493,31 @@ static const char led_slot_device_docstring[] =
     "Returns:\n"
     "    device node (string) if present or None\n";
 
+static const char msgpack_pack_docstring[] =
+    "INTERNAL USE ONLY!\n"
+    "\n"
+    "Usage:\n"
+    "    Encode an object to MessagePack for the IPC transport\n"
+    "Parameters:\n"
+    "    obj (None, bool, int, float, str, list, tuple or dict)\n"
+    "    default (callable)\n"
+    "        Called with any other object, returns something encodable.\n"
+    "Returns:\n"
+    "    data (bytes)\n";
+
+static const char msgpack_unpack_docstring[] =
+    "INTERNAL USE ONLY!\n"
+    "\n"
+    "Usage:\n"
+    "    Decode a MessagePack payload received over the IPC transport\n"
+    "Parameters:\n"
+    "    data (bytes)\n"
+    "    class_hook (callable)\n"
+    "        Called with every decoded dict holding a 'class' key, the\n"
+    "        return value replaces the dict.\n"
+    "Returns:\n"
+    "    obj\n";
+
 static PyObject *local_disk_serial_num_get(PyObject *self, PyObject *args,
                                            PyObject *kwargs);
 
@@ -542,6 +568,10 @@ static PyObject *led_slot_id(PyObject *self, PyObject *args, PyObject *kwargs);
 
 static PyObject *led_slot_device(PyObject *self, PyObject *args,
                                  PyObject *kwargs);
+static PyObject *msgpack_pack(PyObject *self, PyObject *args,
+                              PyObject *kwargs);
+static PyObject *msgpack_unpack(PyObject *self, PyObject *args,
+                                PyObject *kwargs);
 
 _wrapper_no_output(local_disk_ident_led_on, lsm_local_disk_ident_led_on,
                    const char *, disk_path);
@@ -599,6 +629,10 @@ static PyMethodDef _methods[] = {
      METH_VARARGS | METH_KEYWORDS, local_disk_led_status_get_docstring},
     {"_local_disk_link_speed_get", (PyCFunction)local_disk_link_speed_get,
      METH_VARARGS | METH_KEYWORDS, local_disk_link_speed_get_docstring},
+    {"_msgpack_pack", (PyCFunction)msgpack_pack, METH_VARARGS | METH_KEYWORDS,
+     msgpack_pack_docstring},
+    {"_msgpack_unpack", (PyCFunction)msgpack_unpack,
+     METH_VARARGS | METH_KEYWORDS, msgpack_unpack_docstring},
     {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
@@ -1088,6 +1122,465 @@ out:
     return rc_obj;
 }
 
+/*
+ * MessagePack codec for lsm._transport, it has to stay compatible with the
+ * one in the C library, see c_binding/lsm_value_msgpack.hpp.  Only nil,
+ * boolean, integer, float, str, array and map are used.
+ */
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t size;
+} _mp_buf;
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} _mp_reader;
+
+static int _mp_put(_mp_buf *b, const void *src, size_t len) {
+    if (b->len + len > b->size) {
+        size_t size = b->size ? b->size : 256;
+        char *data = NULL;
+
+        while (size < b->len + len)
+            size *= 2;
+        data = PyMem_Realloc(b->data, size);
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        b->data = data;
+        b->size = size;
+    }
+    memcpy(b->data + b->len, src, len);
+    b->len += len;
+    return 0;
+}
+
+static int _mp_put_be(_mp_buf *b, uint8_t tag, uint64_t v, int bytes) {
+    uint8_t tmp[9];
+    int i;
+
+    tmp[0] = tag;
+    for (i = bytes; i > 0; --i) {
+        tmp[i] = (uint8_t)(v & 0xff);
+        v >>= 8;
+    }
+    return _mp_put(b, tmp, bytes + 1);
+}
+
+static int _mp_put_len(_mp_buf *b, size_t len, uint8_t fix_tag,
+                       size_t fix_max, uint8_t tag16) {
+    uint8_t tag = 0;
+
+    if (len <= fix_max) {
+        tag = fix_tag | (uint8_t)len;
+        return _mp_put(b, &tag, 1);
+    } else if (len <= 0xffff) {
+        return _mp_put_be(b, tag16, len, 2);
+    } else if (len <= 0xffffffff) {
+        return _mp_put_be(b, tag16 + 1, len, 4);
+    }
+    PyErr_SetString(PyExc_ValueError, "Object too large to encode");
+    return -1;
+}
+
+static int _mp_put_str(_mp_buf *b, PyObject *str) {
+    Py_ssize_t len = 0;
+    const char *utf8 = PyUnicode_AsUTF8AndSize(str, &len);
+
+    if (utf8 == NULL)
+        return -1;
+    if (len > 31 && len <= 0xff) {
+        if (_mp_put_be(b, 0xd9, len, 1))
+            return -1;
+    } else if (_mp_put_len(b, len, 0xa0, 31, 0xda)) {
+        return -1;
+    }
+    return _mp_put(b, utf8, len);
+}
+
+static int _mp_put_int(_mp_buf *b, PyObject *obj) {
+    int overflow = 0;
+    long long v = PyLong_AsLongLongAndOverflow(obj, &overflow);
+    uint8_t tag = 0;
+
+    if (v == -1 && PyErr_Occurred())
+        return -1;
+
+    if (overflow > 0) {
+        unsigned long long u = PyLong_AsUnsignedLongLong(obj);
+
+        if (PyErr_Occurred())
+            return -1;
+        return _mp_put_be(b, 0xcf, u, 8);
+    } else if (overflow < 0) {
+        PyErr_SetString(PyExc_ValueError, "Integer too small to encode");
+        return -1;
+    }
+
+    if (v >= 0) {
+        if (v < 0x80) {
+            tag = (uint8_t)v;
+            return _mp_put(b, &tag, 1);
+        } else if (v <= 0xff) {
+            return _mp_put_be(b, 0xcc, v, 1);
+        } else if (v <= 0xffff) {
+            return _mp_put_be(b, 0xcd, v, 2);
+        } else if (v <= 0xffffffffLL) {
+            return _mp_put_be(b, 0xce, v, 4);
+        }
+        return _mp_put_be(b, 0xcf, v, 8);
+    }
+
+    if (v >= -32) {
+        tag = (uint8_t)v;
+        return _mp_put(b, &tag, 1);
+    } else if (v >= INT8_MIN) {
+        return _mp_put_be(b, 0xd0, (uint8_t)v, 1);
+    } else if (v >= INT16_MIN) {
+        return _mp_put_be(b, 0xd1, (uint16_t)v, 2);
+    } else if (v >= INT32_MIN) {
+        return _mp_put_be(b, 0xd2, (uint32_t)v, 4);
+    }
+    return _mp_put_be(b, 0xd3, (uint64_t)v, 8);
+}
+
+static int _mp_pack(_mp_buf *b, PyObject *obj, PyObject *default_func) {
+    int rc = -1;
+    uint8_t tag = 0;
+
+    if (obj == Py_None) {
+        tag = 0xc0;
+        return _mp_put(b, &tag, 1);
+    } else if (obj == Py_True || obj == Py_False) {
+        tag = (obj == Py_True) ? 0xc3 : 0xc2;
+        return _mp_put(b, &tag, 1);
+    } else if (PyLong_Check(obj)) {
+        return _mp_put_int(b, obj);
+    } else if (PyFloat_Check(obj)) {
+        double d = PyFloat_AS_DOUBLE(obj);
+        uint64_t bits = 0;
+
+        memcpy(&bits, &d, sizeof(bits));
+        return _mp_put_be(b, 0xcb, bits, 8);
+    } else if (PyUnicode_Check(obj)) {
+        return _mp_put_str(b, obj);
+    }
+
+    if (Py_EnterRecursiveCall(" while encoding MessagePack"))
+        return -1;
+
+    if (PyList_Check(obj) || PyTuple_Check(obj)) {
+        PyObject *seq = PySequence_Fast(obj, "expecting list or tuple");
+        Py_ssize_t i = 0;
+        Py_ssize_t num = 0;
+
+        if (seq != NULL) {
+            num = PySequence_Fast_GET_SIZE(seq);
+            rc = _mp_put_len(b, num, 0x90, 15, 0xdc);
+            for (i = 0; rc == 0 && i < num; ++i)
+                rc = _mp_pack(b, PySequence_Fast_GET_ITEM(seq, i),
+                              default_func);
+            Py_DECREF(seq);
+        }
+    } else if (PyDict_Check(obj)) {
+        PyObject *key = NULL;
+        PyObject *value = NULL;
+        Py_ssize_t pos = 0;
+
+        rc = _mp_put_len(b, PyDict_Size(obj), 0x80, 15, 0xde);
+        while (rc == 0 && PyDict_Next(obj, &pos, &key, &value)) {
+            if (PyUnicode_Check(key)) {
+                rc = _mp_put_str(b, key);
+            } else if (PyLong_Check(key) && !PyBool_Check(key)) {
+                /* Like json, integer keys are sent as strings */
+                PyObject *key_str = PyObject_Str(key);
+
+                rc = key_str ? _mp_put_str(b, key_str) : -1;
+                Py_XDECREF(key_str);
+            } else {
+                PyErr_SetString(PyExc_ValueError, "dict key is not a str");
+                rc = -1;
+            }
+            if (rc == 0)
+                rc = _mp_pack(b, value, default_func);
+        }
+    } else if (default_func != Py_None) {
+        PyObject *replacement =
+            PyObject_CallFunctionObjArgs(default_func, obj, NULL);
+
+        if (replacement != NULL) {
+            rc = _mp_pack(b, replacement, default_func);
+            Py_DECREF(replacement);
+        }
+    } else {
+        PyErr_Format(PyExc_ValueError, "incorrect class type: %s",
+                     Py_TYPE(obj)->tp_name);
+    }
+
+    Py_LeaveRecursiveCall();
+    return rc;
+}
+
+static PyObject *msgpack_pack(PyObject *self, PyObject *args,
+                              PyObject *kwargs) {
+    static const char *kwlist[] = {"obj", "default", NULL};
+    PyObject *obj = NULL;
+    PyObject *default_func = Py_None;
+    PyObject *rc_obj = NULL;
+    _mp_buf b = {NULL, 0, 0};
+
+    _UNUSED(self);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", (char **)kwlist,
+                                     &obj, &default_func))
+        return NULL;
+
+    if (_mp_pack(&b, obj, default_func) == 0)
+        rc_obj = PyBytes_FromStringAndSize(b.data, b.len);
+
+    PyMem_Free(b.data);
+    return rc_obj;
+}
+
+static const uint8_t *_mp_take(_mp_reader *r, uint64_t len) {
+    const uint8_t *rc = r->p;
+
+    if ((uint64_t)(r->end - r->p) < len) {
+        PyErr_SetString(PyExc_ValueError, "Truncated MessagePack payload");
+        return NULL;
+    }
+    r->p += len;
+    return rc;
+}
+
+static int _mp_get_be(_mp_reader *r, int bytes, uint64_t *v) {
+    const uint8_t *b = _mp_take(r, bytes);
+    int i;
+
+    if (b == NULL)
+        return -1;
+    *v = 0;
+    for (i = 0; i < bytes; ++i)
+        *v = (*v << 8) | b[i];
+    return 0;
+}
+
+static PyObject *_mp_unpack(_mp_reader *r, PyObject *class_hook);
+
+static PyObject *_mp_get_str(_mp_reader *r, uint64_t len) {
+    const uint8_t *b = _mp_take(r, len);
+
+    if (b == NULL)
+        return NULL;
+    return PyUnicode_DecodeUTF8((const char *)b, len, "strict");
+}
+
+static PyObject *_mp_get_array(_mp_reader *r, uint64_t num,
+                               PyObject *class_hook) {
+    PyObject *list = NULL;
+    PyObject *item = NULL;
+    uint64_t i = 0;
+
+    /* Every element takes at least a byte */
+    if (num > (uint64_t)(r->end - r->p)) {
+        PyErr_SetString(PyExc_ValueError, "Truncated MessagePack payload");
+        return NULL;
+    }
+
+    list = PyList_New(num);
+    if (list == NULL)
+        return NULL;
+
+    for (i = 0; i < num; ++i) {
+        item = _mp_unpack(r, class_hook);
+        if (item == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+static PyObject *_mp_get_map(_mp_reader *r, uint64_t num,
+                             PyObject *class_hook) {
+    PyObject *dict = PyDict_New();
+    PyObject *key = NULL;
+    PyObject *value = NULL;
+    PyObject *obj = NULL;
+    uint64_t i = 0;
+
+    if (dict == NULL)
+        return NULL;
+
+    for (i = 0; i < num; ++i) {
+        key = _mp_unpack(r, class_hook);
+        if (key == NULL)
+            goto fail;
+        if (!PyUnicode_Check(key)) {
+            PyErr_SetString(PyExc_ValueError,
+                            "Expecting MessagePack map key to be str");
+            goto fail;
+        }
+        value = _mp_unpack(r, class_hook);
+        if (value == NULL || PyDict_SetItem(dict, key, value))
+            goto fail;
+        Py_CLEAR(key);
+        Py_CLEAR(value);
+    }
+
+    if (class_hook != Py_None && PyDict_GetItemString(dict, "class")) {
+        obj = PyObject_CallFunctionObjArgs(class_hook, dict, NULL);
+        Py_DECREF(dict);
+        return obj;
+    }
+    return dict;
+
+fail:
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    Py_DECREF(dict);
+    return NULL;
+}
+
+static PyObject *_mp_get_container(_mp_reader *r, uint64_t num, bool is_map,
+                                   PyObject *class_hook) {
+    PyObject *rc_obj = NULL;
+
+    if (Py_EnterRecursiveCall(" while decoding MessagePack"))
+        return NULL;
+    if (is_map)
+        rc_obj = _mp_get_map(r, num, class_hook);
+    else
+        rc_obj = _mp_get_array(r, num, class_hook);
+    Py_LeaveRecursiveCall();
+    return rc_obj;
+}
+
+static PyObject *_mp_unpack(_mp_reader *r, PyObject *class_hook) {
+    const uint8_t *b = _mp_take(r, 1);
+    uint8_t tag = 0;
+    uint64_t v = 0;
+
+    if (b == NULL)
+        return NULL;
+    tag = *b;
+
+    if (tag < 0x80)
+        return PyLong_FromLong(tag);
+    if (tag >= 0xe0)
+        return PyLong_FromLong((int8_t)tag);
+    if ((tag & 0xf0) == 0x80)
+        return _mp_get_container(r, tag & 0x0f, true, class_hook);
+    if ((tag & 0xf0) == 0x90)
+        return _mp_get_container(r, tag & 0x0f, false, class_hook);
+    if ((tag & 0xe0) == 0xa0)
+        return _mp_get_str(r, tag & 0x1f);
+
+    switch (tag) {
+    case 0xc0:
+        Py_RETURN_NONE;
+    case 0xc2:
+        Py_RETURN_FALSE;
+    case 0xc3:
+        Py_RETURN_TRUE;
+    case 0xca: {
+        uint32_t bits = 0;
+        float f = 0;
+
+        if (_mp_get_be(r, 4, &v))
+            return NULL;
+        bits = (uint32_t)v;
+        memcpy(&f, &bits, sizeof(f));
+        return PyFloat_FromDouble(f);
+    }
+    case 0xcb: {
+        double d = 0;
+
+        if (_mp_get_be(r, 8, &v))
+            return NULL;
+        memcpy(&d, &v, sizeof(d));
+        return PyFloat_FromDouble(d);
+    }
+    case 0xcc:
+    case 0xcd:
+    case 0xce:
+    case 0xcf:
+        if (_mp_get_be(r, 1 << (tag - 0xcc), &v))
+            return NULL;
+        return PyLong_FromUnsignedLongLong(v);
+    case 0xd0:
+        if (_mp_get_be(r, 1, &v))
+            return NULL;
+        return PyLong_FromLong((int8_t)v);
+    case 0xd1:
+        if (_mp_get_be(r, 2, &v))
+            return NULL;
+        return PyLong_FromLong((int16_t)v);
+    case 0xd2:
+        if (_mp_get_be(r, 4, &v))
+            return NULL;
+        return PyLong_FromLong((int32_t)v);
+    case 0xd3:
+        if (_mp_get_be(r, 8, &v))
+            return NULL;
+        return PyLong_FromLongLong((int64_t)v);
+    case 0xd9:
+    case 0xda:
+    case 0xdb:
+        if (_mp_get_be(r, 1 << (tag - 0xd9), &v))
+            return NULL;
+        return _mp_get_str(r, v);
+    case 0xdc:
+    case 0xdd:
+        if (_mp_get_be(r, 2 << (tag - 0xdc), &v))
+            return NULL;
+        return _mp_get_container(r, v, false, class_hook);
+    case 0xde:
+    case 0xdf:
+        if (_mp_get_be(r, 2 << (tag - 0xde), &v))
+            return NULL;
+        return _mp_get_container(r, v, true, class_hook);
+    default:
+        break;
+    }
+
+    PyErr_Format(PyExc_ValueError, "Unsupported MessagePack type 0x%x",
+                 (unsigned int)tag);
+    return NULL;
+}
+
+static PyObject *msgpack_unpack(PyObject *self, PyObject *args,
+                                PyObject *kwargs) {
+    static const char *kwlist[] = {"data", "class_hook", NULL};
+    Py_buffer data;
+    PyObject *class_hook = Py_None;
+    PyObject *rc_obj = NULL;
+    _mp_reader r;
+
+    _UNUSED(self);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|O", (char **)kwlist,
+                                     &data, &class_hook))
+        return NULL;
+
+    r.p = (const uint8_t *)data.buf;
+    r.end = r.p + data.len;
+
+    rc_obj = _mp_unpack(&r, class_hook);
+    if (rc_obj != NULL && r.p != r.end) {
+        Py_DECREF(rc_obj);
+        rc_obj = NULL;
+        PyErr_SetString(PyExc_ValueError,
+                        "Trailing data after MessagePack payload");
+    }
+
+    PyBuffer_Release(&data);
+    return rc_obj;
+}
+
 #if PY_MAJOR_VERSION >= 3
 #define MOD_DEF(name, methods)                                                 \
     static struct PyModuleDef moduledef = {PyModuleDef_HEAD_INIT,              \
@@ -7,6 +7,7 @@
 import os
 import sys
 import socket
+import inspect
 from stat import S_ISSOCK
 from lsm import (Volume, NfsExport, Capabilities, Pool, System, Battery, Disk,
                  AccessGroup, FileSystem, FsSnapshot, uri_parse, LsmError,
@@ -45,6 +46,43 @@ def _raise_no_daemon():
         "name lsmd), please start service")
 
 
+# Records the calls made on it for Client.batch(), which sends them when the
+# with block is left.
+class _Batch(object):
+    def __init__(self, client):
+        self._client = client
+        self._calls = []
+        self.results = None
+
+    def __getattr__(self, name):
+        if name.startswith('_'):
+            raise AttributeError(name)
+
+        def record(*args, **kwargs):
+            method = getattr(self._client, name, None)
+            if callable(method):
+                try:
+                    kwargs = dict(
+                        inspect.signature(method).bind(*args,
+                                                       **kwargs).arguments)
+                except TypeError as te:
+                    raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                                   "%s: %s" % (name, str(te)))
+            # Refuse what can't be batched now rather than when leaving
+            self._calls.extend(
+                self._client._calls_bind([(name, kwargs)], 'batched'))
+        return record
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, exc_tb):
+        # Nothing is sent if the with block raised
+        if exc_type is None:
+            self.results = self._client.batch(self._calls)
+        return False
+
+
 # Main client class for library.
 # ** IMPORTANT **
 # Theory of operation for methods in this class.
@@ -83,7 +121,9 @@ def __start(self, uri, password, timeout, flags=0):
         """
         Instruct the plug-in to get ready
         """
-        self._tp.rpc('plugin_register', _del_self(locals()))
+        self._tp.rpc('plugin_register',
+                     _del_self(locals()),
+                     offer_encodings=True)
 
     # Checks to see if any unix domain sockets exist in the base directory
     # and opens a socket to one to see if the server is actually there.
@@ -189,6 +229,156 @@ def close(self, flags=FLAG_RSVD):
         self._tp.close()
         self._tp = None
 
+    # Sends several requests before waiting for any of the responses
+    # @param    self    The this pointer
+    # @param    calls   List of (method name, dict of arguments) tuples
+    # @returns List of results, in the same order as calls
+    def pipeline(self, calls):
+        """
+        Sends several requests to the plug-in before waiting for any of the
+        responses, saving a round trip for every request but the first.
+
+        calls is a list of (method name, arguments) tuples, method name being
+        the name of a Client method and arguments a dict of its keyword
+        arguments, for example:
+
+            systems, pools, volumes = client.pipeline([
+                ('systems', {}),
+                ('pools', {}),
+                ('volumes', {'search_key': 'pool_id', 'search_value': 'P1'})])
+
+        The arguments are matched against the method signature, but are not
+        otherwise checked as the method itself would.
+
+        Returns a list holding the result of each call, in the same order.  If
+        a call failed its LsmError is raised once all responses are in.
+        """
+        requests = self._calls_bind(calls, 'pipelined')
+        ids = [self._tp.send_req(m, a) for (m, a) in requests]
+
+        results = []
+        error = None
+        for msg_id in ids:
+            try:
+                results.append(self._tp.wait_resp(msg_id))
+            except LsmError as le:
+                results.append(None)
+                error = error or le
+        if error:
+            raise error
+        return results
+
+    def _calls_bind(self, calls, what):
+        """
+        Checks the (method name, arguments) tuples of pipeline() and batch()
+        and fills in the default arguments.  Returns a list of (method name,
+        arguments dict) tuples.
+        """
+        requests = []
+        for (method, args) in calls:
+            if method in ('close', 'plugin_register', 'plugin_unregister',
+                          'pipeline', 'batch', 'available_plugins',
+                          'connect_stats', 'connect_stats_reset',
+                          'job_wait') or \
+                    method.startswith('_') or \
+                    not callable(getattr(self, method, None)):
+                raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                               "Method %s can't be %s" % (method, what))
+            try:
+                params = inspect.signature(getattr(self, method)).bind(**args)
+            except TypeError as te:
+                raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                               "%s: %s" % (method, str(te)))
+            params.apply_defaults()
+            requests.append((method, dict(params.arguments)))
+        return requests
+
+    def batch(self, calls=None):
+        """
+        Sends several requests to the plug-in as a single one, the plug-in
+        runs them in order and answers them all at once.  This saves the
+        round trip and the plug-in dispatch for every request but the first,
+        for example when masking hundreds of volumes.
+
+        calls is a list of (method name, arguments) tuples, the same as for
+        pipeline().  A failing call doesn't stop the ones after it.
+
+        Without calls, returns a context manager instead, recording the
+        Client method calls made on it and sending them when the with block
+        is left, its results attribute then holding what is returned here:
+
+            with client.batch() as b:
+                for vol in volumes:
+                    b.volume_mask(access_group, vol)
+            print(b.results)
+
+        Returns a list holding the result of each call, in the same order.  If
+        a call failed its LsmError is raised once all of them have run.
+        Plug-ins which can't run batches get the calls pipelined instead.
+        """
+        if calls is None:
+            return _Batch(self)
+
+        requests = self._calls_bind(calls, 'batched')
+        try:
+            items = self._tp.rpc('batch', {
+                'requests': [{'method': m, 'params': a}
+                             for (m, a) in requests],
+                'flags': Client.FLAG_RSVD})
+        except LsmError as le:
+            if le.code != ErrorNumber.NO_SUPPORT:
+                raise
+            return self.pipeline(calls)
+
+        if not isinstance(items, list) or len(items) != len(requests):
+            raise LsmError(ErrorNumber.PLUGIN_BUG,
+                           "Batch results don't match the calls")
+
+        results = []
+        error = None
+        for item in items:
+            try:
+                results.append(_TransPort._result(item))
+            except LsmError as le:
+                results.append(None)
+                error = error or le
+        if error:
+            raise error
+        return results
+
+    # Retrieves the statistics of the calls made on this connection
+    # @param    self    The this pointer
+    # @returns Dict of statistics by method name
+    def connect_stats(self):
+        """
+        Returns what the calls made so far on this connection have cost, to
+        find slow plug-ins and oversized responses.  The result is a dict by
+        method name, each value a dict holding:
+
+            calls           Calls which got a response
+            errors          Of those, calls which failed
+            bytes_sent      Size of the requests, headers included
+            bytes_received  Size of the responses, headers included
+            serialize_ns    Time spent encoding the requests
+            transport_ns    Time spent waiting on the transport and plug-in
+            deserialize_ns  Time spent decoding the responses
+            histogram       List of call counts by latency, bucket 0 counts
+                            calls which took less than 1us, bucket n those
+                            which took from 2^(n-1)us up to 2^n us, the last
+                            bucket everything longer
+
+        Same as lsm_connect_stats_get() of the C library.
+        """
+        return self._tp.stats()
+
+    # Clears the statistics of the calls made on this connection
+    # @param    self    The this pointer
+    def connect_stats_reset(self):
+        """
+        Clears what connect_stats() returns.
+        """
+        self._tp.stats_reset()
+
     # Retrieves all the available plug-ins
     # @param    field_sep   Field separator
     # @param    flags:      Reserved for future use
@@ -280,6 +470,45 @@ def job_free(self, job_id, flags=FLAG_RSVD):
         """
         return self._tp.rpc('job_free', _del_self(locals()))
 
+    # Waits until a job completes or gets as far as percent.
+    # @param    self    The this pointer
+    # @param    job_id  Job id to wait on
+    # @param    percent Progress which ends the wait, 100 for completion
+    # @param    timeout Time out in milliseconds
+    # @param    flags   Reserved for future use, must be zero.
+    # @returns A tuple (status (enumeration), percent_complete)
+    def job_wait(self, job_id, percent=100, timeout=30000, flags=FLAG_RSVD):
+        """
+        Waits until the job is no longer in progress, has got as far as
+        percent or timeout milliseconds have passed.  The plug-in holds the
+        request until then, so completion is seen without polling
+        job_status().
+
+        Returns a tuple (status (enumeration), percent_complete), status is
+        JobStatus.INPROGRESS when the time out passed.
+        """
+        return self.jobs_wait_any([job_id], percent, timeout, flags)[1:]
+
+    # Waits until any of many jobs completes or gets as far as percent.
+    # @param    self    The this pointer
+    # @param    job_ids Job ids to wait on
+    # @param    percent Progress which ends the wait, 100 for completion
+    # @param    timeout Time out in milliseconds
+    # @param    flags   Reserved for future use, must be zero.
+    # @returns A tuple (index, status (enumeration), percent_complete)
+    @_return_requires(int, int, int)
+    def jobs_wait_any(self, job_ids, percent=100, timeout=30000,
+                      flags=FLAG_RSVD):
+        """
+        Waits until one of the jobs is no longer in progress or has got as
+        far as percent, or until timeout milliseconds have passed.
+
+        Returns a tuple (index, status (enumeration), percent_complete).
+        index is the position in job_ids of the job which ended the wait, or
+        the one furthest along when the time out passed.
+        """
+        return self._tp.rpc('jobs_wait_any', _del_self(locals()))
+
     # Gets the capabilities of the array.
     # @param    self    The this pointer
     # @param    system  The system of interest
@@ -537,6 +766,24 @@ def volume_delete(self, volume, flags=FLAG_RSVD):
         """
         return self._tp.rpc('volume_delete', _del_self(locals()))
 
+    # Deletes many volumes
+    # @param    self    The this pointer
+    # @param    volumes The volumes to delete
+    # @param    flags   Reserved for future use, must be zero.
+    # @returns (results, jobs), the error number and job id of each volume
+    @_return_requires([int], [str])
+    def volume_delete_bulk(self, volumes, flags=FLAG_RSVD):
+        """
+        Deletes many volumes in one request, a volume which can't be deleted
+        doesn't stop the ones after it.
+
+        Returns a tuple (results, jobs).  results holds the error number
+        volume_delete() would have raised for each volume, ErrorNumber.OK if
+        none, or ErrorNumber.JOB_STARTED when jobs holds the job id of the
+        volume.  jobs holds None for the others.
+        """
+        return self._tp.rpc('volume_delete_bulk', _del_self(locals()))
+
     # Makes a volume online and available to the host.
     # @param    self    The this pointer
     # @param    volume  The volume to place online
@@ -608,6 +855,37 @@ def volume_unmask(self, access_group, volume, flags=FLAG_RSVD):
         """
         return self._tp.rpc('volume_unmask', _del_self(locals()))
 
+    # Grants access to many volumes to initiators in an access group
+    # @param    self            The this pointer
+    # @param    access_group    The access group
+    # @param    volumes         The volumes to grant access to
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns The error number of each volume.
+    @_return_requires([int])
+    def volume_mask_bulk(self, access_group, volumes, flags=FLAG_RSVD):
+        """
+        Allows an access group to access many volumes in one request, a
+        volume which can't be masked doesn't stop the ones after it.
+
+        Returns a list holding the error number volume_mask() would have
+        raised for each volume, ErrorNumber.OK if none.
+        """
+        return self._tp.rpc('volume_mask_bulk', _del_self(locals()))
+
+    # Revokes access to many volumes to initiators in an access group
+    # @param    self            The this pointer
+    # @param    access_group    The access group
+    # @param    volumes         The volumes to revoke access to
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns The error number of each volume.
+    @_return_requires([int])
+    def volume_unmask_bulk(self, access_group, volumes, flags=FLAG_RSVD):
+        """
+        Revokes access for an access group for many volumes in one request,
+        see volume_mask_bulk().
+        """
+        return self._tp.rpc('volume_unmask_bulk', _del_self(locals()))
+
     # Returns a list of access group objects
     # @param    self    The this pointer
     # @param    search_key      Search Key
@@ -680,6 +958,36 @@ def access_group_initiator_add(self,
             init_id, init_type, raise_exception=True)[1:]
         return self._tp.rpc('access_group_initiator_add', _del_self(locals()))
 
+    # Adds many initiators to an access group
+    # @param    self            The this pointer
+    # @param    access_group    The access group to add the initiators to
+    # @param    init_ids        The initiators to add
+    # @param    init_type       Initiator id type of all of them (enumeration)
+    # @param    flags           Reserved for future use, must be zero.
+    # @returns (results, access_group), throws LsmError on errors.
+    @_return_requires([int], AccessGroup)
+    def access_group_initiator_add_bulk(self,
+                                        access_group,
+                                        init_ids,
+                                        init_type,
+                                        flags=FLAG_RSVD):
+        """
+        Adds many initiators to an access group in one request, an initiator
+        which can't be added doesn't stop the ones after it.
+
+        Returns a tuple (results, access_group).  results holds the error
+        number access_group_initiator_add() would have raised for each
+        initiator, ErrorNumber.OK if none, and access_group the group once
+        they were added.
+        """
+        init_ids = [
+            AccessGroup.initiator_id_verify(i, init_type,
+                                            raise_exception=True)[2]
+            for i in init_ids
+        ]
+        return self._tp.rpc('access_group_initiator_add_bulk',
+                            _del_self(locals()))
+
     # Deletes an initiator from an access group
     # @param    self            The this pointer
     # @param    access_group    The access group to remove initiator from
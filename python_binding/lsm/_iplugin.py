@@ -4,9 +4,25 @@
 #
 # Author: Tony Asleson <tasleson@redhat.com>
 
+import time as _time
 from abc import ABCMeta as _ABCMeta
 from abc import abstractmethod as _abstractmethod
-from lsm import LsmError, ErrorNumber
+from lsm import LsmError, ErrorNumber, JobStatus
+
+
+def _each(func, items):
+    """
+    Calls func with each of items in turn.  Returns a list holding the error
+    number of each call.
+    """
+    results = []
+    for item in items:
+        try:
+            func(item)
+            results.append(ErrorNumber.OK)
+        except LsmError as le:
+            results.append(le.code)
+    return results
 
 
 class IPlugin(object, metaclass=_ABCMeta):
@@ -76,6 +92,38 @@ def job_free(self, job_id, flags=0):
         """
         pass
 
+    def jobs_wait_any(self, job_ids, percent, timeout, flags=0):
+        """
+        Waits until one of the jobs is no longer in progress or has got as
+        far as percent, or until timeout milliseconds have passed.  This polls
+        job_status, from every 10ms at first backing off to once a second.
+        Plug-ins which know when their jobs complete should override this.
+
+        Returns a tuple (index, status, percent_complete) of the job which
+        ended the wait, or the one furthest along when the time out passed.
+        """
+        deadline = _time.monotonic() + timeout / 1000.0
+        interval = 0.01
+        while True:
+            index, done = 0, 0
+            ended = None
+            # Every job is looked at, so one not found is always reported
+            for i, job_id in enumerate(job_ids):
+                (status, percent_complete) = self.job_status(job_id, flags)[:2]
+                if ended is None and (status != JobStatus.INPROGRESS or
+                                      percent_complete >= percent):
+                    ended = (i, status, percent_complete)
+                elif percent_complete > done:
+                    index, done = i, percent_complete
+
+            if ended is not None:
+                return ended
+            remaining = deadline - _time.monotonic()
+            if remaining <= 0:
+                return index, JobStatus.INPROGRESS, done
+            _time.sleep(min(interval, remaining))
+            interval = min(interval * 2, 1.0)
+
     @_abstractmethod
     def capabilities(self, system, flags=0):
         """
@@ -99,6 +147,14 @@ def pools(self, search_key=None, search_value=None, flags=0):
         Returns an array of pool objects.  Pools are used in both block and
         file system interfaces, thus the reason they are in the base class.
 
+        Clients may ask for a page of the listing with the limit and cursor
+        parameters.  Plug-ins which don't take them get the page cut out of
+        the full listing by the plug-in runner.  Plug-ins which can page
+        themselves add limit=None and cursor=None arguments and return the
+        tuple (records, next_cursor), next_cursor being None on the last
+        page.  The same goes for volumes, disks, access_groups, fs and
+        exports.
+
         Raises LsmError on error
         """
         pass
@@ -148,6 +204,29 @@ def volume_delete(self, volume, flags=0):
         """
         raise LsmError(ErrorNumber.NO_SUPPORT, "Not supported")
 
+    def volume_delete_bulk(self, volumes, flags=0):
+        """
+        Deletes many volumes, a failing one doesn't stop the ones after it.
+        Plug-ins which can delete them faster than one at a time should
+        override this.
+
+        Returns a tuple (results, jobs), results holding the error number of
+        each volume and jobs the job id of each volume, None for those which
+        completed or failed.
+        """
+        results = []
+        jobs = []
+        for volume in volumes:
+            try:
+                job = self.volume_delete(volume, flags)
+                results.append(ErrorNumber.JOB_STARTED if job
+                               else ErrorNumber.OK)
+                jobs.append(job)
+            except LsmError as le:
+                results.append(le.code)
+                jobs.append(None)
+        return results, jobs
+
     def volume_resize(self, volume, new_size_bytes, flags=0):
         """
         Re-sizes a volume.
@@ -242,6 +321,27 @@ def volume_unmask(self, access_group, volume, flags=0):
         """
         raise LsmError(ErrorNumber.NO_SUPPORT, "Not supported")
 
+    def volume_mask_bulk(self, access_group, volumes, flags=0):
+        """
+        Allows an access group to access many volumes, a failing one doesn't
+        stop the ones after it.  Plug-ins which can mask them faster than one
+        at a time should override this.
+
+        Returns a list holding the error number of each volume.
+        """
+        return _each(lambda v: self.volume_mask(access_group, v, flags),
+                     volumes)
+
+    def volume_unmask_bulk(self, access_group, volumes, flags=0):
+        """
+        Revokes access for an access group for many volumes, see
+        volume_mask_bulk.
+
+        Returns a list holding the error number of each volume.
+        """
+        return _each(lambda v: self.volume_unmask(access_group, v, flags),
+                     volumes)
+
     def access_groups(self, search_key=None, search_value=None, flags=0):
         """
         Returns a list of access groups, raises LsmError on errors.
@@ -270,6 +370,30 @@ def access_group_initiator_add(self,
         """
         raise LsmError(ErrorNumber.NO_SUPPORT, "Not supported")
 
+    def access_group_initiator_add_bulk(self,
+                                        access_group,
+                                        init_ids,
+                                        init_type,
+                                        flags=0):
+        """
+        Adds many initiators to an access group, a failing one doesn't stop
+        the ones after it.  Plug-ins which can add them faster than one at a
+        time should override this.
+
+        Returns a tuple (results, access_group), results holding the error
+        number of each initiator and access_group the group once they were
+        added.
+        """
+        results = []
+        for init_id in init_ids:
+            try:
+                access_group = self.access_group_initiator_add(
+                    access_group, init_id, init_type, flags)
+                results.append(ErrorNumber.OK)
+            except LsmError as le:
+                results.append(le.code)
+        return results, access_group
+
     def access_group_initiator_delete(self,
                                       access_group,
                                       init_id,
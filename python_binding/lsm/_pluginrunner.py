@@ -4,17 +4,65 @@
 #
 # Author: Tony Asleson <tasleson@redhat.com>
 
+import os
 import socket
+import struct
 import traceback
 import sys
 from lsm import LsmError, error, ErrorNumber
 from lsm.lsmcli import cmd_line_wrapper
 import errno
+import inspect
 
 from lsm._common import SocketEOF as _SocketEOF
 from lsm._transport import TransPort
 
 
+# Listing methods which take the optional limit and cursor parameters
+_PAGED_METHODS = ('pools', 'volumes', 'disks', 'access_groups', 'fs',
+                  'exports')
+
+
+def _page_cut(records, limit, cursor):
+    """
+    Cuts a page out of a full listing for plug-ins which can't return one
+    themselves, the cursor is the offset of the first record of the page.
+    """
+    try:
+        start = int(cursor) if cursor is not None else 0
+    except (TypeError, ValueError):
+        start = -1
+    if start < 0:
+        raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                       "Invalid cursor: %s" % cursor)
+
+    end = start + limit
+    next_cursor = str(end) if end < len(records) else None
+    return records[start:end], next_cursor
+
+
+def _paged_call(func, params):
+    """
+    Calls a listing method with the page the client asked for, plug-ins
+    with a cursor argument get limit and cursor handed through and return
+    (records, next_cursor).
+    """
+    limit = params.pop('limit', None)
+    cursor = params.pop('cursor', None)
+    if limit is None:
+        return func(**params)
+
+    if not isinstance(limit, int) or isinstance(limit, bool) or limit < 1:
+        raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                       "Invalid limit: %s" % limit)
+
+    if 'cursor' in inspect.signature(func).parameters:
+        records, next_cursor = func(limit=limit, cursor=cursor, **params)
+    else:
+        records, next_cursor = _page_cut(func(**params), limit, cursor)
+    return {'records': records, 'cursor': next_cursor}
+
+
 def search_property(lsm_objs, search_key, search_value):
     """
     This method does not check whether lsm_obj contain requested property.
@@ -43,11 +91,46 @@ def _is_number(val):
         except ValueError:
             return False
 
+    @staticmethod
+    def _client_fd_receive(ctl_fd):
+        """
+        Waits for lsmd to pass us the client connection over ctl_fd, which is
+        how plug-ins lsmd started ahead of time get their client.  Returns
+        None if lsmd closed ctl_fd instead.
+        """
+        ctl = socket.fromfd(ctl_fd, socket.AF_UNIX, socket.SOCK_STREAM)
+        os.close(ctl_fd)
+        try:
+            fd_size = struct.calcsize('i')
+            _, ancdata, _, _ = ctl.recvmsg(1, socket.CMSG_SPACE(fd_size))
+        finally:
+            ctl.close()
+
+        for level, kind, data in ancdata:
+            if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+                return struct.unpack('i', data[:fd_size])[0]
+        return None
+
     def __init__(self, plugin, args):
         self.cmdline = False
-        if len(args) == 2 and PluginRunner._is_number(args[1]):
+        fd = None
+
+        if len(args) == 3 and args[1] == '--warm' and \
+                PluginRunner._is_number(args[2]):
+            try:
+                fd = PluginRunner._client_fd_receive(int(args[2]))
+            except Exception:
+                error(traceback.format_exc())
+                error('Plug-in exiting.')
+                sys.exit(2)
+            if fd is None:
+                # lsmd is going away or reloading, nobody to serve
+                sys.exit(0)
+        elif len(args) == 2 and PluginRunner._is_number(args[1]):
+            fd = int(args[1])
+
+        if fd is not None:
             try:
-                fd = int(args[1])
                 self.tp = TransPort(
                     socket.fromfd(fd, socket.AF_UNIX, socket.SOCK_STREAM))
 
@@ -69,6 +152,65 @@ def __init__(self, plugin, args):
             self.cmdline = True
             cmd_line_wrapper(plugin)
 
+    def _call(self, method, params):
+        """
+        Calls method of the plug-in with params, raising the expected error
+        if the plug-in doesn't implement it.
+        """
+        if not hasattr(self.plugin, method):
+            raise LsmError(ErrorNumber.NO_SUPPORT, "Unsupported operation")
+
+        if params is None:
+            return getattr(self.plugin, method)()
+        elif method in _PAGED_METHODS:
+            return _paged_call(getattr(self.plugin, method), params)
+        return getattr(self.plugin, method)(**params)
+
+    def _batch(self, params):
+        """
+        Runs each request of a batch in turn, a failing one doesn't stop the
+        ones after it, whatever it raised.  Returns a list holding either
+        {'result': ...} or {'error': {'code': ..., 'message': ..., 'data':
+        ...}} for each request, in the same order.
+        """
+        requests = params.get('requests')
+        if params.get('flags', 0) != 0:
+            raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                           "Reserved flag set")
+        if not isinstance(requests, list):
+            raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                           "Batch requests must be a list")
+
+        results = []
+        for req in requests:
+            try:
+                if not isinstance(req, dict) or \
+                        req.get('method') in (None, 'batch',
+                                              'plugin_register',
+                                              'plugin_unregister'):
+                    raise LsmError(ErrorNumber.INVALID_ARGUMENT,
+                                   "Invalid batch request")
+                results.append(
+                    {'result': self._call(req['method'], req.get('params'))})
+            except LsmError as lsm_err:
+                results.append({'error': {'code': lsm_err.code,
+                                          'message': lsm_err.msg,
+                                          'data': lsm_err.data}})
+            except Exception as e:
+                # Whatever else it raises is this request's error alone,
+                # coded as run() would have sent it.
+                error(traceback.format_exc())
+                if isinstance(e, ValueError):
+                    code = -32700
+                elif isinstance(e, AttributeError):
+                    code = -32601
+                else:
+                    code = ErrorNumber.PLUGIN_BUG
+                results.append({'error': {'code': code,
+                                          'message': str(e),
+                                          'data': traceback.format_exc()}})
+        return results
+
     def run(self):
         # Don't need to invoke this when running stand alone as a cmdline
         if self.cmdline:
@@ -88,22 +230,38 @@ def run(self):
                     msg_id = msg['id']
                     params = msg['params']
 
-                    # Check to see if this plug-in implements this operation
-                    # if not return the expected error.
-                    if hasattr(self.plugin, method):
-                        if params is None:
-                            result = getattr(self.plugin, method)()
-                        else:
-                            result = getattr(self.plugin,
-                                             method)(**msg['params'])
+                    if method == 'batch':
+                        result = self._batch(params or {})
                     else:
-                        raise LsmError(ErrorNumber.NO_SUPPORT,
-                                       "Unsupported operation")
-
-                    self.tp.send_resp(result)
+                        result = self._call(method, params)
 
                     if method == 'plugin_register':
+                        # Clients offer the encodings they support when
+                        # they register, older ones don't and stay on json.
+                        self.tp.send_resp(result,
+                                          msg_id,
+                                          encoding=TransPort.encoding_select(
+                                              msg.get('encodings')))
+                        # Same for receiving large responses in a memfd
+                        self.tp.transfer_select(msg.get('transfers'))
                         need_shutdown = True
+                    else:
+                        # Clients listing lots of records may ask for them
+                        # in parts, so they can start on the first ones
+                        # before the rest arrive.  Anything but a positive
+                        # chunk size gets the whole result at once.
+                        stream = msg.get('stream')
+                        if isinstance(stream, int) and \
+                                not isinstance(stream, bool) and \
+                                stream > 0 and isinstance(result, list):
+                            start = 0
+                            while len(result) - start > stream:
+                                self.tp.send_resp(result[start:start + stream],
+                                                  msg_id,
+                                                  more=True)
+                                start += stream
+                            result = result[start:]
+                        self.tp.send_resp(result, msg_id)
 
                     if method == 'plugin_unregister':
                         # This is a graceful plugin_unregister
@@ -4,9 +4,13 @@
 #
 # Author: Tony Asleson <tasleson@redhat.com>
 
+import array
+import fcntl
 import json
+import mmap
 import socket
 import os
+import time
 import unittest
 import threading
 
@@ -14,6 +18,18 @@
 from lsm._common import SocketEOF as _SocketEOF
 from lsm._data import DataDecoder as _DataDecoder
 from lsm._data import DataEncoder as _DataEncoder
+from lsm._data import IData as _IData
+from lsm._clib import _msgpack_pack, _msgpack_unpack
+
+
+def _msgpack_default(obj):
+    """
+    Turns the objects MessagePack can't carry into dictionaries, the same as
+    DataEncoder does for json.
+    """
+    if not isinstance(obj, _IData):
+        raise ValueError('incorrect class type:' + str(type(obj)))
+    return obj._to_dict()
 
 
 class TransPort(object):
@@ -26,12 +42,42 @@ class TransPort(object):
     valid json.
 
     Notes:
-    id field (json-rpc) is present but currently not being used.
-    This is available to be expanded on later.
+    Every request gets its own id, which the plug-in echoes back in the
+    response, so several requests can be outstanding at once.  Plug-ins
+    which predate this answer with id 100, in order.
+
+    A client can offer other encodings with its plugin_register request by
+    adding 'encodings', a list of names in order of preference, to the
+    request.  A plug-in which supports one of them names it as 'encoding' in
+    the response and both sides use it for every message after that.  The
+    receiving side tells the encodings apart by the first byte of the
+    payload.  Supported encodings are 'json' and 'msgpack' (MessagePack).
+
+    The same request can carry 'transfers': ['memfd'], saying the client can
+    receive payloads in a memfd.  The plug-in then sends large payloads by
+    writing them to a sealed memfd and passing it over the socket with a
+    header of zero length, instead of streaming them through the socket.
     """
 
     HDR_LEN = 10
 
+    ENCODINGS = ('msgpack', 'json')
+
+    TRANSFERS = ('memfd', )
+
+    # Payloads at least this big are passed in a memfd when allowed
+    MEMFD_MIN = 256 * 1024
+
+    # Room for the descriptors which can come with one read
+    _ANC_SIZE = socket.CMSG_SPACE(4 * array.array('i').itemsize)
+
+    # Id older plug-ins use for every response, never handed out so those
+    # responses are not mistaken for the response to a particular request.
+    _LEGACY_ID = 100
+
+    # Buckets in the latency histogram of stats(), same as the C library
+    HISTOGRAM_BUCKETS = 24
+
     def _read_all(self, l):
         """
         Reads l number of bytes before returning.  Will raise a SocketEOF
@@ -41,28 +87,93 @@ def _read_all(self, l):
         if l < 1:
             raise ValueError("Trying to read less than 1 byte!")
 
-        data = bytearray()
-        while len(data) < l:
-            r = self.s.recv(l - len(data))
+        data = bytearray(l)
+        view = memoryview(data)
+        while view:
+            r, ancdata, _, _ = self.s.recvmsg_into([view], self._ANC_SIZE)
+            for level, kind, fds in ancdata:
+                if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+                    a = array.array('i')
+                    a.frombytes(fds[:len(fds) - (len(fds) % a.itemsize)])
+                    self._fds.extend(a)
             if not r:
                 raise _SocketEOF()
-            data += r
+            view = view[r:]
+
+        return data
 
-        return data.decode("utf-8")
+    def _read_memfd(self):
+        """
+        Maps the next memfd received and returns the payload in it.
+        """
+        if not self._fds:
+            raise LsmError(ErrorNumber.TRANSPORT_SERIALIZATION,
+                           "Zero length message without a memfd")
+        fd = self._fds.pop(0)
+        try:
+            # Make sure it can't be truncated while we have it mapped
+            if hasattr(fcntl, 'F_GET_SEALS'):
+                seals = fcntl.fcntl(fd, fcntl.F_GET_SEALS)
+                needed = fcntl.F_SEAL_SHRINK | fcntl.F_SEAL_WRITE
+                if seals & needed != needed:
+                    raise LsmError(ErrorNumber.TRANSPORT_SERIALIZATION,
+                                   "Payload memfd is not sealed")
+            size = os.fstat(fd).st_size
+            with mmap.mmap(fd, size, prot=mmap.PROT_READ) as m:
+                return m[:]
+        finally:
+            os.close(fd)
+
+    def _send_memfd(self, msg):
+        """
+        Writes msg to a sealed memfd and sends it with a zero length header.
+        """
+        fd = os.memfd_create('lsm_ipc',
+                             os.MFD_CLOEXEC | os.MFD_ALLOW_SEALING)
+        try:
+            view = memoryview(msg)
+            while view:
+                view = view[os.write(fd, view):]
+            fcntl.fcntl(
+                fd, fcntl.F_ADD_SEALS, fcntl.F_SEAL_SHRINK
+                | fcntl.F_SEAL_GROW | fcntl.F_SEAL_WRITE | fcntl.F_SEAL_SEAL)
+            self.s.sendmsg([b'0' * self.HDR_LEN],
+                           [(socket.SOL_SOCKET, socket.SCM_RIGHTS,
+                             array.array('i', [fd]))])
+        finally:
+            os.close(fd)
 
     def _send_msg(self, msg):
         """
-        Sends the json formatted message by pre-appending the length
-        first.
+        Sends the encoded message by pre-appending the length first.
         """
 
         if msg is None or len(msg) < 1:
             raise ValueError("Msg argument empty")
 
+        if isinstance(msg, str):
+            msg = msg.encode('utf-8')
+
         # Note: Don't catch io exceptions at this level!
-        s = str.zfill(str(len(msg)), self.HDR_LEN) + msg
-        # common.Info("SEND: ", msg)
-        self.s.sendall(bytes(s.encode('utf-8')))
+        if self.memfd and len(msg) >= self.MEMFD_MIN:
+            self._send_memfd(msg)
+        else:
+            hdr = str.zfill(str(len(msg)), self.HDR_LEN).encode('utf-8')
+            # common.Info("SEND: ", msg)
+            self.s.sendall(hdr + msg)
+        return len(msg) + self.HDR_LEN
+
+    def _encode(self, msg):
+        if self.encoding == 'msgpack':
+            return _msgpack_pack(msg, _msgpack_default)
+        return json.dumps(msg, cls=_DataEncoder)
+
+    @staticmethod
+    def _decode(data):
+        # json always starts with text, MessagePack with a map header
+        if data[0] >= 0x80:
+            return _msgpack_unpack(data, _IData._factory)
+        return json.loads(data.decode('utf-8'), cls=_DataDecoder)
 
     def _recv_msg(self):
         """
@@ -70,8 +181,11 @@ def _recv_msg(self):
         bytes of the message.
         """
         try:
-            num_bytes = self._read_all(self.HDR_LEN)
-            msg = self._read_all(int(num_bytes))
+            num_bytes = int(self._read_all(self.HDR_LEN).decode('utf-8'))
+            if num_bytes == 0:
+                msg = self._read_memfd()
+            else:
+                msg = self._read_all(num_bytes)
             # common.Info("RECV: ", msg)
         except socket.error as e:
             raise LsmError(ErrorNumber.TRANSPORT_COMMUNICATION,
@@ -85,6 +199,14 @@ def _recv_msg(self):
 
     def __init__(self, socket_descriptor):
         self.s = socket_descriptor
+        self.encoding = 'json'
+        self.memfd = False  # Send large payloads in a memfd
+        self._fds = []  # memfds received, in the order they were sent
+        self._next_id = 1
+        self._pending = []  # Ids of requests sent, oldest first
+        self._replies = {}  # Responses not asked for yet, by id
+        self._inflight = {}  # Cost so far of requests sent, by id
+        self._stats = {}  # By method, see stats()
 
     @staticmethod
     def get_socket(path):
@@ -122,22 +244,53 @@ def close(self):
         """
         Closes the transport and the underlying socket
         """
+        for fd in self._fds:
+            os.close(fd)
+        self._fds = []
         self.s.close()
 
-    def send_req(self, method, args):
+    def _id_get(self):
+        msg_id = self._next_id
+        if msg_id == TransPort._LEGACY_ID:
+            msg_id += 1
+        self._next_id = msg_id + 1 if msg_id < 2**31 else 1
+        return msg_id
+
+    def send_req(self, method, args, offer_encodings=False):
         """
-        Sends a request given a method and arguments.
+        Sends a request given a method and arguments, returns the id of the
+        request which is needed to wait for its response.
         Note: arguments must be in the form that can be automatically
         serialized to json
+        When offer_encodings is True the encodings we support are offered to
+        the plug-in, unless LSM_IPC_ENCODING=json is set in the environment.
+        With LSM_IPC_MEMFD=1 set receiving large payloads in a memfd is
+        offered too.
         """
         try:
-            msg = {'method': method, 'id': 100, 'params': args}
-            data = json.dumps(msg, cls=_DataEncoder)
-            self._send_msg(data)
+            start = time.perf_counter_ns()
+            msg_id = self._id_get()
+            msg = {'method': method, 'id': msg_id, 'params': args}
+            if offer_encodings and \
+                    os.getenv('LSM_IPC_ENCODING', '') != 'json':
+                msg['encodings'] = list(TransPort.ENCODINGS)
+            if offer_encodings and os.getenv('LSM_IPC_MEMFD', '') == '1':
+                msg['transfers'] = list(TransPort.TRANSFERS)
+            data = self._encode(msg)
+            serialize_ns = time.perf_counter_ns() - start
+            sent = self._send_msg(data)
         except socket.error as se:
             raise LsmError(ErrorNumber.TRANSPORT_COMMUNICATION,
                            "Error while sending a message to the plug-in",
                            str(se))
+        self._pending.append(msg_id)
+        self._inflight[msg_id] = {
+            'method': method,
+            'start': start,
+            'serialize_ns': serialize_ns,
+            'bytes_sent': sent
+        }
+        return msg_id
 
     def read_req(self):
         """
@@ -146,16 +299,13 @@ def read_req(self):
         data = self._recv_msg()
         if len(data):
             # common.Info(str(data))
-            return json.loads(data, cls=_DataDecoder)
+            return self._decode(data)
 
-    def rpc(self, method, args):
+    def rpc(self, method, args, offer_encodings=False):
         """
         Sends a request and waits for a response.
         """
-        self.send_req(method, args)
-        (reply, msg_id) = self.read_resp()
-        assert msg_id == 100
-        return reply
+        return self.wait_resp(self.send_req(method, args, offer_encodings))
 
     def send_error(self, msg_id, error_code, msg, data=None):
         """
@@ -169,25 +319,159 @@ def send_error(self, msg_id, error_code, msg, data=None):
                 'data': data
             }
         }
-        self._send_msg(json.dumps(e, cls=_DataEncoder))
+        self._send_msg(self._encode(e))
 
-    def send_resp(self, result, msg_id=100):
+    def send_resp(self, result, msg_id=100, encoding=None, more=False):
         """
-        Used to transmit a response
+        Used to transmit a response.  If encoding is given it is announced to
+        the client and used for every message after this one.  With more the
+        result is one part of a streamed listing, more parts follow.
         """
         r = {'id': msg_id, 'result': result}
-        self._send_msg(json.dumps(r, cls=_DataEncoder))
+        if more:
+            r['more'] = True
+        if encoding is not None:
+            r['encoding'] = encoding
+        self._send_msg(self._encode(r))
+        if encoding is not None:
+            self.encoding = encoding
 
-    def read_resp(self):
+    @staticmethod
+    def encoding_select(offered):
+        """
+        Returns the first of the encodings offered by a client which we
+        support, None if there are none.
+        """
+        if isinstance(offered, list):
+            for name in offered:
+                if name in TransPort.ENCODINGS:
+                    return name
+        return None
+
+    def transfer_select(self, offered):
+        """
+        Starts sending large payloads in a memfd if the client offered to
+        receive them that way and we are able to.
+        """
+        if isinstance(offered, list) and 'memfd' in offered and \
+                hasattr(os, 'memfd_create') and hasattr(fcntl, 'F_ADD_SEALS'):
+            self.memfd = True
+
+    def _read_reply(self):
+        """
+        Reads the next response and files it under the id of the request it
+        answers, returns that id.
+        """
         data = self._recv_msg()
-        resp = json.loads(data, cls=_DataDecoder)
+        start = time.perf_counter_ns()
+        resp = self._decode(data)
+        deserialize_ns = time.perf_counter_ns() - start
+
+        if 'encoding' in resp:
+            if resp['encoding'] not in TransPort.ENCODINGS:
+                raise LsmError(ErrorNumber.TRANSPORT_SERIALIZATION,
+                               "Plug-in picked unsupported encoding",
+                               str(resp['encoding']))
+            self.encoding = resp['encoding']
+
+        msg_id = resp.get('id')
+        if msg_id not in self._pending and self._pending:
+            # Plug-ins which don't echo the id still answer in order
+            msg_id = self._pending[0]
+        if msg_id in self._pending:
+            self._pending.remove(msg_id)
+
+        self._stats_record(msg_id, len(data) + self.HDR_LEN, deserialize_ns,
+                           'result' not in resp)
+        self._replies[msg_id] = resp
+        return msg_id
+
+    def _stats_record(self, msg_id, received, deserialize_ns, error):
+        """
+        Adds a request which got its response to the statistics of its
+        method.
+        """
+        f = self._inflight.pop(msg_id, None)
+        if f is None:
+            return
+
+        took = time.perf_counter_ns() - f['start']
+        st = self._stats.get(f['method'])
+        if st is None:
+            st = dict(calls=0,
+                      errors=0,
+                      bytes_sent=0,
+                      bytes_received=0,
+                      serialize_ns=0,
+                      transport_ns=0,
+                      deserialize_ns=0,
+                      histogram=[0] * TransPort.HISTOGRAM_BUCKETS)
+            self._stats[f['method']] = st
+
+        st['calls'] += 1
+        if error:
+            st['errors'] += 1
+        st['bytes_sent'] += f['bytes_sent']
+        st['bytes_received'] += received
+        st['serialize_ns'] += f['serialize_ns']
+        st['deserialize_ns'] += deserialize_ns
+        st['transport_ns'] += max(
+            0, took - f['serialize_ns'] - deserialize_ns)
+        bucket = min((took // 1000).bit_length(),
+                     TransPort.HISTOGRAM_BUCKETS - 1)
+        st['histogram'][bucket] += 1
+
+    def stats(self):
+        """
+        Returns what the requests sent so far have cost, as a dict of dicts
+        by method name.  Each holds the number of 'calls' which got a
+        response and how many of those were 'errors', 'bytes_sent' and
+        'bytes_received' including headers, the time in ns spent in
+        'serialize_ns', 'deserialize_ns' and 'transport_ns' (what is left,
+        spent in the transport and the plug-in) and a latency 'histogram'.
+        Bucket 0 of the histogram counts requests which took less than 1us,
+        bucket n those which took from 2^(n-1)us up to 2^n us, the last
+        bucket everything longer.
+        """
+        return dict((m, dict(st, histogram=list(st['histogram'])))
+                    for m, st in self._stats.items())
 
+    def stats_reset(self):
+        """
+        Clears the statistics, requests outstanding are still counted once
+        their response arrives.
+        """
+        self._stats = {}
+
+    @staticmethod
+    def _result(resp):
         if 'result' in resp:
-            return resp['result'], resp['id']
+            return resp['result']
         else:
             e = resp['error']
             raise LsmError(**e)
 
+    def read_resp(self):
+        """
+        Reads the next response, whichever request it answers.  Returns the
+        result and the id of the request.
+        """
+        msg_id = self._read_reply()
+        return TransPort._result(self._replies.pop(msg_id)), msg_id
+
+    def wait_resp(self, msg_id):
+        """
+        Waits for the response to the request with id msg_id and returns its
+        result.  Responses to other requests which arrive first are kept
+        until they are waited for.
+        """
+        while msg_id not in self._replies:
+            if msg_id not in self._pending:
+                raise LsmError(ErrorNumber.LIB_BUG,
+                               "Waiting on unknown request id %s" % msg_id)
+            self._read_reply()
+        return TransPort._result(self._replies.pop(msg_id))
+
 
 def _server(s):
     """
@@ -203,6 +487,21 @@ def _server(s):
             if msg['method'] == 'error':
                 srv.send_error(msg['id'], msg['params']['errorcode'],
                                msg['params']['errormsg'])
+            elif msg['method'] == 'pipeline':
+                # Hold responses back and answer them in reverse order
+                held = []
+                while msg['method'] == 'pipeline':
+                    held.append(msg)
+                    if msg['params'] == 'last':
+                        break
+                    msg = srv.read_req()
+                for m in reversed(held):
+                    srv.send_resp(m['params'], m['id'])
+            elif msg['method'] == 'plugin_register':
+                srv.send_resp(msg['params'],
+                              encoding=TransPort.encoding_select(
+                                  msg.get('encodings')))
+                srv.transfer_select(msg.get('transfers'))
             else:
                 srv.send_resp(msg['params'])
             msg = srv.read_req()
@@ -226,9 +525,9 @@ def test_simple(self):
         tc = ['0', ' ', '   ', '{}:""', "Some text message", 'DEADBEEF']
 
         for t in tc:
-            self.client.send_req('test', t)
+            sent_id = self.client.send_req('test', t)
             reply, msg_id = self.client.read_resp()
-            self.assertTrue(msg_id == 100)
+            self.assertTrue(msg_id == sent_id)
             self.assertTrue(reply == t)
 
     def test_exceptions(self):
@@ -270,6 +569,91 @@ def test_slow(self):
             reply, msg_id = self.client.read_resp()
             self.assertTrue(payload == reply)
 
+    def test_pipeline(self):
+        ids = [self.client.send_req('pipeline', i) for i in range(10)]
+        ids.append(self.client.send_req('pipeline', 'last'))
+        self.assertTrue(len(set(ids)) == len(ids))
+        self.assertTrue(100 not in ids)
+
+        # Responses come back in reverse order, results must still match
+        for i in range(10):
+            self.assertTrue(self.client.wait_resp(ids[i]) == i)
+        self.assertTrue(self.client.wait_resp(ids[10]) == 'last')
+        self.assertRaises(LsmError, self.client.wait_resp, ids[0])
+
+    def test_stats(self):
+        self.assertTrue(self.client.stats() == {})
+        for i in range(3):
+            self.client.rpc('stats', i)
+        self.assertRaises(LsmError, self.client.rpc, 'error', {
+            'errorcode': 100,
+            'errormsg': 'Test error message'
+        })
+
+        st = self.client.stats()
+        self.assertTrue(sorted(st.keys()) == ['error', 'stats'])
+        self.assertTrue(st['stats']['calls'] == 3)
+        self.assertTrue(st['stats']['errors'] == 0)
+        self.assertTrue(st['error']['errors'] == 1)
+        self.assertTrue(sum(st['stats']['histogram']) == 3)
+        self.assertTrue(st['stats']['bytes_sent'] > 3 * TransPort.HDR_LEN)
+        self.assertTrue(st['stats']['bytes_received'] > 3 * TransPort.HDR_LEN)
+
+        self.client.stats_reset()
+        self.assertTrue(self.client.stats() == {})
+
+    def test_msgpack(self):
+        reply = self.client.rpc('plugin_register', None, offer_encodings=True)
+        self.assertTrue(reply is None)
+        self.assertTrue(self.client.encoding == 'msgpack')
+
+        tc = [
+            0, 1, 127, 128, -1, -32, -33, -129, 2**16, 2**32, 2**64 - 1,
+            -2**63, 1.5, True, False, None, '', 'x' * 31, 'x' * 32, 'x' * 256,
+            'x' * 70000, 'dévice "quoted"', [], [1] * 16,
+            list(range(70000)), {}, {
+                'a': {
+                    'b': [1, 'c', None]
+                }
+            },
+            dict((str(i), i) for i in range(20))
+        ]
+
+        for t in tc:
+            self.assertTrue(self.client.rpc('test', t) == t)
+
+        # IData objects are sent as dictionaries and rebuilt on receipt
+        from lsm import Volume
+        vol = Volume('id', 'name', '600508b1001c5e4f9b2d1a3c00000001', 512,
+                     2048, Volume.ADMIN_STATE_ENABLED, 'sim-01', 'pool', None)
+        reply = self.client.rpc('test', {'volume': vol})
+        self.assertTrue(isinstance(reply['volume'], Volume))
+        self.assertTrue(reply['volume'].vpd83 == vol.vpd83)
+
+        self.assertRaises(ValueError, _msgpack_unpack, b'\x81\xa1')
+        self.assertRaises(ValueError, _msgpack_unpack, b'\x80\x80')
+        self.assertRaises(ValueError, _msgpack_pack, object())
+
+    def test_memfd(self):
+        os.environ['LSM_IPC_MEMFD'] = '1'
+        try:
+            self.client.rpc('plugin_register', None, offer_encodings=True)
+        finally:
+            del os.environ['LSM_IPC_MEMFD']
+
+        big = 'x' * (TransPort.MEMFD_MIN * 2)
+        for t in ['small', big, [big, 'small', big]]:
+            self.assertTrue(self.client.rpc('test', t) == t)
+
+        # Several memfds queued up must each go with their own header
+        ids = [self.client.send_req('pipeline', big + str(i))
+               for i in range(3)]
+        ids.append(self.client.send_req('pipeline', 'last'))
+        for i in range(3):
+            self.assertTrue(self.client.wait_resp(ids[i]) == big + str(i))
+        self.assertTrue(self.client.wait_resp(ids[3]) == 'last')
+        self.assertTrue(len(self.client._fds) == 0)
+
     def tearDown(self):
         self.client.send_req("done", None)
         resp, msg_id = self.client.read_resp()
@@ -14,6 +14,8 @@
 #include <inttypes.h>
 #include <libstoragemgmt/libstoragemgmt.h>
 #include <libstoragemgmt/libstoragemgmt_plug_interface.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -4232,6 +4234,826 @@ START_TEST(test_local_disk_link_speed_get) {
 }
 END_TEST
 
+START_TEST(test_ipc_encoding) {
+    char uri[_URI_BUFF_SIZE];
+    lsm_connect *json_c = NULL;
+    lsm_error_ptr e = NULL;
+    lsm_disk **disks = NULL;
+    lsm_disk **json_disks = NULL;
+    uint32_t count = 0;
+    uint32_t json_count = 0;
+    uint32_t i = 0;
+    int rc = 0;
+
+    /*
+     * The connection made in setup() negotiated the binary encoding, open
+     * one which stays on json and check both return the same disks.
+     */
+    ck_assert_msg(c != NULL, "c = %p", c);
+
+    setenv("LSM_IPC_ENCODING", "json", 1);
+    rc = lsm_connect_password(plugin_to_use(uri), NULL, &json_c, 30000, &e,
+                              LSM_CLIENT_FLAG_RSVD);
+    unsetenv("LSM_IPC_ENCODING");
+    ck_assert_msg(LSM_ERR_OK == rc, "lsm_connect_password %d, %s", rc,
+                  error(e));
+
+    G(rc, lsm_disk_list, c, NULL, NULL, &disks, &count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_disk_list, json_c, NULL, NULL, &json_disks, &json_count,
+      LSM_CLIENT_FLAG_RSVD);
+
+    ck_assert_msg(count >= 1 && count == json_count,
+                  "count %" PRIu32 " json_count %" PRIu32, count, json_count);
+
+    for (i = 0; i < count; ++i) {
+        ck_assert_msg(compare_disks(disks[i], json_disks[i]) == 0,
+                      "disk %s differs between encodings",
+                      lsm_disk_id_get(disks[i]));
+    }
+
+    G(rc, lsm_disk_record_array_free, disks, count);
+    G(rc, lsm_disk_record_array_free, json_disks, json_count);
+    G(rc, lsm_connect_close, json_c, LSM_CLIENT_FLAG_RSVD);
+}
+END_TEST
+
+START_TEST(test_json_escaping) {
+    char uri[_URI_BUFF_SIZE];
+    const char *name = "esc \"quoted\" back\\slash\ttab\nnew caf\xc3\xa9";
+    lsm_connect *json_c = NULL;
+    lsm_error_ptr e = NULL;
+    lsm_pool *pool = NULL;
+    lsm_volume *n = NULL;
+    char *job = NULL;
+    int rc = 0;
+
+    /*
+     * Round trip a name which has to be escaped in json, both in the
+     * request and in the response.
+     */
+    setenv("LSM_IPC_ENCODING", "json", 1);
+    rc = lsm_connect_password(plugin_to_use(uri), NULL, &json_c, 30000, &e,
+                              LSM_CLIENT_FLAG_RSVD);
+    unsetenv("LSM_IPC_ENCODING");
+    ck_assert_msg(LSM_ERR_OK == rc, "lsm_connect_password %d, %s", rc,
+                  error(e));
+
+    pool = get_test_pool(json_c);
+    ck_assert_msg(pool != NULL, "pool = %p", pool);
+
+    rc = lsm_volume_create(json_c, pool, name, 20000000,
+                           LSM_VOLUME_PROVISION_DEFAULT, &n, &job,
+                           LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                  "lsm_volume_create %d (%s)", rc,
+                  error(lsm_error_last_get(json_c)));
+
+    if (LSM_ERR_JOB_STARTED == rc) {
+        n = wait_for_job_vol(json_c, &job);
+    }
+    ck_assert_msg(n != NULL, "n = %p", n);
+    ck_assert_msg(strcmp(lsm_volume_name_get(n), name) == 0, "name '%s'",
+                  lsm_volume_name_get(n));
+
+    rc = lsm_volume_delete(json_c, n, &job, LSM_CLIENT_FLAG_RSVD);
+    if (LSM_ERR_JOB_STARTED == rc) {
+        wait_for_job(json_c, &job);
+    } else {
+        ck_assert_msg(LSM_ERR_OK == rc, "rc %d", rc);
+    }
+
+    G(rc, lsm_volume_record_free, n);
+    G(rc, lsm_pool_record_free, pool);
+    G(rc, lsm_connect_close, json_c, LSM_CLIENT_FLAG_RSVD);
+}
+END_TEST
+
+START_TEST(test_rpc_submit) {
+    lsm_pool **pools = NULL;
+    lsm_pool **async_pools = NULL;
+    lsm_volume **volumes = NULL;
+    lsm_system **systems = NULL;
+    lsm_system **again = NULL;
+    lsm_disk **disks = NULL;
+    uint32_t pool_count = 0;
+    uint32_t async_pool_count = 0;
+    uint32_t volume_count = 0;
+    uint32_t system_count = 0;
+    uint32_t count = 0;
+    uint32_t ids[3] = {0, 0, 0};
+    uint32_t id = 0;
+    uint32_t i = 0;
+    int answered = 0;
+    int fd = -1;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+
+    G(rc, lsm_connect_fd_get, c, &fd, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(fd >= 0, "fd = %d", fd);
+
+    G(rc, lsm_rpc_submit, c, LSM_RPC_POOL_LIST, NULL, NULL, &ids[0],
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_rpc_submit, c, LSM_RPC_VOLUME_LIST, NULL, NULL, &ids[1],
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_rpc_submit, c, LSM_RPC_SYSTEM_LIST, NULL, NULL, &ids[2],
+      LSM_CLIENT_FLAG_RSVD);
+
+    rc = lsm_rpc_submit(c, LSM_RPC_SYSTEM_LIST, "id", "sim-01", &id,
+                        LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    // Blocking calls still work with requests outstanding
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &pool_count,
+      LSM_CLIENT_FLAG_RSVD);
+
+    while (answered < 3) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+
+        G(rc, lsm_rpc_poll_complete, c, &id, LSM_CLIENT_FLAG_RSVD);
+        if (0 == id) {
+            ck_assert_msg(poll(&pfd, 1, 30000) == 1, "poll timed out");
+            continue;
+        }
+
+        ck_assert_msg(id == ids[0] || id == ids[1] || id == ids[2],
+                      "unexpected id %" PRIu32, id);
+        answered++;
+    }
+
+    // Every answer is reported once
+    G(rc, lsm_rpc_poll_complete, c, &id, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(0 == id, "id %" PRIu32 " reported twice", id);
+
+    rc = lsm_rpc_disk_list_complete(c, ids[0], &disks, &count,
+                                    LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_rpc_pool_list_complete, c, ids[0], &async_pools,
+      &async_pool_count, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(async_pool_count == pool_count,
+                  "count %" PRIu32 " != %" PRIu32, async_pool_count,
+                  pool_count);
+    for (i = 0; i < pool_count; ++i) {
+        ASSERT_STR_MATCH(lsm_pool_id_get(pools[i]),
+                         lsm_pool_id_get(async_pools[i]));
+    }
+
+    G(rc, lsm_rpc_volume_list_complete, c, ids[1], &volumes, &volume_count,
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_rpc_system_list_complete, c, ids[2], &systems, &system_count,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(system_count >= 1, "system_count %" PRIu32, system_count);
+
+    rc = lsm_rpc_system_list_complete(c, ids[2], &again, &count,
+                                      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_pool_record_array_free, pools, pool_count);
+    G(rc, lsm_pool_record_array_free, async_pools, async_pool_count);
+    if (volume_count) {
+        G(rc, lsm_volume_record_array_free, volumes, volume_count);
+    }
+    G(rc, lsm_system_record_array_free, systems, system_count);
+}
+END_TEST
+
+START_TEST(test_list_iter) {
+    lsm_disk **disks = NULL;
+    lsm_disk *disk = NULL;
+    lsm_volume *vol = NULL;
+    lsm_fs *fs = NULL;
+    lsm_pool **pools = NULL;
+    lsm_list_iter *iter = NULL;
+    uint32_t disk_count = 0;
+    uint32_t pool_count = 0;
+    uint32_t i = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+
+    G(rc, lsm_disk_list, c, NULL, NULL, &disks, &disk_count,
+      LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_disk_list_iter_open, c, NULL, NULL, &iter, LSM_CLIENT_FLAG_RSVD);
+
+    // An iterator only hands out what it was opened for
+    rc = lsm_volume_list_iter_next(iter, &vol, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    for (i = 0;; ++i) {
+        G(rc, lsm_disk_list_iter_next, iter, &disk, LSM_CLIENT_FLAG_RSVD);
+        if (!disk) {
+            break;
+        }
+
+        ck_assert_msg(i < disk_count, "more disks than %" PRIu32, disk_count);
+        ASSERT_STR_MATCH(lsm_disk_id_get(disk), lsm_disk_id_get(disks[i]));
+        G(rc, lsm_disk_record_free, disk);
+    }
+    ck_assert_msg(i == disk_count, "count %" PRIu32 " != %" PRIu32, i,
+                  disk_count);
+
+    // Stays at the end
+    G(rc, lsm_disk_list_iter_next, iter, &disk, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(disk == NULL, "disk = %p", disk);
+    G(rc, lsm_list_iter_close, iter, LSM_CLIENT_FLAG_RSVD);
+    iter = NULL;
+
+    rc = lsm_volume_list_iter_open(c, "name", "x", &iter,
+                                   LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_UNSUPPORTED_SEARCH_KEY == rc, "rc = %d", rc);
+    ck_assert_msg(iter == NULL, "iter = %p", iter);
+
+    // Other calls can be made with one open and it can be closed early
+    G(rc, lsm_fs_list_iter_open, c, NULL, NULL, &iter, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &pool_count,
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_fs_list_iter_next, iter, &fs, LSM_CLIENT_FLAG_RSVD);
+    if (fs) {
+        G(rc, lsm_fs_record_free, fs);
+    }
+    G(rc, lsm_list_iter_close, iter, LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_pool_record_array_free, pools, pool_count);
+    G(rc, lsm_disk_record_array_free, disks, disk_count);
+}
+END_TEST
+
+START_TEST(test_connect_stats) {
+    lsm_rpc_stats **stats = NULL;
+    lsm_pool **pools = NULL;
+    uint32_t stats_count = 0;
+    uint32_t pool_count = 0;
+    uint32_t i = 0;
+    uint32_t b = 0;
+    int found = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+
+    G(rc, lsm_connect_stats_reset, c, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_connect_stats_get, c, &stats, &stats_count,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(stats_count == 0, "stats_count = %" PRIu32, stats_count);
+    ck_assert_msg(stats == NULL, "stats = %p", stats);
+
+    for (i = 0; i < 3; ++i) {
+        G(rc, lsm_pool_list, c, NULL, NULL, &pools, &pool_count,
+          LSM_CLIENT_FLAG_RSVD);
+        G(rc, lsm_pool_record_array_free, pools, pool_count);
+        pools = NULL;
+    }
+
+    G(rc, lsm_connect_stats_get, c, &stats, &stats_count,
+      LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < stats_count; ++i) {
+        uint64_t in_histogram = 0;
+
+        if (strcmp(lsm_rpc_stats_method_get(stats[i]), "pools") != 0) {
+            continue;
+        }
+        found = 1;
+
+        ck_assert_msg(lsm_rpc_stats_calls_get(stats[i]) == 3,
+                      "calls = %" PRIu64, lsm_rpc_stats_calls_get(stats[i]));
+        ck_assert_msg(lsm_rpc_stats_errors_get(stats[i]) == 0,
+                      "errors = %" PRIu64, lsm_rpc_stats_errors_get(stats[i]));
+        ck_assert_msg(lsm_rpc_stats_bytes_sent_get(stats[i]) > 0,
+                      "bytes_sent = 0");
+        ck_assert_msg(lsm_rpc_stats_bytes_received_get(stats[i]) > 0,
+                      "bytes_received = 0");
+        ck_assert_msg(lsm_rpc_stats_transport_ns_get(stats[i]) > 0,
+                      "transport_ns = 0");
+
+        for (b = 0; b < LSM_RPC_STATS_HISTOGRAM_BUCKETS; ++b) {
+            in_histogram += lsm_rpc_stats_histogram_get(stats[i], b);
+        }
+        ck_assert_msg(in_histogram == 3, "histogram holds %" PRIu64,
+                      in_histogram);
+        ck_assert_msg(lsm_rpc_stats_histogram_get(
+                          stats[i], LSM_RPC_STATS_HISTOGRAM_BUCKETS) == 0,
+                      "bucket out of range");
+    }
+    ck_assert_msg(found, "no statistics for pools");
+    G(rc, lsm_rpc_stats_record_array_free, stats, stats_count);
+    stats = NULL;
+
+    rc = lsm_connect_stats_get(c, &stats, NULL, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+}
+END_TEST
+
+START_TEST(test_connect_cache) {
+    lsm_pool **pools = NULL;
+    lsm_pool *pool = NULL;
+    lsm_volume *vol = NULL;
+    char *job = NULL;
+    uint32_t count = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    int i = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+    pool = get_test_pool(c);
+
+    G(rc, lsm_connect_cache_ttl_set, c, LSM_CACHE_POOLS, 60000,
+      LSM_CLIENT_FLAG_RSVD);
+
+    for (i = 0; i < 3; ++i) {
+        G(rc, lsm_pool_list, c, NULL, NULL, &pools, &count,
+          LSM_CLIENT_FLAG_RSVD);
+        G(rc, lsm_pool_record_array_free, pools, count);
+        pools = NULL;
+    }
+
+    G(rc, lsm_connect_cache_stats_get, c, LSM_CACHE_POOLS, &hits, &misses,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(hits == 2 && misses == 1,
+                  "hits = %" PRIu64 ", misses = %" PRIu64, hits, misses);
+
+    /* Creating a volume changes the free space of the pool */
+    rc = lsm_volume_create(c, pool, "cache_test", 20000000,
+                           LSM_VOLUME_PROVISION_DEFAULT, &vol, &job,
+                           LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                  "lsm_volume_create %d (%s)", rc,
+                  error(lsm_error_last_get(c)));
+    if (LSM_ERR_JOB_STARTED == rc) {
+        vol = wait_for_job_vol(c, &job);
+    }
+
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_record_array_free, pools, count);
+    pools = NULL;
+
+    G(rc, lsm_connect_cache_stats_get, c, LSM_CACHE_POOLS, &hits, &misses,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(hits == 2 && misses == 2,
+                  "hits = %" PRIu64 ", misses = %" PRIu64, hits, misses);
+
+    rc = lsm_volume_delete(c, vol, &job, LSM_CLIENT_FLAG_RSVD);
+    if (LSM_ERR_JOB_STARTED == rc) {
+        wait_for_job_vol(c, &job);
+    } else {
+        ck_assert_msg(LSM_ERR_OK == rc, "rc = %d", rc);
+    }
+
+    G(rc, lsm_connect_cache_ttl_set, c, LSM_CACHE_POOLS, 0,
+      LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_pool_record_array_free, pools, count);
+    G(rc, lsm_connect_cache_stats_get, c, LSM_CACHE_POOLS, &hits, &misses,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(hits == 2 && misses == 2,
+                  "hits = %" PRIu64 ", misses = %" PRIu64, hits, misses);
+
+    rc = lsm_connect_cache_ttl_set(c, (lsm_cache_class)99, 1,
+                                   LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_volume_record_free, vol);
+    G(rc, lsm_pool_record_free, pool);
+}
+END_TEST
+
+START_TEST(test_batch) {
+    lsm_access_group *group = NULL;
+    lsm_volume *vols[4] = {NULL};
+    lsm_volume **accessible = NULL;
+    lsm_batch *batch = NULL;
+    lsm_pool *pool = NULL;
+    lsm_system *system = NULL;
+    char name[32];
+    char *job = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+    pool = get_test_pool(c);
+    system = get_system(c);
+
+    G(rc, lsm_access_group_create, c, "test_batch", ISCSI_HOST[0],
+      LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_IQN, system, &group,
+      LSM_CLIENT_FLAG_RSVD);
+
+    for (i = 0; i < 4; ++i) {
+        snprintf(name, sizeof(name), "batch_test_%u", i);
+        rc = lsm_volume_create(c, pool, name, 20000000,
+                               LSM_VOLUME_PROVISION_DEFAULT, &vols[i], &job,
+                               LSM_CLIENT_FLAG_RSVD);
+        ck_assert_msg(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                      "lsm_volume_create %d (%s)", rc,
+                      error(lsm_error_last_get(c)));
+        if (LSM_ERR_JOB_STARTED == rc) {
+            vols[i] = wait_for_job_vol(c, &job);
+        }
+    }
+
+    /* Masking the first volume twice fails the last call only */
+    G(rc, lsm_batch_open, c, &batch, LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < 4; ++i) {
+        G(rc, lsm_batch_volume_mask, batch, group, vols[i],
+          LSM_CLIENT_FLAG_RSVD);
+    }
+    G(rc, lsm_batch_volume_mask, batch, group, vols[0], LSM_CLIENT_FLAG_RSVD);
+
+    rc = lsm_batch_run(batch, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_NO_STATE_CHANGE == rc, "rc = %d", rc);
+    for (i = 0; i < 4; ++i) {
+        G(rc, lsm_batch_result_get, batch, i, &job, LSM_CLIENT_FLAG_RSVD);
+    }
+    rc = lsm_batch_result_get(batch, 4, &job, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_NO_STATE_CHANGE == rc, "rc = %d", rc);
+    rc = lsm_batch_result_get(batch, 5, &job, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_volumes_accessible_by_access_group, c, group, &accessible,
+      &count, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(4 == count, "count = %" PRIu32, count);
+    G(rc, lsm_volume_record_array_free, accessible, count);
+
+    /* The batch can be filled again once run */
+    for (i = 0; i < 4; ++i) {
+        G(rc, lsm_batch_volume_unmask, batch, group, vols[i],
+          LSM_CLIENT_FLAG_RSVD);
+        G(rc, lsm_batch_volume_delete, batch, vols[i], LSM_CLIENT_FLAG_RSVD);
+    }
+    G(rc, lsm_batch_run, batch, LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < 8; ++i) {
+        rc = lsm_batch_result_get(batch, i, &job, LSM_CLIENT_FLAG_RSVD);
+        if (LSM_ERR_JOB_STARTED == rc) {
+            wait_for_job(c, &job);
+        } else {
+            ck_assert_msg(LSM_ERR_OK == rc, "rc = %d", rc);
+        }
+    }
+    G(rc, lsm_batch_close, batch, LSM_CLIENT_FLAG_RSVD);
+
+    G(rc, lsm_access_group_delete, c, group, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_access_group_record_free, group);
+    for (i = 0; i < 4; ++i) {
+        G(rc, lsm_volume_record_free, vols[i]);
+    }
+    G(rc, lsm_system_record_free, system);
+    G(rc, lsm_pool_record_free, pool);
+}
+END_TEST
+
+START_TEST(test_bulk) {
+    lsm_access_group *group = NULL;
+    lsm_access_group *updated = NULL;
+    lsm_volume *vols[5] = {NULL};
+    lsm_volume **accessible = NULL;
+    lsm_string_list *init_ids = NULL;
+    lsm_string_list *jobs = NULL;
+    lsm_pool *pool = NULL;
+    lsm_system *system = NULL;
+    int32_t *results = NULL;
+    char name[32];
+    char *job = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+    pool = get_test_pool(c);
+    system = get_system(c);
+
+    G(rc, lsm_access_group_create, c, "test_bulk", ISCSI_HOST[0],
+      LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_IQN, system, &group,
+      LSM_CLIENT_FLAG_RSVD);
+
+    for (i = 0; i < 4; ++i) {
+        snprintf(name, sizeof(name), "bulk_test_%u", i);
+        rc = lsm_volume_create(c, pool, name, 20000000,
+                               LSM_VOLUME_PROVISION_DEFAULT, &vols[i], &job,
+                               LSM_CLIENT_FLAG_RSVD);
+        ck_assert_msg(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                      "lsm_volume_create %d (%s)", rc,
+                      error(lsm_error_last_get(c)));
+        if (LSM_ERR_JOB_STARTED == rc) {
+            vols[i] = wait_for_job_vol(c, &job);
+        }
+    }
+    /* The first volume twice */
+    vols[4] = vols[0];
+
+    G(rc, lsm_volume_mask_bulk, c, group, vols, 5, &results,
+      LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < 4; ++i) {
+        ck_assert_msg(LSM_ERR_OK == results[i], "results[%u] = %d", i,
+                      results[i]);
+    }
+    ck_assert_msg(LSM_ERR_NO_STATE_CHANGE == results[4], "results[4] = %d",
+                  results[4]);
+    free(results);
+    results = NULL;
+
+    G(rc, lsm_volumes_accessible_by_access_group, c, group, &accessible,
+      &count, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(4 == count, "count = %" PRIu32, count);
+    G(rc, lsm_volume_record_array_free, accessible, count);
+
+    /* Masked volumes can't be deleted */
+    G(rc, lsm_volume_delete_bulk, c, vols, 1, &results, &jobs,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_IS_MASKED == results[0], "results[0] = %d",
+                  results[0]);
+    free(results);
+    results = NULL;
+    G(rc, lsm_string_list_free, jobs);
+    jobs = NULL;
+
+    G(rc, lsm_volume_unmask_bulk, c, group, vols, 4, &results,
+      LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < 4; ++i) {
+        ck_assert_msg(LSM_ERR_OK == results[i], "results[%u] = %d", i,
+                      results[i]);
+    }
+    free(results);
+    results = NULL;
+
+    /* The second initiator is in the group already */
+    init_ids = lsm_string_list_alloc(0);
+    G(rc, lsm_string_list_append, init_ids, ISCSI_HOST[1]);
+    G(rc, lsm_string_list_append, init_ids, ISCSI_HOST[0]);
+    G(rc, lsm_access_group_initiator_add_bulk, c, group, init_ids,
+      LSM_ACCESS_GROUP_INIT_TYPE_ISCSI_IQN, &results, &updated,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_OK == results[0], "results[0] = %d", results[0]);
+    ck_assert_msg(LSM_ERR_OK != results[1], "results[1] = %d", results[1]);
+    count = lsm_string_list_size(lsm_access_group_initiator_id_get(updated));
+    ck_assert_msg(2 == count, "count = %" PRIu32, count);
+    free(results);
+    results = NULL;
+    G(rc, lsm_access_group_record_free, updated);
+    G(rc, lsm_string_list_free, init_ids);
+
+    G(rc, lsm_volume_delete_bulk, c, vols, 4, &results, &jobs,
+      LSM_CLIENT_FLAG_RSVD);
+    for (i = 0; i < 4; ++i) {
+        if (LSM_ERR_JOB_STARTED == results[i]) {
+            job = strdup(lsm_string_list_elem_get(jobs, i));
+            wait_for_job(c, &job);
+        } else {
+            ck_assert_msg(LSM_ERR_OK == results[i], "results[%u] = %d", i,
+                          results[i]);
+        }
+    }
+    free(results);
+    results = NULL;
+    G(rc, lsm_string_list_free, jobs);
+
+    rc = lsm_volume_mask_bulk(c, group, vols, 0, &results,
+                              LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_access_group_delete, c, group, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_access_group_record_free, group);
+    for (i = 0; i < 4; ++i) {
+        G(rc, lsm_volume_record_free, vols[i]);
+    }
+    G(rc, lsm_system_record_free, system);
+    G(rc, lsm_pool_record_free, pool);
+}
+END_TEST
+
+START_TEST(test_job_wait) {
+    lsm_pool *pool = NULL;
+    lsm_volume *vol = NULL;
+    lsm_job_status status;
+    uint8_t pc = 0;
+    uint32_t index = 0;
+    char *jobs[2] = {NULL, NULL};
+    char *job = NULL;
+    const char *missing[2] = {"NOT_A_JOB", "NOT_A_JOB_EITHER"};
+    char name[32];
+    uint32_t i = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+    pool = get_test_pool(c);
+
+    for (i = 0; i < 2; ++i) {
+        snprintf(name, sizeof(name), "job_wait_%u", i);
+        rc = lsm_volume_create(c, pool, name, 20000000,
+                               LSM_VOLUME_PROVISION_DEFAULT, &vol, &jobs[i],
+                               LSM_CLIENT_FLAG_RSVD);
+        ck_assert_msg(rc == LSM_ERR_OK || rc == LSM_ERR_JOB_STARTED,
+                      "lsm_volume_create %d (%s)", rc,
+                      error(lsm_error_last_get(c)));
+        if (LSM_ERR_OK == rc) {
+            G(rc, lsm_volume_record_free, vol);
+            vol = NULL;
+        }
+    }
+
+    if (jobs[0] && jobs[1]) {
+        G(rc, lsm_jobs_wait_any, c, (const char **)jobs, 2, 100, 30000,
+          &index, &status, &pc, LSM_CLIENT_FLAG_RSVD);
+        ck_assert_msg(index < 2, "index = %" PRIu32, index);
+        ck_assert_msg(LSM_JOB_COMPLETE == status, "status = %d", status);
+        ck_assert_msg(100 == pc, "Percent complete %d", pc);
+
+        for (i = 0; i < 2; ++i) {
+            G(rc, lsm_job_wait, c, jobs[i], 100, 30000, &status, &pc,
+              LSM_CLIENT_FLAG_RSVD);
+            ck_assert_msg(LSM_JOB_COMPLETE == status, "status = %d", status);
+
+            /* Completed, so the volume comes back without waiting */
+            vol = wait_for_job_vol(c, &jobs[i]);
+            rc = lsm_volume_delete(c, vol, &job, LSM_CLIENT_FLAG_RSVD);
+            if (LSM_ERR_JOB_STARTED == rc) {
+                wait_for_job(c, &job);
+            } else {
+                ck_assert_msg(LSM_ERR_OK == rc, "rc = %d", rc);
+            }
+            G(rc, lsm_volume_record_free, vol);
+            vol = NULL;
+        }
+    }
+
+    rc = lsm_jobs_wait_any(c, missing, 2, 100, 1000, &index, &status, &pc,
+                           LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_NOT_FOUND_JOB == rc, "rc = %d", rc);
+
+    rc = lsm_jobs_wait_any(c, missing, 0, 100, 1000, &index, &status, &pc,
+                           LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    rc = lsm_job_wait(c, "NOT_A_JOB", 101, 1000, &status, &pc,
+                      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    G(rc, lsm_pool_record_free, pool);
+}
+END_TEST
+
+#define SHARED_THREADS 8
+#define SHARED_CALLS   50
+
+/*
+ * Calls made on the connection from a thread of its own.  Only the test's
+ * thread can fail the test, so what went wrong is counted and handed back.
+ */
+static void *shared_connection_calls(void *arg) {
+    uintptr_t failed = 0;
+    uint32_t i = 0;
+
+    (void)arg;
+    for (i = 0; i < SHARED_CALLS; ++i) {
+        lsm_pool **pools = NULL;
+        uint32_t count = 0;
+        lsm_job_status status;
+        uint8_t pc = 0;
+        lsm_error_ptr e = NULL;
+        int rc = lsm_pool_list(c, NULL, NULL, &pools, &count,
+                               LSM_CLIENT_FLAG_RSVD);
+
+        if (LSM_ERR_OK != rc || 0 == count) {
+            failed++;
+        }
+        if (pools) {
+            lsm_pool_record_array_free(pools, count);
+        }
+
+        // The calls of the other threads leave this thread's error alone
+        rc = lsm_job_status_get(c, "NOT_A_JOB", &status, &pc,
+                                LSM_CLIENT_FLAG_RSVD);
+        e = lsm_error_last_get(c);
+        if (LSM_ERR_NOT_FOUND_JOB != rc || !e ||
+            LSM_ERR_NOT_FOUND_JOB != lsm_error_number_get(e)) {
+            failed++;
+        }
+        if (e) {
+            lsm_error_free(e);
+        }
+    }
+    return (void *)failed;
+}
+
+START_TEST(test_shared_connection) {
+    pthread_t threads[SHARED_THREADS];
+    lsm_job_status status;
+    lsm_error_ptr e = NULL;
+    uint8_t pc = 0;
+    uint32_t i = 0;
+    void *failed = NULL;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+
+    rc = lsm_job_status_get(c, "NOT_A_JOB", &status, &pc,
+                            LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_NOT_FOUND_JOB == rc, "rc = %d", rc);
+
+    for (i = 0; i < SHARED_THREADS; ++i) {
+        rc = pthread_create(&threads[i], NULL, shared_connection_calls, NULL);
+        ck_assert_msg(0 == rc, "pthread_create %d", rc);
+    }
+
+    for (i = 0; i < SHARED_THREADS; ++i) {
+        rc = pthread_join(threads[i], &failed);
+        ck_assert_msg(0 == rc, "pthread_join %d", rc);
+        ck_assert_msg(NULL == failed, "thread %" PRIu32 " failed %p calls", i,
+                      failed);
+    }
+
+    // Still the error of this thread's last call
+    e = lsm_error_last_get(c);
+    ck_assert_msg(e != NULL, "e = %p", e);
+    ck_assert_msg(LSM_ERR_NOT_FOUND_JOB == lsm_error_number_get(e),
+                  "error %d", lsm_error_number_get(e));
+    G(rc, lsm_error_free, e);
+}
+END_TEST
+
+START_TEST(test_list_page) {
+    lsm_disk **disks = NULL;
+    lsm_disk **page = NULL;
+    lsm_volume **vols = NULL;
+    lsm_volume **vol_page = NULL;
+    lsm_pool **pools = NULL;
+    char *cursor = NULL;
+    char *next = NULL;
+    uint32_t disk_count = 0;
+    uint32_t page_count = 0;
+    uint32_t vol_count = 0;
+    uint32_t pool_count = 0;
+    uint32_t seen = 0;
+    uint32_t i = 0;
+    int rc = 0;
+
+    ck_assert_msg(c != NULL, "c = %p", c);
+
+    G(rc, lsm_disk_list, c, NULL, NULL, &disks, &disk_count,
+      LSM_CLIENT_FLAG_RSVD);
+
+    // Walking the pages gives back the full listing in the same order
+    do {
+        G(rc, lsm_disk_list_page, c, NULL, NULL, 2, cursor, &page,
+          &page_count, &next, LSM_CLIENT_FLAG_RSVD);
+        ck_assert_msg(page_count <= 2, "page_count = %" PRIu32, page_count);
+
+        for (i = 0; i < page_count; ++i) {
+            ck_assert_msg(seen < disk_count, "more disks than %" PRIu32,
+                          disk_count);
+            ASSERT_STR_MATCH(lsm_disk_id_get(page[i]),
+                             lsm_disk_id_get(disks[seen]));
+            ++seen;
+        }
+        if (page) {
+            G(rc, lsm_disk_record_array_free, page, page_count);
+            page = NULL;
+        }
+        free(cursor);
+        cursor = next;
+        next = NULL;
+    } while (cursor);
+    ck_assert_msg(seen == disk_count, "count %" PRIu32 " != %" PRIu32, seen,
+                  disk_count);
+
+    // Search keys apply before the page is cut
+    G(rc, lsm_pool_list, c, NULL, NULL, &pools, &pool_count,
+      LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(pool_count > 0, "pool_count = %" PRIu32, pool_count);
+    G(rc, lsm_volume_list, c, "pool_id", lsm_pool_id_get(pools[0]), &vols,
+      &vol_count, LSM_CLIENT_FLAG_RSVD);
+    G(rc, lsm_volume_list_page, c, "pool_id", lsm_pool_id_get(pools[0]), 1,
+      NULL, &vol_page, &page_count, &next, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(page_count == (vol_count ? 1 : 0), "page_count = %" PRIu32,
+                  page_count);
+    if (page_count) {
+        ASSERT_STR_MATCH(lsm_volume_id_get(vol_page[0]),
+                         lsm_volume_id_get(vols[0]));
+    }
+    ck_assert_msg((vol_count > 1) == (next != NULL), "next = %p", next);
+    free(next);
+    next = NULL;
+    if (vol_page) {
+        G(rc, lsm_volume_record_array_free, vol_page, page_count);
+    }
+
+    rc = lsm_disk_list_page(c, NULL, NULL, 0, NULL, &page, &page_count, &next,
+                            LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+
+    rc = lsm_disk_list_page(c, NULL, NULL, 1, "not-a-cursor", &page,
+                            &page_count, &next, LSM_CLIENT_FLAG_RSVD);
+    ck_assert_msg(LSM_ERR_INVALID_ARGUMENT == rc, "rc = %d", rc);
+    ck_assert_msg(next == NULL, "next = %p", next);
+
+    if (vols) {
+        G(rc, lsm_volume_record_array_free, vols, vol_count);
+    }
+    G(rc, lsm_pool_record_array_free, pools, pool_count);
+    G(rc, lsm_disk_record_array_free, disks, disk_count);
+}
+END_TEST
+
 Suite *lsm_suite(void) {
     Suite *s = suite_create("libStorageMgmt");
 
@@ -4295,6 +5117,17 @@ Suite *lsm_suite(void) {
     tcase_add_test(basic, test_local_disk_fault_led);
     tcase_add_test(basic, test_local_disk_led_status_get);
     tcase_add_test(basic, test_local_disk_link_speed_get);
+    tcase_add_test(basic, test_ipc_encoding);
+    tcase_add_test(basic, test_json_escaping);
+    tcase_add_test(basic, test_rpc_submit);
+    tcase_add_test(basic, test_list_iter);
+    tcase_add_test(basic, test_list_page);
+    tcase_add_test(basic, test_connect_stats);
+    tcase_add_test(basic, test_connect_cache);
+    tcase_add_test(basic, test_batch);
+    tcase_add_test(basic, test_bulk);
+    tcase_add_test(basic, test_job_wait);
+    tcase_add_test(basic, test_shared_connection);
 
     suite_add_tcase(s, basic);
     return s;
@@ -34,6 +34,21 @@ my $C_LIB_HEADER = "$LSM_CODE_BASE_DIR"
                    . "/c_binding/include/libstoragemgmt/libstoragemgmt.h";
 my %C_ACCEPT_LIST = (
     'ANON_UID_GID_NA'=> 1,
+    # lsm_rpc_submit() is C only, python has Client.pipeline() instead.
+    'LSM_RPC_SYSTEM_LIST' => 1,
+    'LSM_RPC_POOL_LIST' => 1,
+    'LSM_RPC_VOLUME_LIST' => 1,
+    'LSM_RPC_DISK_LIST' => 1,
+    'LSM_RPC_FS_LIST' => 1,
+    'LSM_RPC_ACCESS_GROUP_LIST' => 1,
+    'LSM_RPC_TARGET_PORT_LIST' => 1,
+    'LSM_RPC_BATTERY_LIST' => 1,
+    # python keeps it as TransPort.HISTOGRAM_BUCKETS, not part of the API.
+    'LSM_RPC_STATS_HISTOGRAM_BUCKETS' => 1,
+    # The response cache is C only.
+    'LSM_CACHE_SYSTEMS' => 1,
+    'LSM_CACHE_POOLS' => 1,
+    'LSM_CACHE_CAPABILITIES' => 1,
 );
 my $REGEX_HEX = qr/[0-9a-fA-F]/;
 
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: LGPL-2.1-or-later
+#
+# Copyright (C) 2026 Red Hat, Inc.
+
+# Measures how fast lsmd accepts connections and starts plug-ins for them.
+# The plug-ins are a trivial shell script which exits straight away, so what
+# is measured is lsmd itself: accepting, forking, exec'ing and reaping.
+#
+# Give --lsmd more than once to compare builds, eg. before and after a
+# change.  With --plugins above 1024 an lsmd using select() can't serve at
+# all.
+#
+# Example, from a built tree:
+#   tools/utility/lsmd_accept_bench.py --lsmd /tmp/lsmd.old \
+#       --lsmd daemon/lsmd --plugins 16 --count 2000 --threads 8
+
+import argparse
+import os
+import resource
+import shutil
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+PLUGIN_SCRIPT = "#!/bin/sh\nexit 0\n"
+
+
+def plugin_dir_create(work, count):
+    pdir = os.path.join(work, 'plugins')
+    os.mkdir(pdir)
+    script = os.path.join(work, 'bench_plugin.sh')
+    with open(script, 'w') as f:
+        f.write(PLUGIN_SCRIPT)
+    os.chmod(script, 0o755)
+    for i in range(count):
+        os.symlink(script, os.path.join(pdir, 'bench%d_lsmplugin' % i))
+    return pdir
+
+
+def raise_fd_limit():
+    _, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+
+def zombies(ppid):
+    count = 0
+    for pid in os.listdir('/proc'):
+        if not pid.isdigit():
+            continue
+        try:
+            with open('/proc/%s/stat' % pid) as f:
+                fields = f.read().rsplit(')', 1)[1].split()
+        except (IOError, IndexError):
+            continue
+        if fields[0] == 'Z' and int(fields[1]) == ppid:
+            count += 1
+    return count
+
+
+def client(sockets, count, times):
+    for i in range(count):
+        path = sockets[i % len(sockets)]
+        start = time.perf_counter()
+        s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            s.connect(path)
+            # The plug-in exits straight away, EOF means it was started
+            s.recv(1)
+        except socket.error:
+            # lsmd is gone
+            return
+        finally:
+            s.close()
+        times.append(time.perf_counter() - start)
+
+
+def run_lsmd(lsmd_bin, args):
+    work = tempfile.mkdtemp(prefix='lsmd_bench_')
+    ipc = os.path.join(work, 'ipc')
+    conf = os.path.join(work, 'conf')
+    os.mkdir(ipc)
+    os.mkdir(conf)
+    pdir = plugin_dir_create(work, args.plugins)
+
+    lsmd = subprocess.Popen([
+        lsmd_bin, '--plugindir', pdir, '--socketdir', ipc, '--confdir',
+        conf, '-d'
+    ],
+                            stdout=subprocess.DEVNULL,
+                            preexec_fn=raise_fd_limit)
+    try:
+        deadline = time.time() + 10
+        while len(os.listdir(ipc)) < args.plugins:
+            if lsmd.poll() is not None or time.time() > deadline:
+                return None
+            time.sleep(0.05)
+
+        sockets = [
+            os.path.join(ipc, 'bench%d' % i) for i in range(args.plugins)
+        ]
+        per_thread = args.count // args.threads
+        times = []
+        threads = [
+            threading.Thread(target=client,
+                             args=(sockets, per_thread, times))
+            for _ in range(args.threads)
+        ]
+
+        start = time.perf_counter()
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        elapsed = time.perf_counter() - start
+
+        time.sleep(1)
+        if lsmd.poll() is not None or not times:
+            return None
+        return times, elapsed, zombies(lsmd.pid)
+    finally:
+        lsmd.send_signal(signal.SIGTERM)
+        lsmd.wait()
+        shutil.rmtree(work)
+
+
+def report(name, result):
+    if result is None:
+        print("%s: lsmd failed to serve" % name)
+        return
+    times, elapsed, left = result
+    times = sorted(times)
+    print("%s: %d connections in %.2f s, %.0f/s, median %.2f ms, "
+          "p99 %.2f ms, unreaped children 1s later %d" %
+          (name, len(times), elapsed, len(times) / elapsed,
+           times[len(times) // 2] * 1000, times[int(len(times) * 0.99)] *
+           1000, left))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure lsmd connection accept rate')
+    parser.add_argument('--lsmd',
+                        required=True,
+                        action='append',
+                        help='lsmd binary, give more than once to compare')
+    parser.add_argument('--plugins',
+                        type=int,
+                        default=1,
+                        help='number of plug-in sockets')
+    parser.add_argument('--count',
+                        type=int,
+                        default=1000,
+                        help='total connections')
+    parser.add_argument('--threads',
+                        type=int,
+                        default=4,
+                        help='concurrent clients')
+    args = parser.parse_args()
+
+    for lsmd_bin in args.lsmd:
+        report(lsmd_bin, run_lsmd(lsmd_bin, args))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
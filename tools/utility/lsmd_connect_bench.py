@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: LGPL-2.1-or-later
+#
+# Copyright (C) 2026 Red Hat, Inc.
+
+# Measures how long lsm.Client() takes to connect through lsmd, once with
+# every connection starting a new plug-in and once with a warm pool of idle
+# plug-ins (plugin-warm-pool-size in lsmd.conf).
+#
+# Example, from a built tree:
+#   PYTHONPATH=<python lib> LSM_SIM_DATA=/tmp/bench_sim.db \
+#       tools/utility/lsmd_connect_bench.py --lsmd daemon/lsmd \
+#       --plugindir <dir with sim_lsmplugin> --uri sim://
+
+import argparse
+import os
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+import lsm
+
+
+def connect_times(uri, count, gap):
+    times = []
+    for _ in range(count):
+        start = time.perf_counter()
+        c = lsm.Client(uri)
+        c.systems()
+        times.append(time.perf_counter() - start)
+        c.close()
+        # Give lsmd time to start the replacement idle plug-in
+        time.sleep(gap)
+    return times
+
+
+def run_lsmd(args, pool_size):
+    work = tempfile.mkdtemp(prefix='lsmd_bench_')
+    ipc = os.path.join(work, 'ipc')
+    conf = os.path.join(work, 'conf')
+    os.mkdir(ipc)
+    os.mkdir(conf)
+
+    with open(os.path.join(conf, 'lsmd.conf'), 'w') as f:
+        f.write('plugin-warm-pool-size = %d;\n' % pool_size)
+
+    lsmd = subprocess.Popen([
+        args.lsmd, '--plugindir', args.plugindir, '--socketdir', ipc,
+        '--confdir', conf, '-d'
+    ],
+                            stdout=subprocess.DEVNULL)
+    os.environ['LSM_UDS_PATH'] = ipc
+
+    try:
+        # Wait for the sockets and for the idle plug-ins to finish starting
+        deadline = time.time() + 10
+        while not os.listdir(ipc) and time.time() < deadline:
+            time.sleep(0.05)
+        time.sleep(args.settle)
+
+        return connect_times(args.uri, args.count, args.gap)
+    finally:
+        lsmd.send_signal(signal.SIGTERM)
+        lsmd.wait()
+        shutil.rmtree(work)
+
+
+def report(name, times):
+    times = sorted(times)
+    print("%-12s n=%-4d min %8.1f ms  median %8.1f ms  p90 %8.1f ms" %
+          (name, len(times), times[0] * 1000, times[len(times) // 2] * 1000,
+           times[int(len(times) * 0.9)] * 1000))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compare lsmd connect latency with and without a warm '
+        'plug-in pool')
+    parser.add_argument('--lsmd', required=True, help='lsmd binary')
+    parser.add_argument('--plugindir',
+                        required=True,
+                        help='directory holding the plug-ins')
+    parser.add_argument('--uri', default='sim://', help='URI to connect to')
+    parser.add_argument('--count',
+                        type=int,
+                        default=20,
+                        help='connections per mode')
+    parser.add_argument('--pool',
+                        type=int,
+                        default=2,
+                        help='plugin-warm-pool-size of the warm mode')
+    parser.add_argument('--gap',
+                        type=float,
+                        default=0.5,
+                        help='seconds between connections')
+    parser.add_argument('--settle',
+                        type=float,
+                        default=2,
+                        help='seconds to let lsmd start up')
+    args = parser.parse_args()
+
+    report('cold', run_lsmd(args, 0))
+    report('warm (%d)' % args.pool, run_lsmd(args, args.pool))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())